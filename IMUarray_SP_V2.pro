@@ -4,11 +4,31 @@
 #
 #-------------------------------------------------
 
-QT       += core gui charts serialport
+# 默认构建图形界面程序；qmake CONFIG+=headless 构建无界面的命令行采集程序
+# （只依赖 QtCore、QtSerialPort 和 QtNetwork，用于长时间无人值守记录）；
+# qmake CONFIG+=benchmark 构建热点路径基准测试（可在 offscreen 平台下运行）；
+# qmake CONFIG+=converter 构建离线转换程序（CSV/二进制记录 → NumPy .npy，--analyze 为噪声分析）
+headless {
+    QT       = core serialport network
+    CONFIG  += console
+    CONFIG  -= app_bundle
+    TARGET   = IMUarray_SP_V2_cli
+} else: converter {
+    QT       = core serialport network
+    CONFIG  += console
+    CONFIG  -= app_bundle
+    TARGET   = IMUarray_SP_V2_convert
+} else: benchmark {
+    QT       += core gui charts serialport network widgets
+    CONFIG  += console
+    CONFIG  -= app_bundle
+    TARGET   = IMUarray_SP_V2_bench
+} else {
+    QT       += core gui charts serialport network
+    greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+    TARGET   = IMUarray_SP_V2
+}
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-TARGET = IMUarray_SP_V2
 TEMPLATE = app
 
 # The following define makes your compiler emit warnings if you use
@@ -24,22 +44,118 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 CONFIG += c++11
 
+# 采集核心：图形界面、命令行、离线转换和基准测试共用
 SOURCES += \
-        main.cpp \
-        mainwindow.cpp
+        acquisitionworker.cpp \
+        framelayout.cpp \
+        framesynchronizer.cpp \
+        binaryrecorder.cpp \
+        recordingreader.cpp \
+        csvencoder.cpp \
+        asyncfilewriter.cpp \
+        fileutil.cpp \
+        replaysource.cpp \
+        frameclock.cpp \
+        pipelinestats.cpp \
+        imuarraystats.cpp \
+        dspstage.cpp \
+        csvrecorder.cpp \
+        imucalibration.cpp \
+        attitudefilter.cpp \
+        serialtuning.cpp \
+        framemerger.cpp \
+        recordingcodec.cpp \
+        recordingsegments.cpp \
+        csvparser.cpp \
+        recordingconverter.cpp \
+        noiseanalysis.cpp \
+        recordinganalyzer.cpp \
+        metricsserver.cpp
 
 HEADERS += \
-        mainwindow.h
+        imuframe.h \
+        framelayout.h \
+        spscringbuffer.h \
+        acquisitionworker.h \
+        framesynchronizer.h \
+        recordingformat.h \
+        binaryrecorder.h \
+        recordingreader.h \
+        csvencoder.h \
+        asyncfilewriter.h \
+        fileutil.h \
+        replaysource.h \
+        frameclock.h \
+        pipelinestats.h \
+        imuarraystats.h \
+        dspstage.h \
+        csvrecorder.h \
+        imucalibration.h \
+        attitudefilter.h \
+        serialtuning.h \
+        framemerger.h \
+        recordingcodec.h \
+        recordingsegments.h \
+        csvparser.h \
+        recordingconverter.h \
+        noiseanalysis.h \
+        recordinganalyzer.h \
+        metricsserver.h
+
+# 跨IMU统计的 AVX 内核单独按 AVX 指令集编译（Qt simd 特性的 AVX_SOURCES），运行时检测到CPU支持才调用；
+# 非 x86 平台只有标量内核
+contains(QT_ARCH, x86_64)|contains(QT_ARCH, i386) {
+    CONFIG += simd
+    AVX_SOURCES += imuarraystats_avx.cpp
+    DEFINES += IMU_HAVE_AVX_KERNEL
+}
+
+headless {
+    SOURCES += \
+            climain.cpp
+} else: converter {
+    SOURCES += \
+            convertmain.cpp
+} else {
+    # 界面文本和图表：图形界面和基准测试共用
+    SOURCES += \
+            displayformatter.cpp \
+            imuchart.cpp \
+            minmaxpyramid.cpp \
+            framelogmodel.cpp \
+            recordingview.cpp
+
+    HEADERS += \
+            displayformatter.h \
+            imuchart.h \
+            minmaxpyramid.h \
+            framelogmodel.h \
+            recordingview.h
+}
+
+benchmark {
+    SOURCES += \
+            benchmain.cpp
+} else: !headless:!converter {
+    SOURCES += \
+            main.cpp \
+            mainwindow.cpp \
+            analysisdialog.cpp
 
-FORMS += \
-        mainwindow.ui
+    HEADERS += \
+            mainwindow.h \
+            analysisdialog.h
+
+    FORMS += \
+            mainwindow.ui
+
+    RESOURCES += \
+        icon.qrc
+
+    RC_ICONS = 3D_IMUArray.ico
+}
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
-
-RESOURCES += \
-    icon.qrc
-
-RC_ICONS = 3D_IMUArray.ico
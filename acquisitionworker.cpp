@@ -0,0 +1,869 @@
+#include "acquisitionworker.h"
+#include "serialtuning.h"
+#include <QFileInfo>
+#include <QDebug>
+
+AcquisitionWorker::AcquisitionWorker(QObject *parent) :
+    QObject(parent),
+    totalBytesReceived(0),
+    validFramesReceived(0),
+    invalidFramesReceived(0),
+    actualFrequency(0),
+    clockDriftPpm(0),
+    arrivalJitterMs(0),
+    droppedBytes(0),
+    droppedFrames(0),
+    displaySkippedFrames(0),
+    backlogBytes(0),
+    overloadPolicy(DrainAll),
+    imuCount(DEFAULT_IMU_COUNT),
+    expectedRate(DEFAULT_FRAME_RATE),
+    saturatedFrames(0),
+    saturatedImuMask(0),
+    stuckImuMask(0),
+    dspEnabled(false),
+    dspBiasProgress(1),
+    dspFramesOut(0),
+    attitudeEnabled(false),
+    recording(false),
+    attitudeRecorder(CsvRecorder::OrientationColumns)
+{
+    // 串口以本对象为父对象，随 moveToThread 一起迁移到采集线程
+    serialcheck = new QSerialPort(this);
+    // 记录文件默认每秒同步一次、按64MB预分配
+    writerPolicy.syncIntervalMs = 1000;
+    writerPolicy.preallocateBytes = 64u * 1024 * 1024;
+    savingStartMs = 0;
+    countedResyncs = synchronizer.resyncEvents();
+    rawBuffer = nullptr;
+    gapFile = nullptr;
+    replayStartFrames = 0;
+    countedTailMismatches = 0;
+    countedDiscardedBytes = 0;
+    nextSequence = 0;
+    displayPhase = 0;
+    batchSize = 0;
+    selectedFormat = &defaultFrameFormat();
+    frameClock.setNominalRate(DEFAULT_FRAME_RATE);
+    replay.setNominalFrameRate(DEFAULT_FRAME_RATE);
+    applyFrameFormat(*selectedFormat);
+    resetTiming();
+
+    connect(serialcheck, &QSerialPort::readyRead, this, &AcquisitionWorker::onSerialDataReceived);
+    connect(serialcheck, &QSerialPort::errorOccurred, this, &AcquisitionWorker::onSerialError);
+
+    // CSV 和二进制记录不会同时打开，写盘延迟直方图始终只有一个写盘线程写入（处理后数据的旁路文件不计入）
+    csvRecorder.setLatencyHistogram(&pipeline.writeLatency);
+    binaryRecorder.setLatencyHistogram(&pipeline.writeLatency);
+    dsp.setCostHistogram(&pipeline.dspCost);
+    dspStats.setHealthChecks(false);
+    dspText = QString::fromStdString(dsp.describe());
+    attitude.setCostHistogram(&pipeline.attitudeCost);
+    updateAttitudeText();
+
+    replayTimer = new QTimer(this);
+    connect(replayTimer, &QTimer::timeout, this, &AcquisitionWorker::onReplayTick);
+}
+
+AcquisitionWorker::~AcquisitionWorker()
+{
+    stopReplay();
+    stopRawCapture();
+    stopSaving();
+    if (serialcheck->isOpen())  serialcheck->close();
+}
+
+QString AcquisitionWorker::setFrameFormat(int count)
+{
+    const FrameFormat *format = findFrameFormat(count);
+    if (!format)    return QString("不支持 %1 个IMU的帧格式").arg(count);
+    selectedFormat = format;
+    return QString();
+}
+
+QString AcquisitionWorker::setExpectedRate(double hz)
+{
+    if (!(hz > 0 && hz <= 1.0e6))   return QString("无效的帧率 %1 Hz").arg(hz);
+    // 滤波器按理论帧率设计，截止频率等须对新的帧率仍然有效
+    DspStage::Config config = dsp.config();
+    config.sampleRate = hz;
+    std::string error;
+    if (!dsp.configure(config, &error))
+    {
+        return QString("帧率 %1 Hz 与实时信号处理设置不符: %2").arg(hz).arg(QString::fromStdString(error));
+    }
+    dspBiasProgress = static_cast<float>(dsp.biasProgress());
+    expectedRate = static_cast<float>(hz);
+    frameClock.setNominalRate(hz);
+    replay.setNominalFrameRate(hz);
+    updateBacklogLimit();
+    return QString();
+}
+
+void AcquisitionWorker::updateBacklogLimit()
+{
+    const double frames = expectedRate * BACKLOG_LIMIT_MS / 1000.0;
+    backlogLimitBytes = static_cast<qint64>(synchronizer.format().frameSize) * qMax<qint64>(1, qRound64(frames));
+}
+
+void AcquisitionWorker::applyFrameFormat(const FrameFormat &format)
+{
+    // 切换格式会清空接收缓冲区
+    synchronizer.setFormat(format);
+    updateBacklogLimit();
+    // 接收缓冲区中最多容纳的完整帧数，一批不会超过该值
+    batch.resize(synchronizer.buffer().capacity() / static_cast<std::size_t>(format.frameSize) + 1);
+    batchClockIndex.resize(batch.size());
+    // 处理后的帧不多于输入，一批之内不会重新分配
+    dspFrames.reserve(batch.size());
+    batchSize = 0;
+    imuCount = format.imuCount;
+    arrayStats.reset();
+    saturatedImuMask = 0;
+    stuckImuMask = 0;
+}
+
+QString AcquisitionWorker::openPort(const QString &portName, int baudRate)
+{
+    if (baudRate <= 0)  return QString("无效的波特率 %1").arg(baudRate);
+    serialcheck->setPortName(portName);
+    serialcheck->setBaudRate(baudRate);
+
+    // --- 以下是程序内部固定设置的参数 ---
+    serialcheck->setDataBits(QSerialPort::Data8);      // 数据位：8
+    serialcheck->setStopBits(QSerialPort::OneStop);    // 停止位：1
+    serialcheck->setParity(QSerialPort::NoParity);     // 校验位：无
+    serialcheck->setFlowControl(QSerialPort::NoFlowControl); // 流控制：无
+    // ------------------------------------
+    if (!serialcheck->open(QIODevice::ReadWrite))
+    {
+        return serialcheck->errorString();
+    }
+    // 非标准波特率（例如 2000000、3000000）由 Qt 按平台方式设置，驱动不支持时打开后才会失败
+    if (!serialcheck->setBaudRate(baudRate) || serialcheck->baudRate() != baudRate)
+    {
+        const QString error = QString("串口不支持波特率 %1: %2").arg(baudRate).arg(serialcheck->errorString());
+        serialcheck->close();
+        return error;
+    }
+    // 串口驱动缓冲中的数据随到随读，不限制 QSerialPort 内部缓冲区
+    serialcheck->setReadBufferSize(0);
+#ifdef Q_OS_UNIX
+    std::string tuning;
+    if (!applySerialLowLatency(static_cast<int>(serialcheck->handle()), tuning))
+    {
+        qDebug() << "串口低延迟设置失败:" << QString::fromStdString(tuning);
+    }
+    serialTuning = QString::fromStdString(tuning);
+#else
+    serialTuning = QString("系统默认");
+#endif
+    qDebug() << "串口设置:" << baudRate << "baud," << serialTuning;
+    applyFrameFormat(*selectedFormat);
+    countedTailMismatches = synchronizer.tailMismatches();
+    countedDiscardedBytes = synchronizer.discardedBytes();
+    resetTiming();
+    return QString();
+}
+
+void AcquisitionWorker::resetTiming()
+{
+    frameClock.reset();
+    clockIndexOffset = 0;
+    clockDiscardedBytes = synchronizer.discardedBytes();
+    lastStampNs = 0;
+    lastArrivalNs = 0;
+    dropLogNs = 0;
+    dropLogFrames = 0;
+    // 之后的UTC时间都由单调时钟换算，不受系统校时跳变影响
+    wallClockOffsetNs = QDateTime::currentMSecsSinceEpoch() * 1000000 - steadyClockNs();
+    actualFrequency = 0;
+    clockDriftPpm = 0;
+    arrivalJitterMs = 0;
+    countedResyncs = synchronizer.resyncEvents();
+    pipeline.reset();
+    dsp.reset();
+    dspStats.reset();
+    dspBiasProgress = static_cast<float>(dsp.biasProgress());
+    dspFramesOut = 0;
+    attitude.reset();
+}
+
+void AcquisitionWorker::closePort()
+{
+    if (serialcheck->isOpen())  serialcheck->close();
+    stopRawCapture();
+    stopSaving();
+}
+
+void AcquisitionWorker::onSerialError(QSerialPort::SerialPortError error)
+{
+    // ResourceError 表示设备已不可用，关闭串口并把已收到的数据写完
+    if (error != QSerialPort::ResourceError || !serialcheck->isOpen())  return;
+    QString message = serialcheck->errorString();
+    qDebug() << "串口断开:" << message;
+    closePort();
+    emit portLost(message);
+}
+
+QString AcquisitionWorker::startSaving(const QString &fileName, int format)
+{
+    // 启用实时信号处理时，处理后的帧以相同格式写入 IMU_Data_xxx_dsp.*（同样分段）
+    QFileInfo info(fileName);
+    dspFileName.clear();
+    if (dsp.isEnabled())
+    {
+        dspFileName = info.absolutePath() + "/" + info.completeBaseName() + "_dsp"
+                + (info.suffix().isEmpty() ? QString() : "." + info.suffix());
+    }
+
+    // 加载标定时，校正后的帧以相同格式写入 IMU_Data_xxx_cal.*（同样分段），原始记录保持传感器的原始输出
+    calibratedFileName.clear();
+    if (calibration.isEnabled())
+    {
+        calibratedFileName = info.absolutePath() + "/" + info.completeBaseName() + "_cal"
+                + (info.suffix().isEmpty() ? QString() : "." + info.suffix());
+    }
+
+    // 开启姿态解算时，各IMU的姿态写入 IMU_Data_xxx_attitude.csv（同样分段）
+    attitudeFileName.clear();
+    if (attitude.isEnabled())   attitudeFileName = info.absolutePath() + "/" + info.completeBaseName() + "_attitude.csv";
+
+    QString error;
+    if (format == BinaryFormat || format == CompressedFormat)
+    {
+        const bool compressed = format == CompressedFormat;
+        if (!binaryRecorder.open(fileName, synchronizer.format(), writerPolicy, compressed, segmentLimits, &error))
+        {
+            return error;
+        }
+        if (!dspFileName.isEmpty() && !dspBinaryRecorder.open(dspFileName, synchronizer.format(), writerPolicy,
+                                                              compressed, segmentLimits, &error))
+        {
+            binaryRecorder.close();
+            return error;
+        }
+        if (!calibratedFileName.isEmpty() && !calibratedBinaryRecorder.open(calibratedFileName, synchronizer.format(),
+                                                                            writerPolicy, compressed, segmentLimits, &error))
+        {
+            binaryRecorder.close();
+            dspBinaryRecorder.close();
+            return error;
+        }
+    }
+    else
+    {
+        if (!csvRecorder.open(fileName, writerPolicy, segmentLimits, &error))
+        {
+            return error;
+        }
+        if (!dspFileName.isEmpty() && !dspCsvRecorder.open(dspFileName, writerPolicy, segmentLimits, &error))
+        {
+            csvRecorder.close();
+            return error;
+        }
+        if (!calibratedFileName.isEmpty() && !calibratedCsvRecorder.open(calibratedFileName, writerPolicy, segmentLimits, &error))
+        {
+            csvRecorder.close();
+            dspCsvRecorder.close();
+            return error;
+        }
+    }
+    if (!attitudeFileName.isEmpty() && !attitudeRecorder.open(attitudeFileName, writerPolicy, segmentLimits, &error))
+    {
+        csvRecorder.close();
+        binaryRecorder.close();
+        dspCsvRecorder.close();
+        dspBinaryRecorder.close();
+        calibratedCsvRecorder.close();
+        calibratedBinaryRecorder.close();
+        return error;
+    }
+
+    // 缺口记录文件：IMU_Data_xxx_gaps.csv，仅在保存期间出现丢帧时创建
+    gapFileName = info.absolutePath() + "/" + info.completeBaseName() + "_gaps.csv";
+    // 管线统计从开始保存时重新计算，停止保存时写入 IMU_Data_xxx_stats.txt
+    statsFileName = info.absolutePath() + "/" + info.completeBaseName() + "_stats.txt";
+    savingStartMs = QDateTime::currentMSecsSinceEpoch();
+    pipeline.reset();
+    recording = true;
+    return QString();
+}
+
+void AcquisitionWorker::stopSaving()
+{
+    const bool wasSaving = isSaving();
+    recording = false;
+    const AsyncFileWriter &writer = csvRecorder.isOpen() ? csvRecorder.writer() : binaryRecorder.writer();
+    // close() 提交剩余数据并等待写盘线程全部写完
+    csvRecorder.close();
+    binaryRecorder.close();
+    dspCsvRecorder.close();
+    dspBinaryRecorder.close();
+    calibratedCsvRecorder.close();
+    calibratedBinaryRecorder.close();
+    attitudeRecorder.close();
+    // 写盘线程已结束，写盘延迟完整
+    if (wasSaving)  writeStatsReport(writer);
+    if (gapFile)
+    {
+        gapFile->close();
+        delete gapFile;
+        gapFile = nullptr;
+    }
+}
+
+void AcquisitionWorker::writeStatsReport(const AsyncFileWriter &writer)
+{
+    QFile file(statsFileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qDebug() << "无法创建统计报告文件:" << file.errorString();
+        return;
+    }
+    const qint64 endMs = QDateTime::currentMSecsSinceEpoch();
+    QByteArray header;
+    header += "# IMU 采集管线统计\n";
+    header += "start_utc," + QDateTime::fromMSecsSinceEpoch(savingStartMs, Qt::UTC).toString(Qt::ISODateWithMs).toUtf8() + '\n';
+    header += "duration_s," + QByteArray::number((endMs - savingStartMs) / 1000.0, 'f', 3) + '\n';
+    header += "valid_frames," + QByteArray::number(qint64(validFramesReceived)) + '\n';
+    header += "invalid_frames," + QByteArray::number(qint64(invalidFramesReceived)) + '\n';
+    header += "dropped_bytes," + QByteArray::number(qint64(droppedBytes)) + '\n';
+    header += "dropped_frames," + QByteArray::number(qint64(droppedFrames)) + '\n';
+    header += "frame_rate_hz," + QByteArray::number(double(actualFrequency), 'f', 4) + '\n';
+    header += "clock_drift_ppm," + QByteArray::number(double(clockDriftPpm), 'f', 1) + '\n';
+    header += "arrival_jitter_ms," + QByteArray::number(double(arrivalJitterMs), 'f', 3) + '\n';
+    header += "segments," + QByteArray::number(qint64(writer.segments)) + '\n';
+    header += "syncs," + QByteArray::number(qint64(writer.syncs)) + '\n';
+    if (!dspFileName.isEmpty())
+    {
+        header += "dsp," + dspText.toUtf8() + '\n';
+        header += "dsp_file," + QFileInfo(dspFileName).fileName().toUtf8() + '\n';
+        header += "dsp_frames," + QByteArray::number(qint64(dspFramesOut)) + '\n';
+    }
+    if (!calibratedFileName.isEmpty())
+    {
+        header += "calibration," + QFileInfo(calibrationFile).fileName().toUtf8() + '\n';
+        header += "calibrated_file," + QFileInfo(calibratedFileName).fileName().toUtf8() + '\n';
+    }
+    if (!attitudeFileName.isEmpty())
+    {
+        header += "attitude_gain," + QByteArray::number(attitude.gain(), 'g', 6) + '\n';
+        header += "attitude_file," + QFileInfo(attitudeFileName).fileName().toUtf8() + '\n';
+    }
+    header += '\n';
+    file.write(header);
+    const std::string report = pipeline.report();
+    file.write(report.data(), static_cast<qint64>(report.size()));
+}
+
+void AcquisitionWorker::setFlushPolicy(int intervalMs, int bytes)
+{
+    // 下次开始保存时生效
+    writerPolicy.flushIntervalMs = intervalMs;
+    writerPolicy.flushBytes = static_cast<std::size_t>(bytes);
+}
+
+void AcquisitionWorker::setSyncPolicy(int syncIntervalMs, int preallocateMB)
+{
+    writerPolicy.syncIntervalMs = syncIntervalMs;
+    writerPolicy.preallocateBytes = static_cast<uint64_t>(qMax(0, preallocateMB)) * 1024 * 1024;
+}
+
+void AcquisitionWorker::setSegmentPolicy(int maxMB, int maxSeconds)
+{
+    segmentLimits.maxBytes = static_cast<uint64_t>(qMax(0, maxMB)) * 1024 * 1024;
+    segmentLimits.maxDurationNs = static_cast<int64_t>(qMax(0, maxSeconds)) * 1000000000;
+}
+
+void AcquisitionWorker::setHealthLimits(double accelRange, double gyroRange, int stuckFrames)
+{
+    arrayStats.setFullScale(static_cast<float>(accelRange), static_cast<float>(gyroRange));
+    arrayStats.setStuckFrames(stuckFrames);
+}
+
+QString AcquisitionWorker::setDspConfig(double cutoffHz, int filterOrder, int decimation, int decimator,
+                                        int biasMode, double biasSeconds)
+{
+    DspStage::Config config = DspStage::defaultConfig(expectedRate);
+    config.cutoffHz = cutoffHz;
+    config.filterOrder = filterOrder;
+    config.decimation = decimation;
+    config.decimator = decimator == DspStage::CicDecimator ? DspStage::CicDecimator : DspStage::MovingAverage;
+    config.biasMode = static_cast<DspStage::BiasMode>(qBound(0, biasMode, static_cast<int>(DspStage::AllBias)));
+    config.biasSeconds = biasSeconds;
+    std::string error;
+    if (!dsp.configure(config, &error)) return QString::fromStdString(error);
+    dspEnabled = dsp.isEnabled();
+    dspBiasProgress = static_cast<float>(dsp.biasProgress());
+    dspText = QString::fromStdString(dsp.describe());
+    qDebug() << "实时信号处理:" << dspText;
+    return QString();
+}
+
+QString AcquisitionWorker::setCalibrationFile(const QString &fileName)
+{
+    if (isSaving()) return QString("保存期间不能更改标定");
+    if (fileName.isEmpty())
+    {
+        calibration.clear();
+        calibrationFile.clear();
+        updateAttitudeText();
+        return QString();
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))    return file.errorString();
+    // 标定文件每个传感器一行，32个IMU也只有几KB
+    if (file.size() > 1024 * 1024)          return QString("%1 不是标定文件（过大）").arg(fileName);
+    const QByteArray text = file.readAll();
+    std::string error;
+    if (!calibration.parse(text.constData(), static_cast<std::size_t>(text.size()), &error))
+    {
+        return QString::fromStdString(error);
+    }
+    calibrationFile = fileName;
+    updateAttitudeText();
+    qDebug() << "标定:" << attitudeText;
+    return QString();
+}
+
+QString AcquisitionWorker::setAttitudeFilter(bool enabled, double gain)
+{
+    if (isSaving()) return QString("保存期间不能更改姿态解算");
+    if (!(gain > 0 && gain <= 10))  return QString("无效的姿态解算增益 %1（须在 0 ~ 10 之间）").arg(gain);
+    attitude.setGain(gain);
+    attitude.setEnabled(enabled);
+    attitude.reset();
+    attitudeEnabled = enabled;
+    updateAttitudeText();
+    return QString();
+}
+
+void AcquisitionWorker::updateAttitudeText()
+{
+    QStringList lines;
+    if (calibration.isEnabled())
+    {
+        lines << QString("标定: %1（%2 个IMU，%3 个传感器，%4）").arg(QFileInfo(calibrationFile).fileName())
+                 .arg(calibration.imuCount()).arg(calibration.calibratedSensors())
+                 .arg(ImuCalibration::kernelName(calibration.kernel()));
+    }
+    if (attitude.isEnabled())
+    {
+        lines << QString("姿态解算: Madgwick β=%1（%2）").arg(attitude.gain(), 0, 'g', 4)
+                 .arg(AttitudeFilter::kernelName(attitude.kernel()));
+    }
+    attitudeText = lines.join('\n');
+}
+
+void AcquisitionWorker::recordingStats(quint64 &written, quint64 &queued, quint64 &dropped) const
+{
+    const AsyncFileWriter *writers[] = {
+        &csvRecorder.writer(), &binaryRecorder.writer(), &dspCsvRecorder.writer(), &dspBinaryRecorder.writer(),
+        &calibratedCsvRecorder.writer(), &calibratedBinaryRecorder.writer(), &attitudeRecorder.writer()
+    };
+    written = queued = dropped = 0;
+    for (const AsyncFileWriter *writer : writers)
+    {
+        written += writer->bytesWritten;
+        queued += writer->queuedBytes;
+        dropped += writer->droppedBytes;
+    }
+    written += rawWriter.bytesWritten;
+    queued += rawWriter.queuedBytes;
+    dropped += rawWriter.droppedBytes;
+}
+
+quint64 AcquisitionWorker::recordingFileBytes() const
+{
+    // 写盘线程顺序追加、从不回退，已写入字节数即文件大小（分段时为各段之和；CSV 和二进制不会同时打开）
+    return csvRecorder.writer().bytesWritten + binaryRecorder.writer().bytesWritten;
+}
+
+void AcquisitionWorker::setOverloadPolicy(int policy)
+{
+    overloadPolicy = policy;
+    displayPhase = 0;
+}
+
+QString AcquisitionWorker::startReplay(const QString &fileName, double speed, double corruptionRate)
+{
+    stopReplay();
+    std::string error;
+    replay.setRawFrameFormat(*selectedFormat);
+    if (!replay.open(fileName.toUtf8().toStdString(), &error))  return QString::fromStdString(error);
+    replay.setSpeed(speed);
+    replay.setCorruptionRate(corruptionRate);
+
+    applyFrameFormat(replay.frameFormat());
+    countedTailMismatches = synchronizer.tailMismatches();
+    countedDiscardedBytes = synchronizer.discardedBytes();
+    resetTiming();
+    replayStartFrames = validFramesReceived;
+
+    replayClock.start();
+    // 实时回放每5ms送一次到期的数据；不限速时事件循环一空闲就继续送
+    replayTimer->start(speed > 0 ? 5 : 0);
+    return QString();
+}
+
+void AcquisitionWorker::stopReplay()
+{
+    replayTimer->stop();
+    replay.close();
+}
+
+QString AcquisitionWorker::startRawCapture(const QString &fileName)
+{
+    stopRawCapture();
+    std::string error;
+    if (!rawWriter.open(fileName.toUtf8().toStdString(), writerPolicy, &error))
+    {
+        return QString::fromStdString(error);
+    }
+    rawBuffer = rawWriter.acquireBuffer();
+    return QString();
+}
+
+void AcquisitionWorker::stopRawCapture()
+{
+    if (!rawBuffer) return;
+    rawWriter.submit(rawBuffer);
+    rawBuffer = nullptr;
+    rawWriter.close();
+}
+
+void AcquisitionWorker::onSerialDataReceived()
+{
+    ByteRingBuffer &ring = synchronizer.buffer();
+
+    // 一次处理完全部积压：环形缓冲区读满时先解析腾出空间，再继续读取
+    do
+    {
+        // 直接读入预分配的环形缓冲区，不经过 readAll() 的临时 QByteArray
+        for (;;)
+        {
+            std::size_t space = 0;
+            char *dst = ring.writeRegion(space);
+            if (space == 0) break;
+            qint64 n = serialcheck->read(dst, static_cast<qint64>(space));
+            if (n <= 0) break;
+            ring.commit(static_cast<std::size_t>(n));
+            totalBytesReceived += n;
+            if (rawBuffer)  rawBuffer->insert(rawBuffer->end(), dst, dst + n);
+        }
+        // 每批读取只读一次时钟，作为这批数据的到达时刻
+        const qint64 arrivalNs = steadyClockNs();
+
+        // 串口驱动缓冲中尚未读取的字节也算积压
+        processBuffered(serialcheck->bytesAvailable(), arrivalNs);
+    } while (serialcheck->bytesAvailable() > 0);
+
+    finishBatch();
+}
+
+void AcquisitionWorker::onReplayTick()
+{
+    // 不限速回放时每次最多处理4MB，然后回到事件循环响应停止等命令
+    const std::size_t MAX_BYTES_PER_TICK = 4 * 1024 * 1024;
+    const qint64 elapsedNs = replayClock.nsecsElapsed();
+    ByteRingBuffer &ring = synchronizer.buffer();
+    std::size_t tickBytes = 0;
+
+    for (;;)
+    {
+        std::size_t space = 0;
+        char *dst = ring.writeRegion(space);
+        const std::size_t n = replay.read(dst, space, elapsedNs);
+        ring.commit(n);
+        totalBytesReceived += static_cast<qint64>(n);
+        tickBytes += n;
+
+        processBuffered(0, steadyClockNs());
+        if (n == 0 || tickBytes >= MAX_BYTES_PER_TICK)  break;
+    }
+    finishBatch();
+
+    if (replay.atEnd())
+    {
+        const double seconds = replayClock.nsecsElapsed() / 1.0e9;
+        const qint64 frames = validFramesReceived - replayStartFrames;
+        stopReplay();
+        qDebug() << "回放结束:" << frames << "帧," << seconds << "秒," << frames / seconds << "帧/秒";
+        emit replayFinished(frames, seconds);
+    }
+}
+
+void AcquisitionWorker::processBuffered(qint64 pendingBytes, qint64 arrivalNs)
+{
+    const int policy = overloadPolicy;
+
+    // 积压 = 已读入但未解析的字节 + 数据源中尚未读取的字节
+    const qint64 backlog = static_cast<qint64>(synchronizer.buffer().size()) + pendingBytes;
+    backlogBytes = backlog;
+    PipelineStats::raisePeak(pipeline.backlogPeak, static_cast<quint64>(backlog));
+
+    if (policy == DropOldest && backlog > backlogLimitBytes)
+    {
+        dropOldestFrames(static_cast<std::size_t>(backlog - backlogLimitBytes));
+    }
+
+    // 积压时界面抽帧：每 displayStride 帧只显示一帧，保存不受影响
+    int displayStride = 1;
+    if (policy == DecimateDisplay && backlog > backlogLimitBytes)
+    {
+        displayStride = static_cast<int>(backlog / backlogLimitBytes) + 1;
+    }
+
+    while (parseReceivedData() == 0)
+    {
+        validFramesReceived++;
+    }
+    deliverBatch(arrivalNs, displayStride);
+}
+
+void AcquisitionWorker::finishBatch()
+{
+    // 本批数据交给写盘线程，采集线程不等待磁盘
+    submitPendingWrites();
+    quint64 written = 0, queued = 0, writeDropped = 0;
+    recordingStats(written, queued, writeDropped);
+    PipelineStats::raisePeak(pipeline.writeQueuePeak, queued);
+
+    const quint64 resyncs = synchronizer.resyncEvents();
+    pipeline.resyncEvents += resyncs - countedResyncs;
+    countedResyncs = resyncs;
+
+    // 帧头匹配但尾标不符的假帧计入无效帧
+    quint64 mismatches = synchronizer.tailMismatches();
+    invalidFramesReceived += static_cast<qint64>(mismatches - countedTailMismatches);
+    countedTailMismatches = mismatches;
+
+    // 失步时跳过的垃圾字节计入丢弃字节，保存期间同时记录缺口
+    quint64 discarded = synchronizer.discardedBytes();
+    if (discarded != countedDiscardedBytes)
+    {
+        qint64 bytes = static_cast<qint64>(discarded - countedDiscardedBytes);
+        droppedBytes += bytes;
+        countedDiscardedBytes = discarded;
+        logGap(bytes / synchronizer.format().frameSize, bytes);
+    }
+}
+
+void AcquisitionWorker::dropOldestFrames(std::size_t bytesToDrop)
+{
+    // 仍然经过帧同步器，以便准确统计被丢弃的完整帧数并保持帧对齐
+    ByteRingBuffer &ring = synchronizer.buffer();
+    ImuFrame scratch;
+    const std::size_t before = ring.size();
+    qint64 frameCount = 0;
+
+    while (before - ring.size() < bytesToDrop &&
+           synchronizer.nextFrame(scratch) == FrameSynchronizer::FrameReady)
+    {
+        frameCount++;
+    }
+    if (frameCount == 0)    return;
+
+    nextSequence += static_cast<quint64>(frameCount);
+    droppedFrames += frameCount;
+    // 失步垃圾字节由 finishBatch() 统一统计，这里只计完整帧
+    const qint64 bytes = frameCount * synchronizer.format().frameSize;
+    droppedBytes += bytes;
+    logGap(frameCount, bytes);
+
+    // 持续过载时每次读出都会丢帧：日志汇总为每秒最多一行，避免在采集线程落后时再增加控制台输出
+    dropLogFrames += frameCount;
+    const qint64 nowNs = steadyClockNs();
+    if (dropLogNs == 0 || nowNs - dropLogNs >= 1000000000)
+    {
+        qDebug() << "积压过多，丢弃最旧的" << dropLogFrames << "帧";
+        dropLogNs = nowNs;
+        dropLogFrames = 0;
+    }
+}
+
+void AcquisitionWorker::logGap(qint64 frames, qint64 bytes)
+{
+    if (!isSaving())    return;
+    if (!gapFile)
+    {
+        gapFile = new QFile(gapFileName);
+        if (!gapFile->open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            qDebug() << "无法创建缺口记录文件:" << gapFile->errorString();
+            delete gapFile;
+            gapFile = nullptr;
+            return;
+        }
+        gapFile->write("Timestamp,Sequence,DroppedFrames,DroppedBytes\n");
+    }
+    // 序号为缺口之后下一帧的序号
+    QByteArray line = QByteArray::number(QDateTime::currentDateTimeUtc().toMSecsSinceEpoch())
+            + ',' + QByteArray::number(nextSequence)
+            + ',' + QByteArray::number(frames)
+            + ',' + QByteArray::number(bytes) + '\n';
+    gapFile->write(line);
+    gapFile->flush();
+}
+
+int AcquisitionWorker::parseReceivedData()
+{
+    if (batchSize == batch.size())  return 1;   // 不会发生：批容量按接收缓冲区计算
+
+    ImuFrame &frame = batch[batchSize];
+    // 帧同步：按当前帧格式的专用内核把负载直接解码到 frame，无需中间缓冲（均值在 deliverBatch 中整批计算）
+    if (synchronizer.nextFrame(frame) != FrameSynchronizer::FrameReady)
+    {
+        return 1; // 需要更多数据
+    }
+    frame.sequence = nextSequence++;
+
+    // 失步跳过的字节约等于整帧时，按丢失的帧数推进帧时钟序号，避免模型把缺口当作抖动
+    const quint64 frameSize = static_cast<quint64>(synchronizer.format().frameSize);
+    const quint64 discarded = synchronizer.discardedBytes() - clockDiscardedBytes;
+    if (discarded >= frameSize / 2)
+    {
+        const quint64 lost = (discarded + frameSize / 2) / frameSize;
+        clockIndexOffset += lost;
+        clockDiscardedBytes += lost * frameSize;
+    }
+    batchClockIndex[batchSize] = frame.sequence + clockIndexOffset;
+    batchSize++;
+    return 0;  // 成功解析
+}
+
+void AcquisitionWorker::deliverBatch(qint64 arrivalNs, int displayStride)
+{
+    if (batchSize == 0) return;
+
+    // 本批最后一帧刚刚到达，作为帧时钟的一个观测点；之后按更新后的模型给整批打时间戳
+    frameClock.addSample(batchClockIndex[batchSize - 1], arrivalNs);
+
+    for (std::size_t i = 0; i < batchSize; ++i)
+    {
+        ImuFrame &frame = batch[i];
+        qint64 stampNs = frameClock.timeAt(batchClockIndex[i]);
+        if (stampNs <= lastStampNs) stampNs = lastStampNs + 1;
+        lastStampNs = stampNs;
+        frame.monotonicNs = stampNs;
+        frame.arrivalNs = arrivalNs;
+        frame.timestampMs = (stampNs + wallClockOffsetNs) / 1000000;
+    }
+
+    // === 保存数据到文件 ===
+    // 记录始终保存传感器的原始输出（记录只含时间戳和各IMU的数据，与统计结果无关）
+    for (std::size_t i = 0; i < batchSize; ++i)  saveDataToFile(batch[i]);
+
+    // === 标定 ===
+    // 按各IMU的标定模型原地校正，之后的统计、姿态、信号处理和显示都使用校正后的数据，并另存旁路文件
+    if (calibration.isEnabled())
+    {
+        calibration.apply(batch.data(), batchSize);
+        for (std::size_t i = 0; i < batchSize; ++i)
+        {
+            if (calibratedBinaryRecorder.isOpen())  calibratedBinaryRecorder.write(batch[i]);
+            else                                    calibratedCsvRecorder.write(batch[i]);
+        }
+    }
+
+    // 整批计算均值和跨IMU统计（样本转置为结构数组后用SIMD内核按帧并行计算）
+    arrayStats.process(batch.data(), batchSize);
+    quint32 saturated = 0;
+    qint64 saturatedCount = 0;
+    for (std::size_t i = 0; i < batchSize; ++i)
+    {
+        saturated |= batch[i].saturatedMask;
+        if (batch[i].saturatedMask) saturatedCount++;
+    }
+    saturatedFrames += saturatedCount;
+    saturatedImuMask = saturated;
+    stuckImuMask = batch[batchSize - 1].stuckMask;
+
+    // 读出 → 解析完成（含打时间戳、原始数据编码、标定和统计）；同一批读出的帧到达间隔为0
+    const quint64 count = static_cast<quint64>(batchSize);
+    pipeline.decodeLatency.record(steadyClockNs() - arrivalNs, count);
+    if (lastArrivalNs != 0) pipeline.frameInterval.record(arrivalNs - lastArrivalNs);
+    pipeline.frameInterval.record(0, lastArrivalNs != 0 ? count - 1 : count);
+    lastArrivalNs = arrivalNs;
+    pipeline.rate1s.add(arrivalNs, count);
+    pipeline.rate10s.add(arrivalNs, count);
+
+    // === 姿态解算 ===
+    // 按时间戳的间隔逐帧更新所有IMU的姿态，结果随帧保存和显示（实时信号处理的输出帧沿用组内最后一帧的姿态）
+    attitude.process(batch.data(), batchSize);
+
+    for (std::size_t i = 0; i < batchSize; ++i)
+    {
+        const ImuFrame &frame = batch[i];
+        attitudeRecorder.write(frame);
+
+        // === 交给界面线程 ===
+        if (!dsp.isEnabled())   deliverFrame(frame, displayStride);
+    }
+
+    // === 实时信号处理 ===
+    // 处理后的帧重新计算均值和跨IMU统计，写入旁路文件，并代替原始帧交给界面
+    if (dsp.isEnabled())
+    {
+        dspFrames.clear();
+        dsp.process(batch.data(), batchSize, dspFrames);
+        dspStats.process(dspFrames.data(), dspFrames.size());
+        for (const ImuFrame &frame : dspFrames)
+        {
+            if (dspBinaryRecorder.isOpen()) dspBinaryRecorder.write(frame);
+            else                            dspCsvRecorder.write(frame);
+            deliverFrame(frame, displayStride);
+        }
+        dspFramesOut += static_cast<qint64>(dspFrames.size());
+        dspBiasProgress = static_cast<float>(dsp.biasProgress());
+    }
+    batchSize = 0;
+    PipelineStats::raisePeak(pipeline.frameQueuePeak, frames.size());
+
+    actualFrequency = static_cast<float>(frameClock.rateHz());
+    clockDriftPpm = static_cast<float>(frameClock.driftPpm());
+    arrivalJitterMs = static_cast<float>(frameClock.jitterNs() / 1.0e6);
+}
+
+void AcquisitionWorker::saveDataToFile(const ImuFrame &frame)
+{
+    if (binaryRecorder.isOpen())
+    {
+        // 二进制格式：原样写入负载，无需任何文本转换
+        binaryRecorder.write(frame);
+        return;
+    }
+    csvRecorder.write(frame);
+}
+
+void AcquisitionWorker::deliverFrame(const ImuFrame &frame, int displayStride)
+{
+    // 队列满说明界面来不及取用，界面只需要最新数据，跳过该帧的显示（已保存）
+    if (++displayPhase >= displayStride)
+    {
+        displayPhase = 0;
+        if (!frames.push(frame))    displaySkippedFrames++;
+    }
+    else
+    {
+        displaySkippedFrames++;
+    }
+}
+
+void AcquisitionWorker::submitPendingWrites()
+{
+    csvRecorder.submitPending();
+    binaryRecorder.submitPending();
+    dspCsvRecorder.submitPending();
+    dspBinaryRecorder.submitPending();
+    calibratedCsvRecorder.submitPending();
+    calibratedBinaryRecorder.submitPending();
+    attitudeRecorder.submitPending();
+    if (rawBuffer && !rawBuffer->empty())
+    {
+        rawWriter.submit(rawBuffer);
+        rawBuffer = rawWriter.acquireBuffer();
+    }
+}
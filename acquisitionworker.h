@@ -0,0 +1,254 @@
+#ifndef ACQUISITIONWORKER_H
+#define ACQUISITIONWORKER_H
+
+#include <QObject>
+#include <QSerialPort>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QFile>
+#include <atomic>
+#include <vector>
+#include "imuframe.h"
+#include "spscringbuffer.h"
+#include "framesynchronizer.h"
+#include "binaryrecorder.h"
+#include "csvrecorder.h"
+#include "asyncfilewriter.h"
+#include "replaysource.h"
+#include "frameclock.h"
+#include "imuarraystats.h"
+#include "dspstage.h"
+#include "imucalibration.h"
+#include "attitudefilter.h"
+#include "pipelinestats.h"
+
+// 采集线程工作对象：独占串口和帧解析器，运行在独立的 QThread 中。
+// 数据来源可以是实时串口，也可以是录制文件的回放，两者走完全相同的解析和保存流程。
+// 解析出的帧通过无锁环形队列交给界面线程，界面按自己的刷新节奏取用；
+// 统计计数器为原子变量，界面线程可以无锁读取。
+//
+// 时间戳：每次从数据源读出一批字节时读一次单调时钟（到达时刻），
+// 一批解析完后由帧时钟模型（FrameClock）按帧序号统一重建每帧的采样时刻，
+// 再换算UTC时间、保存和交给界面，因此同一批的帧不会出现重复或锯齿时间戳。
+// 跨IMU统计（均值、离散度、饱和/卡死检测）同样按批计算（ImuArrayStats，SIMD内核）。
+// 加载标定文件后，原始帧先照常保存，然后各IMU的数据按标定模型原地校正（ImuCalibration），
+// 之后的统计、姿态、信号处理和显示都使用校正后的数据，保存时校正后的帧另写旁路文件 *_cal.*；
+// 开启姿态解算时，打好时间戳的帧逐帧更新所有IMU的姿态（AttitudeFilter），
+// 随帧交给界面，保存时另写旁路文件 *_attitude.csv。
+// 启用实时信号处理（DspStage：零偏扣除、低通、抽取）时，原始帧照常保存，
+// 处理后的帧另行计算统计后交给界面，保存时同时写入旁路文件 *_dsp.*。
+class AcquisitionWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 积压过载策略
+    enum OverloadPolicy {
+        DrainAll = 0,           // 全部解析、全部保存，界面队列满时跳过显示
+        DropOldest,             // 积压超过上限时丢弃最旧的帧（保存文件中会出现缺口）
+        DecimateDisplay         // 全部保存，积压时仅对界面显示抽帧
+    };
+    Q_ENUM(OverloadPolicy)
+
+    // 保存格式
+    enum RecordingFormat {
+        CsvFormat = 0,          // 文本CSV（兼容已有分析工具）
+        BinaryFormat,           // 原始二进制 + 时间索引（*.imu）
+        CompressedFormat        // 压缩二进制（*.imuz，无损，写盘线程中编码）
+    };
+    Q_ENUM(RecordingFormat)
+
+    // 积压上限：串口缓冲 + 接收环形缓冲中待解析的数据（约1秒），按理论帧率和当前帧长换算为字节
+    static const int BACKLOG_LIMIT_MS = 1000;
+    // 默认理论帧率（Hz）
+    static const int DEFAULT_FRAME_RATE = 100;
+
+    // 界面消费队列容量（100Hz 时约10秒；界面每100ms取一次，2kHz 时仍有5倍余量）；
+    // 命令行多串口合并时由 FrameMerger 代替界面取用（与 ImuFrameQueue 为同一类型）
+    typedef SpscRingBuffer<ImuFrame, 1024> FrameQueue;
+
+    explicit AcquisitionWorker(QObject *parent = nullptr);
+    ~AcquisitionWorker();
+
+    FrameQueue *frameQueue() { return &frames; }
+    std::size_t frameQueueDepth() const { return frames.size(); }
+
+    // 写盘统计（任意线程可读）：已写入、排队中、因磁盘过慢被丢弃的字节数
+    void recordingStats(quint64 &written, quint64 &queued, quint64 &dropped) const;
+    // 当前（或最近一次）记录数据文件已写入的大小（任意线程可读）
+    quint64 recordingFileBytes() const;
+    // 是否正在保存（任意线程可读；采集线程内判断用 isSaving()）
+    bool isRecording() const { return recording; }
+    // 跨IMU统计使用的SIMD内核（运行时按CPU选择）
+    const char *statsKernelName() const { return ImuArrayStats::kernelName(arrayStats.kernel()); }
+    // 最近一次打开串口时的低延迟设置结果（打开串口后可读）
+    QString serialTuningReport() const { return serialTuning; }
+    // 最近一次保存的管线统计报告文件名（停止保存时写入）
+    QString statsReportFileName() const { return statsFileName; }
+    // 实时信号处理的配置描述（setDspConfig 之后可读）和本次保存的处理后数据文件名（未启用时为空）
+    QString dspDescription() const { return dspText; }
+    QString dspRecordingFileName() const { return dspFileName; }
+    // 标定和姿态解算的描述（每项一行，均未启用时为空）和本次保存的校正后数据、姿态文件名
+    QString attitudeDescription() const { return attitudeText; }
+    QString calibratedRecordingFileName() const { return calibratedFileName; }
+    QString attitudeRecordingFileName() const { return attitudeFileName; }
+
+    // 统计信息（采集线程写，界面线程读）
+    std::atomic<qint64> totalBytesReceived;     // 总接收字节数
+    std::atomic<qint64> validFramesReceived;    // 有效帧数
+    std::atomic<qint64> invalidFramesReceived;  // 无效帧数
+    std::atomic<float> actualFrequency;         // 真实帧率（帧时钟模型估计，收敛前为0）
+    std::atomic<float> clockDriftPpm;           // 设备时钟相对理论帧率的偏差（ppm）
+    std::atomic<float> arrivalJitterMs;         // 到达时刻相对模型的抖动（均方根，毫秒）
+    std::atomic<qint64> droppedBytes;           // 丢弃字节数（失步垃圾 + 策略丢弃）
+    std::atomic<qint64> droppedFrames;          // 按策略丢弃、未保存的帧数
+    std::atomic<qint64> displaySkippedFrames;   // 仅未显示（已保存）的帧数
+    std::atomic<qint64> backlogBytes;           // 最近一次读取时的积压字节数
+    std::atomic<int> overloadPolicy;            // 当前过载策略
+    std::atomic<int> imuCount;                  // 当前数据源的IMU数量（帧格式）
+    std::atomic<float> expectedRate;            // 理论帧率（Hz）
+    std::atomic<qint64> saturatedFrames;        // 有IMU读数达到量程的帧数
+    std::atomic<quint32> saturatedImuMask;      // 最近一批中出现饱和的IMU（bit i 对应第 i+1 个IMU）
+    std::atomic<quint32> stuckImuMask;          // 最近一帧中疑似卡死的IMU
+    std::atomic<bool> dspEnabled;               // 界面收到的是处理后的帧
+    std::atomic<float> dspBiasProgress;         // 零偏估计进度（0~1）
+    std::atomic<qint64> dspFramesOut;           // 处理后输出的帧数
+    std::atomic<bool> attitudeEnabled;          // 帧中带有各IMU的姿态（ImuFrame::orientation）
+    std::atomic<bool> recording;                // 正在保存（开始/停止保存时更新）
+
+    // 管线统计：帧间隔、各阶段延迟、失步次数、队列峰值。
+    // 打开数据源和开始保存时清零，停止保存时写入 *_stats.txt；
+    // 其中 drawLatency 由界面线程在绘制后写入
+    PipelineStats pipeline;
+
+public slots:
+    // 以下函数需在采集线程中执行（通过 QMetaObject::invokeMethod 调用），
+    // 返回空字符串表示成功，否则为错误描述
+    // 串口和原始字节回放使用的帧格式（按IMU数量选择，下次打开数据源时生效）；
+    // 二进制记录回放按文件头中的IMU数量自动选择
+    QString setFrameFormat(int imuCount);
+    // 设备的理论帧率（Hz）：帧时钟收敛前的周期、原始字节回放的节奏和积压上限都按它换算
+    QString setExpectedRate(double hz);
+    QString openPort(const QString &portName, int baudRate);
+    void closePort();
+    QString startSaving(const QString &fileName, int format);
+    void stopSaving();
+    void setOverloadPolicy(int policy);
+    // 写盘策略：最长 intervalMs 毫秒或积累 bytes 字节写一次盘
+    void setFlushPolicy(int intervalMs, int bytes);
+    // 落盘策略：每隔 syncIntervalMs 毫秒 fdatasync 一次（0 只在每段结束时，< 0 从不），
+    // 文件空间按 preallocateMB 兆字节一段预分配（0 不预分配）。下次开始保存时生效
+    void setSyncPolicy(int syncIntervalMs, int preallocateMB);
+    // 分段记录：每段达到 maxMB 兆字节（压缩前）或 maxSeconds 秒后切换到新文件，均为0时不分段。下次开始保存时生效
+    void setSegmentPolicy(int maxMB, int maxSeconds);
+    // 传感器健康检查：加速度/陀螺仪量程（g、deg/s）和判定卡死的连续相同帧数
+    void setHealthLimits(double accelRange, double gyroRange, int stuckFrames);
+    // 实时信号处理（按理论帧率设计滤波器，立即生效并重新估计零偏；均为0时不处理）：
+    // cutoffHz 低通截止频率（0 不滤波），filterOrder Butterworth 阶数，decimation 抽取倍数，
+    // decimator 为 DspStage::Decimator，biasMode 为 DspStage::BiasMode，biasSeconds 零偏估计时长
+    QString setDspConfig(double cutoffHz, int filterOrder, int decimation, int decimator,
+                         int biasMode, double biasSeconds);
+    // 各IMU的标定文件（格式见 ImuCalibration），空字符串为不校正。立即生效，保存期间不能更改
+    QString setCalibrationFile(const QString &fileName);
+    // 姿态解算：gain 为 Madgwick 增益 beta。立即生效（重新初始化），保存期间不能更改
+    QString setAttitudeFilter(bool enabled, double gain);
+
+    // 回放录制文件（原始字节 *.bin 或二进制记录 *.imu）
+    // speed: 回放倍速，<= 0 表示不限速；corruptionRate: 每帧注入错误的概率
+    QString startReplay(const QString &fileName, double speed, double corruptionRate);
+    void stopReplay();
+
+    // 把串口收到的原始字节原样录制下来，供之后回放复现问题
+    QString startRawCapture(const QString &fileName);
+    void stopRawCapture();
+
+signals:
+    // 回放结束：解析出的帧数和耗时（秒）
+    void replayFinished(qint64 frames, double seconds);
+    // 串口意外断开（例如 USB 拔出），端口已关闭，保存已停止
+    void portLost(const QString &error);
+
+private slots:
+    void onSerialDataReceived();
+    void onReplayTick();
+    void onSerialError(QSerialPort::SerialPortError error);
+
+private:
+    // 按过载策略解析环形缓冲区中的全部帧，arrivalNs 为这批字节读出的单调时刻
+    void processBuffered(qint64 pendingBytes, qint64 arrivalNs);
+    void finishBatch();                          // 一批数据处理完后的统计和写盘
+    int parseReceivedData();                     // 解析接收缓冲区中的一帧，暂存到 batch
+    void deliverBatch(qint64 arrivalNs, int displayStride);  // 给暂存的帧打时间戳，保存并交给界面
+    void applyFrameFormat(const FrameFormat &format);  // 新的数据源开始：按帧格式重置帧同步器和批缓冲
+    void updateBacklogLimit();                   // 按理论帧率和帧长计算积压上限
+    void resetTiming();                          // 新的数据源开始：重置帧时钟、UTC锚点和管线统计
+    void writeStatsReport(const AsyncFileWriter &writer);  // 把本次保存期间的管线统计写入 statsFileName
+    void dropOldestFrames(std::size_t bytesToDrop);  // 按 DropOldest 策略丢弃最旧数据
+    void saveDataToFile(const ImuFrame &frame);  // 保存数据到文件
+    void deliverFrame(const ImuFrame &frame, int displayStride);    // 按抽帧间隔交给界面
+    void submitPendingWrites();                  // 把本批编码好的数据交给写盘线程
+    void logGap(qint64 frames, qint64 bytes);    // 记录保存文件中的数据缺口
+    void updateAttitudeText();                   // 按标定和姿态解算的设置更新 attitudeText
+    bool isSaving() const { return csvRecorder.isOpen() || binaryRecorder.isOpen(); }
+
+    QSerialPort *serialcheck;
+    const FrameFormat *selectedFormat;  // 串口和原始字节回放的帧格式
+    FrameSynchronizer synchronizer;   // 接收环形缓冲区 + 帧同步（及当前帧格式）
+    qint64 backlogLimitBytes;         // BACKLOG_LIMIT_MS 毫秒数据对应的字节数
+    qint64 dropLogNs;                 // 上次输出积压丢帧日志的时刻（持续过载时每秒最多一行）
+    qint64 dropLogFrames;             // 之后丢弃、尚未输出日志的帧数
+    QString serialTuning;             // 串口低延迟设置结果
+    quint64 countedTailMismatches;    // 已计入无效帧的尾标错误次数
+    quint64 countedDiscardedBytes;    // 已计入丢弃字节的失步字节数
+    quint64 countedResyncs;           // 已计入管线统计的失步次数
+    quint64 nextSequence;             // 下一帧的序号
+    int displayPhase;                 // 界面抽帧计数
+    FrameQueue frames;                // 交给界面线程的帧队列
+
+    std::vector<ImuFrame> batch;      // 本批已解析、待打时间戳的帧（容量按接收缓冲区预分配）
+    std::vector<quint64> batchClockIndex;   // 对应的帧时钟序号
+    std::size_t batchSize;
+    FrameClock frameClock;            // 帧序号 → 采样时刻 的在线模型
+    ImuArrayStats arrayStats;         // 跨IMU统计和饱和/卡死检测
+    DspStage dsp;                     // 实时信号处理
+    ImuArrayStats dspStats;           // 处理后帧的跨IMU统计（不做健康检查，饱和标记沿用原始帧）
+    std::vector<ImuFrame> dspFrames;  // 本批处理后的帧
+    QString dspText;                  // dsp 的配置描述
+    ImuCalibration calibration;       // 各IMU的标定模型
+    QString calibrationFile;          // 标定文件名（未加载时为空）
+    AttitudeFilter attitude;          // 各IMU的姿态解算
+    QString attitudeText;             // 标定和姿态解算的描述
+    quint64 clockIndexOffset;         // 失步丢失的帧数估计（帧时钟序号 = 帧序号 + 该值）
+    quint64 clockDiscardedBytes;      // 已折算为丢失帧的失步字节数
+    qint64 lastStampNs;               // 上一帧的时间戳，保证严格递增
+    qint64 wallClockOffsetNs;         // UTC纳秒 - 单调时钟纳秒，数据源开始时取一次
+    qint64 lastArrivalNs;             // 上一批的到达时刻，用于帧间隔统计
+
+    AsyncFileWriter::Policy writerPolicy;   // 写盘策略
+    RecordingSegments::Limits segmentLimits;    // 分段条件
+    CsvRecorder csvRecorder;          // CSV 记录器
+    BinaryRecorder binaryRecorder;    // 二进制记录器
+    CsvRecorder dspCsvRecorder;       // 处理后的帧：与原始记录同格式的旁路文件
+    BinaryRecorder dspBinaryRecorder;
+    QString dspFileName;
+    CsvRecorder calibratedCsvRecorder;    // 校正后的帧：与原始记录同格式的旁路文件
+    BinaryRecorder calibratedBinaryRecorder;
+    QString calibratedFileName;
+    CsvRecorder attitudeRecorder;     // 各IMU的姿态四元数（CSV，与数据格式无关）
+    QString attitudeFileName;
+
+    AsyncFileWriter rawWriter;        // 原始串口字节录制
+    AsyncFileWriter::Buffer *rawBuffer;
+
+    ReplaySource replay;              // 回放数据源
+    QTimer *replayTimer;              // 回放节拍定时器
+    QElapsedTimer replayClock;        // 回放开始后的单调时间
+    qint64 replayStartFrames;         // 回放开始时的有效帧数
+    QString gapFileName;              // 缺口记录文件名（出现缺口时才创建）
+    QString statsFileName;            // 管线统计报告文件名（停止保存时写入）
+    qint64 savingStartMs;             // 开始保存的UTC毫秒
+    QFile *gapFile;                   // 缺口记录文件
+};
+
+#endif // ACQUISITIONWORKER_H
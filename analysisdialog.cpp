@@ -0,0 +1,136 @@
+#include "analysisdialog.h"
+#include "imuframe.h"
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPen>
+#include <QVBoxLayout>
+#include <QtCharts/QChartView>
+#include <cmath>
+
+static const char *const SERIES_NAMES[6] = {"Accel X", "Accel Y", "Accel Z", "Gyro X", "Gyro Y", "Gyro Z"};
+
+AnalysisDialog::AnalysisDialog(const RecordingAnalyzer::Result &result, const QString &outputDir, QWidget *parent) :
+    QDialog(parent),
+    analysis(result)
+{
+    setWindowTitle("噪声分析");
+    resize(1200, 700);
+
+    source = new QComboBox(this);
+    source->addItem("均值", result.imuCount);
+    for (int i = 0; i < result.imuCount; ++i)    source->addItem(QString("IMU %1").arg(i + 1), i);
+    QLabel *info = new QLabel(QString("%1 帧，τ0 = %2 ms，%3 段 FFT（%4 点），耗时 %5 秒（%6 线程）。全部通道的结果已写入 %7")
+                              .arg(result.rows).arg(result.sampleInterval * 1000, 0, 'f', 3)
+                              .arg(result.segments).arg(result.fftLength)
+                              .arg(result.seconds, 0, 'f', 1).arg(result.threads).arg(outputDir), this);
+    info->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    QHBoxLayout *top = new QHBoxLayout;
+    top->addWidget(source);
+    top->addWidget(info, 1);
+
+    allanPlot = createPlot("Allan deviation", "τ (s)", "Accel (g)", "Gyro (dps)");
+    psdPlot = createPlot("Welch PSD", "Frequency (Hz)", "Accel (g²/Hz)", "Gyro (dps²/Hz)");
+    QHBoxLayout *charts = new QHBoxLayout;
+    charts->addWidget(new QChartView(allanPlot.chart, this));
+    charts->addWidget(new QChartView(psdPlot.chart, this));
+
+    summary = new QLabel(this);
+    summary->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(top);
+    layout->addLayout(charts, 1);
+    layout->addWidget(summary);
+
+    connect(source, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, &AnalysisDialog::onSourceChanged);
+    onSourceChanged(0);
+}
+
+AnalysisDialog::Plot AnalysisDialog::createPlot(const QString &title, const QString &xTitle,
+                                                const QString &accelTitle, const QString &gyroTitle)
+{
+    // 颜色和线型与实时曲线相同
+    static const QColor COLORS[6] = {Qt::red, Qt::green, Qt::blue, Qt::darkRed, Qt::darkGreen, Qt::darkBlue};
+    Plot plot;
+    plot.chart = new QChart();
+    plot.chart->setTitle(title);
+    plot.chart->setAnimationOptions(QChart::NoAnimation);
+    plot.axisX = new QLogValueAxis();
+    plot.axisX->setTitleText(xTitle);
+    plot.axisX->setLabelFormat("%g");
+    plot.axisAccel = new QLogValueAxis();
+    plot.axisAccel->setTitleText(accelTitle);
+    plot.axisAccel->setLabelFormat("%.0e");
+    plot.axisGyro = new QLogValueAxis();
+    plot.axisGyro->setTitleText(gyroTitle);
+    plot.axisGyro->setLabelFormat("%.0e");
+    plot.chart->addAxis(plot.axisX, Qt::AlignBottom);
+    plot.chart->addAxis(plot.axisAccel, Qt::AlignLeft);
+    plot.chart->addAxis(plot.axisGyro, Qt::AlignRight);
+    for (int i = 0; i < 6; ++i)
+    {
+        plot.series[i] = new QLineSeries();
+        plot.series[i]->setName(SERIES_NAMES[i]);
+        plot.series[i]->setPen(QPen(COLORS[i], 2, i < 3 ? Qt::SolidLine : Qt::DashLine));
+        plot.chart->addSeries(plot.series[i]);
+        plot.series[i]->attachAxis(plot.axisX);
+        plot.series[i]->attachAxis(i < 3 ? plot.axisAccel : plot.axisGyro);
+    }
+    return plot;
+}
+
+void AnalysisDialog::fillPlot(Plot &plot, const std::vector<double> &x, const std::vector<std::vector<double>> &values,
+                              int firstChannel)
+{
+    // 对数坐标只能显示正值：跳过 0（例如去均值后的直流分量），坐标轴按整十倍取整
+    double xMin = 0, xMax = 0, range[2][2] = {{0, 0}, {0, 0}};
+    for (int i = 0; i < 6; ++i)
+    {
+        const std::vector<double> &v = values[static_cast<std::size_t>(firstChannel + i)];
+        double (&r)[2] = range[i < 3 ? 0 : 1];
+        QVector<QPointF> points;
+        points.reserve(static_cast<int>(x.size()));
+        for (std::size_t k = 0; k < x.size() && k < v.size(); ++k)
+        {
+            if (!(x[k] > 0) || !(v[k] > 0) || !std::isfinite(v[k]))  continue;
+            points.append(QPointF(x[k], v[k]));
+            if (xMin == 0 || x[k] < xMin)   xMin = x[k];
+            if (x[k] > xMax)                xMax = x[k];
+            if (r[0] == 0 || v[k] < r[0])   r[0] = v[k];
+            if (v[k] > r[1])                r[1] = v[k];
+        }
+        plot.series[i]->replace(points);
+    }
+    const auto decades = [](QLogValueAxis *axis, double lo, double hi) {
+        if (!(lo > 0))
+        {
+            lo = 1;
+            hi = 10;
+        }
+        const double a = std::pow(10.0, std::floor(std::log10(lo)));
+        const double b = std::pow(10.0, std::ceil(std::log10(hi)));
+        axis->setRange(a, b > a ? b : a * 10);
+    };
+    decades(plot.axisX, xMin, xMax);
+    decades(plot.axisAccel, range[0][0], range[0][1]);
+    decades(plot.axisGyro, range[1][0], range[1][1]);
+}
+
+void AnalysisDialog::onSourceChanged(int index)
+{
+    const int imu = source->itemData(index).toInt();
+    const int firstChannel = imu * DATA_PER_IMU;        // 均值的序号为 imuCount，其通道紧接在各IMU之后
+    fillPlot(allanPlot, analysis.tau, analysis.adev, firstChannel);
+    fillPlot(psdPlot, analysis.frequency, analysis.psd, firstChannel);
+
+    QString text;
+    for (int c = firstChannel; c < firstChannel + DATA_PER_IMU; ++c)
+    {
+        const RecordingAnalyzer::NoiseSummary s = RecordingAnalyzer::summarize(analysis, c);
+        text += QString("%1: σ(1s) = %2  最低 %3 @ %4 s  零偏不稳定性 %5\n")
+                .arg(SERIES_NAMES[c - firstChannel]).arg(s.adevAt1s, 0, 'g', 4).arg(s.minimumAdev, 0, 'g', 4)
+                .arg(s.minimumTau, 0, 'g', 4).arg(s.biasInstability, 0, 'g', 4);
+    }
+    summary->setText(text.trimmed());
+}
@@ -0,0 +1,49 @@
+#ifndef ANALYSISDIALOG_H
+#define ANALYSISDIALOG_H
+
+#include <QDialog>
+#include <QtCharts/QChart>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QLogValueAxis>
+#include "recordinganalyzer.h"
+
+class QComboBox;
+class QLabel;
+
+QT_CHARTS_USE_NAMESPACE
+
+// 噪声分析结果：Allan 偏差和功率谱密度两张双对数曲线图（左轴加速度计，右轴陀螺仪），
+// 可切换均值或某个IMU；全部通道的数据和曲线图已由 RecordingAnalyzer::writeResults 写到输出目录。
+class AnalysisDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    AnalysisDialog(const RecordingAnalyzer::Result &result, const QString &outputDir, QWidget *parent = nullptr);
+
+private slots:
+    void onSourceChanged(int index);
+
+private:
+    // 一张图：3条加速度曲线（实线）和3条陀螺仪曲线（虚线）
+    struct Plot {
+        QChart *chart;
+        QLineSeries *series[6];
+        QLogValueAxis *axisX;
+        QLogValueAxis *axisAccel;
+        QLogValueAxis *axisGyro;
+    };
+
+    static Plot createPlot(const QString &title, const QString &xTitle, const QString &accelTitle, const QString &gyroTitle);
+    // 显示 firstChannel 起的6个通道
+    static void fillPlot(Plot &plot, const std::vector<double> &x, const std::vector<std::vector<double>> &values,
+                         int firstChannel);
+
+    RecordingAnalyzer::Result analysis;
+    QComboBox *source;
+    QLabel *summary;
+    Plot allanPlot;
+    Plot psdPlot;
+};
+
+#endif // ANALYSISDIALOG_H
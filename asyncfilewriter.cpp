@@ -0,0 +1,286 @@
+#include "asyncfilewriter.h"
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include "fileutil.h"
+#include "pipelinestats.h"
+
+static const std::size_t BUFFER_RESERVE = 64 * 1024;
+
+AsyncFileWriter::AsyncFileWriter() :
+    bytesWritten(0),
+    queuedBytes(0),
+    droppedBytes(0),
+    writeErrors(0),
+    syncs(0),
+    segments(0),
+    file(nullptr),
+    fileBytes(0),
+    allocatedBytes(0),
+    stopRequested(false),
+    running(false),
+    latency(nullptr),
+    encoder(nullptr)
+{
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    close();
+    for (std::size_t i = 0; i < pool.size(); ++i)   delete pool[i];
+}
+
+bool AsyncFileWriter::open(const std::string &path, const Policy &writePolicy, std::string *errorString)
+{
+    close();
+
+    policy = writePolicy;
+    segments = 0;
+    if (!openFile(path, errorString))   return false;
+
+    staging.reserve(policy.flushBytes + BUFFER_RESERVE);
+    stagingStamps.clear();
+    stagingStamps.reserve(1024);
+    bytesWritten = 0;
+    queuedBytes = 0;
+    droppedBytes = 0;
+    writeErrors = 0;
+    stopRequested = false;
+    running = true;
+    thread = std::thread(&AsyncFileWriter::run, this);
+    return true;
+}
+
+void AsyncFileWriter::close()
+{
+    if (!running)   return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    wakeup.notify_one();
+    thread.join();
+
+    finishFile();
+    running = false;
+}
+
+bool AsyncFileWriter::openFile(const std::string &path, std::string *errorString)
+{
+    file = openFileUtf8(path, "wb");
+    if (!file)
+    {
+        if (errorString)    *errorString = std::strerror(errno);
+        return false;
+    }
+    // 合并后的大块直接交给系统调用，不再经过 stdio 缓冲
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    fileBytes = 0;
+    allocatedBytes = 0;
+    if (policy.preallocateBytes > 0 && preallocateFile(file, policy.preallocateBytes))
+    {
+        allocatedBytes = policy.preallocateBytes;
+    }
+    segments++;
+    return true;
+}
+
+void AsyncFileWriter::finishFile()
+{
+    if (!file)  return;
+    if (allocatedBytes > fileBytes) releasePreallocation(file, fileBytes);
+    if (policy.syncIntervalMs >= 0 && syncFileData(file))   syncs++;
+    std::fclose(file);
+    file = nullptr;
+}
+
+AsyncFileWriter::Buffer *AsyncFileWriter::acquireBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!pool.empty())
+        {
+            Buffer *buffer = pool.back();
+            pool.pop_back();
+            return buffer;
+        }
+    }
+    Buffer *buffer = new Buffer;
+    buffer->reserve(BUFFER_RESERVE);
+    return buffer;
+}
+
+void AsyncFileWriter::submit(Buffer *buffer, int64_t oldestNs)
+{
+    const std::size_t size = buffer->size();
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (size == 0 || !running)
+        {
+            buffer->clear();
+            pool.push_back(buffer);
+            return;
+        }
+        // 磁盘长时间跟不上时宁可丢数据（并计数），也不阻塞采集线程
+        if (queuedBytes + size > policy.maxQueuedBytes)
+        {
+            droppedBytes += size;
+            buffer->clear();
+            pool.push_back(buffer);
+            return;
+        }
+        Queued item;
+        item.buffer = buffer;
+        item.oldestNs = oldestNs;
+        item.endOfFile = false;
+        queue.push_back(item);
+        queuedBytes += size;
+        wake = queuedBytes >= policy.flushBytes;
+    }
+    if (wake)   wakeup.notify_one();
+}
+
+void AsyncFileWriter::rollover(Buffer *trailer, const std::string &nextPath)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+        {
+            if (trailer)
+            {
+                trailer->clear();
+                pool.push_back(trailer);
+            }
+            return;
+        }
+        Queued item;
+        item.buffer = trailer;
+        item.oldestNs = 0;
+        item.endOfFile = true;
+        item.nextPath = nextPath;
+        queue.push_back(item);
+        if (trailer)    queuedBytes += trailer->size();
+    }
+    wakeup.notify_one();
+}
+
+void AsyncFileWriter::run()
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration interval = std::chrono::milliseconds(policy.flushIntervalMs);
+    const Clock::duration syncInterval = std::chrono::milliseconds(policy.syncIntervalMs);
+    Clock::time_point deadline = Clock::now() + interval;
+    Clock::time_point lastSync = Clock::now();
+    std::vector<Queued> taken;
+
+    for (;;)
+    {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait_until(lock, deadline, [this]() {
+                return stopRequested || (!queue.empty() && (queuedBytes >= policy.flushBytes || queue.back().endOfFile));
+            });
+            taken.assign(queue.begin(), queue.end());
+            queue.clear();
+            stop = stopRequested;
+        }
+
+        // 合并为一个连续大块，缓冲区立即归还对象池；遇到文件切换时先写完并结束当前文件
+        for (std::size_t i = 0; i < taken.size(); ++i)
+        {
+            Buffer *buffer = taken[i].buffer;
+            if (taken[i].endOfFile)
+            {
+                writeStaging(true);
+                if (buffer)
+                {
+                    writeOut(buffer->data(), buffer->size());
+                    queuedBytes -= buffer->size();
+                }
+                finishFile();
+                if (!taken[i].nextPath.empty() && !openFile(taken[i].nextPath, nullptr))    writeErrors++;
+                lastSync = Clock::now();
+            }
+            else
+            {
+                staging.insert(staging.end(), buffer->begin(), buffer->end());
+                if (taken[i].oldestNs != 0) stagingStamps.push_back(taken[i].oldestNs);
+            }
+            if (buffer) buffer->clear();
+        }
+        if (!taken.empty())
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::size_t i = 0; i < taken.size(); ++i)
+            {
+                if (taken[i].buffer)    pool.push_back(taken[i].buffer);
+            }
+        }
+        taken.clear();
+
+        const Clock::time_point now = Clock::now();
+        if (staging.size() >= policy.flushBytes || now >= deadline || stop)
+        {
+            writeStaging(stop);
+            deadline = now + interval;
+        }
+        // 定期同步，限定异常断电时丢失的数据量；同步耗时只落在写盘线程
+        if (file && policy.syncIntervalMs > 0 && now - lastSync >= syncInterval && !stop)
+        {
+            if (syncFileData(file)) syncs++;
+            lastSync = now;
+        }
+        if (stop)   break;
+    }
+}
+
+void AsyncFileWriter::writeStaging(bool final)
+{
+    const Buffer *out = &staging;
+    if (encoder)
+    {
+        encoded.clear();
+        if (!staging.empty())   encoder->encode(staging.data(), staging.size(), encoded);
+        if (final)  encoder->finish(encoded);
+        out = &encoded;
+    }
+    else if (staging.empty())
+    {
+        return;
+    }
+    writeOut(out->data(), out->size());
+    queuedBytes -= staging.size();
+    staging.clear();
+
+    if (latency && !stagingStamps.empty())
+    {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+        for (std::size_t i = 0; i < stagingStamps.size(); ++i)  latency->record(now - stagingStamps[i]);
+    }
+    stagingStamps.clear();
+}
+
+void AsyncFileWriter::writeOut(const char *data, std::size_t size)
+{
+    if (size == 0)  return;
+    if (!file)
+    {
+        // 分段文件打开失败
+        droppedBytes += size;
+        return;
+    }
+    // 写入逼近已预留的空间时再预留一段
+    if (allocatedBytes > 0 && fileBytes + size > allocatedBytes)
+    {
+        uint64_t target = allocatedBytes;
+        while (target < fileBytes + size)   target += policy.preallocateBytes;
+        if (preallocateFile(file, target))  allocatedBytes = target;
+    }
+    const std::size_t n = std::fwrite(data, 1, size, file);
+    if (n != size)  writeErrors++;
+    bytesWritten += n;
+    fileBytes += n;
+}
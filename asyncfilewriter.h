@@ -0,0 +1,111 @@
+#ifndef ASYNCFILEWRITER_H
+#define ASYNCFILEWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class LatencyHistogram;
+
+// 后台写盘线程（write-behind）
+// 采集线程把写满的缓冲区交给 submit()，只在入队时短暂持锁，从不等待磁盘；
+// 写盘线程把排队的缓冲区合并成大块顺序写入，按时间或字节数策略落盘。
+// 缓冲区由内部对象池回收复用，稳态下不分配内存。
+// 分段记录时生产者在数据流中插入 rollover()，写盘线程按顺序结束当前文件并打开下一个，采集线程不等待文件操作。
+class AsyncFileWriter
+{
+public:
+    struct Policy {
+        int flushIntervalMs;        // 最长多久写一次盘
+        std::size_t flushBytes;     // 积累到多少字节立即写盘
+        std::size_t maxQueuedBytes; // 排队上限，超过后丢弃新数据（计入 droppedBytes），保证不阻塞采集
+        uint64_t preallocateBytes;  // 预分配粒度：写入逼近已预留的空间时再预留这么多，0 为不预分配
+        int syncIntervalMs;         // fdatasync：> 0 每隔该毫秒数同步一次，0 只在结束文件时同步，< 0 从不主动同步
+        Policy() : flushIntervalMs(1000), flushBytes(256 * 1024), maxQueuedBytes(256u * 1024 * 1024),
+            preallocateBytes(0), syncIntervalMs(0) {}
+    };
+
+    typedef std::vector<char> Buffer;
+
+    // 写盘线程中的数据变换（例如压缩）：排队的数据按提交顺序、以任意长度的片段送入 encode()，
+    // 变换结果代替原数据写入文件；结束文件（close() 或 rollover()）时调用 finish() 输出剩余部分，
+    // 之后编码器回到初始状态，接着处理下一个文件的数据。
+    // 编码耗时全部落在写盘线程，不占用采集线程。
+    class Encoder
+    {
+    public:
+        virtual ~Encoder() {}
+        virtual void encode(const char *data, std::size_t size, Buffer &out) = 0;
+        virtual void finish(Buffer &out) = 0;
+    };
+
+    AsyncFileWriter();
+    ~AsyncFileWriter();
+
+    // path 为 UTF-8 编码
+    bool open(const std::string &path, const Policy &policy, std::string *errorString);
+    // 写完所有排队数据后关闭文件（会等待写盘线程结束）
+    void close();
+    bool isOpen() const { return running; }
+
+    // 生产者：取得一个空缓冲区（来自对象池）
+    Buffer *acquireBuffer();
+    // 生产者：提交缓冲区，之后不得再访问；空缓冲区直接回收。
+    // oldestNs 为缓冲区中最早一项数据的到达时刻（steady_clock 纳秒），0 表示不统计延迟
+    void submit(Buffer *buffer, int64_t oldestNs = 0);
+    // 生产者：结束当前文件并切换到 nextPath（UTF-8）。之前提交的数据全部写完后原样写入 trailer
+    // （不经过 Encoder，可为 nullptr），释放多余的预留空间、同步并关闭文件，之后提交的数据写入新文件。
+    // 新文件打开失败时计入 writeErrors，之后的数据计入 droppedBytes
+    void rollover(Buffer *trailer, const std::string &nextPath);
+    // 写入文件后把 (写完时刻 - oldestNs) 记入该直方图（由写盘线程写入），nullptr 为不统计
+    void setLatencyHistogram(LatencyHistogram *histogram) { latency = histogram; }
+    // 写盘前的数据变换，open() 之前设置，nullptr 为原样写入；encoder 的生命周期须长于 close()
+    void setEncoder(Encoder *dataEncoder) { encoder = dataEncoder; }
+
+    // 统计（任意线程可读）
+    std::atomic<uint64_t> bytesWritten;     // 已写入文件的字节数（有 Encoder 时为变换后的字节数，分段时为各段之和）
+    std::atomic<uint64_t> queuedBytes;      // 排队等待写盘的字节数
+    std::atomic<uint64_t> droppedBytes;     // 因排队超限被丢弃的字节数
+    std::atomic<uint64_t> writeErrors;      // 写盘失败次数
+    std::atomic<uint64_t> syncs;            // fdatasync 次数
+    std::atomic<uint64_t> segments;         // 已打开的文件数（含第一个）
+
+private:
+    void run();
+    void writeStaging(bool final);
+    void writeOut(const char *data, std::size_t size);
+    bool openFile(const std::string &path, std::string *errorString);
+    void finishFile();
+
+    std::FILE *file;
+    uint64_t fileBytes;                     // 当前文件的长度
+    uint64_t allocatedBytes;                // 当前文件已预留的空间
+    Policy policy;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    struct Queued {
+        Buffer *buffer;
+        int64_t oldestNs;
+        bool endOfFile;                     // rollover()：buffer 为文件尾（可为 nullptr）
+        std::string nextPath;
+    };
+    std::deque<Queued> queue;               // 待写缓冲区
+    std::vector<Buffer *> pool;             // 空闲缓冲区
+    bool stopRequested;
+    std::atomic<bool> running;
+
+    Buffer staging;                         // 写盘线程的合并缓冲区
+    std::vector<int64_t> stagingStamps;     // staging 中各缓冲区的 oldestNs
+    LatencyHistogram *latency;
+    Encoder *encoder;
+    Buffer encoded;                         // staging 经 encoder 变换后的数据
+};
+
+#endif // ASYNCFILEWRITER_H
@@ -0,0 +1,322 @@
+#include "attitudefilter.h"
+#include "pipelinestats.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#ifdef IMU_HAVE_SSE2_KERNEL
+#include <emmintrin.h>
+#endif
+
+static_assert(MAX_IMU_COUNT % 4 == 0, "IMUs are updated four at a time");
+
+static const double PI = 3.14159265358979323846;   // MSVC 默认没有 M_PI
+static const float DEG_TO_RAD = static_cast<float>(PI / 180.0);
+static const float RAD_TO_DEG = static_cast<float>(180.0 / PI);
+
+const double AttitudeFilter::DEFAULT_GAIN = 0.033;
+
+// ---------------------------------------------------------------------------
+// 内核：Madgwick（2010）IMU版本的一步更新。
+//   q̇ = ½ q ⊗ (0, ω) - β ∇f / |∇f|，f 为按 q 预测的重力方向与归一化加速度之差；
+//   q ← normalize(q + q̇·dt)
+// 加速度为0或非有限值时不修正（归一化方向置0，只积分陀螺仪）；
+// 更新后四元数非有限（陀螺仪输入异常）时回到单位四元数。
+// 分支都写成选择，SSE2 内核用掩码实现，两者运算顺序相同，结果逐位一致。
+// ---------------------------------------------------------------------------
+
+void madgwickScalar(AttitudeLanes &lanes, int count, float beta, float dt)
+{
+    const float infinity = std::numeric_limits<float>::infinity();
+    for (int i = 0; i < count; ++i)
+    {
+        float q0 = lanes.q[0][i], q1 = lanes.q[1][i], q2 = lanes.q[2][i], q3 = lanes.q[3][i];
+        const float ax = lanes.input[0][i], ay = lanes.input[1][i], az = lanes.input[2][i];
+        const float gx = lanes.input[3][i], gy = lanes.input[4][i], gz = lanes.input[5][i];
+
+        // 陀螺仪积分
+        float dq0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+        float dq1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+        float dq2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+        float dq3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+        // 加速度计修正：目标函数的梯度方向
+        const float an = ax * ax + ay * ay + az * az;
+        const bool accelValid = an > 0.0f && an < infinity;    // NaN 两个比较都不成立
+        const float ar = accelValid ? 1.0f / std::sqrt(an) : 0.0f;
+        const float nx = accelValid ? ax * ar : 0.0f;
+        const float ny = accelValid ? ay * ar : 0.0f;
+        const float nz = accelValid ? az * ar : 0.0f;
+        const float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+        const float s0 = 4.0f * q0 * q2q2 + 2.0f * q2 * nx + 4.0f * q0 * q1q1 - 2.0f * q1 * ny;
+        const float s1 = 4.0f * q1 * q3q3 - 2.0f * q3 * nx + 4.0f * q0q0 * q1 - 2.0f * q0 * ny - 4.0f * q1
+                + 8.0f * q1 * q1q1 + 8.0f * q1 * q2q2 + 4.0f * q1 * nz;
+        const float s2 = 4.0f * q0q0 * q2 + 2.0f * q0 * nx + 4.0f * q2 * q3q3 - 2.0f * q3 * ny - 4.0f * q2
+                + 8.0f * q2 * q1q1 + 8.0f * q2 * q2q2 + 4.0f * q2 * nz;
+        const float s3 = 4.0f * q1q1 * q3 - 2.0f * q1 * nx + 4.0f * q2q2 * q3 - 2.0f * q2 * ny;
+        const float sn = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        const float step = (accelValid && sn > 0.0f) ? beta / std::sqrt(sn) : 0.0f;
+        dq0 = dq0 - step * s0;
+        dq1 = dq1 - step * s1;
+        dq2 = dq2 - step * s2;
+        dq3 = dq3 - step * s3;
+
+        q0 = q0 + dq0 * dt;
+        q1 = q1 + dq1 * dt;
+        q2 = q2 + dq2 * dt;
+        q3 = q3 + dq3 * dt;
+        const float qn = q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3;
+        const bool valid = qn > 0.0f && qn < infinity;
+        const float qr = 1.0f / std::sqrt(qn);
+        lanes.q[0][i] = valid ? q0 * qr : 1.0f;
+        lanes.q[1][i] = valid ? q1 * qr : 0.0f;
+        lanes.q[2][i] = valid ? q2 * qr : 0.0f;
+        lanes.q[3][i] = valid ? q3 * qr : 0.0f;
+    }
+}
+
+#ifdef IMU_HAVE_SSE2_KERNEL
+static inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+void madgwickSse2(AttitudeLanes &lanes, int count, float beta, float dt)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 sign = _mm_set1_ps(-0.0f);            // 取反（与标量的 -q1 一致，包括0的符号）
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 eight = _mm_set1_ps(8.0f);
+    const __m128 infinity = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    const __m128 betaV = _mm_set1_ps(beta);
+    const __m128 dtV = _mm_set1_ps(dt);
+    for (int i = 0; i < count; i += 4)
+    {
+        __m128 q0 = _mm_load_ps(lanes.q[0] + i), q1 = _mm_load_ps(lanes.q[1] + i);
+        __m128 q2 = _mm_load_ps(lanes.q[2] + i), q3 = _mm_load_ps(lanes.q[3] + i);
+        const __m128 ax = _mm_load_ps(lanes.input[0] + i), ay = _mm_load_ps(lanes.input[1] + i);
+        const __m128 az = _mm_load_ps(lanes.input[2] + i), gx = _mm_load_ps(lanes.input[3] + i);
+        const __m128 gy = _mm_load_ps(lanes.input[4] + i), gz = _mm_load_ps(lanes.input[5] + i);
+
+        // 陀螺仪积分
+        __m128 dq0 = _mm_mul_ps(half, _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(_mm_xor_ps(q1, sign), gx), _mm_mul_ps(q2, gy)),
+                                                 _mm_mul_ps(q3, gz)));
+        __m128 dq1 = _mm_mul_ps(half, _mm_sub_ps(_mm_add_ps(_mm_mul_ps(q0, gx), _mm_mul_ps(q2, gz)), _mm_mul_ps(q3, gy)));
+        __m128 dq2 = _mm_mul_ps(half, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(q0, gy), _mm_mul_ps(q1, gz)), _mm_mul_ps(q3, gx)));
+        __m128 dq3 = _mm_mul_ps(half, _mm_sub_ps(_mm_add_ps(_mm_mul_ps(q0, gz), _mm_mul_ps(q1, gy)), _mm_mul_ps(q2, gx)));
+
+        // 加速度计修正
+        const __m128 an = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, ax), _mm_mul_ps(ay, ay)), _mm_mul_ps(az, az));
+        const __m128 accelValid = _mm_and_ps(_mm_cmpgt_ps(an, zero), _mm_cmplt_ps(an, infinity));
+        const __m128 ar = _mm_and_ps(accelValid, _mm_div_ps(one, _mm_sqrt_ps(an)));
+        const __m128 nx = _mm_and_ps(accelValid, _mm_mul_ps(ax, ar));
+        const __m128 ny = _mm_and_ps(accelValid, _mm_mul_ps(ay, ar));
+        const __m128 nz = _mm_and_ps(accelValid, _mm_mul_ps(az, ar));
+        const __m128 q0q0 = _mm_mul_ps(q0, q0), q1q1 = _mm_mul_ps(q1, q1);
+        const __m128 q2q2 = _mm_mul_ps(q2, q2), q3q3 = _mm_mul_ps(q3, q3);
+        const __m128 s0 = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(four, q0), q2q2),
+                                                           _mm_mul_ps(_mm_mul_ps(two, q2), nx)),
+                                                _mm_mul_ps(_mm_mul_ps(four, q0), q1q1)),
+                                     _mm_mul_ps(_mm_mul_ps(two, q1), ny));
+        __m128 s1 = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(four, q1), q3q3), _mm_mul_ps(_mm_mul_ps(two, q3), nx));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_mul_ps(four, q0q0), q1));
+        s1 = _mm_sub_ps(s1, _mm_mul_ps(_mm_mul_ps(two, q0), ny));
+        s1 = _mm_sub_ps(s1, _mm_mul_ps(four, q1));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_mul_ps(eight, q1), q1q1));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_mul_ps(eight, q1), q2q2));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_mul_ps(four, q1), nz));
+        __m128 s2 = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(four, q0q0), q2), _mm_mul_ps(_mm_mul_ps(two, q0), nx));
+        s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_mul_ps(four, q2), q3q3));
+        s2 = _mm_sub_ps(s2, _mm_mul_ps(_mm_mul_ps(two, q3), ny));
+        s2 = _mm_sub_ps(s2, _mm_mul_ps(four, q2));
+        s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_mul_ps(eight, q2), q1q1));
+        s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_mul_ps(eight, q2), q2q2));
+        s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_mul_ps(four, q2), nz));
+        const __m128 s3 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(four, q1q1), q3),
+                                                           _mm_mul_ps(_mm_mul_ps(two, q1), nx)),
+                                                _mm_mul_ps(_mm_mul_ps(four, q2q2), q3)),
+                                     _mm_mul_ps(_mm_mul_ps(two, q2), ny));
+        const __m128 sn = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(s0, s0), _mm_mul_ps(s1, s1)), _mm_mul_ps(s2, s2)),
+                                     _mm_mul_ps(s3, s3));
+        const __m128 corrected = _mm_and_ps(accelValid, _mm_cmpgt_ps(sn, zero));
+        const __m128 step = _mm_and_ps(corrected, _mm_div_ps(betaV, _mm_sqrt_ps(sn)));
+        dq0 = _mm_sub_ps(dq0, _mm_mul_ps(step, s0));
+        dq1 = _mm_sub_ps(dq1, _mm_mul_ps(step, s1));
+        dq2 = _mm_sub_ps(dq2, _mm_mul_ps(step, s2));
+        dq3 = _mm_sub_ps(dq3, _mm_mul_ps(step, s3));
+
+        q0 = _mm_add_ps(q0, _mm_mul_ps(dq0, dtV));
+        q1 = _mm_add_ps(q1, _mm_mul_ps(dq1, dtV));
+        q2 = _mm_add_ps(q2, _mm_mul_ps(dq2, dtV));
+        q3 = _mm_add_ps(q3, _mm_mul_ps(dq3, dtV));
+        const __m128 qn = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(q0, q0), _mm_mul_ps(q1, q1)), _mm_mul_ps(q2, q2)),
+                                     _mm_mul_ps(q3, q3));
+        const __m128 valid = _mm_and_ps(_mm_cmpgt_ps(qn, zero), _mm_cmplt_ps(qn, infinity));
+        const __m128 qr = _mm_div_ps(one, _mm_sqrt_ps(qn));
+        _mm_store_ps(lanes.q[0] + i, select(valid, _mm_mul_ps(q0, qr), one));
+        _mm_store_ps(lanes.q[1] + i, select(valid, _mm_mul_ps(q1, qr), zero));
+        _mm_store_ps(lanes.q[2] + i, select(valid, _mm_mul_ps(q2, qr), zero));
+        _mm_store_ps(lanes.q[3] + i, select(valid, _mm_mul_ps(q3, qr), zero));
+    }
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// AttitudeFilter
+// ---------------------------------------------------------------------------
+
+AttitudeFilter::AttitudeFilter() :
+    active(false),
+    beta(static_cast<float>(DEFAULT_GAIN)),
+    selected(ScalarKernel),
+    run(&madgwickScalar),
+    costHistogram(nullptr),
+    imus(DEFAULT_IMU_COUNT),
+    paddedImus(DEFAULT_IMU_COUNT),
+    initialized(false),
+    lastNs(0)
+{
+    setKernel(AutoKernel);
+    start(DEFAULT_IMU_COUNT);
+}
+
+bool AttitudeFilter::isSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case AutoKernel:
+    case ScalarKernel:
+        return true;
+    case Sse2Kernel:
+#ifdef IMU_HAVE_SSE2_KERNEL
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char *AttitudeFilter::kernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case AutoKernel:    return "auto";
+    case ScalarKernel:  return "scalar";
+    case Sse2Kernel:    return "sse2";
+    }
+    return "unknown";
+}
+
+bool AttitudeFilter::setKernel(Kernel kernel)
+{
+    if (kernel == AutoKernel)   kernel = isSupported(Sse2Kernel) ? Sse2Kernel : ScalarKernel;
+    if (!isSupported(kernel))   return false;
+
+    switch (kernel)
+    {
+#ifdef IMU_HAVE_SSE2_KERNEL
+    case Sse2Kernel:    run = &madgwickSse2;    break;
+#endif
+    default:            run = &madgwickScalar;  break;
+    }
+    selected = kernel;
+    return true;
+}
+
+void AttitudeFilter::reset()
+{
+    start(imus);
+}
+
+void AttitudeFilter::start(int imuCount)
+{
+    imus = imuCount;
+    paddedImus = (imuCount + 3) & ~3;
+    // 补齐的IMU输入为0、姿态为单位四元数，更新后保持不变
+    memset(&lanes, 0, sizeof(lanes));
+    for (int i = 0; i < MAX_IMU_COUNT; ++i) lanes.q[0][i] = 1.0f;
+    initialized = false;
+    lastNs = 0;
+}
+
+void AttitudeFilter::load(const ImuFrame &frame)
+{
+    for (int i = 0; i < imus; ++i)
+    {
+        const IMUData &d = frame.imu[i];
+        lanes.input[0][i] = d.accel[0];
+        lanes.input[1][i] = d.accel[1];
+        lanes.input[2][i] = d.accel[2];
+        lanes.input[3][i] = d.gyro[0] * DEG_TO_RAD;
+        lanes.input[4][i] = d.gyro[1] * DEG_TO_RAD;
+        lanes.input[5][i] = d.gyro[2] * DEG_TO_RAD;
+    }
+}
+
+void AttitudeFilter::initialize()
+{
+    for (int i = 0; i < imus; ++i)
+    {
+        const double ax = lanes.input[0][i], ay = lanes.input[1][i], az = lanes.input[2][i];
+        const double an = ax * ax + ay * ay + az * az;
+        if (!(an > 0 && std::isfinite(an)))
+        {
+            lanes.q[0][i] = 1.0f;
+            lanes.q[1][i] = lanes.q[2][i] = lanes.q[3][i] = 0.0f;
+            continue;
+        }
+        // 横滚、俯仰由重力方向确定，航向为0
+        const double roll = std::atan2(ay, az);
+        const double pitch = std::atan2(-ax, std::sqrt(ay * ay + az * az));
+        const double cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+        const double cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+        lanes.q[0][i] = static_cast<float>(cr * cp);
+        lanes.q[1][i] = static_cast<float>(sr * cp);
+        lanes.q[2][i] = static_cast<float>(cr * sp);
+        lanes.q[3][i] = static_cast<float>(-sr * sp);
+    }
+}
+
+void AttitudeFilter::process(ImuFrame *frames, std::size_t count)
+{
+    if (!active || count == 0)  return;
+    if (frames[0].imuCount != imus) start(frames[0].imuCount);
+
+    const int64_t startNs = costHistogram ? steadyClockNs() : 0;
+    for (std::size_t f = 0; f < count; ++f)
+    {
+        ImuFrame &frame = frames[f];
+        load(frame);
+        const int64_t stepNs = frame.monotonicNs - lastNs;
+        if (!initialized)
+        {
+            initialize();
+            initialized = true;
+        }
+        else if (stepNs > 0 && stepNs <= MAX_STEP_NS)
+        {
+            run(lanes, paddedImus, beta, static_cast<float>(stepNs * 1.0e-9));
+        }
+        lastNs = frame.monotonicNs;
+        for (int i = 0; i < imus; ++i)
+        {
+            frame.orientation[i][0] = lanes.q[0][i];
+            frame.orientation[i][1] = lanes.q[1][i];
+            frame.orientation[i][2] = lanes.q[2][i];
+            frame.orientation[i][3] = lanes.q[3][i];
+        }
+    }
+    if (costHistogram)  costHistogram->record((steadyClockNs() - startNs) / static_cast<int64_t>(count));
+}
+
+void AttitudeFilter::toEuler(const float *q, float *euler)
+{
+    const double q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    const double sinPitch = 2.0 * (q0 * q2 - q1 * q3);
+    euler[0] = static_cast<float>(std::atan2(2.0 * (q0 * q1 + q2 * q3), 1.0 - 2.0 * (q1 * q1 + q2 * q2)) * RAD_TO_DEG);
+    euler[1] = static_cast<float>(std::asin(sinPitch > 1.0 ? 1.0 : (sinPitch < -1.0 ? -1.0 : sinPitch)) * RAD_TO_DEG);
+    euler[2] = static_cast<float>(std::atan2(2.0 * (q0 * q3 + q1 * q2), 1.0 - 2.0 * (q2 * q2 + q3 * q3)) * RAD_TO_DEG);
+}
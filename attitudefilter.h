@@ -0,0 +1,85 @@
+#ifndef ATTITUDEFILTER_H
+#define ATTITUDEFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "imuframe.h"
+#include "imuarraystats.h"     // IMU_HAVE_SSE2_KERNEL
+
+class LatencyHistogram;
+
+// 各IMU姿态解算的状态和输入，按 分量 → IMU 存储（结构数组），一条SIMD指令同时更新4个IMU
+struct AttitudeLanes
+{
+    alignas(16) float q[4][MAX_IMU_COUNT];          // 四元数 w, x, y, z
+    alignas(16) float input[6][MAX_IMU_COUNT];      // 加速度（g）和角速度（rad/s）
+};
+
+// Madgwick 梯度下降姿态更新（只用加速度计和陀螺仪）：更新前 count 个IMU（4 的倍数）的四元数，
+// beta 为加速度计修正增益，dt 为时间步长（秒）。两个内核的运算顺序相同，结果逐位一致。
+typedef void (*MadgwickKernel)(AttitudeLanes &lanes, int count, float beta, float dt);
+void madgwickScalar(AttitudeLanes &lanes, int count, float beta, float dt);
+#ifdef IMU_HAVE_SSE2_KERNEL
+void madgwickSse2(AttitudeLanes &lanes, int count, float beta, float dt);
+#endif
+
+// 实时姿态解算（采集线程，逐批调用，位于帧时钟打时间戳之后）：
+// 对每帧的所有IMU同时做一步 Madgwick 更新，结果写入各帧的 orientation。
+// 时间步长取相邻两帧的时间戳之差；数据源开始后的第一帧由加速度计确定横滚和俯仰（航向为0）。
+// 两帧之间超过 MAX_STEP_NS（数据缺口）时不积分，保持缺口前的姿态，之后由加速度计逐渐修正。
+// 四元数表示传感器坐标系相对水平坐标系（Z 轴朝上，静止时加速度计读数为 +1g）的姿态。
+class AttitudeFilter
+{
+public:
+    enum Kernel {
+        AutoKernel = 0,         // 运行时选择最宽的可用内核
+        ScalarKernel,
+        Sse2Kernel
+    };
+
+    static const int64_t MAX_STEP_NS = 500000000;   // 最长积分步长（0.5秒）
+    static const double DEFAULT_GAIN;               // 0.033（Madgwick 论文中IMU的推荐值）
+
+    AttitudeFilter();
+
+    void setEnabled(bool enabled) { active = enabled; }
+    bool isEnabled() const { return active; }
+    // 加速度计修正增益 beta（rad/s），越大收敛越快但越受线加速度影响
+    void setGain(double gain) { beta = static_cast<float>(gain); }
+    double gain() const { return beta; }
+
+    bool setKernel(Kernel kernel);
+    Kernel kernel() const { return selected; }
+    static bool isSupported(Kernel kernel);
+    static const char *kernelName(Kernel kernel);
+
+    // 每批处理耗时（纳秒 / 帧，所有IMU）记入该直方图，nullptr 不统计
+    void setCostHistogram(LatencyHistogram *histogram) { costHistogram = histogram; }
+
+    // 新的数据源开始：下一帧重新由加速度计初始化
+    void reset();
+    // 原地更新一批帧（各帧 imuCount 相同，monotonicNs 已打好）的 orientation
+    void process(ImuFrame *frames, std::size_t count);
+
+    // 四元数 → 欧拉角（度）：横滚、俯仰、航向（Z-Y-X 顺序）
+    static void toEuler(const float *q, float *euler);
+
+private:
+    void start(int imuCount);
+    void load(const ImuFrame &frame);       // 帧 → lanes.input
+    void initialize();                      // 由 lanes.input 中的加速度确定初始姿态
+
+    bool active;
+    float beta;
+    Kernel selected;
+    MadgwickKernel run;
+    LatencyHistogram *costHistogram;
+
+    int imus;
+    int paddedImus;                         // 向上取整到 4 的倍数
+    bool initialized;
+    int64_t lastNs;                         // 上一帧的时间戳
+    AttitudeLanes lanes;
+};
+
+#endif // ATTITUDEFILTER_H
@@ -0,0 +1,1042 @@
+// 热点路径基准测试：帧同步解析、IMU均值、跨IMU统计、实时信号处理、标定和姿态解算、离线噪声分析、帧时钟、CSV编码、
+// 界面文本和图表更新
+// 用合成的帧（按 --imus 选择帧格式，9 IMU 为222字节；可按比例注入错误）驱动与程序相同的代码，
+// 报告每帧耗时（ns）、每帧内存分配次数和吞吐量（MB/s），用于比较优化前后的效果。
+//
+// 构建：qmake CONFIG+=benchmark && make
+// 运行：QT_QPA_PLATFORM=offscreen IMUarray_SP_V2_bench -n 100000 --corrupt 0,0.01,0.1
+// Linux 下另有伪终端回环测试（--pty-rate 2000 --pty-seconds 10）：以真实串口流程持续接收高帧率数据并核对丢帧，
+// 以及多个伪终端同时采集并按时间合并的测试（--pty-ports 3）。
+// 压缩记录测试默认用合成帧（噪声占满尾数，接近最差情况），--recording 指定 *.imu 文件时改用实际记录。
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QtCharts/QChartView>
+#include "imuframe.h"
+#include "framesynchronizer.h"
+#include "csvencoder.h"
+#include "displayformatter.h"
+#include "imuchart.h"
+#include "framelogmodel.h"
+#include "frameclock.h"
+#include "imuarraystats.h"
+#include "dspstage.h"
+#include "imucalibration.h"
+#include "attitudefilter.h"
+#include "noiseanalysis.h"
+#include "acquisitionworker.h"
+#include "framemerger.h"
+#include "recordingcodec.h"
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <fcntl.h>
+#include <memory>
+#include <sys/resource.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QThread>
+#include <QTimer>
+#endif
+
+// ---------------------------------------------------------------------------
+// 内存分配计数
+// glibc 下直接替换 malloc 系列函数，能统计到 Qt 容器（QString 等用 malloc）的分配；
+// 其他平台只能替换 operator new，统计不到 Qt 容器的分配
+// ---------------------------------------------------------------------------
+static std::atomic<unsigned long long> allocationCount(0);
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+static const char *ALLOCATION_METHOD = "malloc/calloc/realloc";
+#else
+#include <new>
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))   return p;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+static const char *ALLOCATION_METHOD = "operator new（不含 Qt 容器的 malloc）";
+#endif
+
+// ---------------------------------------------------------------------------
+// 合成数据
+// ---------------------------------------------------------------------------
+
+// 合成数据和各测试使用的帧格式（--imus 选择）
+static const FrameFormat *benchFormat = &defaultFrameFormat();
+
+// 生成 frameCount 帧的串口字节流，每帧以 corruptionRate 的概率插入垃圾字节或翻转一位
+static std::vector<char> makeStream(int frameCount, double corruptionRate, unsigned seed,
+                                    std::vector<ImuFrame> *frames)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    std::vector<char> stream;
+    const FrameFormat &format = *benchFormat;
+    stream.reserve(static_cast<std::size_t>(frameCount) * (format.frameSize + 4));
+    if (frames)    frames->resize(static_cast<std::size_t>(frameCount));
+
+    std::vector<char> unit(static_cast<std::size_t>(format.frameSize));
+    for (int n = 0; n < frameCount; ++n)
+    {
+        ImuFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        const float t = n * 0.01f;
+        for (int i = 0; i < format.imuCount; ++i)
+        {
+            frame.imu[i].accel[0] = 0.1f * std::sin(t + i) + noise(rng);
+            frame.imu[i].accel[1] = 0.1f * std::cos(t + i) + noise(rng);
+            frame.imu[i].accel[2] = 1.0f + noise(rng);
+            frame.imu[i].gyro[0] = 30.0f * std::sin(0.5f * t) + noise(rng) * 100;
+            frame.imu[i].gyro[1] = -12.5f + noise(rng) * 100;
+            frame.imu[i].gyro[2] = 150.0f * std::cos(0.2f * t) + noise(rng) * 100;
+        }
+        frame.imuCount = format.imuCount;
+        format.reduce(frame);
+        frame.timestampMs = 1700000000000LL + n * 10;
+        frame.sequence = static_cast<uint64_t>(n);
+        if (frames)    (*frames)[static_cast<std::size_t>(n)] = frame;
+
+        unit.assign(format.headPattern, format.headPattern + format.headSize);
+        const char *payload = reinterpret_cast<const char *>(frame.imu);
+        unit.insert(unit.end(), payload, payload + format.payloadSize);
+        unit.insert(unit.end(), format.tailPattern, format.tailPattern + format.tailSize);
+
+        if (corruptionRate > 0 && std::generate_canonical<double, 32>(rng) < corruptionRate)
+        {
+            std::uniform_int_distribution<std::size_t> position(0, unit.size() - 1);
+            if (rng() & 1)
+            {
+                // 插入1~16个垃圾字节，其中约1/4为帧头首字节
+                const int count = 1 + static_cast<int>(rng() % 16);
+                std::vector<char> garbage;
+                for (int i = 0; i < count; ++i)
+                {
+                    garbage.push_back((rng() & 3) == 0 ? format.headPattern[0] : static_cast<char>(rng() & 0xFF));
+                }
+                unit.insert(unit.begin() + static_cast<std::ptrdiff_t>(position(rng)), garbage.begin(), garbage.end());
+            }
+            else
+            {
+                unit[position(rng)] ^= static_cast<char>(1 << (rng() & 7));
+            }
+        }
+        stream.insert(stream.end(), unit.begin(), unit.end());
+    }
+    return stream;
+}
+
+// ---------------------------------------------------------------------------
+// 计时和报告
+// ---------------------------------------------------------------------------
+
+struct Measurement
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start;
+    unsigned long long allocationsAtStart;
+
+    Measurement() : start(Clock::now()), allocationsAtStart(allocationCount.load()) {}
+
+    // items: 处理的帧数（或调用次数）；bytes: 吞吐量按多少字节计
+    void report(const char *name, long long items, double bytes, const char *note = "") const
+    {
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        const unsigned long long allocations = allocationCount.load() - allocationsAtStart;
+        std::printf("%-22s %10lld %12.1f %12.3f %10.1f  %s\n", name, items,
+                    items > 0 ? seconds * 1e9 / items : 0.0,
+                    items > 0 ? static_cast<double>(allocations) / items : 0.0,
+                    seconds > 0 ? bytes / seconds / 1e6 : 0.0, note);
+        std::fflush(stdout);
+    }
+};
+
+static bool selected(const QString &filter, const char *name)
+{
+    return filter.isEmpty() || QString(name).contains(filter);
+}
+
+// 防止编译器把无副作用的计算优化掉
+static volatile double sink;
+
+// 帧同步 + 负载解码：按 4KB 一块写入接收环形缓冲区，与串口读取方式一致
+static void benchSynchronizer(const std::vector<char> &stream, int expectedFrames, double corruptionRate)
+{
+    const std::size_t CHUNK = 4096;
+    FrameSynchronizer synchronizer;
+    synchronizer.setFormat(*benchFormat);
+    ByteRingBuffer &ring = synchronizer.buffer();
+    ImuFrame frame;
+    long long frames = 0;
+
+    Measurement m;
+    std::size_t pos = 0;
+    while (pos < stream.size())
+    {
+        std::size_t space = 0;
+        char *dst = ring.writeRegion(space);
+        std::size_t n = std::min(std::min(space, CHUNK), stream.size() - pos);
+        memcpy(dst, stream.data() + pos, n);
+        ring.commit(n);
+        pos += n;
+        while (synchronizer.nextFrame(frame) == FrameSynchronizer::FrameReady)
+        {
+            frames++;
+        }
+    }
+    sink = frame.meanAccel[0];
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "sync (corrupt %.3g)", corruptionRate);
+    char note[128];
+    std::snprintf(note, sizeof(note), "解析出 %lld/%d 帧，丢弃 %llu 字节", frames, expectedFrames,
+                  static_cast<unsigned long long>(synchronizer.discardedBytes()));
+    m.report(name, frames, static_cast<double>(stream.size()), note);
+}
+
+// 所有IMU均值（当前帧格式的展开内核）
+static void benchMean(std::vector<ImuFrame> &frames)
+{
+    void (*reduce)(ImuFrame &) = benchFormat->reduce;
+    Measurement m;
+    double acc = 0;
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+        reduce(frames[i]);
+        acc += frames[i].meanAccel[0];
+    }
+    sink = acc;
+    m.report("mean", static_cast<long long>(frames.size()), static_cast<double>(frames.size()) * benchFormat->dataSize);
+}
+
+// 跨IMU统计：SoA 转置 + 块统计内核 + 卡死检测，与采集线程相同按批调用
+// （每批64帧，即高帧率下一次读出的帧数；100Hz 时每批只有1~2帧，SIMD通道利用率较低但总开销很小）
+static void benchArrayStats(std::vector<ImuFrame> &frames, ImuArrayStats::Kernel kernel)
+{
+    const std::size_t BATCH = SampleBlock::BLOCK_FRAMES;
+    ImuArrayStats stats;
+    if (!stats.setKernel(kernel))   return;
+
+    Measurement m;
+    for (std::size_t i = 0; i < frames.size(); i += BATCH)
+    {
+        stats.process(&frames[i], std::min(BATCH, frames.size() - i));
+    }
+    sink = frames.back().spread.stdDev[0];
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "array stats (%s)", ImuArrayStats::kernelName(kernel));
+    m.report(name, static_cast<long long>(frames.size()), static_cast<double>(frames.size()) * benchFormat->dataSize);
+}
+
+// 实时信号处理：1kHz 数据，陀螺零偏 + 4阶低通50Hz + 抽取到100Hz（滑动平均或CIC），与采集线程相同按批调用；
+// 备注中给出每通道每帧的耗时（9 IMU 为54个通道）
+static void benchDsp(const std::vector<ImuFrame> &frames, DspStage::Kernel kernel, DspStage::Decimator decimator)
+{
+    const std::size_t BATCH = DspStage::BLOCK_FRAMES;
+    DspStage dsp;
+    if (!dsp.setKernel(kernel)) return;
+    DspStage::Config config = DspStage::defaultConfig(1000.0);
+    config.cutoffHz = 50.0;
+    config.filterOrder = 4;
+    config.decimation = 10;
+    config.decimator = decimator;
+    config.biasMode = DspStage::GyroBias;
+    config.biasSeconds = 0.05;
+    if (!dsp.configure(config, nullptr))    return;
+    std::vector<ImuFrame> out;
+    out.reserve(frames.size() / config.decimation + BATCH);
+
+    Measurement m;
+    for (std::size_t i = 0; i < frames.size(); i += BATCH)
+    {
+        dsp.process(&frames[i], std::min(BATCH, frames.size() - i), out);
+    }
+    const double seconds = std::chrono::duration<double>(Measurement::Clock::now() - m.start).count();
+    sink = out.empty() ? 0.0 : out.back().imu[0].gyro[0];
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "dsp %s (%s)", decimator == DspStage::CicDecimator ? "cic" : "avg",
+                  DspStage::kernelName(kernel));
+    char note[128];
+    std::snprintf(note, sizeof(note), "每通道每帧 %.2f ns，输出 %zu 帧",
+                  seconds * 1e9 / static_cast<double>(frames.size()) / (benchFormat->imuCount * DATA_PER_IMU),
+                  out.size());
+    m.report(name, static_cast<long long>(frames.size()), static_cast<double>(frames.size()) * benchFormat->dataSize,
+             note);
+}
+
+// 标定：所有IMU的加速度计和陀螺仪都有标定（接近单位阵的矩阵 + 零偏），与采集线程相同按批原地校正
+static void benchCalibration(std::vector<ImuFrame> &frames, ImuCalibration::Kernel kernel)
+{
+    const std::size_t BATCH = SampleBlock::BLOCK_FRAMES;
+    std::string text;
+    char line[256];
+    for (int i = 1; i <= benchFormat->imuCount; ++i)
+    {
+        std::snprintf(line, sizeof(line), "%d,accel,1.01,0.002,-0.003,0.001,0.99,0.002,-0.002,0.001,1.02,0.01,-0.02,0.03\n"
+                      "%d,gyro,1.002,0.01,0.0,-0.01,0.998,0.005,0.0,-0.005,1.001,0.5,-0.3,0.2\n", i, i);
+        text += line;
+    }
+    ImuCalibration calibration;
+    if (!calibration.setKernel(kernel) || !calibration.parse(text.data(), text.size(), nullptr))  return;
+
+    Measurement m;
+    for (std::size_t i = 0; i < frames.size(); i += BATCH)
+    {
+        calibration.apply(&frames[i], std::min(BATCH, frames.size() - i));
+    }
+    const double seconds = std::chrono::duration<double>(Measurement::Clock::now() - m.start).count();
+    sink = frames.back().imu[0].gyro[0];
+
+    // 备注：单核可承受的帧率（实时采集只需几 kHz）
+    char name[64];
+    std::snprintf(name, sizeof(name), "calibration (%s)", ImuCalibration::kernelName(kernel));
+    char note[128];
+    std::snprintf(note, sizeof(note), "可承受 %.1f MHz 帧率", seconds > 0 ? static_cast<double>(frames.size()) / seconds / 1e6 : 0.0);
+    m.report(name, static_cast<long long>(frames.size()), static_cast<double>(frames.size()) * benchFormat->dataSize,
+             note);
+}
+
+// 姿态解算：1kHz 数据，每帧对所有IMU做一步 Madgwick 更新，与采集线程相同按批调用
+static void benchAttitude(std::vector<ImuFrame> &frames, AttitudeFilter::Kernel kernel)
+{
+    const std::size_t BATCH = SampleBlock::BLOCK_FRAMES;
+    AttitudeFilter attitude;
+    if (!attitude.setKernel(kernel))    return;
+    attitude.setEnabled(true);
+    for (std::size_t i = 0; i < frames.size(); ++i) frames[i].monotonicNs = static_cast<int64_t>(i) * 1000000;
+
+    Measurement m;
+    for (std::size_t i = 0; i < frames.size(); i += BATCH)
+    {
+        attitude.process(&frames[i], std::min(BATCH, frames.size() - i));
+    }
+    sink = frames.back().orientation[0][0];
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "attitude (%s)", AttitudeFilter::kernelName(kernel));
+    m.report(name, static_cast<long long>(frames.size()), static_cast<double>(frames.size()) * benchFormat->dataSize);
+}
+
+// 离线噪声分析的单线程核心：所有通道（各IMU的6个数据）的 Allan 偏差和 Welch 功率谱密度累加器，
+// 按列每块64帧送入（分析程序按块转置后逐通道处理，多个通道由各线程并行）；备注中给出每通道每帧的耗时
+static void benchNoiseAnalysis(const std::vector<ImuFrame> &frames)
+{
+    const std::size_t BATCH = SampleBlock::BLOCK_FRAMES;
+    const int channels = benchFormat->imuCount * DATA_PER_IMU;
+    const RealFft fft(WelchPsd::DEFAULT_LENGTH);
+    std::vector<AllanDeviation> allan(static_cast<std::size_t>(channels));
+    std::vector<std::unique_ptr<WelchPsd>> welch;
+    for (int c = 0; c < channels; ++c)
+    {
+        allan[static_cast<std::size_t>(c)].configure(static_cast<int64_t>(frames.size() / 2));
+        welch.emplace_back(new WelchPsd(&fft));
+    }
+    std::vector<float> column(BATCH);
+
+    Measurement m;
+    for (std::size_t i = 0; i < frames.size(); i += BATCH)
+    {
+        const std::size_t n = std::min(BATCH, frames.size() - i);
+        for (int c = 0; c < channels; ++c)
+        {
+            for (std::size_t k = 0; k < n; ++k)  column[k] = (&frames[i + k].imu[0].accel[0])[c];
+            allan[static_cast<std::size_t>(c)].add(column.data(), n);
+            welch[static_cast<std::size_t>(c)]->add(column.data(), n);
+        }
+    }
+    const double seconds = std::chrono::duration<double>(Measurement::Clock::now() - m.start).count();
+    sink = allan.front().deviation(0);
+
+    char note[128];
+    std::snprintf(note, sizeof(note), "每通道每帧 %.1f ns，单线程", seconds * 1e9 / static_cast<double>(frames.size()) / channels);
+    m.report("noise analysis", static_cast<long long>(frames.size()), static_cast<double>(frames.size()) * benchFormat->dataSize,
+             note);
+}
+
+// 帧时钟：模拟晶振偏快50ppm的100Hz设备，经USB转串口每16ms成批到达（另加0~2ms调度延迟），
+// 与采集线程相同，每批加入一个观测点并给整批帧打时间戳；
+// 备注中给出估计帧率的误差和时间戳相对真实采样时刻的标准差
+static void benchFrameClock(int frameCount)
+{
+    const double periodNs = 1.0e7 * (1.0 - 50.0e-6);
+    const int64_t startNs = 1000000000LL;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> delay(0.0, 2.0e6);
+    FrameClock clock(100.0);
+    int64_t stampSum = 0;
+    double errorSum = 0, errorSquareSum = 0;
+    long long measured = 0;
+    uint64_t next = 0;
+
+    Measurement m;
+    for (long long tick = 1; next < static_cast<uint64_t>(frameCount); ++tick)
+    {
+        const double tickNs = tick * 16.0e6;
+        const uint64_t available = std::min<uint64_t>(static_cast<uint64_t>(tickNs / periodNs),
+                                                      static_cast<uint64_t>(frameCount));
+        if (available <= next) continue;
+        clock.addSample(available - 1, startNs + static_cast<int64_t>(tickNs + delay(rng)));
+        for (; next < available; ++next)
+        {
+            const int64_t stamp = clock.timeAt(next);
+            stampSum += stamp;
+            // 前10秒为收敛过程，不计入误差
+            if (next >= 1000)
+            {
+                const double error = static_cast<double>(stamp - startNs) - next * periodNs;
+                errorSum += error;
+                errorSquareSum += error * error;
+                measured++;
+            }
+        }
+    }
+    sink = static_cast<double>(stampSum);
+
+    const double mean = measured > 0 ? errorSum / measured : 0.0;
+    const double deviation = measured > 0 ? std::sqrt(std::max(0.0, errorSquareSum / measured - mean * mean)) : 0.0;
+    char note[128];
+    std::snprintf(note, sizeof(note), "帧率误差 %.1f ppm，时间戳标准差 %.3f ms（到达抖动 %.2f ms）",
+                  (clock.rateHz() * periodNs / 1.0e9 - 1.0) * 1.0e6, deviation / 1.0e6, clock.jitterNs() / 1.0e6);
+    m.report("frame clock", frameCount, static_cast<double>(frameCount) * benchFormat->frameSize, note);
+}
+
+// 按二进制记录器的布局把合成帧写成 *.imu 文件内容（采样间隔10ms，每4帧一批到达）
+static std::vector<char> makeRecording(const std::vector<ImuFrame> &frames)
+{
+    const RecordingFileHeader header = makeRecordingHeader(*benchFormat, 1700000000000LL, 0);
+    std::vector<char> recording(reinterpret_cast<const char *>(&header),
+                                reinterpret_cast<const char *>(&header) + sizeof(header));
+    recording.reserve(sizeof(header) + frames.size() * header.recordSize);
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+        RecordHeader record;
+        record.sequence = frames[i].sequence;
+        record.timestampNs = static_cast<int64_t>(i) * 10000000 + static_cast<int64_t>(i % 3) * 1000;
+        record.arrivalNs = static_cast<int64_t>(i / 4 * 4 + 4) * 10000000 + 250000;
+        const char *p = reinterpret_cast<const char *>(&record);
+        recording.insert(recording.end(), p, p + sizeof(record));
+        p = reinterpret_cast<const char *>(frames[i].imu);
+        recording.insert(recording.end(), p, p + header.payloadSize);
+    }
+    return recording;
+}
+
+// 读入 *.imu 记录文件（只保留完整的记录）；不是当前版本的二进制记录时返回空
+static std::vector<char> loadRecording(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))    return std::vector<char>();
+    const QByteArray content = file.readAll();
+    RecordingFileHeader header;
+    if (content.size() < static_cast<int>(sizeof(header)))  return std::vector<char>();
+    memcpy(&header, content.constData(), sizeof(header));
+    if (memcmp(header.magic, RECORDING_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RECORDING_VERSION || !isReadableRecordLayout(header))
+    {
+        return std::vector<char>();
+    }
+    const char *tail = content.size() >= static_cast<int>(sizeof(RecordingFooter)) ?
+                content.constData() + content.size() - sizeof(RecordingFooter) : nullptr;
+    const std::size_t records = recordingDataBytes(header, static_cast<uint64_t>(content.size()), tail) / header.recordSize;
+    return std::vector<char>(content.constData(), content.constData() + sizeof(header) + records * header.recordSize);
+}
+
+// 压缩记录：与保存时相同，按32KB分段交给编码器（写盘线程中的工作），再逐块解码并与原记录核对。
+// 吞吐量按未压缩的记录字节计
+static void benchCompression(const std::vector<char> &recording, RecordBlockCodec::ChannelCodec codec, const char *source)
+{
+    static const char *const CODEC_NAMES[] = {"auto", "xor", "delta"};
+    RecordingFileHeader header;
+    memcpy(&header, recording.data(), sizeof(header));
+    const long long frames = static_cast<long long>((recording.size() - sizeof(header)) / header.recordSize);
+
+    CompressedRecordingEncoder encoder;
+    encoder.setCodec(codec);
+    AsyncFileWriter::Buffer compressed;
+    compressed.reserve(recording.size() + 1024);
+    const std::size_t CHUNK = 32 * 1024;
+
+    char name[64];
+    char note[160];
+    Measurement encode;
+    for (std::size_t pos = 0; pos < recording.size(); pos += CHUNK)
+    {
+        encoder.encode(recording.data() + pos, std::min(CHUNK, recording.size() - pos), compressed);
+    }
+    encoder.finish(compressed);
+    std::snprintf(name, sizeof(name), "compress (%s)", CODEC_NAMES[codec]);
+    std::snprintf(note, sizeof(note), "%s: 压缩比 %.2f，%.1f 字节/帧（原 %u）", source,
+                  static_cast<double>(recording.size()) / compressed.size(),
+                  frames > 0 ? static_cast<double>(compressed.size() - sizeof(header)) / frames : 0.0,
+                  header.recordSize);
+    encode.report(name, frames, static_cast<double>(recording.size()), note);
+
+    std::vector<char> records;
+    records.reserve(static_cast<std::size_t>(RecordBlockCodec::BLOCK_FRAMES) * header.recordSize);
+    std::size_t pos = sizeof(header);
+    std::size_t decoded = sizeof(header);
+    bool equal = true;
+    Measurement decode;
+    while (equal && pos + sizeof(CompressedBlockHeader) <= compressed.size())
+    {
+        CompressedBlockHeader block;
+        memcpy(&block, compressed.data() + pos, sizeof(block));
+        pos += sizeof(block);
+        equal = RecordBlockCodec::decodeBlock(header, block, compressed.data() + pos, records) &&
+                decoded + records.size() <= recording.size() &&
+                memcmp(records.data(), recording.data() + decoded, records.size()) == 0;
+        pos += block.payloadSize;
+        decoded += records.size();
+    }
+    std::snprintf(name, sizeof(name), "decompress (%s)", CODEC_NAMES[codec]);
+    decode.report(name, frames, static_cast<double>(recording.size()),
+                  equal && decoded == recording.size() ? "无损" : "解码结果与原记录不一致!");
+}
+
+// CSV编码：与采集线程相同，写入可复用缓冲区，攒到32KB交出一次
+static void benchCsv(const std::vector<ImuFrame> &frames)
+{
+    std::vector<char> buffer;
+    buffer.reserve(64 * 1024);
+    double bytes = 0;
+
+    Measurement m;
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+        CsvEncoder::appendFrame(buffer, frames[i].timestampMs, frames[i].imu, frames[i].imuCount);
+        if (buffer.size() >= 32 * 1024)
+        {
+            bytes += buffer.size();
+            buffer.clear();
+        }
+    }
+    bytes += buffer.size();
+    m.report("csv", static_cast<long long>(frames.size()), bytes);
+}
+
+// 对照组：最初版本的 QString::arg + QTextStream 写法
+static void benchCsvQString(const std::vector<ImuFrame> &frames)
+{
+    QByteArray output;
+    QTextStream stream(&output);
+    double bytes = 0;
+
+    Measurement m;
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+        const IMUData *imuData = frames[i].imu;
+        QString line = QString::number(frames[i].timestampMs);
+        for (int k = 0; k < frames[i].imuCount; ++k)
+        {
+            line += QString(",%1,%2,%3,%4,%5,%6")
+                    .arg(imuData[k].accel[0], 0, 'f', 6)
+                    .arg(imuData[k].accel[1], 0, 'f', 6)
+                    .arg(imuData[k].accel[2], 0, 'f', 6)
+                    .arg(imuData[k].gyro[0], 0, 'f', 6)
+                    .arg(imuData[k].gyro[1], 0, 'f', 6)
+                    .arg(imuData[k].gyro[2], 0, 'f', 6);
+        }
+        stream << line << "\n";
+        if (i % 100 == 0)
+        {
+            stream.flush();
+            bytes += output.size();
+            output.clear();
+        }
+    }
+    stream.flush();
+    bytes += output.size();
+    m.report("csv (QString baseline)", static_cast<long long>(frames.size()), bytes);
+}
+
+// 原始数据区一行的文本（视图只对可见行调用）
+static void benchFrameText(const std::vector<ImuFrame> &frames)
+{
+    double bytes = 0;
+    Measurement m;
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+        bytes += DisplayFormatter::frameLine(frames[i]).size() * sizeof(QChar);
+    }
+    m.report("display frame text", static_cast<long long>(frames.size()), bytes, "每行");
+}
+
+// 原始数据区的模型：每帧写入环形缓冲区，每10帧（界面一次刷新）通知视图一次
+static void benchFrameLog(const std::vector<ImuFrame> &frames)
+{
+    FrameLogModel model;
+    Measurement m;
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+        model.append(frames[i]);
+        if (i % 10 == 9)    model.commit();
+    }
+    model.commit();
+    m.report("display frame log", static_cast<long long>(frames.size()),
+             static_cast<double>(frames.size()) * benchFormat->frameSize, "每帧，不含可见行绘制");
+}
+
+// 统计面板文本（界面每次刷新构建一次）
+static void benchStatusText(const std::vector<ImuFrame> &frames, int calls)
+{
+    DisplayStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.actualFrequency = 100.0f;
+    stats.expectedRate = 100.0f;
+    stats.saving = true;
+    double bytes = 0;
+
+    // 管线统计面板：按100Hz、每批1~2帧填充各直方图
+    static PipelineStats pipeline;
+    const int64_t startNs = steadyClockNs();
+    for (int i = 0; i < 10000; ++i)
+    {
+        pipeline.frameInterval.record(i % 2 ? 0 : 20000000 + (i % 7) * 100000);
+        pipeline.decodeLatency.record(20000 + (i % 13) * 1000);
+        pipeline.writeLatency.record(500000000 + (i % 11) * 1000000);
+        pipeline.drawLatency.record(50000000 + (i % 17) * 1000000);
+        pipeline.rate1s.add(startNs - 1000000000LL + i * 100000LL, 1);
+        pipeline.rate10s.add(startNs - 1000000000LL + i * 100000LL, 1);
+    }
+    stats.pipeline = &pipeline;
+    stats.nowNs = startNs;
+
+    Measurement m;
+    for (int i = 0; i < calls; ++i)
+    {
+        stats.totalBytesReceived += benchFormat->frameSize * 10;
+        stats.validFramesReceived += 10;
+        bytes += DisplayFormatter::statusText(stats, frames[static_cast<std::size_t>(i) % frames.size()]).size()
+                * sizeof(QChar);
+    }
+    m.report("display status text", calls, bytes, "每次调用");
+}
+
+// 图表更新：先填满 windowSeconds 秒的窗口，再按 rateHz 的时间间隔逐帧追加，
+// 与界面一样每100ms（10Hz）refresh() 一次；render 为 true 时每次刷新后渲染一次
+static void benchChart(const std::vector<ImuFrame> &frames, int calls, double rateHz, bool render,
+                       int windowSeconds)
+{
+    ImuChart chart;
+    chart.setImuCount(benchFormat->imuCount);
+    chart.setWindow(windowSeconds);
+    QChartView view(chart.chart());
+    view.resize(1200, 500);
+    view.show();
+
+    const qint64 startMs = QDateTime::currentMSecsSinceEpoch();
+    const double stepMs = 1000.0 / rateHz;
+    const int fill = static_cast<int>(windowSeconds * rateHz);
+    ImuFrame frame;
+    for (int i = 0; i < fill; ++i)
+    {
+        frame = frames[static_cast<std::size_t>(i) % frames.size()];
+        frame.timestampMs = startMs + static_cast<qint64>(i * stepMs);
+        chart.append(frame);
+    }
+    chart.refresh();
+    const int refreshEvery = qMax(1, static_cast<int>(rateHz / 10));
+
+    Measurement m;
+    for (int i = 0; i < calls; ++i)
+    {
+        frame = frames[static_cast<std::size_t>(fill + i) % frames.size()];
+        frame.timestampMs = startMs + static_cast<qint64>((fill + i) * stepMs);
+        chart.append(frame);
+        if ((i + 1) % refreshEvery == 0)
+        {
+            chart.refresh();
+            if (render)  view.grab();
+        }
+    }
+
+    char name[64];
+    std::snprintf(name, sizeof(name), render ? "chart+render %.0fHz %ds" : "chart %.0fHz %ds", rateHz, windowSeconds);
+    char note[64];
+    std::snprintf(note, sizeof(note), "每帧，窗口内 %d 帧", fill);
+    m.report(name, calls, static_cast<double>(calls) * benchFormat->frameSize, note);
+}
+
+#if defined(Q_OS_LINUX)
+static double processCpuSeconds()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1.0e6;
+}
+
+// 伪终端回环：写线程按 rateHz 把合成帧逐帧写入伪终端主端，AcquisitionWorker 像打开真实串口一样
+// 打开从端，走完整的 QSerialPort 读取、帧同步、跨IMU统计、帧时钟和界面队列流程（界面队列每10ms取空）。
+// 主端为非阻塞写，写不进去的字节计为发送端溢出（没有流控的真实串口会丢失这些数据），
+// 因此“零丢帧”要求接收端始终跟得上：收到帧数 = 发送帧数，且无溢出、无无效帧、无丢弃字节。
+// ports > 1 时模拟同时采集多个阵列：每个伪终端一个写线程（相位互相错开）和一个采集线程，
+// 界面队列改由 FrameMerger 取用并按时间对齐合并（输出到 /dev/null），另外核对合并行是否完整。
+static void benchPtyIngest(double rateHz, double seconds, int ports)
+{
+    const char *stage = ports > 1 ? "pty merge" : "pty ingest";
+    std::vector<int> masters;
+    QStringList slaveNames;
+    for (int k = 0; k < ports; ++k)
+    {
+        const int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+        {
+            std::printf("%-22s 无法创建伪终端: %s\n", stage, std::strerror(errno));
+            if (master >= 0)    close(master);
+            for (int fd : masters)  close(fd);
+            return;
+        }
+        masters.push_back(master);
+        slaveNames << QString::fromLocal8Bit(ptsname(master));
+    }
+
+    // 工作对象运行在独立线程中，与图形界面相同（每个伪终端一个）
+    std::vector<std::unique_ptr<QThread> > threads;
+    std::vector<AcquisitionWorker *> workers;
+    QString error;
+    for (int k = 0; k < ports; ++k)
+    {
+        threads.emplace_back(new QThread);
+        AcquisitionWorker *worker = new AcquisitionWorker;
+        worker->moveToThread(threads.back().get());
+        QObject::connect(threads.back().get(), &QThread::finished, worker, &QObject::deleteLater);
+        threads.back()->start(QThread::HighPriority);
+        workers.push_back(worker);
+
+        if (error.isEmpty())
+        {
+            QMetaObject::invokeMethod(worker, "setFrameFormat", Qt::BlockingQueuedConnection,
+                                      Q_RETURN_ARG(QString, error), Q_ARG(int, benchFormat->imuCount));
+        }
+        if (error.isEmpty())
+        {
+            QMetaObject::invokeMethod(worker, "setExpectedRate", Qt::BlockingQueuedConnection,
+                                      Q_RETURN_ARG(QString, error), Q_ARG(double, rateHz));
+        }
+        if (error.isEmpty())
+        {
+            QMetaObject::invokeMethod(worker, "openPort", Qt::BlockingQueuedConnection,
+                                      Q_RETURN_ARG(QString, error), Q_ARG(QString, slaveNames[k]), Q_ARG(int, 3000000));
+            if (!error.isEmpty())   error = slaveNames[k] + ": " + error;
+        }
+    }
+
+    FrameMerger merger;
+    if (error.isEmpty() && ports > 1)
+    {
+        for (int k = 0; k < ports; ++k)
+        {
+            merger.addInput(QString("p%1").arg(k + 1).toStdString(), workers[k]->frameQueue(), benchFormat->imuCount);
+        }
+        std::string mergeError;
+        if (!merger.start("/dev/null", static_cast<int64_t>(1.0e9 / rateHz), FrameMerger::DEFAULT_MAX_LATENCY_NS,
+                          &mergeError))
+        {
+            error = QString::fromStdString(mergeError);
+        }
+    }
+    if (!error.isEmpty())
+    {
+        std::printf("%-22s 无法打开: %s\n", stage, qPrintable(error));
+        for (std::size_t k = 0; k < threads.size(); ++k)
+        {
+            QMetaObject::invokeMethod(workers[k], "closePort", Qt::BlockingQueuedConnection);
+            threads[k]->quit();
+            threads[k]->wait();
+        }
+        for (int fd : masters)  close(fd);
+        return;
+    }
+
+    // 发送数据：1000帧不含错误的合成帧循环使用
+    const int cycleFrames = 1000;
+    const std::vector<char> stream = makeStream(cycleFrames, 0.0, 5, nullptr);
+    const std::size_t frameSize = static_cast<std::size_t>(benchFormat->frameSize);
+    const long long totalFrames = static_cast<long long>(rateHz * seconds);
+    std::atomic<long long> overflowBytes(0);
+    std::atomic<long long> maxLagNs(0);
+    std::atomic<int> writersRunning(ports);
+
+    const double cpuStart = processCpuSeconds();
+    Measurement m;
+    std::vector<std::thread> writers;
+    for (int k = 0; k < ports; ++k)
+    {
+        writers.emplace_back([&, k]() {
+            // 按绝对时刻定时，睡眠误差不会累积；各设备的帧相位互相错开
+            const long long periodNs = static_cast<long long>(1.0e9 / rateHz);
+            timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            const long long startNs = start.tv_sec * 1000000000LL + start.tv_nsec + periodNs * k / ports;
+            for (long long n = 0; n < totalFrames; ++n)
+            {
+                const long long dueNs = startNs + (n + 1) * periodNs;
+                const timespec due = {static_cast<time_t>(dueNs / 1000000000LL), static_cast<long>(dueNs % 1000000000LL)};
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, nullptr);
+
+                const char *frame = stream.data() + static_cast<std::size_t>(n % cycleFrames) * frameSize;
+                ssize_t written = write(masters[k], frame, frameSize);
+                if (written < 0)    written = 0;
+                overflowBytes += static_cast<long long>(frameSize) - written;
+
+                timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                const long long lagNs = now.tv_sec * 1000000000LL + now.tv_nsec - dueNs;
+                if (lagNs > maxLagNs)   maxLagNs = lagNs;
+            }
+            writersRunning--;
+        });
+    }
+
+    // 界面线程的角色：定时取空界面队列（合并时由合并线程取用）；发送结束后等待接收端处理完剩余数据
+    QEventLoop loop;
+    QTimer drain;
+    QElapsedTimer settle;
+    QObject::connect(&drain, &QTimer::timeout, &loop, [&]() {
+        long long receivedAll = 0;
+        for (AcquisitionWorker *worker : workers)
+        {
+            ImuFrame frame;
+            if (!merger.isRunning())    while (worker->frameQueue()->pop(frame)) {}
+            receivedAll += worker->validFramesReceived;
+        }
+        if (writersRunning > 0) return;
+        if (!settle.isValid())  settle.start();
+        const long long expected = totalFrames * ports - overflowBytes / static_cast<long long>(frameSize);
+        if (receivedAll >= expected || settle.elapsed() > 1000) loop.quit();
+    });
+    drain.start(10);
+    loop.exec();
+    for (std::thread &writer : writers) writer.join();
+    const double cpuSeconds = processCpuSeconds() - cpuStart;
+
+    long long received = 0, invalid = 0, dropped = 0;
+    double maxIntervalMs = 0, decodeP99Ms = 0;
+    for (AcquisitionWorker *worker : workers)
+    {
+        QMetaObject::invokeMethod(worker, "closePort", Qt::BlockingQueuedConnection);
+        received += worker->validFramesReceived;
+        invalid += worker->invalidFramesReceived;
+        dropped += worker->droppedBytes;
+        maxIntervalMs = qMax(maxIntervalMs, worker->pipeline.frameInterval.maximum() / 1.0e6);
+        decodeP99Ms = qMax(decodeP99Ms, worker->pipeline.decodeLatency.percentile(99) / 1.0e6);
+    }
+    merger.stop();
+    const QString tuning = workers[0]->serialTuningReport();
+    for (std::unique_ptr<QThread> &thread : threads)
+    {
+        thread->quit();
+        thread->wait();
+    }
+    for (int fd : masters)  close(fd);
+
+    const long long sent = totalFrames * ports;
+    bool clean = received == sent && overflowBytes == 0 && invalid == 0 && dropped == 0;
+    if (ports > 1)  clean = clean && merger.completeRows.load() == static_cast<uint64_t>(totalFrames);
+    char name[64];
+    if (ports > 1)  std::snprintf(name, sizeof(name), "pty merge %dx%.0fHz", ports, rateHz);
+    else            std::snprintf(name, sizeof(name), "pty ingest %.0fHz", rateHz);
+    char note[256];
+    std::snprintf(note, sizeof(note), "%s: 收 %lld/%lld 帧  发送溢出 %lld 字节  无效 %lld  丢弃 %lld 字节  "
+                  "最长到达间隔 %.2f ms  读出→解析 P99 %.3f ms  写入滞后最大 %.2f ms  进程CPU %.1f%%",
+                  clean ? "零丢帧" : "有丢失", received, sent, overflowBytes.load(), invalid, dropped,
+                  maxIntervalMs, decodeP99Ms, maxLagNs / 1.0e6, cpuSeconds / seconds * 100.0);
+    m.report(name, sent, static_cast<double>(sent) * frameSize, note);
+    if (ports > 1)
+    {
+        uint64_t late = 0, gaps = 0;
+        int64_t skewP99 = 0;
+        for (int k = 0; k < ports; ++k)
+        {
+            const FrameMerger::PortStats &stats = merger.portStats(k);
+            late += stats.lateFrames.load();
+            gaps += stats.gapFrames.load();
+            skewP99 = qMax(skewP99, stats.skew.percentile(99));
+        }
+        std::printf("%-22s 合并: %llu 行, 完整 %llu  迟到 %llu  未入队 %llu  时间差P99 %.1f us（相位错开 %.1f us）\n", "",
+                    static_cast<unsigned long long>(merger.rows.load()),
+                    static_cast<unsigned long long>(merger.completeRows.load()),
+                    static_cast<unsigned long long>(late), static_cast<unsigned long long>(gaps),
+                    skewP99 / 1.0e3, 1.0e6 / rateHz / ports);
+    }
+    std::printf("%-22s 串口设置: %s\n", "", qPrintable(tuning));
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    // 无显示服务时也能运行（图表渲染使用 offscreen 平台）
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("IMU阵列热点路径基准测试");
+    parser.addHelpOption();
+    QCommandLineOption framesOption(QStringList() << "n" << "frames", "合成帧数（默认100000）", "count", "100000");
+    QCommandLineOption corruptOption("corrupt", "帧同步测试的错误注入比例，逗号分隔（默认 0,0.01,0.1）",
+                                     "rates", "0,0.01,0.1");
+    QCommandLineOption chartOption("chart-calls", "图表测试的追加次数（默认2000）", "count", "2000");
+    QCommandLineOption imusOption("imus", QString("合成帧的IMU数量，即帧格式（默认%1）").arg(DEFAULT_IMU_COUNT),
+                                  "count", QString::number(DEFAULT_IMU_COUNT));
+    QCommandLineOption ptyRateOption("pty-rate", "伪终端回环测试的帧率（Hz，默认2000，仅 Linux）", "hz", "2000");
+    QCommandLineOption ptySecondsOption("pty-seconds", "伪终端回环测试时长（秒，默认10，0为不运行）", "seconds", "10");
+    QCommandLineOption ptyPortsOption("pty-ports", "多串口合并测试的伪终端数量（默认3，小于2为不运行）", "count", "3");
+    QCommandLineOption recordingOption("recording", "压缩测试改用该 *.imu 记录文件的数据", "file");
+    QCommandLineOption onlyOption("only", "只运行名称包含该字符串的测试", "name");
+    parser.addOptions(QList<QCommandLineOption>() << framesOption << corruptOption << chartOption << imusOption
+                      << ptyRateOption << ptySecondsOption << ptyPortsOption << recordingOption << onlyOption);
+    parser.process(app);
+
+    benchFormat = findFrameFormat(parser.value(imusOption).toInt());
+    if (!benchFormat)
+    {
+        std::fprintf(stderr, "不支持的IMU数量: %s\n", qPrintable(parser.value(imusOption)));
+        return 1;
+    }
+
+    const int frameCount = qMax(1, parser.value(framesOption).toInt());
+    const int chartCalls = qMax(1, parser.value(chartOption).toInt());
+    const QString filter = parser.value(onlyOption);
+
+    std::vector<ImuFrame> frames;
+    std::vector<char> cleanStream = makeStream(frameCount, 0.0, 1, &frames);
+
+    std::printf("帧数: %d  帧格式: %s  帧长: %d 字节  分配计数: %s\n\n", frameCount, benchFormat->name,
+                benchFormat->frameSize, ALLOCATION_METHOD);
+    std::printf("%-22s %10s %12s %12s %10s\n", "benchmark", "items", "ns/item", "allocs/item", "MB/s");
+
+    if (selected(filter, "sync"))
+    {
+        foreach (const QString &rateText, parser.value(corruptOption).split(',', QString::SkipEmptyParts))
+        {
+            const double rate = rateText.toDouble();
+            if (rate <= 0)  benchSynchronizer(cleanStream, frameCount, 0.0);
+            else            benchSynchronizer(makeStream(frameCount, rate, 2, nullptr), frameCount, rate);
+        }
+    }
+    if (selected(filter, "mean"))                       benchMean(frames);
+    const ImuArrayStats::Kernel kernels[] = {ImuArrayStats::ScalarKernel, ImuArrayStats::Sse2Kernel,
+                                             ImuArrayStats::AvxKernel};
+    for (ImuArrayStats::Kernel kernel : kernels)
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "array stats (%s)", ImuArrayStats::kernelName(kernel));
+        if (selected(filter, name)) benchArrayStats(frames, kernel);
+    }
+    const DspStage::Kernel dspKernels[] = {DspStage::ScalarKernel, DspStage::Sse2Kernel};
+    for (DspStage::Kernel kernel : dspKernels)
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "dsp avg (%s)", DspStage::kernelName(kernel));
+        if (selected(filter, name)) benchDsp(frames, kernel, DspStage::MovingAverage);
+        std::snprintf(name, sizeof(name), "dsp cic (%s)", DspStage::kernelName(kernel));
+        if (selected(filter, name)) benchDsp(frames, kernel, DspStage::CicDecimator);
+    }
+    const ImuCalibration::Kernel calibrationKernels[] = {ImuCalibration::ScalarKernel, ImuCalibration::Sse2Kernel};
+    for (ImuCalibration::Kernel kernel : calibrationKernels)
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "calibration (%s)", ImuCalibration::kernelName(kernel));
+        if (selected(filter, name)) benchCalibration(frames, kernel);
+    }
+    const AttitudeFilter::Kernel attitudeKernels[] = {AttitudeFilter::ScalarKernel, AttitudeFilter::Sse2Kernel};
+    for (AttitudeFilter::Kernel kernel : attitudeKernels)
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "attitude (%s)", AttitudeFilter::kernelName(kernel));
+        if (selected(filter, name)) benchAttitude(frames, kernel);
+    }
+    if (selected(filter, "noise analysis"))             benchNoiseAnalysis(frames);
+    if (selected(filter, "frame clock"))                benchFrameClock(frameCount);
+    if (selected(filter, "csv"))                        benchCsv(frames);
+    if (selected(filter, "csv (QString baseline)"))     benchCsvQString(frames);
+    if (selected(filter, "display frame text"))         benchFrameText(frames);
+    if (selected(filter, "display frame log"))          benchFrameLog(frames);
+    if (selected(filter, "display status text"))        benchStatusText(frames, qMin(frameCount, 20000));
+    // 10Hz：原来界面的抽样率（对照）；100Hz：完整帧率
+    if (selected(filter, "chart 10Hz 10s"))             benchChart(frames, chartCalls, 10.0, false, 10);
+    if (selected(filter, "chart 100Hz 10s"))            benchChart(frames, chartCalls, 100.0, false, 10);
+    if (selected(filter, "chart+render 100Hz 10s"))     benchChart(frames, chartCalls, 100.0, true, 10);
+    // 长窗口：曲线点数由降采样金字塔限制在约每像素一个桶
+    if (selected(filter, "chart+render 100Hz 3600s"))   benchChart(frames, chartCalls, 100.0, true, 3600);
+    if (selected(filter, "compress"))
+    {
+        std::vector<char> recording;
+        QByteArray source = "合成";
+        if (parser.isSet(recordingOption))
+        {
+            recording = loadRecording(parser.value(recordingOption));
+            source = QFileInfo(parser.value(recordingOption)).fileName().toUtf8();
+            if (recording.empty())  std::printf("%-22s 不是可读取的 *.imu 记录: %s\n", "compress", source.constData());
+        }
+        else
+        {
+            recording = makeRecording(frames);
+        }
+        const RecordBlockCodec::ChannelCodec codecs[] = {RecordBlockCodec::AutoCodec, RecordBlockCodec::XorCodec,
+                                                         RecordBlockCodec::DeltaCodec};
+        for (RecordBlockCodec::ChannelCodec codec : codecs)
+        {
+            if (!recording.empty()) benchCompression(recording, codec, source.constData());
+        }
+    }
+#if defined(Q_OS_LINUX)
+    const double ptyRate = parser.value(ptyRateOption).toDouble();
+    const double ptySeconds = parser.value(ptySecondsOption).toDouble();
+    const int ptyPorts = parser.value(ptyPortsOption).toInt();
+    if (selected(filter, "pty ingest") && ptyRate > 0 && ptySeconds > 0)    benchPtyIngest(ptyRate, ptySeconds, 1);
+    if (selected(filter, "pty merge") && ptyRate > 0 && ptySeconds > 0 && ptyPorts > 1)
+    {
+        benchPtyIngest(ptyRate, ptySeconds, ptyPorts);
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "binaryrecorder.h"
+#include <QDateTime>
+#include <chrono>
+
+// 缓冲区达到该大小时提前交给写盘线程
+static const std::size_t SUBMIT_BYTES = 32 * 1024;
+
+static void appendBytes(AsyncFileWriter::Buffer &buffer, const void *data, std::size_t size)
+{
+    const char *p = static_cast<const char *>(data);
+    buffer.insert(buffer.end(), p, p + size);
+}
+
+BinaryRecorder::BinaryRecorder() :
+    compressed(false),
+    frameFormat(&defaultFrameFormat()),
+    dataBuffer(nullptr),
+    indexBuffer(nullptr),
+    dataOldestNs(0),
+    payloadSize(0),
+    recordSize(0),
+    framesWritten(0),
+    dataOffset(0)
+{
+}
+
+BinaryRecorder::~BinaryRecorder()
+{
+    close();
+}
+
+bool BinaryRecorder::open(const QString &fileName, const FrameFormat &format, const AsyncFileWriter::Policy &policy,
+                          bool compressedFile, const RecordingSegments::Limits &segmentLimits, QString *errorString)
+{
+    close();
+
+    compressed = compressedFile;
+    frameFormat = &format;
+    encoder.reset();
+    dataWriter.setEncoder(compressed ? &encoder : nullptr);
+    segments.start(fileName.toUtf8().toStdString(), segmentLimits);
+
+    const std::string dataFileName = segments.currentFileName();
+    std::string error;
+    if (!dataWriter.open(dataFileName, policy, &error))
+    {
+        if (errorString)    *errorString = QString::fromStdString(error);
+        return false;
+    }
+    // 索引文件很小，不预分配
+    AsyncFileWriter::Policy indexPolicy = policy;
+    indexPolicy.preallocateBytes = 0;
+    if (!compressed && !indexWriter.open(dataFileName + ".idx", indexPolicy, &error))
+    {
+        if (errorString)    *errorString = QString::fromStdString(error);
+        dataWriter.close();
+        return false;
+    }
+    dataBuffer = dataWriter.acquireBuffer();
+    indexBuffer = compressed ? nullptr : indexWriter.acquireBuffer();
+    dataOldestNs = 0;
+    beginFile();
+    return true;
+}
+
+void BinaryRecorder::beginFile()
+{
+    // 文件头记录帧布局、单位，以及单调时钟与UTC时间的对应关系（每段重新取）
+    const int64_t steadyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    RecordingFileHeader header = makeRecordingHeader(
+                *frameFormat, QDateTime::currentDateTimeUtc().toMSecsSinceEpoch(), steadyNs);
+    appendBytes(*dataBuffer, &header, sizeof(header));
+
+    if (indexBuffer)
+    {
+        RecordingIndexHeader indexHeader = makeRecordingIndexHeader();
+        appendBytes(*indexBuffer, &indexHeader, sizeof(indexHeader));
+    }
+
+    framesWritten = 0;
+    dataOffset = sizeof(header);
+    payloadSize = header.payloadSize;
+    recordSize = header.recordSize;
+}
+
+void BinaryRecorder::endFile(const std::string &nextFileName)
+{
+    submitPending();
+    // 文件尾不经过压缩编码，由写盘线程在本段数据之后写入
+    const RecordingFooter footer = segments.footer();
+    AsyncFileWriter::Buffer *trailer = dataWriter.acquireBuffer();
+    appendBytes(*trailer, &footer, sizeof(footer));
+    dataWriter.rollover(trailer, nextFileName);
+    if (indexBuffer)    indexWriter.rollover(nullptr, nextFileName.empty() ? nextFileName : nextFileName + ".idx");
+}
+
+void BinaryRecorder::write(const ImuFrame &frame)
+{
+    if (!dataBuffer)    return;
+
+    // 当前段已满：结束本段，之后的帧写入下一段
+    if (segments.full(frame.monotonicNs))
+    {
+        endFile(segments.fileName(segments.index() + 1));
+        segments.next();
+        beginFile();
+    }
+
+    RecordHeader record;
+    record.sequence = frame.sequence;
+    record.timestampNs = frame.monotonicNs;
+    record.arrivalNs = frame.arrivalNs;
+
+    // 每 RECORDING_INDEX_INTERVAL 帧写一个索引项
+    if (indexBuffer && framesWritten % RECORDING_INDEX_INTERVAL == 0)
+    {
+        RecordingIndexEntry entry;
+        entry.timestampNs = record.timestampNs;
+        entry.sequence = record.sequence;
+        entry.offset = dataOffset;
+        appendBytes(*indexBuffer, &entry, sizeof(entry));
+    }
+
+    // IMUData 数组与帧负载布局一致，原样写入
+    if (dataOldestNs == 0)  dataOldestNs = frame.arrivalNs;
+    appendBytes(*dataBuffer, &record, sizeof(record));
+    appendBytes(*dataBuffer, frame.imu, payloadSize);
+    framesWritten++;
+    dataOffset += recordSize;
+    segments.add(record.sequence, record.timestampNs, recordSize);
+
+    if (dataBuffer->size() >= SUBMIT_BYTES) submitPending();
+}
+
+void BinaryRecorder::submitPending()
+{
+    if (!dataBuffer)    return;
+    if (!dataBuffer->empty())
+    {
+        dataWriter.submit(dataBuffer, dataOldestNs);
+        dataBuffer = dataWriter.acquireBuffer();
+        dataOldestNs = 0;
+    }
+    if (indexBuffer && !indexBuffer->empty())
+    {
+        indexWriter.submit(indexBuffer);
+        indexBuffer = indexWriter.acquireBuffer();
+    }
+}
+
+void BinaryRecorder::close()
+{
+    if (!dataBuffer)    return;
+    endFile(std::string());
+    // 把空缓冲区还给对象池
+    dataWriter.submit(dataBuffer);
+    if (indexBuffer)    indexWriter.submit(indexBuffer);
+    dataBuffer = nullptr;
+    indexBuffer = nullptr;
+    indexWriter.close();
+    dataWriter.close();
+}
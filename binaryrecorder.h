@@ -0,0 +1,61 @@
+#ifndef BINARYRECORDER_H
+#define BINARYRECORDER_H
+
+#include <QString>
+#include "imuframe.h"
+#include "recordingformat.h"
+#include "asyncfilewriter.h"
+#include "recordingcodec.h"
+#include "recordingsegments.h"
+
+// 二进制记录器：每帧原样写入负载（imuCount 个 IMUData）+ 帧序号 + 采样/到达时间戳，
+// 同时维护稀疏时间索引旁路文件（见 recordingformat.h）。
+// 压缩记录（*.imuz）在写盘线程中按块编码（CompressedRecordingEncoder），块头即索引，不写旁路文件。
+// 可按大小或时长分段（RecordingSegments），每段结束时写入文件尾。
+// 只在采集线程中使用，实际写盘由后台写盘线程完成。
+class BinaryRecorder
+{
+public:
+    BinaryRecorder();
+    ~BinaryRecorder();
+
+    // format: 本次记录的帧格式（写入文件头，决定每条记录的长度）；compressed: 写压缩记录；
+    // segmentLimits: 分段条件，不分段时只写 fileName 一个文件
+    bool open(const QString &fileName, const FrameFormat &format, const AsyncFileWriter::Policy &policy,
+              bool compressed, const RecordingSegments::Limits &segmentLimits, QString *errorString);
+    void write(const ImuFrame &frame);
+    // 把已编码的数据交给写盘线程（每批解析结束时调用）
+    void submitPending();
+    // 写入最后一段的文件尾并关闭（等待写盘线程写完）
+    void close();
+    bool isOpen() const { return dataWriter.isOpen(); }
+
+    bool isCompressed() const { return compressed; }
+    int segmentIndex() const { return segments.index(); }
+    const AsyncFileWriter &writer() const { return dataWriter; }
+    // 数据文件的写盘延迟（读出 → 写入文件）记入该直方图
+    void setLatencyHistogram(LatencyHistogram *histogram) { dataWriter.setLatencyHistogram(histogram); }
+
+    static QString indexFileName(const QString &fileName) { return fileName + ".idx"; }
+
+private:
+    void beginFile();                   // 写入当前段的文件头和索引文件头
+    // 把当前段的文件尾交给写盘线程并切换到 nextFileName（为空时只结束当前段）
+    void endFile(const std::string &nextFileName);
+
+    CompressedRecordingEncoder encoder; // 压缩记录的块编码（在 dataWriter 的写盘线程中运行）
+    AsyncFileWriter dataWriter;         // 数据文件 *.imu / *.imuz
+    AsyncFileWriter indexWriter;        // 索引文件 *.imu.idx
+    bool compressed;
+    const FrameFormat *frameFormat;
+    RecordingSegments segments;
+    AsyncFileWriter::Buffer *dataBuffer;
+    AsyncFileWriter::Buffer *indexBuffer;
+    int64_t dataOldestNs;               // dataBuffer 中最早一帧的到达时刻
+    std::size_t payloadSize;            // 每帧负载字节数
+    uint32_t recordSize;                // 每条记录字节数
+    quint64 framesWritten;              // 当前段已写入帧数
+    quint64 dataOffset;                 // 下一条记录在当前段中的文件偏移
+};
+
+#endif // BINARYRECORDER_H
@@ -0,0 +1,674 @@
+// 命令行采集程序（无界面）：用于机柜电脑上长时间无人值守的记录
+// 与图形界面共用 AcquisitionWorker 的串口读取、帧解析和写盘流程，
+// 只依赖 QtCore、QtSerialPort 和 QtNetwork，不需要 QtWidgets/QtCharts 和显示服务。
+// 可同时采集多个串口（多个 -p）：每个串口一个采集线程，各自保存，可再按时间对齐合并为一个CSV。
+//
+// 构建：qmake CONFIG+=headless && make
+// 示例：IMUarray_SP_V2_cli -p COM3 -b 460800 -o run1.imu -d 3600
+//       IMUarray_SP_V2_cli -p /dev/ttyUSB0 -b 3000000 --rate 1000 -o fast.imu   （高帧率固件）
+//       IMUarray_SP_V2_cli -p /dev/ttyUSB0 -p /dev/ttyUSB1 -o run.imu --merge run_merged.csv
+//                          （保存 run_1.imu、run_2.imu，并写出按时间对齐的合并CSV）
+//       IMUarray_SP_V2_cli -p /dev/ttyUSB0 -o day.imuz --segment-time 3600   （每小时一个文件 day_001.imuz ...）
+//       IMUarray_SP_V2_cli -p /dev/ttyUSB0 -o run.imu --calibration array.cal --attitude
+//                          （run.imu 为原始数据，另存校正后的数据 run_cal.imu 和各IMU的姿态 run_attitude.csv）
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSerialPortInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <csignal>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "acquisitionworker.h"
+#include "framemerger.h"
+#include "metricsserver.h"
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int)
+{
+    stopRequested = 1;
+}
+
+static QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+static QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+// IMU位掩码 → "1,5,9"（IMU编号从1起），没有时为 "-"
+static QString imuList(quint32 mask)
+{
+    QStringList imus;
+    for (int i = 0; i < MAX_IMU_COUNT; ++i)
+    {
+        if (mask & (1u << i))   imus << QString::number(i + 1);
+    }
+    return imus.isEmpty() ? QString("-") : imus.join(',');
+}
+
+// 每个数据源一项的参数：单个值用于全部数据源，也可用逗号分隔逐个指定
+static QStringList perSource(const QString &value, int count)
+{
+    QStringList values = value.split(',');
+    if (values.size() == 1) while (values.size() < count)   values << values.first();
+    return values;
+}
+
+// 多个数据源时的文件名：run.imu → run_2.imu（第 index + 1 个数据源）
+static QString sourceFileName(const QString &fileName, int index, int count)
+{
+    if (count <= 1) return fileName;
+    const QFileInfo info(fileName);
+    const QString base = info.completeBaseName() + QString("_%1").arg(index + 1);
+    const QString name = info.suffix().isEmpty() ? base : base + '.' + info.suffix();
+    return info.path() == "." && !fileName.startsWith("./") ? name : info.path() + '/' + name;
+}
+
+// 在工作对象所在的采集线程中调用返回 QString 的槽
+static QString invoke(AcquisitionWorker *worker, const char *method,
+                      QGenericArgument arg0 = QGenericArgument(), QGenericArgument arg1 = QGenericArgument(),
+                      QGenericArgument arg2 = QGenericArgument())
+{
+    QString error;
+    QMetaObject::invokeMethod(worker, method, Qt::BlockingQueuedConnection, Q_RETURN_ARG(QString, error),
+                              arg0, arg1, arg2);
+    return error;
+}
+
+// 停止数据源（回放、串口和保存）并结束各采集线程
+static void stopSources(const QList<AcquisitionWorker *> &workers, const QList<QThread *> &threads)
+{
+    foreach (AcquisitionWorker *worker, workers)
+    {
+        QMetaObject::invokeMethod(worker, "stopReplay", Qt::BlockingQueuedConnection);
+        QMetaObject::invokeMethod(worker, "closePort", Qt::BlockingQueuedConnection);
+    }
+    foreach (QThread *thread, threads)
+    {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("IMUarray_SP_V2_cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("IMU阵列串口采集（命令行）");
+    parser.addHelpOption();
+    QCommandLineOption portOption(QStringList() << "p" << "port",
+                                  "串口名，例如 COM3 或 /dev/ttyUSB0；多次指定时同时采集多个串口", "port");
+    QCommandLineOption baudOption(QStringList() << "b" << "baud",
+                                  "波特率，可为任意值，例如 2000000（默认460800）；多个串口时可逗号分隔逐个指定",
+                                  "baud", "460800");
+    QCommandLineOption rateOption(QStringList() << "r" << "rate",
+                                  QString("设备的理论帧率（Hz，默认%1）").arg(AcquisitionWorker::DEFAULT_FRAME_RATE),
+                                  "hz", QString::number(AcquisitionWorker::DEFAULT_FRAME_RATE));
+    QStringList imuCounts;
+    for (int i = 0; i < frameFormatCount(); ++i)    imuCounts << QString::number(frameFormatAt(i).imuCount);
+    QCommandLineOption imusOption("imus", QString("每帧IMU数量，即帧格式 %1（默认%2；回放 *.imu 时按文件头；"
+                                                  "多个串口时可逗号分隔逐个指定）")
+                                  .arg(imuCounts.join('|')).arg(DEFAULT_IMU_COUNT),
+                                  "count", QString::number(DEFAULT_IMU_COUNT));
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                    "保存文件；扩展名 .imu 为二进制记录，.imuz 为压缩二进制记录，其余为CSV（默认 IMU_Data_时间.csv）；"
+                                    "多个串口时依次保存为 文件名_1、文件名_2 ...", "file");
+    QCommandLineOption formatOption(QStringList() << "f" << "format", "保存格式 csv、imu 或 imuz（默认按扩展名）", "format");
+    QCommandLineOption noSaveOption("no-save", "只接收和统计，不保存");
+    QCommandLineOption durationOption(QStringList() << "d" << "duration", "记录时长（秒），到时自动退出", "seconds");
+    QCommandLineOption sizeOption(QStringList() << "s" << "max-size", "保存文件（分段时为各段之和，含 *_dsp 和 *_attitude.csv 文件）达到该大小（MB）后自动退出", "MB");
+    QCommandLineOption segmentSizeOption("segment-size", "分段保存：每段达到该大小（MB，压缩前）后切换到新文件", "MB");
+    QCommandLineOption segmentTimeOption("segment-time", "分段保存：每段达到该时长（秒）后切换到新文件", "seconds");
+    QCommandLineOption syncOption("sync-interval", "每隔该毫秒数 fdatasync 一次（默认1000；0 只在每段结束时，-1 从不）",
+                                  "ms", "1000");
+    QCommandLineOption preallocateOption("preallocate", "保存文件按该大小（MB）分段预分配磁盘空间（默认64，0为不预分配）",
+                                         "MB", "64");
+    QCommandLineOption statsOption(QStringList() << "i" << "stats-interval", "统计输出间隔（秒，默认1，0为不输出）",
+                                   "seconds", "1");
+    QCommandLineOption policyOption("policy", "积压过载策略 drain|drop|decimate（默认drain）", "policy", "drain");
+    QCommandLineOption rawOption("raw", "同时把原始串口字节录制到该文件（多个串口时同样按序号加后缀）", "file");
+    QCommandLineOption replayOption("replay", "回放录制文件（*.bin 原始字节或 *.imu、*.imuz 记录），代替串口；可多次指定", "file");
+    QCommandLineOption mergeOption("merge", "把各串口的帧按采样时刻对齐，合并写入该CSV文件", "file");
+    QCommandLineOption toleranceOption("merge-tolerance", "合并时同一行各帧采样时刻之差的上限（毫秒，默认一个帧周期）", "ms");
+    QCommandLineOption speedOption("speed", "回放倍速（默认1，0为不限速）", "factor", "1");
+    QCommandLineOption corruptOption("corrupt", "回放时每帧注入错误的概率（0~1，用于测试失步恢复）", "rate", "0");
+    QCommandLineOption metricsOption("metrics-port",
+                                     QString("在 127.0.0.1 该端口提供 Prometheus 监控指标（常用 %1）")
+                                     .arg(MetricsServer::DEFAULT_PORT), "port");
+    QCommandLineOption accelRangeOption("accel-range",
+                                        QString("加速度计量程（g，默认%1），读数达到量程视为饱和")
+                                        .arg(double(ImuArrayStats::DEFAULT_ACCEL_RANGE)),
+                                        "g", QString::number(double(ImuArrayStats::DEFAULT_ACCEL_RANGE)));
+    QCommandLineOption gyroRangeOption("gyro-range",
+                                       QString("陀螺仪量程（deg/s，默认%1）").arg(double(ImuArrayStats::DEFAULT_GYRO_RANGE)),
+                                       "dps", QString::number(double(ImuArrayStats::DEFAULT_GYRO_RANGE)));
+    QCommandLineOption stuckOption("stuck-frames",
+                                   QString("某通道连续该帧数读数完全相同即判定IMU卡死（默认%1）")
+                                   .arg(ImuArrayStats::DEFAULT_STUCK_FRAMES),
+                                   "frames", QString::number(ImuArrayStats::DEFAULT_STUCK_FRAMES));
+    QCommandLineOption lowpassOption("lowpass", "实时信号处理：Butterworth 低通截止频率（Hz，默认不滤波）", "hz");
+    QCommandLineOption filterOrderOption("filter-order", "低通滤波器阶数 2|4|6|8（默认4）", "order", "4");
+    QCommandLineOption decimateOption("decimate", "实时信号处理：抽取倍数（默认1，不抽取）", "factor", "1");
+    QCommandLineOption decimatorOption("decimator", "抽取方式 avg（滑动平均）|cic（3级CIC）（默认avg）", "type", "avg");
+    QCommandLineOption biasOption("bias", "实时信号处理：启动时估计并扣除零偏 none|gyro|all（默认none，需保持静止）",
+                                  "channels", "none");
+    QCommandLineOption biasSecondsOption("bias-seconds", "零偏估计时长（秒，默认2）", "seconds", "2");
+    QCommandLineOption calibrationOption("calibration", "各IMU的加速度计/陀螺仪标定文件（每行 imu,sensor,矩阵9个,零偏3个）", "file");
+    QCommandLineOption attitudeOption("attitude", "实时解算各IMU的姿态（Madgwick），保存时另存 *_attitude.csv 文件");
+    QCommandLineOption attitudeGainOption("attitude-gain", "姿态解算的加速度计修正增益 beta（默认0.033）", "beta", "0.033");
+    QCommandLineOption listOption(QStringList() << "l" << "list-ports", "列出可用串口后退出");
+    parser.addOptions(QList<QCommandLineOption>() << portOption << baudOption << rateOption << imusOption
+                      << outputOption << formatOption << noSaveOption << durationOption << sizeOption
+                      << segmentSizeOption << segmentTimeOption << syncOption << preallocateOption
+                      << statsOption << policyOption << rawOption << replayOption << mergeOption << toleranceOption
+                      << speedOption << corruptOption
+                      << metricsOption << accelRangeOption << gyroRangeOption << stuckOption
+                      << lowpassOption << filterOrderOption << decimateOption << decimatorOption
+                      << biasOption << biasSecondsOption << calibrationOption << attitudeOption << attitudeGainOption
+                      << listOption);
+    parser.process(app);
+
+    if (parser.isSet(listOption))
+    {
+        foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts())
+        {
+            out() << info.portName() << "\t" << info.description() << endl;
+        }
+        return 0;
+    }
+
+    const bool replaying = parser.isSet(replayOption);
+    if (!replaying && !parser.isSet(portOption))
+    {
+        err() << "需要指定串口 (-p) 或回放文件 (--replay)，参见 --help" << endl;
+        return 1;
+    }
+    if (replaying && parser.isSet(portOption))
+    {
+        err() << "串口 (-p) 和回放文件 (--replay) 不能同时指定" << endl;
+        return 1;
+    }
+    const QStringList sources = replaying ? parser.values(replayOption) : parser.values(portOption);
+    const int sourceCount = sources.size();
+
+    bool ok = true;
+    const QStringList baudValues = perSource(parser.value(baudOption), sourceCount);
+    const QStringList imuValues = perSource(parser.value(imusOption), sourceCount);
+    if (baudValues.size() != sourceCount || imuValues.size() != sourceCount)
+    {
+        err() << "--baud 和 --imus 需为单个值或与串口数量相同的逗号分隔列表" << endl;
+        return 1;
+    }
+    QList<int> baudRates;
+    QList<int> imuCountValues;
+    for (int k = 0; k < sourceCount; ++k)
+    {
+        const int baudRate = baudValues[k].toInt(&ok);
+        if (!ok || baudRate <= 0)
+        {
+            err() << "无效的波特率: " << baudValues[k] << endl;
+            return 1;
+        }
+        const int imuCount = imuValues[k].toInt(&ok);
+        if (!ok || !findFrameFormat(imuCount))
+        {
+            err() << "不支持的IMU数量: " << imuValues[k] << "（可选 " << imuCounts.join(", ") << "）" << endl;
+            return 1;
+        }
+        baudRates << baudRate;
+        imuCountValues << imuCount;
+    }
+    const double frameRate = parser.value(rateOption).toDouble(&ok);
+    if (!ok || frameRate <= 0)
+    {
+        err() << "无效的帧率: " << parser.value(rateOption) << endl;
+        return 1;
+    }
+    // 实时信号处理：滤波器参数由工作对象按帧率校验；启用后保存时另存 *_dsp 文件，合并的是处理后的帧
+    const double lowpassHz = parser.isSet(lowpassOption) ? parser.value(lowpassOption).toDouble(&ok) : 0;
+    if (!ok || lowpassHz < 0)
+    {
+        err() << "无效的低通截止频率: " << parser.value(lowpassOption) << endl;
+        return 1;
+    }
+    const int filterOrder = parser.value(filterOrderOption).toInt(&ok);
+    const int decimation = ok ? parser.value(decimateOption).toInt(&ok) : 0;
+    if (!ok || decimation < 1)
+    {
+        err() << "无效的滤波器阶数或抽取倍数" << endl;
+        return 1;
+    }
+    const double biasSeconds = parser.value(biasSecondsOption).toDouble(&ok);
+    const QString decimatorName = parser.value(decimatorOption);
+    const QString biasName = parser.value(biasOption);
+    if (!ok || (decimatorName != "avg" && decimatorName != "cic")
+            || (biasName != "none" && biasName != "gyro" && biasName != "all"))
+    {
+        err() << "无效的抽取方式或零偏设置" << endl;
+        return 1;
+    }
+    const int decimator = decimatorName == "cic" ? DspStage::CicDecimator : DspStage::MovingAverage;
+    const int biasMode = biasName == "gyro" ? DspStage::GyroBias : (biasName == "all" ? DspStage::AllBias : DspStage::NoBias);
+    // 标定在统计之前生效（原始数据照常保存，校正后的数据另存 *_cal.*）；增益范围由工作对象校验
+    const QString calibrationFile = parser.value(calibrationOption);
+    const double attitudeGain = parser.value(attitudeGainOption).toDouble(&ok);
+    if (!ok)
+    {
+        err() << "无效的姿态解算增益: " << parser.value(attitudeGainOption) << endl;
+        return 1;
+    }
+
+    const double toleranceMs = parser.isSet(toleranceOption) ? parser.value(toleranceOption).toDouble(&ok)
+                                                             : 1000.0 * decimation / frameRate;
+    if (!ok || toleranceMs <= 0)
+    {
+        err() << "无效的合并容差: " << parser.value(toleranceOption) << endl;
+        return 1;
+    }
+    // 定时器以 int 毫秒计时，上限约24.8天；NaN 两个比较都不成立
+    const double maxDurationSeconds = std::numeric_limits<int>::max() / 1000.0;
+    const double durationSeconds = parser.isSet(durationOption) ? parser.value(durationOption).toDouble(&ok) : 0;
+    if (!ok || !(durationSeconds >= 0 && durationSeconds <= maxDurationSeconds))
+    {
+        err() << "无效的记录时长: " << parser.value(durationOption)
+              << "（0~" << static_cast<qint64>(maxDurationSeconds) << " 秒）" << endl;
+        return 1;
+    }
+    const double maxSizeMB = parser.isSet(sizeOption) ? parser.value(sizeOption).toDouble(&ok) : 0;
+    if (!ok || maxSizeMB < 0)
+    {
+        err() << "无效的文件大小: " << parser.value(sizeOption) << endl;
+        return 1;
+    }
+    const int segmentMB = parser.isSet(segmentSizeOption) ? parser.value(segmentSizeOption).toInt(&ok) : 0;
+    if (!ok || segmentMB < 0)
+    {
+        err() << "无效的分段大小: " << parser.value(segmentSizeOption) << endl;
+        return 1;
+    }
+    const int segmentSeconds = parser.isSet(segmentTimeOption) ? parser.value(segmentTimeOption).toInt(&ok) : 0;
+    if (!ok || segmentSeconds < 0)
+    {
+        err() << "无效的分段时长: " << parser.value(segmentTimeOption) << endl;
+        return 1;
+    }
+    const int syncIntervalMs = parser.value(syncOption).toInt(&ok);
+    if (!ok)
+    {
+        err() << "无效的同步间隔: " << parser.value(syncOption) << endl;
+        return 1;
+    }
+    const int preallocateMB = parser.value(preallocateOption).toInt(&ok);
+    if (!ok || preallocateMB < 0)
+    {
+        err() << "无效的预分配大小: " << parser.value(preallocateOption) << endl;
+        return 1;
+    }
+    const double statsSeconds = parser.value(statsOption).toDouble(&ok);
+    if (!ok || statsSeconds < 0)
+    {
+        err() << "无效的统计间隔: " << parser.value(statsOption) << endl;
+        return 1;
+    }
+
+    const double accelRange = parser.value(accelRangeOption).toDouble(&ok);
+    if (!ok || accelRange <= 0)
+    {
+        err() << "无效的加速度计量程: " << parser.value(accelRangeOption) << endl;
+        return 1;
+    }
+    const double gyroRange = parser.value(gyroRangeOption).toDouble(&ok);
+    if (!ok || gyroRange <= 0)
+    {
+        err() << "无效的陀螺仪量程: " << parser.value(gyroRangeOption) << endl;
+        return 1;
+    }
+    const int stuckFrames = parser.value(stuckOption).toInt(&ok);
+    if (!ok || stuckFrames < 2)
+    {
+        err() << "无效的卡死判定帧数: " << parser.value(stuckOption) << endl;
+        return 1;
+    }
+
+    int policy = AcquisitionWorker::DrainAll;
+    const QString policyName = parser.value(policyOption);
+    if (policyName == "drop")           policy = AcquisitionWorker::DropOldest;
+    else if (policyName == "decimate")  policy = AcquisitionWorker::DecimateDisplay;
+    else if (policyName != "drain")
+    {
+        err() << "未知的过载策略: " << policyName << endl;
+        return 1;
+    }
+
+    // 保存文件和格式
+    QString fileName;
+    int format = AcquisitionWorker::CsvFormat;
+    if (!parser.isSet(noSaveOption))
+    {
+        fileName = parser.value(outputOption);
+        QString formatName = parser.value(formatOption);
+        if (formatName.isEmpty())
+        {
+            const QString suffix = QFileInfo(fileName).suffix().toLower();
+            formatName = suffix == "imu" || suffix == "imuz" ? suffix : "csv";
+        }
+        if (formatName == "imu")        format = AcquisitionWorker::BinaryFormat;
+        else if (formatName == "imuz")  format = AcquisitionWorker::CompressedFormat;
+        else if (formatName != "csv")
+        {
+            err() << "未知的保存格式: " << formatName << endl;
+            return 1;
+        }
+        if (fileName.isEmpty())
+        {
+            fileName = QString("IMU_Data_%1.%2")
+                    .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"))
+                    .arg(formatName);
+        }
+    }
+
+    // 数据源标签：监控指标的 port 标签和合并CSV的列名前缀
+    QStringList labels;
+    for (int k = 0; k < sourceCount; ++k)
+    {
+        const QFileInfo info(sources[k]);
+        QString label = replaying ? info.completeBaseName() : info.fileName();
+        if (labels.contains(label)) label += QString("_%1").arg(k + 1);
+        labels << label;
+    }
+
+    // 每个数据源一个工作对象和采集线程，各自独立读取、解析和保存；主线程只负责统计输出和退出控制。
+    // 进入采集线程之前先直接设置帧格式等参数（此时还没有数据源），之后的调用都通过 invokeMethod
+    // 工作对象内含约1MB的界面帧队列，放在堆上；所有退出路径都先经 stopSources() 结束采集线程
+    std::vector<std::unique_ptr<QThread> > threadHolders;
+    std::vector<std::unique_ptr<AcquisitionWorker> > workerHolders;
+    QList<AcquisitionWorker *> workers;
+    QList<QThread *> threads;
+    QString error;
+    for (int k = 0; k < sourceCount && error.isEmpty(); ++k)
+    {
+        threadHolders.emplace_back(new QThread);
+        workerHolders.emplace_back(new AcquisitionWorker);
+        AcquisitionWorker *worker = workerHolders.back().get();
+        QThread *thread = threadHolders.back().get();
+        workers << worker;
+        threads << thread;
+        worker->setOverloadPolicy(policy);
+        worker->setHealthLimits(accelRange, gyroRange, stuckFrames);
+        worker->setSegmentPolicy(segmentMB, segmentSeconds);
+        worker->setSyncPolicy(syncIntervalMs, preallocateMB);
+        error = worker->setFrameFormat(imuCountValues[k]);
+        if (error.isEmpty())    error = worker->setExpectedRate(frameRate);
+        if (error.isEmpty())    error = worker->setDspConfig(lowpassHz, filterOrder, decimation, decimator, biasMode, biasSeconds);
+        if (error.isEmpty() && !calibrationFile.isEmpty())  error = worker->setCalibrationFile(calibrationFile);
+        if (error.isEmpty())    error = worker->setAttitudeFilter(parser.isSet(attitudeOption), attitudeGain);
+        worker->moveToThread(thread);
+        thread->start(QThread::HighPriority);
+    }
+
+    // 先打开数据源确定帧格式（回放 *.imu 时由文件头决定），再按该格式创建保存文件
+    for (int k = 0; k < sourceCount && error.isEmpty(); ++k)
+    {
+        AcquisitionWorker *worker = workers[k];
+        if (replaying)
+        {
+            error = invoke(worker, "startReplay", Q_ARG(QString, sources[k]),
+                           Q_ARG(double, parser.value(speedOption).toDouble()),
+                           Q_ARG(double, parser.value(corruptOption).toDouble()));
+        }
+        else
+        {
+            error = invoke(worker, "openPort", Q_ARG(QString, sources[k]), Q_ARG(int, baudRates[k]));
+            if (error.isEmpty() && parser.isSet(rawOption))
+            {
+                error = invoke(worker, "startRawCapture",
+                               Q_ARG(QString, sourceFileName(parser.value(rawOption), k, sourceCount)));
+            }
+        }
+        if (!error.isEmpty())   error = sources[k] + ": " + error;
+    }
+    if (!error.isEmpty())
+    {
+        err() << "启动失败: " << error << endl;
+        stopSources(workers, threads);
+        return 1;
+    }
+    QStringList fileNames;
+    for (int k = 0; k < sourceCount && !fileName.isEmpty(); ++k)
+    {
+        fileNames << sourceFileName(fileName, k, sourceCount);
+        error = invoke(workers[k], "startSaving", Q_ARG(QString, fileNames.last()), Q_ARG(int, format));
+        if (!error.isEmpty())
+        {
+            err() << "无法创建文件: " << error << endl;
+            stopSources(workers, threads);
+            return 1;
+        }
+    }
+
+    // 合并线程代替界面线程取用各工作对象的帧队列；帧格式在打开数据源后才确定
+    FrameMerger merger;
+    if (parser.isSet(mergeOption))
+    {
+        for (int k = 0; k < sourceCount; ++k)
+        {
+            merger.addInput(labels[k].toStdString(), workers[k]->frameQueue(), workers[k]->imuCount);
+        }
+        std::string mergeError;
+        if (!merger.start(parser.value(mergeOption).toUtf8().toStdString(),
+                          static_cast<int64_t>(toleranceMs * 1.0e6), FrameMerger::DEFAULT_MAX_LATENCY_NS, &mergeError))
+        {
+            err() << "无法创建合并文件: " << QString::fromStdString(mergeError) << endl;
+            stopSources(workers, threads);
+            return 1;
+        }
+    }
+
+    // 监控指标服务运行在独立线程中，只读取工作对象的原子计数器，不占用采集线程
+    QThread metricsThread;
+    MetricsServer metricsServer(nullptr);
+    for (int k = 0; k < sourceCount; ++k)
+    {
+        metricsServer.addWorker(workers[k], sourceCount > 1 ? labels[k] : QString());
+    }
+    if (parser.isSet(metricsOption))
+    {
+        const int metricsPort = parser.value(metricsOption).toInt();
+        metricsServer.moveToThread(&metricsThread);
+        metricsThread.start(QThread::LowPriority);
+        if (metricsPort <= 0 || metricsPort > 65535)    error = "无效的端口 " + parser.value(metricsOption);
+        else    QMetaObject::invokeMethod(&metricsServer, "listen", Qt::BlockingQueuedConnection,
+                                          Q_RETURN_ARG(QString, error), Q_ARG(int, metricsPort));
+        if (!error.isEmpty())
+        {
+            err() << "监控指标服务启动失败: " << error << endl;
+            metricsThread.quit();
+            metricsThread.wait();
+            stopSources(workers, threads);
+            merger.stop();
+            return 1;
+        }
+        out() << "监控指标: http://127.0.0.1:" << parser.value(metricsOption) << "/metrics" << endl;
+    }
+
+    for (int k = 0; k < sourceCount; ++k)
+    {
+        const AcquisitionWorker *worker = workers[k];
+        out() << (replaying ? "回放 " + sources[k] : QString("串口 %1 @ %2").arg(sources[k]).arg(baudRates[k]));
+        out() << QString(" (%1 IMU, 理论 %2 Hz, 统计内核 %3)").arg(worker->imuCount.load()).arg(frameRate)
+                 .arg(worker->statsKernelName());
+        if (!replaying) out() << "  [" << worker->serialTuningReport() << "]";
+        if (!fileNames.isEmpty())   out() << " -> " << fileNames[k] << (segmentMB > 0 || segmentSeconds > 0 ? "（分段）" : "");
+        if (worker->dspEnabled)
+        {
+            out() << "  信号处理: " << worker->dspDescription();
+            if (!fileNames.isEmpty())   out() << " -> " << QFileInfo(worker->dspRecordingFileName()).fileName();
+        }
+        if (!worker->attitudeDescription().isEmpty())
+        {
+            out() << "  " << QString(worker->attitudeDescription()).replace('\n', "  ");
+            if (!worker->calibratedRecordingFileName().isEmpty())
+                out() << " -> " << QFileInfo(worker->calibratedRecordingFileName()).fileName();
+            if (worker->attitudeEnabled && !fileNames.isEmpty())
+                out() << " -> " << QFileInfo(worker->attitudeRecordingFileName()).fileName();
+        }
+        out() << endl;
+    }
+    if (merger.isRunning())
+    {
+        out() << QString("合并 %1 个数据源 -> %2（容差 %3 ms）")
+                 .arg(sourceCount).arg(parser.value(mergeOption)).arg(toleranceMs, 0, 'f', 3) << endl;
+    }
+
+    int exitCode = 0;
+    int replaysRunning = replaying ? sourceCount : 0;
+    for (int k = 0; k < sourceCount; ++k)
+    {
+        const QString source = sources[k];
+        QObject::connect(workers[k], &AcquisitionWorker::portLost, &app, [&, source](const QString &message) {
+            err() << "串口断开: " << source << ": " << message << endl;
+            exitCode = 2;
+            app.quit();
+        });
+        QObject::connect(workers[k], &AcquisitionWorker::replayFinished, &app, [&, source](qint64 frames, double seconds) {
+            out() << QString("回放结束: %1  %2 帧, %3 秒, %4 帧/秒").arg(source)
+                     .arg(frames).arg(seconds, 0, 'f', 2).arg(seconds > 0 ? frames / seconds : 0.0, 0, 'f', 0) << endl;
+            if (--replaysRunning == 0)  app.quit();
+        });
+    }
+    if (durationSeconds > 0)
+    {
+        QTimer::singleShot(static_cast<int>(durationSeconds * 1000), &app, SLOT(quit()));
+    }
+
+    // Ctrl+C / kill：信号处理函数只置标志，由事件循环中的定时器负责正常退出
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    QElapsedTimer clock;
+    clock.start();
+    qint64 lastStatsMs = 0;
+    QVector<qint64> lastFrames(sourceCount, 0);
+    const quint64 maxSizeBytes = static_cast<quint64>(maxSizeMB * 1024 * 1024);
+
+    auto printStats = [&]() {
+        const qint64 nowMs = clock.elapsed();
+        for (int k = 0; k < sourceCount; ++k)
+        {
+            const AcquisitionWorker &worker = *workers[k];
+            const qint64 frames = worker.validFramesReceived;
+            const double rate = nowMs > lastStatsMs ? (frames - lastFrames[k]) * 1000.0 / (nowMs - lastStatsMs) : 0.0;
+            quint64 written = 0, queued = 0, writeDropped = 0;
+            worker.recordingStats(written, queued, writeDropped);
+            if (sourceCount > 1)    out() << "[" << labels[k] << "] ";
+            out() << QString("[%1s] 帧: %2 (%3 Hz)  无效帧: %4  丢弃字节: %5  丢弃帧: %6  积压: %7  "
+                             "已写盘: %8 KB  队列: %9 KB  磁盘过慢丢弃: %10  "
+                             "真实帧率: %11 Hz  时钟偏差: %12 ppm  到达抖动: %13 ms  最长间隔: %14 ms  失步: %15  "
+                             "饱和帧: %16  饱和IMU: %17  卡死IMU: %18")
+                     .arg(nowMs / 1000.0, 0, 'f', 1).arg(frames).arg(rate, 0, 'f', 1)
+                     .arg(qint64(worker.invalidFramesReceived)).arg(qint64(worker.droppedBytes))
+                     .arg(qint64(worker.droppedFrames)).arg(qint64(worker.backlogBytes))
+                     .arg(written / 1024).arg(queued / 1024).arg(writeDropped)
+                     .arg(double(worker.actualFrequency), 0, 'f', 3)
+                     .arg(double(worker.clockDriftPpm), 0, 'f', 1)
+                     .arg(double(worker.arrivalJitterMs), 0, 'f', 2)
+                     .arg(worker.pipeline.frameInterval.maximum() / 1.0e6, 0, 'f', 1)
+                     .arg(worker.pipeline.resyncEvents.load())
+                     .arg(qint64(worker.saturatedFrames))
+                     .arg(imuList(worker.saturatedImuMask))
+                     .arg(imuList(worker.stuckImuMask));
+            if (worker.dspEnabled)
+            {
+                out() << QString("  处理后帧: %1").arg(qint64(worker.dspFramesOut));
+                if (worker.dspBiasProgress < 1) out() << QString("（零偏估计 %1%）").arg(qRound(worker.dspBiasProgress * 100));
+            }
+            out() << endl;
+            lastFrames[k] = frames;
+        }
+        if (merger.inputCount() > 0)
+        {
+            out() << QString("[合并] 行: %1  完整: %2  已写盘: %3 KB")
+                     .arg(merger.rows.load()).arg(merger.completeRows.load()).arg(merger.fileBytes() / 1024);
+            for (int k = 0; k < merger.inputCount(); ++k)
+            {
+                const FrameMerger::PortStats &stats = merger.portStats(k);
+                out() << QString("  %1: 缺失 %2 迟到 %3 未入队 %4 时间差P99 %5 us")
+                         .arg(labels[k]).arg(stats.missingRows.load()).arg(stats.lateFrames.load())
+                         .arg(stats.gapFrames.load()).arg(stats.skew.percentile(99) / 1.0e3, 0, 'f', 0);
+            }
+            out() << endl;
+        }
+        lastStatsMs = nowMs;
+    };
+
+    QTimer housekeeping;
+    QObject::connect(&housekeeping, &QTimer::timeout, &app, [&]() {
+        // 没有合并时界面队列无人取用，清空以免每帧都计为跳过显示
+        if (!merger.isRunning())
+        {
+            ImuFrame frame;
+            foreach (AcquisitionWorker *worker, workers)
+            {
+                while (worker->frameQueue()->pop(frame)) {}
+            }
+        }
+
+        if (stopRequested)
+        {
+            out() << "收到停止信号" << endl;
+            app.quit();
+            return;
+        }
+        if (maxSizeBytes > 0)
+        {
+            quint64 total = 0;
+            foreach (const AcquisitionWorker *worker, workers)
+            {
+                quint64 written = 0, queued = 0, writeDropped = 0;
+                worker->recordingStats(written, queued, writeDropped);
+                total += written + queued;
+            }
+            if (total >= maxSizeBytes)
+            {
+                out() << "达到设定的文件大小" << endl;
+                app.quit();
+                return;
+            }
+        }
+        if (statsSeconds > 0 && clock.elapsed() - lastStatsMs >= statsSeconds * 1000)   printStats();
+    });
+    housekeeping.start(100);
+
+    app.exec();
+
+    // 写完排队数据后再退出；合并线程在各数据源停止后取完剩余的帧
+    if (metricsThread.isRunning())
+    {
+        QMetaObject::invokeMethod(&metricsServer, "close", Qt::BlockingQueuedConnection);
+        metricsThread.quit();
+        metricsThread.wait();
+    }
+    stopSources(workers, threads);
+    merger.stop();
+    printStats();
+    for (int k = 0; k < sourceCount && !fileNames.isEmpty(); ++k)
+    {
+        out() << "管线统计: " << workers[k]->statsReportFileName() << endl;
+    }
+    return exitCode;
+}
@@ -0,0 +1,187 @@
+// 离线转换程序：把保存的CSV或二进制记录转换为 NumPy .npy 列式文件，供 Python 分析直接 np.load
+// （多GB的CSV用 pandas 解析要几分钟，.npy 可以直接内存映射：np.load(f, mmap_mode='r')）。
+// 输入内存映射后按行对齐切块，由全部CPU核并行解析，输出按顺序流式写出，内存占用与文件大小无关。
+//
+// 构建：qmake CONFIG+=converter && make
+// 示例：IMUarray_SP_V2_convert IMU_Data_20260301_101500.csv        （每列一个 .npy，写入 IMU_Data_20260301_101500_npy/）
+//       IMUarray_SP_V2_convert --layout imu -o run1_npy run1.imuz   （每个IMU一个 (N, 6) 数组）
+//       IMUarray_SP_V2_convert --join -o day_npy day_001.imu day_002.imu day_003.imu   （分段记录拼接为一组）
+//
+// --analyze 改为噪声分析：对每个通道和均值计算重叠 Allan 偏差和 Welch 功率谱密度，
+// 写出 CSV 和 SVG 曲线图到 文件名_analysis/（同样多线程流式处理，内存占用与文件大小无关）。
+// 示例：IMUarray_SP_V2_convert --analyze --join -o static_analysis day_001.imu day_002.imu
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include "recordingconverter.h"
+#include "recordinganalyzer.h"
+#include "noiseanalysis.h"
+#include "imuframe.h"
+
+static QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+static QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+// 默认输出目录：与第一个输入同目录的 文件名_npy（噪声分析为 文件名_analysis）
+static QString defaultOutputDir(const QString &input, const char *suffix)
+{
+    const QFileInfo info(input);
+    return QDir(info.path()).filePath(info.completeBaseName() + suffix);
+}
+
+// 噪声分析一组输入并写出结果，打印均值各通道的噪声参数
+static bool analyzeGroup(RecordingAnalyzer &analyzer, const QStringList &group, const QString &outputDir)
+{
+    RecordingAnalyzer::Result result;
+    QString error;
+    QStringList files;
+    if (!analyzer.analyze(group, &result, &error) || !RecordingAnalyzer::writeResults(result, outputDir, &files, &error))
+    {
+        err() << group.first() << ": 分析失败: " << error << endl;
+        return false;
+    }
+    const double mb = result.inputBytes / (1024.0 * 1024.0);
+    out() << QString("%1 -> %2/  %3 行，τ0 = %4 ms，%5 个簇长，%6 段 FFT（%7 点），%8 秒，%9 MB/s（%10 线程）")
+             .arg(group.size() > 1 ? QString("%1 等 %2 个文件").arg(group.first()).arg(group.size()) : group.first(),
+                  outputDir)
+             .arg(result.rows).arg(result.sampleInterval * 1000, 0, 'f', 3)
+             .arg(result.tau.size()).arg(result.segments).arg(result.fftLength)
+             .arg(result.seconds, 0, 'f', 2)
+             .arg(result.seconds > 0 ? mb / result.seconds : 0.0, 0, 'f', 0)
+             .arg(result.threads)
+          << endl;
+    if (result.badLines > 0)    out() << "  跳过 " << result.badLines << " 行格式错误或损坏的数据" << endl;
+    if (result.gaps > 0)        out() << "  " << result.gaps << " 处缺口（约缺 " << result.missingFrames << " 帧，按连续数据计算）" << endl;
+    if (result.invalidValues > 0)   out() << "  " << result.invalidValues << " 个非有限值按前一个样本计入" << endl;
+    if (result.segments == 0)   out() << "  数据短于FFT长度，没有功率谱密度" << endl;
+    const int meanChannel = result.imuCount * DATA_PER_IMU;
+    for (int c = meanChannel; c < meanChannel + DATA_PER_IMU; ++c)
+    {
+        const RecordingAnalyzer::NoiseSummary summary = RecordingAnalyzer::summarize(result, c);
+        out() << QString("  %1  σ(1s) %2  最低 %3 @ %4 s  零偏不稳定性 %5")
+                 .arg(result.channels.at(c), -8).arg(summary.adevAt1s, 0, 'g', 4).arg(summary.minimumAdev, 0, 'g', 4)
+                 .arg(summary.minimumTau, 0, 'g', 4).arg(summary.biasInstability, 0, 'g', 4)
+              << endl;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("IMUarray_SP_V2_convert");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("把CSV或二进制记录（*.imu、*.imuz）转换为 NumPy .npy 列式文件，或做噪声分析");
+    parser.addHelpOption();
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                    "输出目录（默认为输入文件旁的 文件名_npy；多个输入且未 --join 时在该目录下按文件名分子目录）",
+                                    "dir");
+    QCommandLineOption layoutOption(QStringList() << "l" << "layout",
+                                    "输出布局：channels 每列一个一维数组；struct 一个结构化数组 data.npy；"
+                                    "imu 每个IMU一个 (N, 6) 数组（默认channels）", "layout", "channels");
+    QCommandLineOption threadsOption(QStringList() << "j" << "threads", "解析线程数（默认为CPU核数）", "count", "0");
+    QCommandLineOption chunkOption("chunk", QString("每块输入的大小（MB，默认%1）")
+                                   .arg(RecordingConverter::DEFAULT_CHUNK_BYTES / (1024 * 1024)), "MB",
+                                   QString::number(RecordingConverter::DEFAULT_CHUNK_BYTES / (1024 * 1024)));
+    QCommandLineOption joinOption("join", "把各输入文件按顺序拼接为一组输出（例如分段记录的各段）");
+    QCommandLineOption analyzeOption("analyze", "噪声分析：各通道的 Allan 偏差和 Welch 功率谱密度（CSV 和 SVG），"
+                                     "默认输出到 文件名_analysis");
+    QCommandLineOption fftOption("nfft", QString("噪声分析的 Welch 分段长度（样本数，2的幂，默认%1）")
+                                 .arg(WelchPsd::DEFAULT_LENGTH), "samples", QString::number(WelchPsd::DEFAULT_LENGTH));
+    parser.addOptions(QList<QCommandLineOption>() << outputOption << layoutOption << threadsOption
+                      << chunkOption << joinOption << analyzeOption << fftOption);
+    parser.addPositionalArgument("files", "CSV或二进制记录文件", "files...");
+    parser.process(app);
+
+    const QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty())
+    {
+        err() << "没有指定输入文件" << endl;
+        parser.showHelp(1);
+    }
+
+    RecordingConverter converter;
+    const QString layout = parser.value(layoutOption);
+    if (layout == "channels")       converter.setLayout(RecordingConverter::ChannelFiles);
+    else if (layout == "struct")    converter.setLayout(RecordingConverter::StructFile);
+    else if (layout == "imu")       converter.setLayout(RecordingConverter::ImuFiles);
+    else
+    {
+        err() << "未知的输出布局: " << layout << endl;
+        return 1;
+    }
+    converter.setThreadCount(parser.value(threadsOption).toInt());
+    const double chunkMB = parser.value(chunkOption).toDouble();
+    if (chunkMB > 0)    converter.setChunkBytes(static_cast<qint64>(chunkMB * 1024 * 1024));
+
+    const bool analyzing = parser.isSet(analyzeOption);
+    RecordingAnalyzer analyzer;
+    analyzer.setThreadCount(parser.value(threadsOption).toInt());
+    if (chunkMB > 0)    analyzer.setChunkBytes(static_cast<qint64>(chunkMB * 1024 * 1024));
+    const int fftLength = parser.value(fftOption).toInt();
+    if (!RecordingAnalyzer::isValidFftLength(fftLength))
+    {
+        err() << "无效的FFT长度（须为 16 ~ 2^24 之间的2的幂）: " << parser.value(fftOption) << endl;
+        return 1;
+    }
+    analyzer.setFftLength(fftLength);
+
+    // 每组输入一个输出目录
+    QList<QStringList> groups;
+    if (parser.isSet(joinOption))
+    {
+        groups << inputs;
+    }
+    else
+    {
+        foreach (const QString &input, inputs)  groups << QStringList(input);
+    }
+
+    int failures = 0;
+    foreach (const QStringList &group, groups)
+    {
+        QString outputDir = defaultOutputDir(group.first(), analyzing ? "_analysis" : "_npy");
+        if (parser.isSet(outputOption))
+        {
+            outputDir = parser.value(outputOption);
+            if (groups.size() > 1)  outputDir = QDir(outputDir).filePath(QFileInfo(group.first()).completeBaseName());
+        }
+        if (analyzing)
+        {
+            if (!analyzeGroup(analyzer, group, outputDir))  ++failures;
+            continue;
+        }
+
+        RecordingConverter::Result result;
+        QString error;
+        if (!converter.convert(group, outputDir, &result, &error))
+        {
+            err() << group.first() << ": 转换失败: " << error << endl;
+            ++failures;
+            continue;
+        }
+        const double mb = result.inputBytes / (1024.0 * 1024.0);
+        out() << QString("%1 -> %2/  %3 行，%4 个文件，%5 MB -> %6 MB，%7 秒，%8 MB/s（%9 线程）")
+                 .arg(group.size() > 1 ? QString("%1 等 %2 个文件").arg(group.first()).arg(group.size()) : group.first(),
+                      outputDir)
+                 .arg(result.rows).arg(result.files.size())
+                 .arg(mb, 0, 'f', 1).arg(result.outputBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                 .arg(result.seconds, 0, 'f', 2)
+                 .arg(result.seconds > 0 ? mb / result.seconds : 0.0, 0, 'f', 0)
+                 .arg(result.threads)
+              << endl;
+        if (result.badLines > 0)    out() << "  跳过 " << result.badLines << " 行格式错误或损坏的数据" << endl;
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,104 @@
+#include "csvencoder.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static_assert(sizeof(IMUData) == DATA_PER_IMU * sizeof(float),
+              "IMUData must be densely packed floats");
+
+// 无符号整数转十进制，从右向左写入 end 之前，返回起始位置
+static char *writeDigits(uint64_t value, char *end)
+{
+    do
+    {
+        *--end = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    return end;
+}
+
+std::size_t CsvEncoder::formatInt(int64_t value, char *out)
+{
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    char *begin = writeDigits(magnitude, end);
+    if (value < 0)  *--begin = '-';
+    const std::size_t n = static_cast<std::size_t>(end - begin);
+    memcpy(out, begin, n);
+    return n;
+}
+
+std::size_t CsvEncoder::formatFixed6(float value, char *out)
+{
+    // 与 QString::number(v, 'f', 6) 保持一致的特殊值写法
+    if (std::isnan(value))
+    {
+        memcpy(out, "nan", 3);
+        return 3;
+    }
+    if (std::isinf(value))
+    {
+        if (value < 0)
+        {
+            memcpy(out, "-inf", 4);
+            return 4;
+        }
+        memcpy(out, "inf", 3);
+        return 3;
+    }
+
+    const double magnitude = std::fabs(static_cast<double>(value));
+    if (magnitude >= 9.0e12)
+    {
+        // 超出定点整数范围的极大值（传感器数据中不会出现），交给 snprintf
+        int n = snprintf(out, MAX_FIELD_SIZE, "%.6f", static_cast<double>(value));
+        return n > 0 ? static_cast<std::size_t>(n) : 0;
+    }
+
+    // float 只有24位有效位，乘以1e6（20位）在 double 中是精确的，
+    // 因此四舍五入到整数即得到正确的6位小数；恰好在中点时远离零舍入，
+    // 与Qt（double-conversion）一致，而不是 printf 的银行家舍入
+    const uint64_t scaled = static_cast<uint64_t>(std::llround(magnitude * 1.0e6));
+    const uint64_t intPart = scaled / 1000000;
+    uint64_t fracPart = scaled % 1000000;
+
+    char *p = out;
+    if (value < 0)  *p++ = '-';  // 与Qt一致：-0.0 不输出负号，舍入为0的负数保留负号
+
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    char *begin = writeDigits(intPart, end);
+    memcpy(p, begin, static_cast<std::size_t>(end - begin));
+    p += end - begin;
+
+    *p++ = '.';
+    for (int i = 5; i >= 0; --i)
+    {
+        p[i] = static_cast<char>('0' + fracPart % 10);
+        fracPart /= 10;
+    }
+    p += 6;
+    return static_cast<std::size_t>(p - out);
+}
+
+std::size_t CsvEncoder::encodeLine(int64_t timestampMs, const float *values, int count, char *out)
+{
+    char *p = out;
+    p += formatInt(timestampMs, p);
+    for (int i = 0; i < count; ++i)
+    {
+        *p++ = ',';
+        p += formatFixed6(values[i], p);
+    }
+    *p++ = '\n';
+    return static_cast<std::size_t>(p - out);
+}
+
+void CsvEncoder::appendLine(std::vector<char> &buffer, int64_t timestampMs, const float *values, int count)
+{
+    const std::size_t old = buffer.size();
+    buffer.resize(old + MAX_LINE_SIZE);
+    const std::size_t n = encodeLine(timestampMs, values, count, buffer.data() + old);
+    buffer.resize(old + n);
+}
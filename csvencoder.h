@@ -0,0 +1,40 @@
+#ifndef CSVENCODER_H
+#define CSVENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "imuframe.h"
+
+// CSV 行编码器：把时间戳和 imuCount * DATA_PER_IMU 个 float 直接写成字节，
+// 输出与 QString::arg(v, 0, 'f', 6) 逐行一致，但不创建 QString、不经过 QTextStream，
+// 也不分配内存（写入调用方提供的可复用缓冲区）。
+class CsvEncoder
+{
+public:
+    // 单个数值的最大长度（含符号、小数点和6位小数）
+    static const std::size_t MAX_FIELD_SIZE = 48;
+    // 一行的最大长度（按 MAX_IMU_COUNT）：时间戳 + 每个数值前的逗号 + 换行
+    static const std::size_t MAX_LINE_SIZE = 24 + (MAX_FIELD_SIZE + 1) * MAX_IMU_COUNT * DATA_PER_IMU + 1;
+
+    // 定点6位小数格式化，返回写入的字节数（out 至少 MAX_FIELD_SIZE 字节）
+    static std::size_t formatFixed6(float value, char *out);
+    // 十进制整数格式化，返回写入的字节数（out 至少 24 字节）
+    static std::size_t formatInt(int64_t value, char *out);
+
+    // 编码一行 "timestamp,v1,...,vN\n"（9 IMU 时 N = 54），返回写入的字节数（out 至少 MAX_LINE_SIZE 字节）
+    static std::size_t encodeLine(int64_t timestampMs, const float *values, int count, char *out);
+    static std::size_t encodeFrame(int64_t timestampMs, const IMUData *imu, int imuCount, char *out)
+    {
+        return encodeLine(timestampMs, &imu[0].accel[0], imuCount * DATA_PER_IMU, out);
+    }
+
+    // 把一行追加到可复用缓冲区末尾（容量足够时不分配内存）
+    static void appendLine(std::vector<char> &buffer, int64_t timestampMs, const float *values, int count);
+    static void appendFrame(std::vector<char> &buffer, int64_t timestampMs, const IMUData *imu, int imuCount)
+    {
+        appendLine(buffer, timestampMs, &imu[0].accel[0], imuCount * DATA_PER_IMU);
+    }
+};
+
+#endif // CSVENCODER_H
@@ -0,0 +1,154 @@
+#include "csvparser.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// 10 的整数次幂（直到 1e22 在 double 中都是精确的）
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isDigit(char c)
+{
+    return static_cast<unsigned>(c - '0') < 10;
+}
+
+// 忽略大小写比较 ASCII 前缀（word 为小写）
+static bool startsWith(const char *p, const char *end, const char *word)
+{
+    const std::size_t n = strlen(word);
+    if (static_cast<std::size_t>(end - p) < n)  return false;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if ((p[i] | 0x20) != word[i])   return false;
+    }
+    return true;
+}
+
+const char *CsvParser::parseInt(const char *p, const char *end, int64_t &value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+    const char *digits = p;
+    uint64_t magnitude = 0;
+    while (p < end && isDigit(*p))
+    {
+        magnitude = magnitude * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    if (p == digits || p - digits > 18) return nullptr;
+    value = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+    return p;
+}
+
+const char *CsvParser::parseFloat(const char *p, const char *end, float &value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+    if (startsWith(p, end, "nan"))
+    {
+        value = std::numeric_limits<float>::quiet_NaN();
+        return p + 3;
+    }
+    if (startsWith(p, end, "inf"))
+    {
+        value = negative ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+        return startsWith(p, end, "infinity") ? p + 8 : p + 3;
+    }
+
+    uint64_t mantissa = 0;
+    int significant = 0;                // mantissa 中的有效数字位数
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && isDigit(*p); ++p)
+    {
+        any = true;
+        if (significant < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            if (mantissa)   ++significant;
+        }
+        else
+        {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && isDigit(*p); ++p)
+        {
+            any = true;
+            if (significant < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                if (mantissa)   ++significant;
+                --exponent;
+            }
+        }
+    }
+    if (!any)   return nullptr;
+    if (p < end && (*p | 0x20) == 'e')
+    {
+        int64_t e = 0;
+        p = parseInt(p + 1, end, e);
+        if (!p) return nullptr;
+        exponent += static_cast<int>(std::max<int64_t>(-400, std::min<int64_t>(400, e)));
+    }
+
+    double magnitude = static_cast<double>(mantissa);
+    if (exponent < 0)
+        magnitude = -exponent <= 22 ? magnitude / POW10[-exponent] : magnitude / std::pow(10.0, -exponent);
+    else if (exponent > 0)
+        magnitude = exponent <= 22 ? magnitude * POW10[exponent] : magnitude * std::pow(10.0, exponent);
+    value = static_cast<float>(negative ? -magnitude : magnitude);
+    return p;
+}
+
+bool CsvParser::parseLine(const char *p, const char *end, int count, int64_t &timestampMs, float *values)
+{
+    p = parseInt(p, end, timestampMs);
+    if (!p) return false;
+    for (int i = 0; i < count; ++i)
+    {
+        if (p == end || *p != ',')  return false;
+        p = parseFloat(p + 1, end, values[i]);
+        if (!p) return false;
+    }
+    return p == end;
+}
+
+const char *CsvParser::findData(const char *begin, const char *end)
+{
+    const char *p = begin;
+    while (p < end)
+    {
+        const char c = *p;
+        if (isDigit(c) || c == '-' || c == '+' || c == '.')  break;
+        p = nextLine(p, end);
+    }
+    return p;
+}
+
+const char *CsvParser::findLastLine(const char *begin, const char *end)
+{
+    // 跳过末尾的换行符和空行，再向前找到该行的开头
+    const char *last = end;
+    while (last > begin && (last[-1] == '\n' || last[-1] == '\r'))  --last;
+    if (last == begin)  return end;
+    while (last > begin && last[-1] != '\n')    --last;
+    return last;
+}
+
+int CsvParser::valueCount(const char *line, const char *end)
+{
+    return static_cast<int>(std::count(line, nextLine(line, end), ','));
+}
@@ -0,0 +1,73 @@
+#include "csvrecorder.h"
+#include "csvencoder.h"
+
+// 缓冲区达到该大小时提前交给写盘线程
+static const std::size_t SUBMIT_BYTES = 32 * 1024;
+
+CsvRecorder::CsvRecorder(Columns columns) :
+    content(columns),
+    buffer(nullptr),
+    oldestNs(0)
+{
+}
+
+CsvRecorder::~CsvRecorder()
+{
+    close();
+}
+
+bool CsvRecorder::open(const QString &fileName, const AsyncFileWriter::Policy &policy,
+                       const RecordingSegments::Limits &segmentLimits, QString *errorString)
+{
+    close();
+
+    segments.start(fileName.toUtf8().toStdString(), segmentLimits);
+    std::string error;
+    if (!dataWriter.open(segments.currentFileName(), policy, &error))
+    {
+        if (errorString)    *errorString = QString::fromStdString(error);
+        return false;
+    }
+    buffer = dataWriter.acquireBuffer();
+    oldestNs = 0;
+    return true;
+}
+
+void CsvRecorder::write(const ImuFrame &frame)
+{
+    if (!buffer)    return;
+
+    // 当前段已满：已编码的行交给写盘线程后切换文件
+    if (segments.full(frame.monotonicNs))
+    {
+        submitPending();
+        dataWriter.rollover(nullptr, segments.next());
+    }
+
+    // CSV行：时间戳 + 各IMU的数据（每个IMU 6个值）或姿态（每个IMU 4个值），直接编码到可复用缓冲区
+    if (buffer->empty())    oldestNs = frame.arrivalNs;
+    const std::size_t lineStart = buffer->size();
+    if (content == OrientationColumns)
+        CsvEncoder::appendLine(*buffer, frame.timestampMs, &frame.orientation[0][0], frame.imuCount * 4);
+    else
+        CsvEncoder::appendFrame(*buffer, frame.timestampMs, frame.imu, frame.imuCount);
+    segments.add(frame.sequence, frame.monotonicNs, buffer->size() - lineStart);
+    if (buffer->size() >= SUBMIT_BYTES) submitPending();
+}
+
+void CsvRecorder::submitPending()
+{
+    if (!buffer || buffer->empty()) return;
+    dataWriter.submit(buffer, oldestNs);
+    buffer = dataWriter.acquireBuffer();
+    oldestNs = 0;
+}
+
+void CsvRecorder::close()
+{
+    if (!buffer)    return;
+    // 提交剩余数据（空缓冲区还给对象池），close() 等待写盘线程全部写完
+    dataWriter.submit(buffer, oldestNs);
+    buffer = nullptr;
+    dataWriter.close();
+}
@@ -0,0 +1,47 @@
+#ifndef CSVRECORDER_H
+#define CSVRECORDER_H
+
+#include <QString>
+#include "imuframe.h"
+#include "asyncfilewriter.h"
+#include "recordingsegments.h"
+
+// CSV 记录器：每帧编码为一行（CsvEncoder）写入可复用缓冲区，交给后台写盘线程。
+// 可按大小或时长分段（RecordingSegments），CSV 没有文件头和文件尾，分段时直接切换文件。
+// 接口与 BinaryRecorder 相同，只在采集线程中使用。
+class CsvRecorder
+{
+public:
+    // 每行时间戳之后的数据
+    enum Columns {
+        ImuColumns = 0,         // 各IMU的 accel、gyro（每个IMU 6个值）
+        OrientationColumns      // 各IMU的姿态四元数 w、x、y、z（每个IMU 4个值）
+    };
+
+    explicit CsvRecorder(Columns columns = ImuColumns);
+    ~CsvRecorder();
+
+    // segmentLimits: 分段条件，不分段时只写 fileName 一个文件
+    bool open(const QString &fileName, const AsyncFileWriter::Policy &policy,
+              const RecordingSegments::Limits &segmentLimits, QString *errorString);
+    void write(const ImuFrame &frame);
+    // 把已编码的数据交给写盘线程（每批解析结束时调用）
+    void submitPending();
+    // 提交剩余数据并关闭（等待写盘线程写完）
+    void close();
+    bool isOpen() const { return buffer != nullptr; }
+
+    int segmentIndex() const { return segments.index(); }
+    const AsyncFileWriter &writer() const { return dataWriter; }
+    // 写盘延迟（读出 → 写入文件）记入该直方图
+    void setLatencyHistogram(LatencyHistogram *histogram) { dataWriter.setLatencyHistogram(histogram); }
+
+private:
+    Columns content;
+    AsyncFileWriter dataWriter;
+    RecordingSegments segments;
+    AsyncFileWriter::Buffer *buffer;    // 当前正在填充的缓冲区
+    int64_t oldestNs;                   // buffer 中最早一帧的到达时刻
+};
+
+#endif // CSVRECORDER_H
@@ -0,0 +1,184 @@
+#include "displayformatter.h"
+#include "attitudefilter.h"
+#include <QtMath>
+
+QString DisplayFormatter::frameLine(const ImuFrame &frame)
+{
+    QString frameData;
+    for (int idx = 0; idx < frame.imuCount; ++idx)
+    {
+        frameData += QString("IMU%1:%2,%3,%4,%5,%6,%7;")
+                    .arg(idx + 1)
+                    .arg(frame.imu[idx].accel[0], 0, 'f', 4)
+                    .arg(frame.imu[idx].accel[1], 0, 'f', 4)
+                    .arg(frame.imu[idx].accel[2], 0, 'f', 4)
+                    .arg(frame.imu[idx].gyro[0], 0, 'f', 4)
+                    .arg(frame.imu[idx].gyro[1], 0, 'f', 4)
+                    .arg(frame.imu[idx].gyro[2], 0, 'f', 4);
+    }
+    return frameData;
+}
+
+QString DisplayFormatter::meanLine(const ImuFrame &frame)
+{
+    return QString("Mean:%1,%2,%3,%4,%5,%6")
+            .arg(frame.meanAccel[0], 0, 'f', 4)
+            .arg(frame.meanAccel[1], 0, 'f', 4)
+            .arg(frame.meanAccel[2], 0, 'f', 4)
+            .arg(frame.meanGyro[0], 0, 'f', 4)
+            .arg(frame.meanGyro[1], 0, 'f', 4)
+            .arg(frame.meanGyro[2], 0, 'f', 4);
+}
+
+// 直方图一行：P50 / P99 / P99.9 / 最大（毫秒）
+static QString histogramLine(const QString &name, const LatencyHistogram &histogram)
+{
+    if (histogram.count() == 0) return QString("  %1  无数据\n").arg(name);
+    return QString("  %1  P50 %2  P99 %3  P99.9 %4  最大 %5\n").arg(name)
+            .arg(histogram.percentile(50) / 1.0e6, 0, 'f', 2)
+            .arg(histogram.percentile(99) / 1.0e6, 0, 'f', 2)
+            .arg(histogram.percentile(99.9) / 1.0e6, 0, 'f', 2)
+            .arg(histogram.maximum() / 1.0e6, 0, 'f', 2);
+}
+
+QString DisplayFormatter::pipelineText(const PipelineStats &pipeline, qint64 nowNs)
+{
+    QString text;
+    text += QString("=== 管线统计（毫秒） ===\n");
+    text += QString("滑动帧率: 1秒 %1 Hz  10秒 %2 Hz  失步: %3 次\n")
+            .arg(pipeline.rate1s.rate(nowNs), 0, 'f', 1)
+            .arg(pipeline.rate10s.rate(nowNs), 0, 'f', 1)
+            .arg(pipeline.resyncEvents.load());
+    text += histogramLine("帧到达间隔", pipeline.frameInterval);
+    text += histogramLine("读出→解析", pipeline.decodeLatency);
+    text += histogramLine("读出→写盘", pipeline.writeLatency);
+    text += histogramLine("读出→绘制", pipeline.drawLatency);
+    if (pipeline.dspCost.count() > 0)
+    {
+        text += QString("  信号处理  每块每通道 P50 %1 ns  P99 %2 ns  最大 %3 ns\n")
+                .arg(pipeline.dspCost.percentile(50)).arg(pipeline.dspCost.percentile(99))
+                .arg(pipeline.dspCost.maximum());
+    }
+    if (pipeline.attitudeCost.count() > 0)
+    {
+        text += QString("  姿态解算  每帧 P50 %1 ns  P99 %2 ns  最大 %3 ns\n")
+                .arg(pipeline.attitudeCost.percentile(50)).arg(pipeline.attitudeCost.percentile(99))
+                .arg(pipeline.attitudeCost.maximum());
+    }
+    text += QString("队列峰值: 界面 %1 帧  写盘 %2 KB  接收积压 %3 字节\n\n")
+            .arg(pipeline.frameQueuePeak.load())
+            .arg(pipeline.writeQueuePeak.load() / 1024)
+            .arg(pipeline.backlogPeak.load());
+    return text;
+}
+
+QString DisplayFormatter::statusText(const DisplayStats &stats, const ImuFrame &frame)
+{
+    const IMUData *imuData = frame.imu;
+    QString displayText;
+
+    displayText += QString("=== 接收统计 ===\n");
+    displayText += QString("总字节数: %1  有效帧: %2  无效帧: %3\n")
+            .arg(stats.totalBytesReceived).arg(stats.validFramesReceived).arg(stats.invalidFramesReceived);
+    displayText += QString("丢弃字节: %1  丢弃帧(未保存): %2  跳过显示帧: %3  积压: %4字节\n")
+            .arg(stats.droppedBytes).arg(stats.droppedFrames).arg(stats.displaySkippedFrames).arg(stats.backlogBytes);
+    if (stats.saving)
+    {
+        displayText += QString("已写盘: %1 KB  写盘队列: %2 KB  磁盘过慢丢弃: %3 字节\n")
+                .arg(stats.bytesWritten / 1024).arg(stats.writeQueued / 1024).arg(stats.writeDropped);
+    }
+    if (stats.dspText)
+    {
+        // 显示的是处理后的数据
+        displayText += QString("信号处理: %1  输出: %2 帧").arg(*stats.dspText).arg(stats.dspFramesOut);
+        if (stats.dspBiasProgress < 1)
+        {
+            displayText += QString("  零偏估计中 %1%（请保持静止）").arg(qRound(stats.dspBiasProgress * 100));
+        }
+        displayText += "\n";
+    }
+    if (stats.attitudeText) displayText += *stats.attitudeText + "\n";
+    // 确保 actualFrequency 有有效值
+    if (stats.actualFrequency <= 0 || qIsNaN(stats.actualFrequency))
+    {
+        displayText += QString("实际频率: 计算中... (理论%1Hz)\n\n").arg(stats.expectedRate, 0, 'g', 6);
+    }
+    else
+    {
+        displayText += QString("实际频率: %1 Hz (理论%2Hz)  时钟偏差: %3 ppm  到达抖动: %4 ms\n\n")
+                        .arg(stats.actualFrequency, 0, 'f', 3)  // 明确指定格式
+                        .arg(stats.expectedRate, 0, 'g', 6)
+                        .arg(stats.clockDriftPpm, 0, 'f', 1)
+                        .arg(stats.arrivalJitterMs, 0, 'f', 2);
+    }
+    if (stats.pipeline) displayText += pipelineText(*stats.pipeline, stats.nowNs);
+    displayText += arrayText(frame, stats.saturatedFrames);
+
+    for (int i = 0; i < frame.imuCount; ++i)
+    {
+        displayText += QString("【IMU %1】").arg(i + 1);
+        if (frame.saturatedMask & (1u << i))    displayText += " 饱和";
+        if (frame.stuckMask & (1u << i))        displayText += " 卡死";
+        displayText += "\n";
+        displayText += QString("  Accel(g):  X=%1  Y=%2  Z=%3\n")
+                    .arg(imuData[i].accel[0], 8, 'f', 4)
+                    .arg(imuData[i].accel[1], 8, 'f', 4)
+                    .arg(imuData[i].accel[2], 8, 'f', 4);
+        displayText += QString("  Gyro(dps): X=%1  Y=%2  Z=%3\n")
+                    .arg(imuData[i].gyro[0], 8, 'f', 4)
+                    .arg(imuData[i].gyro[1], 8, 'f', 4)
+                    .arg(imuData[i].gyro[2], 8, 'f', 4);
+        if (stats.attitudeEnabled)
+        {
+            float euler[3];
+            AttitudeFilter::toEuler(frame.orientation[i], euler);
+            displayText += QString("  姿态(度):  横滚=%1  俯仰=%2  航向=%3\n")
+                        .arg(euler[0], 8, 'f', 2).arg(euler[1], 8, 'f', 2).arg(euler[2], 8, 'f', 2);
+        }
+        displayText += "\n";
+    }
+    return displayText;
+}
+
+// IMU位掩码 → "1, 5, 9"（IMU编号从1起），没有时为 "无"
+static QString imuList(uint32_t mask, int imuCount)
+{
+    QString text;
+    for (int i = 0; i < imuCount; ++i)
+    {
+        if (!(mask & (1u << i)))    continue;
+        if (!text.isEmpty())    text += ", ";
+        text += QString::number(i + 1);
+    }
+    return text.isEmpty() ? QString("无") : text;
+}
+
+QString DisplayFormatter::arrayText(const ImuFrame &frame, qint64 saturatedFrames)
+{
+    static const char *CHANNEL_NAMES[DATA_PER_IMU] = {
+        "Accel X", "Accel Y", "Accel Z", "Gyro X ", "Gyro Y ", "Gyro Z "
+    };
+    const float means[DATA_PER_IMU] = {
+        frame.meanAccel[0], frame.meanAccel[1], frame.meanAccel[2],
+        frame.meanGyro[0], frame.meanGyro[1], frame.meanGyro[2]
+    };
+    const CrossImuStats &spread = frame.spread;
+
+    QString text;
+    text += QString("=== 跨IMU统计 ===\n");
+    text += QString("           均值    稳健均值      标准差        最小        最大\n");
+    for (int c = 0; c < DATA_PER_IMU; ++c)
+    {
+        text += QString("  %1 %2 %3 %4 %5 %6\n").arg(CHANNEL_NAMES[c])
+                .arg(means[c], 10, 'f', 4)
+                .arg(spread.robustMean[c], 11, 'f', 4)
+                .arg(spread.stdDev[c], 11, 'f', 4)
+                .arg(spread.minimum[c], 11, 'f', 4)
+                .arg(spread.maximum[c], 11, 'f', 4);
+    }
+    text += QString("饱和IMU: %1（累计 %2 帧）  卡死IMU: %3\n\n")
+            .arg(imuList(frame.saturatedMask, frame.imuCount))
+            .arg(saturatedFrames)
+            .arg(imuList(frame.stuckMask, frame.imuCount));
+    return text;
+}
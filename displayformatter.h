@@ -0,0 +1,52 @@
+#ifndef DISPLAYFORMATTER_H
+#define DISPLAYFORMATTER_H
+
+#include <QString>
+#include "imuframe.h"
+#include "pipelinestats.h"
+
+// 界面显示用的统计快照（由界面线程从采集线程的原子计数器读取）
+struct DisplayStats
+{
+    qint64 totalBytesReceived;
+    qint64 validFramesReceived;
+    qint64 invalidFramesReceived;
+    float actualFrequency;            // 帧时钟模型估计的真实帧率，<= 0 表示尚未收敛
+    float expectedRate;               // 理论帧率（设置值）
+    float clockDriftPpm;              // 设备时钟相对理论帧率的偏差
+    float arrivalJitterMs;            // 到达时刻抖动（均方根）
+    qint64 droppedBytes;
+    qint64 droppedFrames;
+    qint64 displaySkippedFrames;
+    qint64 backlogBytes;
+    qint64 saturatedFrames;           // 有IMU饱和的帧数
+    bool saving;                      // 是否正在保存（决定是否显示写盘统计）
+    quint64 bytesWritten;
+    quint64 writeQueued;
+    quint64 writeDropped;
+    const PipelineStats *pipeline;    // 管线统计，nullptr 时不显示
+    const QString *dspText;           // 实时信号处理的配置描述，nullptr 为未启用
+    float dspBiasProgress;            // 零偏估计进度（0~1）
+    qint64 dspFramesOut;              // 处理后输出的帧数
+    const QString *attitudeText;      // 标定和姿态解算的描述，nullptr 为均未启用
+    bool attitudeEnabled;             // 帧中带有各IMU的姿态（显示欧拉角）
+    qint64 nowNs;                     // 当前单调时钟（滑动窗口帧率以此为终点）
+};
+
+// 界面文本格式化：从 MainWindow 中独立出来，便于基准测试单独测量
+class DisplayFormatter
+{
+public:
+    // 原始数据区的一行：所有IMU的全部数据（只在该行可见并绘制时调用）
+    static QString frameLine(const ImuFrame &frame);
+    // 均值区：6个均值
+    static QString meanLine(const ImuFrame &frame);
+    // 统计面板：接收统计 + 跨IMU统计 + 每个IMU的最新数据
+    static QString statusText(const DisplayStats &stats, const ImuFrame &frame);
+    // 管线统计：滑动帧率、帧间隔和各阶段延迟的分位数、失步次数、队列峰值
+    static QString pipelineText(const PipelineStats &pipeline, qint64 nowNs);
+    // 跨IMU统计：各通道的均值、稳健均值、标准差、极值，以及饱和/卡死的IMU
+    static QString arrayText(const ImuFrame &frame, qint64 saturatedFrames);
+};
+
+#endif // DISPLAYFORMATTER_H
@@ -0,0 +1,434 @@
+#include "dspstage.h"
+#include "pipelinestats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#ifdef IMU_HAVE_SSE2_KERNEL
+#include <emmintrin.h>
+#endif
+
+static_assert(sizeof(IMUData) == DATA_PER_IMU * sizeof(float), "IMUData is read as a flat float array");
+static_assert(DspStage::MAX_CHANNELS % 4 == 0, "rows are processed four channels at a time");
+
+// CIC 输入限幅：定点化后不超过 2^31，D^N 不超过 2^31 时输出不会溢出 int64
+static const float CIC_INPUT_LIMIT = 2047.0f;
+static const double CIC_MAX_GAIN = 2147483648.0;
+static const double PI = 3.14159265358979323846;   // MSVC 默认没有 M_PI
+
+// ---------------------------------------------------------------------------
+// 内核：转置直接II型，y = b0·x + s1；s1 = b1·x - a1·y + s2；s2 = b2·x - a2·y。
+// 外层按帧递推，内层按通道（状态在内存中，各通道互不依赖，流水线不会因递推停顿）。
+// 两个内核的运算顺序相同，结果逐位一致。
+// ---------------------------------------------------------------------------
+
+void biquadScalar(float *rows, int frames, int channels, const BiquadSection &section, float *state1, float *state2)
+{
+    for (int f = 0; f < frames; ++f)
+    {
+        float *row = rows + f * DspStage::MAX_CHANNELS;
+        for (int c = 0; c < channels; ++c)
+        {
+            const float x = row[c];
+            const float y = section.b0 * x + state1[c];
+            state1[c] = section.b1 * x - section.a1 * y + state2[c];
+            state2[c] = section.b2 * x - section.a2 * y;
+            row[c] = y;
+        }
+    }
+}
+
+#ifdef IMU_HAVE_SSE2_KERNEL
+void biquadSse2(float *rows, int frames, int channels, const BiquadSection &section, float *state1, float *state2)
+{
+    const __m128 b0 = _mm_set1_ps(section.b0);
+    const __m128 b1 = _mm_set1_ps(section.b1);
+    const __m128 b2 = _mm_set1_ps(section.b2);
+    const __m128 a1 = _mm_set1_ps(section.a1);
+    const __m128 a2 = _mm_set1_ps(section.a2);
+    for (int f = 0; f < frames; ++f)
+    {
+        float *row = rows + f * DspStage::MAX_CHANNELS;
+        for (int c = 0; c < channels; c += 4)
+        {
+            const __m128 x = _mm_load_ps(row + c);
+            const __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), _mm_load_ps(state1 + c));
+            _mm_store_ps(state1 + c, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), _mm_load_ps(state2 + c)));
+            _mm_store_ps(state2 + c, _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y)));
+            _mm_store_ps(row + c, y);
+        }
+    }
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// DspStage
+// ---------------------------------------------------------------------------
+
+DspStage::DspStage() :
+    sectionCount(0),
+    active(ScalarKernel),
+    run(&biquadScalar),
+    costHistogram(nullptr),
+    stateImuCount(DEFAULT_IMU_COUNT),
+    channels(DEFAULT_IMU_COUNT * DATA_PER_IMU),
+    paddedChannels(DEFAULT_IMU_COUNT * DATA_PER_IMU),
+    biasRemaining(0),
+    biasFrames(0),
+    filterPrimed(false),
+    phase(0),
+    groupSaturated(0),
+    cicWarmup(0),
+    cicScale(1.0)
+{
+    settings = defaultConfig(100.0);
+    setKernel(AutoKernel);
+    reset();
+}
+
+DspStage::Config DspStage::defaultConfig(double sampleRate)
+{
+    Config config;
+    config.sampleRate = sampleRate;
+    config.cutoffHz = 0;
+    config.filterOrder = 4;
+    config.decimation = 1;
+    config.decimator = MovingAverage;
+    config.cicStages = 3;
+    config.biasMode = NoBias;
+    config.biasSeconds = 2.0;
+    return config;
+}
+
+bool DspStage::configure(const Config &config, std::string *errorString)
+{
+    std::string error;
+    char text[160];
+    if (!(config.sampleRate > 0))
+    {
+        error = "帧率须大于0";
+    }
+    else if (config.cutoffHz < 0 || (config.cutoffHz > 0 &&
+             (config.cutoffHz > 0.45 * config.sampleRate || config.cutoffHz < config.sampleRate / 2000.0)))
+    {
+        // 截止频率过低时 float 系数的极点精度不够
+        std::snprintf(text, sizeof(text), "低通截止频率须在 %.3g ~ %.3g Hz 之间（帧率 %.6g Hz）",
+                      config.sampleRate / 2000.0, 0.45 * config.sampleRate, config.sampleRate);
+        error = text;
+    }
+    else if (config.cutoffHz > 0 && (config.filterOrder < 2 || config.filterOrder > 2 * MAX_SECTIONS
+                                     || config.filterOrder % 2 != 0))
+    {
+        std::snprintf(text, sizeof(text), "滤波器阶数须为 2 ~ %d 之间的偶数", 2 * MAX_SECTIONS);
+        error = text;
+    }
+    else if (config.decimation < 1 || config.decimation > 10000)
+    {
+        error = "抽取倍数须在 1 ~ 10000 之间";
+    }
+    else if (config.decimator == CicDecimator && config.decimation > 1 &&
+             (config.cicStages < 1 || config.cicStages > MAX_CIC_STAGES ||
+              std::pow(static_cast<double>(config.decimation), config.cicStages) > CIC_MAX_GAIN))
+    {
+        std::snprintf(text, sizeof(text), "CIC 级数须在 1 ~ %d 之间，且抽取倍数的级数次方不超过 2^31", MAX_CIC_STAGES);
+        error = text;
+    }
+    else if (config.biasMode != NoBias && !(config.biasSeconds * config.sampleRate >= 1.0))
+    {
+        error = "零偏估计时长须至少为一帧";
+    }
+    if (!error.empty())
+    {
+        if (errorString)    *errorString = error;
+        return false;
+    }
+
+    settings = config;
+    // Butterworth 低通：按 N/2 个二阶节级联，双线性变换（预畸变到截止频率），每节直流增益为1
+    sectionCount = config.cutoffHz > 0 ? config.filterOrder / 2 : 0;
+    const double k = std::tan(PI * config.cutoffHz / config.sampleRate);
+    for (int s = 0; s < sectionCount; ++s)
+    {
+        const double q = 1.0 / (2.0 * std::cos(PI * (2 * s + 1) / (2.0 * config.filterOrder)));
+        const double norm = 1.0 / (1.0 + k / q + k * k);
+        sections[s].b0 = static_cast<float>(k * k * norm);
+        sections[s].b1 = static_cast<float>(2.0 * k * k * norm);
+        sections[s].b2 = static_cast<float>(k * k * norm);
+        sections[s].a1 = static_cast<float>(2.0 * (k * k - 1.0) * norm);
+        sections[s].a2 = static_cast<float>((1.0 - k / q + k * k) * norm);
+    }
+    cicScale = 1.0 / (std::pow(static_cast<double>(config.decimation), config.cicStages)
+                      * static_cast<double>(1 << CIC_FRACTION_BITS));
+    reset();
+    return true;
+}
+
+std::string DspStage::describe() const
+{
+    std::string text;
+    char part[64];
+    if (settings.biasMode != NoBias)
+    {
+        std::snprintf(part, sizeof(part), "%s零偏（%.3g秒）", settings.biasMode == GyroBias ? "陀螺" : "全部",
+                      settings.biasSeconds);
+        text += part;
+    }
+    if (settings.cutoffHz > 0)
+    {
+        std::snprintf(part, sizeof(part), "%d阶低通 %.4gHz", settings.filterOrder, settings.cutoffHz);
+        text += text.empty() ? "" : " + ";
+        text += part;
+    }
+    if (settings.decimation > 1)
+    {
+        if (settings.decimator == CicDecimator)
+            std::snprintf(part, sizeof(part), "%d级CIC抽取 ÷%d", settings.cicStages, settings.decimation);
+        else
+            std::snprintf(part, sizeof(part), "平均抽取 ÷%d", settings.decimation);
+        text += text.empty() ? "" : " + ";
+        text += part;
+    }
+    return text.empty() ? std::string("不处理") : text;
+}
+
+bool DspStage::isSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case AutoKernel:
+    case ScalarKernel:
+        return true;
+    case Sse2Kernel:
+#ifdef IMU_HAVE_SSE2_KERNEL
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char *DspStage::kernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case AutoKernel:    return "auto";
+    case ScalarKernel:  return "scalar";
+    case Sse2Kernel:    return "sse2";
+    }
+    return "unknown";
+}
+
+bool DspStage::setKernel(Kernel kernel)
+{
+    if (kernel == AutoKernel)   kernel = isSupported(Sse2Kernel) ? Sse2Kernel : ScalarKernel;
+    if (!isSupported(kernel))   return false;
+
+    switch (kernel)
+    {
+#ifdef IMU_HAVE_SSE2_KERNEL
+    case Sse2Kernel:    run = &biquadSse2;      break;
+#endif
+    default:            run = &biquadScalar;    break;
+    }
+    active = kernel;
+    return true;
+}
+
+void DspStage::reset()
+{
+    start(stateImuCount);
+}
+
+void DspStage::start(int imuCount)
+{
+    stateImuCount = imuCount;
+    channels = imuCount * DATA_PER_IMU;
+    paddedChannels = (channels + 3) & ~3;
+    // 补齐的通道始终为0，滤波后仍为0
+    memset(rows, 0, sizeof(rows));
+    memset(offsets, 0, sizeof(offsets));
+    memset(state1, 0, sizeof(state1));
+    memset(state2, 0, sizeof(state2));
+    memset(average, 0, sizeof(average));
+    memset(result, 0, sizeof(result));
+    memset(integrators, 0, sizeof(integrators));
+    memset(combs, 0, sizeof(combs));
+    memset(lastFinite, 0, sizeof(lastFinite));
+    std::fill(biasSums, biasSums + MAX_CHANNELS, 0.0);
+    std::fill(biasCounts, biasCounts + MAX_CHANNELS, int64_t(0));
+    biasFrames = settings.biasMode != NoBias ? std::llround(settings.biasSeconds * settings.sampleRate) : 0;
+    biasRemaining = biasFrames;
+    filterPrimed = false;
+    phase = 0;
+    groupSaturated = 0;
+    // CIC 的积分器和梳状级从0开始，前 N 个输出含启动瞬态
+    cicWarmup = settings.decimator == CicDecimator && settings.decimation > 1 ? settings.cicStages : 0;
+}
+
+double DspStage::biasProgress() const
+{
+    return biasFrames > 0 ? 1.0 - static_cast<double>(biasRemaining) / biasFrames : 1.0;
+}
+
+std::size_t DspStage::process(const ImuFrame *frames, std::size_t count, std::vector<ImuFrame> &out)
+{
+    const std::size_t before = out.size();
+    if (count == 0) return 0;
+    if (frames[0].imuCount != stateImuCount)    start(frames[0].imuCount);
+
+    for (std::size_t done = 0; done < count; )
+    {
+        const int n = static_cast<int>(std::min<std::size_t>(BLOCK_FRAMES, count - done));
+        const int64_t startNs = costHistogram ? steadyClockNs() : 0;
+        processBlock(frames + done, n, out);
+        if (costHistogram)  costHistogram->record((steadyClockNs() - startNs) / channels);
+        done += static_cast<std::size_t>(n);
+    }
+    return out.size() - before;
+}
+
+int DspStage::estimateBias(const ImuFrame *frames, int count)
+{
+    const int used = static_cast<int>(std::min<int64_t>(count, biasRemaining));
+    for (int f = 0; f < used; ++f)
+    {
+        const float *values = &frames[f].imu[0].accel[0];
+        for (int c = 0; c < channels; ++c)
+        {
+            if (!std::isfinite(values[c])) continue;
+            biasSums[c] += values[c];
+            ++biasCounts[c];
+            lastFinite[c] = values[c];
+        }
+    }
+    biasRemaining -= used;
+    if (biasRemaining == 0)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            const bool gyro = c % DATA_PER_IMU >= 3;
+            const bool remove = settings.biasMode == AllBias || (settings.biasMode == GyroBias && gyro);
+            offsets[c] = remove && biasCounts[c] > 0 ? static_cast<float>(biasSums[c] / biasCounts[c]) : 0.0f;
+        }
+    }
+    return used;
+}
+
+void DspStage::processBlock(const ImuFrame *frames, int count, std::vector<ImuFrame> &out)
+{
+    // 零偏估计期间的帧不输出
+    const int first = biasRemaining > 0 ? estimateBias(frames, count) : 0;
+    const ImuFrame *input = frames + first;
+    const int n = count - first;
+    if (n == 0) return;
+
+    // 载入并扣除零偏（未扣除的通道零偏为0）；非有限值保持上一个有限值
+    for (int f = 0; f < n; ++f)
+    {
+        const float *values = &input[f].imu[0].accel[0];
+        float *row = rows[f];
+        for (int c = 0; c < channels; ++c)
+        {
+            float v = values[c];
+            if (std::isfinite(v))  lastFinite[c] = v;
+            else                   v = lastFinite[c];
+            row[c] = v - offsets[c];
+        }
+    }
+
+    // 低通：第一帧视为此前一直保持的稳态（每节直流增益为1，输出等于输入）
+    if (!filterPrimed)
+    {
+        for (int s = 0; s < sectionCount; ++s)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                state1[s][c] = rows[0][c] * (1.0f - sections[s].b0);
+                state2[s][c] = rows[0][c] * (sections[s].b2 - sections[s].a2);
+            }
+        }
+        filterPrimed = true;
+    }
+    for (int s = 0; s < sectionCount; ++s)
+    {
+        run(rows[0], n, paddedChannels, sections[s], state1[s], state2[s]);
+    }
+
+    // 抽取
+    const int decimation = settings.decimation;
+    if (decimation == 1)
+    {
+        for (int f = 0; f < n; ++f) emitFrame(input[f], rows[f], out);
+        return;
+    }
+    if (settings.decimator == MovingAverage)
+    {
+        const float scale = 1.0f / decimation;
+        for (int f = 0; f < n; ++f)
+        {
+            const float *row = rows[f];
+            for (int c = 0; c < channels; ++c)  average[c] += row[c];
+            groupSaturated |= input[f].saturatedMask;
+            if (++phase < decimation)   continue;
+            for (int c = 0; c < channels; ++c)
+            {
+                result[c] = average[c] * scale;
+                average[c] = 0.0f;
+            }
+            phase = 0;
+            emitFrame(input[f], result, out);
+        }
+        return;
+    }
+
+    // CIC：定点整数按模 2^64 运算，积分器溢出回绕后由梳状级抵消，长时间运行也没有累积误差
+    const int stages = settings.cicStages;
+    const float fixedScale = static_cast<float>(1 << CIC_FRACTION_BITS);
+    for (int f = 0; f < n; ++f)
+    {
+        const float *row = rows[f];
+        for (int c = 0; c < channels; ++c)
+        {
+            float x = row[c];
+            // 限幅；NaN 按0处理
+            x = x >= -CIC_INPUT_LIMIT ? (x <= CIC_INPUT_LIMIT ? x : CIC_INPUT_LIMIT) : (x < 0 ? -CIC_INPUT_LIMIT : 0.0f);
+            uint64_t acc = static_cast<uint64_t>(static_cast<int64_t>(std::lrint(x * fixedScale)));
+            for (int k = 0; k < stages; ++k)
+            {
+                integrators[k][c] += acc;
+                acc = integrators[k][c];
+            }
+        }
+        groupSaturated |= input[f].saturatedMask;
+        if (++phase < decimation)   continue;
+        for (int c = 0; c < channels; ++c)
+        {
+            uint64_t x = integrators[stages - 1][c];
+            for (int k = 0; k < stages; ++k)
+            {
+                const uint64_t y = x - combs[k][c];
+                combs[k][c] = x;
+                x = y;
+            }
+            result[c] = static_cast<float>(static_cast<int64_t>(x) * cicScale);
+        }
+        phase = 0;
+        if (cicWarmup > 0)
+        {
+            --cicWarmup;
+            groupSaturated = 0;
+            continue;
+        }
+        emitFrame(input[f], result, out);
+    }
+}
+
+void DspStage::emitFrame(const ImuFrame &last, const float *values, std::vector<ImuFrame> &out)
+{
+    out.push_back(last);
+    ImuFrame &frame = out.back();
+    memcpy(frame.imu, values, static_cast<std::size_t>(channels) * sizeof(float));
+    frame.saturatedMask = last.saturatedMask | groupSaturated;
+    groupSaturated = 0;
+}
@@ -0,0 +1,148 @@
+#ifndef DSPSTAGE_H
+#define DSPSTAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "imuframe.h"
+#include "imuarraystats.h"     // IMU_HAVE_SSE2_KERNEL
+
+class LatencyHistogram;
+
+// 级联双二阶节的一节（转置直接II型，a0 归一化为1），所有通道共用同一组系数
+struct BiquadSection
+{
+    float b0, b1, b2;
+    float a1, a2;
+};
+
+// 双二阶节滤波内核：rows 为 frames 帧、行距 DspStage::MAX_CHANNELS 的样本（按 帧 → 通道 存储），
+// 原地滤波前 channels 个通道（4 的倍数），state1/state2 为各通道的状态。
+// 时间上逐帧递推，每帧内按通道并行：一条SIMD指令同时处理4个通道（9 IMU 的54个通道为14条向量）。
+typedef void (*BiquadKernel)(float *rows, int frames, int channels, const BiquadSection &section,
+                             float *state1, float *state2);
+void biquadScalar(float *rows, int frames, int channels, const BiquadSection &section, float *state1, float *state2);
+#ifdef IMU_HAVE_SSE2_KERNEL
+void biquadSse2(float *rows, int frames, int channels, const BiquadSection &section, float *state1, float *state2);
+#endif
+
+// 实时信号处理（采集线程，逐批调用，位于解析和各消费者之间）：
+//   零偏扣除 → Butterworth 低通（级联双二阶节） → 抽取（滑动平均或 CIC）
+// 所有通道（imuCount × 6）按块处理：每 BLOCK_FRAMES 帧复制为 帧 → 通道 的连续样本
+// （IMUData 数组本身即此顺序，不需要转置），各级对整块依次处理，块内数据留在L1缓存中。
+//
+// 零偏：数据源开始后的 biasSeconds 秒只用于估计各通道的均值（静止状态），不输出；
+// 之后从每帧中扣除。默认只扣除陀螺仪零偏（加速度计静止时含重力）。
+// 低通滤波器的状态用估计完成后的第一帧初始化为稳态，不产生启动瞬态。
+// 非有限值（NaN/Inf）不计入零偏估计，进入低通前按该通道上一个有限值处理，
+// 否则会使滤波器状态永久变为 NaN。
+// 抽取输出的帧取该组最后一帧的序号和时间戳（因果滤波，延迟与离线处理不同），
+// saturatedMask 为组内各帧之或；均值和跨IMU统计由调用方对输出帧另行计算。
+class DspStage
+{
+public:
+    enum BiasMode {
+        NoBias = 0,             // 不扣除零偏
+        GyroBias,               // 只扣除陀螺仪零偏
+        AllBias                 // 扣除所有通道的均值（加速度计须水平静止，结果不含重力）
+    };
+
+    enum Decimator {
+        MovingAverage = 0,      // 每 decimation 帧取平均（sinc 响应）
+        CicDecimator            // CIC：cicStages 级积分-梳状（sinc^N 响应，定点整数运算，无累积误差）
+    };
+
+    enum Kernel {
+        AutoKernel = 0,         // 运行时选择最宽的可用内核
+        ScalarKernel,
+        Sse2Kernel
+    };
+
+    struct Config {
+        double sampleRate;      // 输入帧率（Hz）
+        double cutoffHz;        // 低通截止频率（-3dB），0 为不滤波
+        int filterOrder;        // Butterworth 阶数（2、4、6、8）
+        int decimation;         // 抽取倍数，1 为不抽取
+        Decimator decimator;
+        int cicStages;          // CIC 级数（1~MAX_CIC_STAGES）
+        BiasMode biasMode;
+        double biasSeconds;     // 零偏估计时长（秒），biasMode 不为 NoBias 时须大于0
+    };
+
+    static const int BLOCK_FRAMES = 64;
+    static const int MAX_CHANNELS = MAX_IMU_COUNT * DATA_PER_IMU;  // 192，4 的倍数
+    static const int MAX_SECTIONS = 4;          // 最高8阶
+    static const int MAX_CIC_STAGES = 5;
+    static const int CIC_FRACTION_BITS = 20;    // CIC 定点数的小数位（分辨率约1e-6，与CSV的6位小数相当）
+
+    DspStage();
+
+    // 默认配置：不处理（isEnabled() 为 false）
+    static Config defaultConfig(double sampleRate);
+    // 校验并应用配置（同时 reset()），参数不合理时返回 false 并保持原配置
+    bool configure(const Config &config, std::string *errorString);
+    const Config &config() const { return settings; }
+    // 至少有一级处理
+    bool isEnabled() const { return settings.biasMode != NoBias || settings.cutoffHz > 0 || settings.decimation > 1; }
+    double outputRate() const { return settings.sampleRate / settings.decimation; }
+    // 配置的文字描述，例如 "陀螺零偏 + 4阶低通 20Hz + 平均抽取 ÷10"
+    std::string describe() const;
+
+    bool setKernel(Kernel kernel);
+    Kernel kernel() const { return active; }
+    static bool isSupported(Kernel kernel);
+    static const char *kernelName(Kernel kernel);
+
+    // 每块处理耗时（纳秒 / 通道）记入该直方图，nullptr 不统计
+    void setCostHistogram(LatencyHistogram *histogram) { costHistogram = histogram; }
+
+    // 新的数据源开始：清除滤波器状态，重新估计零偏
+    void reset();
+    // 处理一批帧（各帧 imuCount 相同），输出的帧追加到 out，返回输出帧数
+    std::size_t process(const ImuFrame *frames, std::size_t count, std::vector<ImuFrame> &out);
+
+    bool biasReady() const { return biasRemaining == 0; }
+    // 零偏估计的进度（0~1）
+    double biasProgress() const;
+    // 各通道（IMU i 的第 j 个数据为 i * DATA_PER_IMU + j）扣除的零偏，估计完成前为0
+    const float *bias() const { return offsets; }
+
+private:
+    void start(int imuCount);                   // 按IMU数量清除状态
+    int estimateBias(const ImuFrame *frames, int count);     // 返回用于估计的帧数
+    void processBlock(const ImuFrame *frames, int count, std::vector<ImuFrame> &out);
+    void emitFrame(const ImuFrame &last, const float *values, std::vector<ImuFrame> &out);
+
+    Config settings;
+    BiquadSection sections[MAX_SECTIONS];
+    int sectionCount;
+    Kernel active;
+    BiquadKernel run;
+    LatencyHistogram *costHistogram;
+
+    int stateImuCount;                  // 状态对应的IMU数量
+    int channels;                       // imuCount × 6
+    int paddedChannels;                 // 向上取整到 4 的倍数
+    int64_t biasRemaining;              // 还需用于估计零偏的帧数
+    int64_t biasFrames;
+    bool filterPrimed;                  // 滤波器状态已按第一帧初始化
+    int phase;                          // 当前抽取组已累加的帧数
+    uint32_t groupSaturated;
+    int cicWarmup;                      // CIC 暖机：丢弃的前几个输出
+
+    alignas(16) float rows[BLOCK_FRAMES][MAX_CHANNELS];
+    alignas(16) float offsets[MAX_CHANNELS];
+    alignas(16) float state1[MAX_SECTIONS][MAX_CHANNELS];
+    alignas(16) float state2[MAX_SECTIONS][MAX_CHANNELS];
+    alignas(16) float average[MAX_CHANNELS];               // 滑动平均的累加和
+    alignas(16) float result[MAX_CHANNELS];
+    alignas(16) float lastFinite[MAX_CHANNELS];            // 各通道上一个有限输入值（未扣零偏）
+    double biasSums[MAX_CHANNELS];
+    int64_t biasCounts[MAX_CHANNELS];                      // 零偏估计中各通道的有限样本数
+    uint64_t integrators[MAX_CIC_STAGES][MAX_CHANNELS];    // CIC 积分器（按模 2^64 回绕，梳状级相减后抵消）
+    uint64_t combs[MAX_CIC_STAGES][MAX_CHANNELS];
+    double cicScale;                    // 1 / (D^N × 2^CIC_FRACTION_BITS)
+};
+
+#endif // DSPSTAGE_H
@@ -0,0 +1,78 @@
+#include "fileutil.h"
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+std::FILE *openFileUtf8(const std::string &path, const char *mode)
+{
+#ifdef _WIN32
+    int len = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring widePath(static_cast<std::size_t>(len > 0 ? len : 1), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], len);
+    std::wstring wideMode(mode, mode + strlen(mode));
+    return _wfopen(widePath.c_str(), wideMode.c_str());
+#else
+    return std::fopen(path.c_str(), mode);
+#endif
+}
+
+bool seekFile(std::FILE *file, int64_t offset, int origin)
+{
+#ifdef _WIN32
+    return _fseeki64(file, offset, origin) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), origin) == 0;
+#endif
+}
+
+int64_t tellFile(std::FILE *file)
+{
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return static_cast<int64_t>(ftello(file));
+#endif
+}
+
+bool preallocateFile(std::FILE *file, uint64_t size)
+{
+#if defined(__linux__)
+    return fallocate(fileno(file), FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)) == 0;
+#elif defined(_WIN32)
+    FILE_ALLOCATION_INFO info;
+    info.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+    return SetFileInformationByHandle(handle, FileAllocationInfo, &info, sizeof(info)) != 0;
+#else
+    (void)file;
+    (void)size;
+    return false;
+#endif
+}
+
+void releasePreallocation(std::FILE *file, uint64_t size)
+{
+#if defined(__linux__)
+    // 截断到当前长度即释放 KEEP_SIZE 预留的尾部空间；Windows 关闭文件时自动释放
+    if (ftruncate(fileno(file), static_cast<off_t>(size)) != 0) {}
+#else
+    (void)file;
+    (void)size;
+#endif
+}
+
+bool syncFileData(std::FILE *file)
+{
+#if defined(_WIN32)
+    return _commit(_fileno(file)) == 0;
+#elif defined(__linux__)
+    return fdatasync(fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
@@ -0,0 +1,26 @@
+#ifndef FILEUTIL_H
+#define FILEUTIL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// 以 UTF-8 路径打开文件（Windows 下转为宽字符，支持中文用户名的桌面路径）
+std::FILE *openFileUtf8(const std::string &path, const char *mode);
+
+// 64位文件定位（Windows 的 long 为32位，fseek/ftell 超过 2GB 即出错）：
+// Windows 用 _fseeki64/_ftelli64，其他平台用 fseeko/ftello。
+// seekFile 成功返回 true；tellFile 失败返回 -1
+bool seekFile(std::FILE *file, int64_t offset, int origin);
+int64_t tellFile(std::FILE *file);
+
+// 为文件预留 [0, size) 的磁盘空间而不改变文件长度（Linux fallocate KEEP_SIZE，Windows 设置分配大小），
+// 顺序追加时不再边写边分配，减少碎片和元数据更新；异常退出后文件长度仍是实际写入的长度。
+// 平台或文件系统不支持时返回 false，不影响写入
+bool preallocateFile(std::FILE *file, uint64_t size);
+// 释放超出文件长度 size 的预留空间（关闭文件前调用）
+void releasePreallocation(std::FILE *file, uint64_t size);
+// 把已写入的数据同步到磁盘（fdatasync / FlushFileBuffers）
+bool syncFileData(std::FILE *file);
+
+#endif // FILEUTIL_H
@@ -0,0 +1,135 @@
+#include "frameclock.h"
+#include <algorithm>
+#include <cmath>
+
+// 收敛所需的最少观测点数
+static const uint64_t MIN_SAMPLES = 10;
+// 离群判据：残差超过 max(OUTLIER_PERIODS 个周期, OUTLIER_JITTERS 倍抖动, OUTLIER_MIN_NS)
+// 时不参与拟合（例如采集线程被阻塞导致读取延迟）
+static const double OUTLIER_PERIODS = 20.0;
+static const double OUTLIER_JITTERS = 10.0;
+static const double OUTLIER_MIN_NS = 50.0e6;
+// 连续离群达到该次数时认为设备复位或帧率改变，丢弃旧模型重新拟合
+static const int RESET_AFTER_OUTLIERS = 20;
+
+FrameClock::FrameClock(double nominalHz, double timeConstantSeconds) :
+    nominalPeriodNs(1.0e9 / nominalHz),
+    timeConstantNs(timeConstantSeconds * 1.0e9)
+{
+    reset();
+}
+
+void FrameClock::reset()
+{
+    started = false;
+    refIndex = 0;
+    refNs = 0;
+    lastIndex = 0;
+    lastNs = 0;
+    samples = 0;
+    weight = 0;
+    meanX = 0;
+    meanY = 0;
+    covXX = 0;
+    covXY = 0;
+    residualSquare = 0;
+    outlierCount = 0;
+    consecutiveOutliers = 0;
+}
+
+void FrameClock::setNominalRate(double hz)
+{
+    if (hz > 0) nominalPeriodNs = 1.0e9 / hz;
+}
+
+void FrameClock::addSample(uint64_t index, int64_t arrivalNs)
+{
+    if (!started)
+    {
+        started = true;
+        refIndex = index;
+        refNs = arrivalNs;
+        lastIndex = index;
+        lastNs = arrivalNs;
+        samples = 1;
+        weight = 1;
+        return;
+    }
+    // 同一帧不重复观测
+    if (index <= lastIndex) return;
+
+    const double x = static_cast<double>(index - refIndex);
+    const double y = static_cast<double>(arrivalNs - refNs);
+
+    if (isValid())
+    {
+        const double residual = y - (meanY + periodNs() * (x - meanX));
+        const double limit = std::max(std::max(OUTLIER_PERIODS * periodNs(), OUTLIER_JITTERS * jitterNs()),
+                                      OUTLIER_MIN_NS);
+        if (std::fabs(residual) > limit)
+        {
+            outlierCount++;
+            if (++consecutiveOutliers >= RESET_AFTER_OUTLIERS)
+            {
+                const uint64_t outliersSoFar = outlierCount;
+                reset();
+                outlierCount = outliersSoFar;
+                addSample(index, arrivalNs);
+            }
+            return;
+        }
+        consecutiveOutliers = 0;
+        residualSquare += (residual * residual - residualSquare) / (weight + 1);
+    }
+
+    // 指数遗忘的加权最小二乘（增量更新中心化矩，数值稳定）
+    const double decay = std::exp(-std::max<double>(0, static_cast<double>(arrivalNs - lastNs)) / timeConstantNs);
+    weight = decay * weight + 1;
+    const double dx = x - meanX;
+    const double dy = y - meanY;
+    meanX += dx / weight;
+    meanY += dy / weight;
+    covXX = decay * covXX + dx * (x - meanX);
+    covXY = decay * covXY + dx * (y - meanY);
+
+    lastIndex = index;
+    lastNs = arrivalNs;
+    samples++;
+}
+
+bool FrameClock::isValid() const
+{
+    return samples >= MIN_SAMPLES && covXX > 0 && covXY > 0;
+}
+
+int64_t FrameClock::timeAt(uint64_t index) const
+{
+    if (!started)   return 0;
+    if (!isValid())
+    {
+        const double offset = static_cast<double>(static_cast<int64_t>(index - lastIndex)) * nominalPeriodNs;
+        return lastNs + static_cast<int64_t>(std::llround(offset));
+    }
+    const double x = static_cast<double>(static_cast<int64_t>(index - refIndex));
+    return refNs + static_cast<int64_t>(std::llround(meanY + periodNs() * (x - meanX)));
+}
+
+double FrameClock::periodNs() const
+{
+    return isValid() ? covXY / covXX : nominalPeriodNs;
+}
+
+double FrameClock::rateHz() const
+{
+    return isValid() ? 1.0e9 / periodNs() : 0.0;
+}
+
+double FrameClock::driftPpm() const
+{
+    return isValid() ? (nominalPeriodNs / periodNs() - 1.0) * 1.0e6 : 0.0;
+}
+
+double FrameClock::jitterNs() const
+{
+    return std::sqrt(residualSquare);
+}
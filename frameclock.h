@@ -0,0 +1,59 @@
+#ifndef FRAMECLOCK_H
+#define FRAMECLOCK_H
+
+#include <cstdint>
+
+// 帧时钟模型：在线拟合 帧序号 → 主机单调时间 的直线 t = t0 + period * index，
+// 用于给每帧重建平滑、连续、已校正时钟漂移的时间戳。
+//
+// 串口数据经 USB 转串口芯片按批到达，同一批内的帧读取时刻相同、批间间隔抖动，
+// 直接用到达时刻作时间戳会出现重复和锯齿；而设备自身按晶振等间隔采样，
+// 帧序号与采样时刻严格线性（晶振偏差表现为斜率偏离理论周期）。
+// 因此每批只取最后一帧（其到达时刻最接近实际发出时刻）作为一个观测点，
+// 以指数遗忘的加权最小二乘拟合直线，斜率即真实采样周期，残差即到达抖动。
+//
+// 纯 C++ 实现，不依赖 Qt，采集线程、命令行和基准测试共用。
+class FrameClock
+{
+public:
+    // nominalHz: 理论帧率，模型收敛前用于推算时间戳；
+    // timeConstantSeconds: 遗忘时间常数，越长斜率越稳，越短越快跟上温漂
+    explicit FrameClock(double nominalHz = 100.0, double timeConstantSeconds = 30.0);
+
+    void reset();
+    void setNominalRate(double hz);
+
+    // 加入一个观测：帧序号 index（含丢失的帧，序号连续递增）在 arrivalNs 时刻到达
+    void addSample(uint64_t index, int64_t arrivalNs);
+
+    // 模型是否已收敛（观测点足够多且跨度足够长）
+    bool isValid() const;
+    // 第 index 帧的模型时间（纳秒）；未收敛时以最近一个观测点按理论周期推算
+    int64_t timeAt(uint64_t index) const;
+
+    double periodNs() const;          // 估计的帧周期（纳秒）
+    double rateHz() const;            // 估计的真实帧率，未收敛时为0
+    double driftPpm() const;          // 真实帧率相对理论帧率的偏差（百万分之一）
+    double jitterNs() const;          // 到达时刻相对模型的残差均方根（纳秒）
+    uint64_t outliers() const { return outlierCount; }   // 被剔除的离群观测数
+
+private:
+    double nominalPeriodNs;
+    double timeConstantNs;
+
+    bool started;
+    uint64_t refIndex;                // 第一个观测点，x/y 均相对该点计算以保证精度
+    int64_t refNs;
+    uint64_t lastIndex;               // 最近一个观测点
+    int64_t lastNs;
+
+    uint64_t samples;                 // 参与拟合的观测数
+    double weight;                    // 加权样本数（指数遗忘）
+    double meanX, meanY;              // 加权均值
+    double covXX, covXY;              // 加权中心化二阶矩
+    double residualSquare;            // 残差平方的加权均值
+    uint64_t outlierCount;
+    int consecutiveOutliers;          // 连续离群次数，过多说明设备复位或速率改变，重新拟合
+};
+
+#endif // FRAMECLOCK_H
@@ -0,0 +1,42 @@
+#include "framelayout.h"
+
+// 程序支持的板卡：9、16、32 IMU，每个IMU 6个通道，标准帧头/尾标
+static const FrameFormat *formatTable(int &count)
+{
+    static const FrameFormat formats[] = {
+        makeFrameFormat<FrameLayout<9> >("9 IMU"),
+        makeFrameFormat<FrameLayout<16> >("16 IMU"),
+        makeFrameFormat<FrameLayout<32> >("32 IMU")
+    };
+    count = static_cast<int>(sizeof(formats) / sizeof(formats[0]));
+    return formats;
+}
+
+int frameFormatCount()
+{
+    int count = 0;
+    formatTable(count);
+    return count;
+}
+
+const FrameFormat &frameFormatAt(int index)
+{
+    int count = 0;
+    return formatTable(count)[index];
+}
+
+const FrameFormat *findFrameFormat(int imuCount)
+{
+    int count = 0;
+    const FrameFormat *formats = formatTable(count);
+    for (int i = 0; i < count; ++i)
+    {
+        if (formats[i].imuCount == imuCount)    return &formats[i];
+    }
+    return nullptr;
+}
+
+const FrameFormat &defaultFrameFormat()
+{
+    return *findFrameFormat(DEFAULT_IMU_COUNT);
+}
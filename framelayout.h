@@ -0,0 +1,158 @@
+#ifndef FRAMELAYOUT_H
+#define FRAMELAYOUT_H
+
+#include <cstring>
+#include "imuframe.h"
+
+// 串口帧布局：帧头 + ImuCount 个IMU × ChannelsPerImu 个 float + 尾标。
+// FrameLayout 在编译期推导帧长和各字段偏移，并生成按 ImuCount 完全展开的解码、求均值内核
+// （采集时均值和跨IMU统计由 ImuArrayStats 按批计算，reduce 用于逐帧读取记录文件）；
+// 程序内实例化的布局登记在布局表中（frameFormatAt()），打开数据源时按IMU数量选择一次，
+// 之后每帧经函数指针调用对应的专用内核，因此同一个程序即可全速处理9/16/32 IMU 等不同板卡。
+//
+// 新增板卡：在 framelayout.cpp 的布局表中加入一行 FrameLayout<N>（N 不超过 MAX_IMU_COUNT）。
+
+// 标准帧头 {0xAA, 0x55} 和尾标 {0x00, 0x00, 0x80, 0x7f}
+struct StandardFraming
+{
+    static const int HEAD_SIZE = ::HEAD_SIZE;
+    static const int TAIL_SIZE = ::TAIL_SIZE;
+    static const char *head() { return HEAD_PATTERN; }
+    static const char *tail() { return TAIL_PATTERN; }
+};
+
+namespace FrameKernels {
+
+// 逐个IMU复制 accel + gyro（负载中每个IMU多于6个通道时跳过其余通道），按 N 递归完全展开
+template <int N, int Stride>
+struct CopyImus
+{
+    static void run(const char *payload, IMUData *imu)
+    {
+        CopyImus<N - 1, Stride>::run(payload, imu);
+        memcpy(&imu[N - 1], payload + (N - 1) * Stride, sizeof(IMUData));
+    }
+};
+
+template <int Stride>
+struct CopyImus<0, Stride>
+{
+    static void run(const char *, IMUData *) {}
+};
+
+// 按 IMU 顺序累加6个通道，按 N 递归完全展开（累加顺序与逐个循环相同）
+template <int N>
+struct SumImus
+{
+    static void run(const IMUData *imu, float sum[6])
+    {
+        SumImus<N - 1>::run(imu, sum);
+        sum[0] += imu[N - 1].accel[0];
+        sum[1] += imu[N - 1].accel[1];
+        sum[2] += imu[N - 1].accel[2];
+        sum[3] += imu[N - 1].gyro[0];
+        sum[4] += imu[N - 1].gyro[1];
+        sum[5] += imu[N - 1].gyro[2];
+    }
+};
+
+template <>
+struct SumImus<0>
+{
+    static void run(const IMUData *, float *) {}
+};
+
+} // namespace FrameKernels
+
+template <int ImuCount, int ChannelsPerImu = DATA_PER_IMU, class Framing = StandardFraming>
+struct FrameLayout
+{
+    static_assert(ImuCount > 0 && ImuCount <= MAX_IMU_COUNT, "ImuCount must fit in ImuFrame");
+    static_assert(ChannelsPerImu >= DATA_PER_IMU, "each IMU must carry at least accel + gyro");
+    static_assert(sizeof(IMUData) == DATA_PER_IMU * FLOAT_SIZE, "IMUData must match the payload layout");
+
+    typedef Framing FramingType;
+
+    static const int IMU_COUNT = ImuCount;
+    static const int CHANNELS_PER_IMU = ChannelsPerImu;
+    static const int HEAD_SIZE = Framing::HEAD_SIZE;
+    static const int TAIL_SIZE = Framing::TAIL_SIZE;
+    static const int IMU_STRIDE = ChannelsPerImu * FLOAT_SIZE;          // 负载中相邻IMU的间隔
+    static const int PAYLOAD_OFFSET = HEAD_SIZE;                         // 负载在帧内的偏移
+    static const int PAYLOAD_SIZE = ImuCount * IMU_STRIDE;               // 9 IMU: 216字节
+    static const int TAIL_OFFSET = PAYLOAD_OFFSET + PAYLOAD_SIZE;        // 尾标在帧内的偏移
+    static const int FRAME_SIZE = TAIL_OFFSET + TAIL_SIZE;               // 9 IMU: 222字节
+    static const int DATA_SIZE = ImuCount * static_cast<int>(sizeof(IMUData));  // 解码后 imu[] 的字节数
+
+    // 第 imu 个IMU的第 channel 个通道在帧内的偏移
+    static constexpr int offsetOf(int imu, int channel)
+    {
+        return PAYLOAD_OFFSET + imu * IMU_STRIDE + channel * FLOAT_SIZE;
+    }
+
+    // 负载 → imu[]（payload 指向帧头之后，无对齐要求）；均值等统计不在这里计算
+    static void decode(const char *payload, ImuFrame &frame)
+    {
+        if (IMU_STRIDE == static_cast<int>(sizeof(IMUData)))
+        {
+            // 负载布局与 IMUData 数组一致：定长复制，编译器展开为若干次宽寄存器搬移
+            memcpy(frame.imu, payload, DATA_SIZE);
+        }
+        else
+        {
+            FrameKernels::CopyImus<ImuCount, IMU_STRIDE>::run(payload, frame.imu);
+        }
+        frame.imuCount = ImuCount;
+    }
+
+    // 由 imu[] 计算所有IMU的加速度/陀螺仪均值
+    static void reduce(ImuFrame &frame)
+    {
+        float sum[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        FrameKernels::SumImus<ImuCount>::run(frame.imu, sum);
+        for (int j = 0; j < 3; ++j)
+        {
+            frame.meanAccel[j] = sum[j] / ImuCount;
+            frame.meanGyro[j]  = sum[3 + j] / ImuCount;
+        }
+    }
+};
+
+// 运行时的帧格式描述：由某个 FrameLayout 实例生成，数据源打开时选定
+struct FrameFormat
+{
+    const char *name;           // 显示名称，例如 "9 IMU"
+    int imuCount;
+    int channelsPerImu;         // 串口帧中每个IMU的通道数
+    int headSize;
+    int payloadSize;            // 串口帧负载字节数
+    int tailSize;
+    int frameSize;              // 整帧字节数
+    int dataSize;               // 解码后 imu[] 的字节数（二进制记录的每帧负载）
+    const char *headPattern;
+    const char *tailPattern;
+    void (*decode)(const char *payload, ImuFrame &frame);   // 负载 → imu[]
+    void (*reduce)(ImuFrame &frame);                        // imu[] → 均值
+};
+
+template <class Layout>
+FrameFormat makeFrameFormat(const char *name)
+{
+    FrameFormat format = {
+        name, Layout::IMU_COUNT, Layout::CHANNELS_PER_IMU,
+        Layout::HEAD_SIZE, Layout::PAYLOAD_SIZE, Layout::TAIL_SIZE, Layout::FRAME_SIZE, Layout::DATA_SIZE,
+        Layout::FramingType::head(), Layout::FramingType::tail(),
+        &Layout::decode, &Layout::reduce
+    };
+    return format;
+}
+
+// 程序内实例化的帧格式（按IMU数量递增，每个IMU数量一种）
+int frameFormatCount();
+const FrameFormat &frameFormatAt(int index);
+// 按IMU数量查找，没有对应布局时返回 nullptr
+const FrameFormat *findFrameFormat(int imuCount);
+// 默认格式（DEFAULT_IMU_COUNT 个IMU）
+const FrameFormat &defaultFrameFormat();
+
+#endif // FRAMELAYOUT_H
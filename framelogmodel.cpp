@@ -0,0 +1,79 @@
+#include "framelogmodel.h"
+#include "displayformatter.h"
+
+FrameLogModel::FrameLogModel(int capacity, QObject *parent) :
+    QAbstractListModel(parent),
+    ring(static_cast<std::size_t>(qMax(1, capacity))),
+    totalFrames(0),
+    firstRow(0),
+    rows(0)
+{
+}
+
+int FrameLogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows;
+}
+
+const ImuFrame &FrameLogModel::frameAtRow(int row) const
+{
+    return ring[(firstRow + static_cast<quint64>(row)) % ring.size()];
+}
+
+QVariant FrameLogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows)    return QVariant();
+
+    // 只有视图绘制可见行时才会走到这里
+    if (role == Qt::DisplayRole)
+    {
+        const ImuFrame &frame = frameAtRow(index.row());
+        return QString("#%1  %2").arg(frame.sequence).arg(DisplayFormatter::frameLine(frame));
+    }
+    return QVariant();
+}
+
+void FrameLogModel::append(const ImuFrame &frame)
+{
+    ring[totalFrames % ring.size()] = frame;
+    totalFrames++;
+}
+
+void FrameLogModel::commit()
+{
+    const quint64 capacity = ring.size();
+    const quint64 announced = firstRow + static_cast<quint64>(rows);
+    if (announced == totalFrames)   return;
+
+    // 新的可见范围：最近 capacity 帧
+    const quint64 newFirst = totalFrames > capacity ? totalFrames - capacity : 0;
+
+    // 先淘汰已被覆盖的旧行（全部被覆盖时整体移除）
+    if (newFirst > firstRow && rows > 0)
+    {
+        const int removed = static_cast<int>(qMin<quint64>(newFirst - firstRow, static_cast<quint64>(rows)));
+        beginRemoveRows(QModelIndex(), 0, removed - 1);
+        rows -= removed;
+        firstRow += static_cast<quint64>(removed);
+        endRemoveRows();
+    }
+    if (rows == 0)  firstRow = newFirst;
+
+    // 再追加新行
+    const int newRows = static_cast<int>(totalFrames - firstRow);
+    if (newRows > rows)
+    {
+        beginInsertRows(QModelIndex(), rows, newRows - 1);
+        rows = newRows;
+        endInsertRows();
+    }
+}
+
+void FrameLogModel::clear()
+{
+    beginResetModel();
+    totalFrames = 0;
+    firstRow = 0;
+    rows = 0;
+    endResetModel();
+}
@@ -0,0 +1,41 @@
+#ifndef FRAMELOGMODEL_H
+#define FRAMELOGMODEL_H
+
+#include <QAbstractListModel>
+#include <vector>
+#include "imuframe.h"
+
+// 原始数据区的数据模型：固定容量的已解码帧环形缓冲区
+// 只保存帧本身，不保存文本；视图只对当前可见、正在绘制的行调用 data() 格式化，
+// 因此内存固定（容量 * sizeof(ImuFrame)），与会话时长无关，
+// 收到新帧时也不做任何字符串格式化。
+class FrameLogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static const int DEFAULT_CAPACITY = 10000;   // 100Hz 下约100秒
+
+    explicit FrameLogModel(int capacity = DEFAULT_CAPACITY, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // 写入一帧（不通知视图）；界面每次刷新调用一次 commit() 统一通知
+    void append(const ImuFrame &frame);
+    // 把上次 commit() 以来的新帧通知给视图（淘汰最旧的行，追加新行）
+    void commit();
+    void clear();
+
+    int capacity() const { return static_cast<int>(ring.size()); }
+
+private:
+    const ImuFrame &frameAtRow(int row) const;
+
+    std::vector<ImuFrame> ring;       // 环形缓冲区
+    quint64 totalFrames;              // 累计写入的帧数（逻辑序号）
+    quint64 firstRow;                 // 视图第0行对应的逻辑序号
+    int rows;                         // 视图已知的行数
+};
+
+#endif // FRAMELOGMODEL_H
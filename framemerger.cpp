@@ -0,0 +1,256 @@
+#include "framemerger.h"
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include "csvencoder.h"
+
+const int64_t FrameMerger::DEFAULT_MAX_LATENCY_NS;
+
+// 缓冲区超过该大小就交给写盘线程（否则每次轮询结束时提交）
+static const std::size_t SUBMIT_BYTES = 64 * 1024;
+
+FrameMerger::FrameMerger() :
+    rows(0),
+    completeRows(0),
+    tolerance(0),
+    maxLatency(DEFAULT_MAX_LATENCY_NS),
+    lastAnchorNs(0),
+    buffer(nullptr),
+    stopRequested(false),
+    running(false)
+{
+}
+
+FrameMerger::~FrameMerger()
+{
+    stop();
+}
+
+int FrameMerger::addInput(const std::string &name, ImuFrameQueue *queue, int imuCount)
+{
+    std::unique_ptr<Port> port(new Port);
+    port->name = name;
+    port->queue = queue;
+    port->imuCount = imuCount < 0 ? 0 : (imuCount > MAX_IMU_COUNT ? MAX_IMU_COUNT : imuCount);
+    port->nextSequence = 0;
+    port->started = false;
+    ports.push_back(std::move(port));
+    return static_cast<int>(ports.size()) - 1;
+}
+
+bool FrameMerger::start(const std::string &path, int64_t toleranceNs, int64_t maxLatencyNs, std::string *errorString)
+{
+    stop();
+    if (ports.empty())
+    {
+        if (errorString)    *errorString = "没有输入";
+        return false;
+    }
+    if (!writer.open(path, AsyncFileWriter::Policy(), errorString)) return false;
+
+    tolerance = toleranceNs < 1 ? 1 : toleranceNs;
+    maxLatency = maxLatencyNs < 0 ? 0 : maxLatencyNs;
+    lastAnchorNs = std::numeric_limits<int64_t>::min();
+    rowMembers.assign(ports.size(), nullptr);
+    rows = 0;
+    completeRows = 0;
+    for (std::size_t i = 0; i < ports.size(); ++i)
+    {
+        Port &port = *ports[i];
+        port.pending.clear();
+        port.started = false;
+        port.stats.frames = 0;
+        port.stats.merged = 0;
+        port.stats.missingRows = 0;
+        port.stats.lateFrames = 0;
+        port.stats.gapFrames = 0;
+        port.stats.skew.reset();
+    }
+
+    buffer = writer.acquireBuffer();
+    writeHeader();
+    stopRequested = false;
+    running = true;
+    thread = std::thread(&FrameMerger::run, this);
+    return true;
+}
+
+void FrameMerger::stop()
+{
+    if (!running)   return;
+    stopRequested = true;
+    thread.join();
+    writer.close();
+    running = false;
+}
+
+void FrameMerger::run()
+{
+    while (!stopRequested.load(std::memory_order_acquire))
+    {
+        drainQueues();
+        mergeRows(steadyClockNs(), false);
+        submitBuffer();
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+    }
+    // 调用方已停止各数据源：取完剩余的帧，不再等待
+    drainQueues();
+    mergeRows(steadyClockNs(), true);
+    submitBuffer();
+    writer.submit(buffer);
+    buffer = nullptr;
+}
+
+void FrameMerger::drainQueues()
+{
+    ImuFrame frame;
+    for (std::size_t i = 0; i < ports.size(); ++i)
+    {
+        Port &port = *ports[i];
+        while (port.queue->pop(frame))
+        {
+            port.stats.frames.fetch_add(1, std::memory_order_relaxed);
+            if (port.started && frame.sequence > port.nextSequence)
+            {
+                port.stats.gapFrames.fetch_add(frame.sequence - port.nextSequence, std::memory_order_relaxed);
+            }
+            port.nextSequence = frame.sequence + 1;
+            port.started = true;
+
+            if (frame.monotonicNs < lastAnchorNs)
+            {
+                port.stats.lateFrames.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            port.pending.push_back(frame);
+        }
+    }
+}
+
+void FrameMerger::mergeRows(int64_t nowNs, bool flush)
+{
+    const ImuFrame **members = rowMembers.data();
+    for (;;)
+    {
+        // 锚点：所有串口待合并帧中最早的一帧
+        const ImuFrame *anchor = nullptr;
+        for (std::size_t i = 0; i < ports.size(); ++i)
+        {
+            const std::deque<ImuFrame> &pending = ports[i]->pending;
+            if (!pending.empty() && (!anchor || pending.front().monotonicNs < anchor->monotonicNs))
+            {
+                anchor = &pending.front();
+            }
+        }
+        if (!anchor)    return;
+
+        const int64_t anchorNs = anchor->monotonicNs;
+        const bool expired = flush || nowNs - anchorNs > maxLatency;
+        for (std::size_t i = 0; i < ports.size(); ++i)
+        {
+            const std::deque<ImuFrame> &pending = ports[i]->pending;
+            if (pending.empty())
+            {
+                // 该串口的帧可能还在路上：等到超时再判定缺失
+                if (!expired)   return;
+                members[i] = nullptr;
+            }
+            else
+            {
+                // 队列按时间递增，队首晚于容差窗口说明本行没有该串口的帧
+                members[i] = pending.front().monotonicNs - anchorNs < tolerance ? &pending.front() : nullptr;
+            }
+        }
+
+        const ImuFrame anchorFrame = *anchor;
+        appendRow(anchorFrame, members);
+        bool complete = true;
+        for (std::size_t i = 0; i < ports.size(); ++i)
+        {
+            Port &port = *ports[i];
+            if (members[i])
+            {
+                port.stats.merged.fetch_add(1, std::memory_order_relaxed);
+                port.stats.skew.record(members[i]->monotonicNs - anchorNs);
+                port.pending.pop_front();
+            }
+            else
+            {
+                port.stats.missingRows.fetch_add(1, std::memory_order_relaxed);
+                complete = false;
+            }
+        }
+        lastAnchorNs = anchorNs;
+        rows.fetch_add(1, std::memory_order_relaxed);
+        if (complete)   completeRows.fetch_add(1, std::memory_order_relaxed);
+        if (buffer->size() >= SUBMIT_BYTES) submitBuffer();
+    }
+}
+
+void FrameMerger::writeHeader()
+{
+    static const char *const CHANNELS[DATA_PER_IMU] = {"ax", "ay", "az", "gx", "gy", "gz"};
+    std::string header = "Timestamp";
+    for (std::size_t i = 0; i < ports.size(); ++i)
+    {
+        const Port &port = *ports[i];
+        header += ',' + port.name + "_Seq," + port.name + "_DtUs";
+        for (int imu = 0; imu < port.imuCount; ++imu)
+        {
+            for (int c = 0; c < DATA_PER_IMU; ++c)
+            {
+                header += ',' + port.name + "_IMU" + std::to_string(imu + 1) + '_' + CHANNELS[c];
+            }
+        }
+    }
+    header += '\n';
+    buffer->insert(buffer->end(), header.begin(), header.end());
+}
+
+void FrameMerger::appendRow(const ImuFrame &anchor, const ImuFrame *const *row)
+{
+    std::size_t maxSize = 24 + 1;
+    for (std::size_t i = 0; i < ports.size(); ++i)
+    {
+        maxSize += 2 * 25 + (CsvEncoder::MAX_FIELD_SIZE + 1) * ports[i]->imuCount * DATA_PER_IMU;
+    }
+    const std::size_t start = buffer->size();
+    buffer->resize(start + maxSize);
+    char *out = buffer->data() + start;
+    char *p = out;
+
+    p += CsvEncoder::formatInt(anchor.timestampMs, p);
+    for (std::size_t i = 0; i < ports.size(); ++i)
+    {
+        const int valueCount = ports[i]->imuCount * DATA_PER_IMU;
+        const ImuFrame *frame = row[i];
+        if (!frame)
+        {
+            // 缺失：帧序号、时间差和全部数值留空
+            memset(p, ',', static_cast<std::size_t>(2 + valueCount));
+            p += 2 + valueCount;
+            continue;
+        }
+        *p++ = ',';
+        p += CsvEncoder::formatInt(static_cast<int64_t>(frame->sequence), p);
+        *p++ = ',';
+        p += CsvEncoder::formatInt((frame->monotonicNs - anchor.monotonicNs) / 1000, p);
+        // 帧格式与登记的不同时按较少的IMU数量输出，其余留空
+        const int available = (frame->imuCount < ports[i]->imuCount ? frame->imuCount : ports[i]->imuCount) * DATA_PER_IMU;
+        const float *values = &frame->imu[0].accel[0];
+        for (int v = 0; v < valueCount; ++v)
+        {
+            *p++ = ',';
+            if (v < available)  p += CsvEncoder::formatFixed6(values[v], p);
+        }
+    }
+    *p++ = '\n';
+    buffer->resize(start + static_cast<std::size_t>(p - out));
+}
+
+void FrameMerger::submitBuffer()
+{
+    if (buffer->empty())    return;
+    writer.submit(buffer);
+    buffer = writer.acquireBuffer();
+}
@@ -0,0 +1,104 @@
+#ifndef FRAMEMERGER_H
+#define FRAMEMERGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "imuframe.h"
+#include "spscringbuffer.h"
+#include "asyncfilewriter.h"
+#include "pipelinestats.h"
+
+// 采集线程交出帧的无锁队列（与 AcquisitionWorker::FrameQueue 为同一类型）
+typedef SpscRingBuffer<ImuFrame, 1024> ImuFrameQueue;
+
+// 多串口帧合并：同时采集多个IMU阵列时，按主机时间戳把各串口的帧对齐成一行，写入合并CSV。
+// 各串口的 AcquisitionWorker 在各自的线程中独立读取和解析，帧时间戳都是同一单调时钟上的采样时刻
+// （帧时钟模型已校正各设备的晶振漂移），可以直接比较。
+//
+// 合并线程代替界面线程取用各工作对象的帧队列（每 POLL_MS 毫秒一次），按锚点逐行合并：
+// 锚点为所有串口待合并帧中最早的一帧，各串口采样时刻在 [锚点, 锚点 + 容差) 内的第一帧归入该行
+// （每个串口每行至多一帧；容差取一个帧周期时，各设备的采样相位可以任意错开）；
+// 某串口暂时没有待合并的帧时，等到锚点之后 maxLatency 仍未到达才判定该串口本行缺失（字段留空）。
+// 在已写出的锚点之前才到达的帧无法再按时间顺序写出，计为迟到帧丢弃。
+// 帧序号跳变说明有帧未进入队列（队列满、抽帧显示或按策略丢弃），计入 gapFrames，
+// 这些帧仍在各串口自己的记录文件中。
+//
+// 合并CSV：首行为表头，之后每行
+//   Timestamp(锚点UTC毫秒), 各串口依次 { 帧序号, 与锚点的时间差(微秒), imuCount * 6 个数值 }
+class FrameMerger
+{
+public:
+    static const int POLL_MS = 5;
+    static const int64_t DEFAULT_MAX_LATENCY_NS = 200 * 1000 * 1000;   // 200ms
+
+    // 各串口的合并统计（合并线程写，任意线程可读）
+    struct PortStats {
+        std::atomic<uint64_t> frames;       // 从队列取到的帧数
+        std::atomic<uint64_t> merged;       // 写入合并行的帧数
+        std::atomic<uint64_t> missingRows;  // 本串口缺失（字段留空）的行数
+        std::atomic<uint64_t> lateFrames;   // 迟到丢弃的帧数
+        std::atomic<uint64_t> gapFrames;    // 帧序号跳变：未进入队列的帧数
+        LatencyHistogram skew;              // 合并帧与本行锚点的时间差（纳秒）
+        PortStats() : frames(0), merged(0), missingRows(0), lateFrames(0), gapFrames(0) {}
+    };
+
+    FrameMerger();
+    ~FrameMerger();
+
+    // 开始合并前添加输入（队列的唯一消费者从此为合并线程），返回串口序号。
+    // imuCount 为该串口的帧格式，决定合并CSV中的列数
+    int addInput(const std::string &name, ImuFrameQueue *queue, int imuCount);
+    int inputCount() const { return static_cast<int>(ports.size()); }
+    const std::string &inputName(int port) const { return ports[port]->name; }
+    const PortStats &portStats(int port) const { return ports[port]->stats; }
+
+    // 打开合并文件（UTF-8 路径）并启动合并线程。
+    // toleranceNs：同一行各帧采样时刻的差小于该值，通常取一个帧周期；maxLatencyNs：等待慢串口的最长时间
+    bool start(const std::string &path, int64_t toleranceNs, int64_t maxLatencyNs, std::string *errorString);
+    // 取完队列中剩余的帧，全部写出后关闭文件
+    void stop();
+    bool isRunning() const { return running; }
+
+    // 合并文件已写入的字节数（任意线程可读）
+    uint64_t fileBytes() const { return writer.bytesWritten.load(std::memory_order_relaxed); }
+
+    std::atomic<uint64_t> rows;             // 已写出的行数
+    std::atomic<uint64_t> completeRows;     // 所有串口都有数据的行数
+
+private:
+    struct Port {
+        std::string name;
+        ImuFrameQueue *queue;
+        int imuCount;
+        std::deque<ImuFrame> pending;       // 已取出、待合并的帧（按采样时刻递增）
+        uint64_t nextSequence;              // 期望的下一帧序号
+        bool started;
+        PortStats stats;
+    };
+
+    void run();
+    void drainQueues();
+    // 写出所有可以确定的行；flush 为 true 时不再等待慢串口
+    void mergeRows(int64_t nowNs, bool flush);
+    void writeHeader();
+    void appendRow(const ImuFrame &anchor, const ImuFrame *const *row);
+    void submitBuffer();
+
+    std::vector<std::unique_ptr<Port> > ports;
+    int64_t tolerance;
+    int64_t maxLatency;
+    int64_t lastAnchorNs;                   // 最近写出的一行的锚点
+    std::vector<const ImuFrame *> rowMembers;   // 正在合并的一行中各串口的帧（缺失为 nullptr）
+    AsyncFileWriter writer;
+    AsyncFileWriter::Buffer *buffer;
+    std::thread thread;
+    std::atomic<bool> stopRequested;
+    bool running;
+};
+
+#endif // FRAMEMERGER_H
@@ -0,0 +1,138 @@
+#include "framesynchronizer.h"
+#include <cstring>
+
+ByteRingBuffer::ByteRingBuffer(std::size_t capacityPow2) :
+    buf(capacityPow2),
+    mask(capacityPow2 - 1),
+    readPos(0),
+    writePos(0)
+{
+}
+
+char *ByteRingBuffer::writeRegion(std::size_t &contiguous)
+{
+    const std::size_t w = static_cast<std::size_t>(writePos) & mask;
+    const std::size_t toEnd = capacity() - w;
+    const std::size_t avail = freeSpace();
+    contiguous = avail < toEnd ? avail : toEnd;
+    return buf.data() + w;
+}
+
+void ByteRingBuffer::copyOut(std::size_t offset, void *dst, std::size_t n) const
+{
+    const std::size_t start = static_cast<std::size_t>(readPos + offset) & mask;
+    const std::size_t first = capacity() - start;
+    if (n <= first)
+    {
+        memcpy(dst, buf.data() + start, n);
+    }
+    else
+    {
+        memcpy(dst, buf.data() + start, first);
+        memcpy(static_cast<char *>(dst) + first, buf.data(), n - first);
+    }
+}
+
+const char *ByteRingBuffer::contiguous(std::size_t offset, std::size_t n, char *scratch) const
+{
+    const std::size_t start = static_cast<std::size_t>(readPos + offset) & mask;
+    if (start + n <= capacity())    return buf.data() + start;
+    copyOut(offset, scratch, n);
+    return scratch;
+}
+
+bool ByteRingBuffer::matches(std::size_t offset, const char *pattern, std::size_t n) const
+{
+    const std::size_t start = static_cast<std::size_t>(readPos + offset) & mask;
+    if (start + n <= capacity())    return memcmp(buf.data() + start, pattern, n) == 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (buf[(start + i) & mask] != pattern[i])  return false;
+    }
+    return true;
+}
+
+std::size_t ByteRingBuffer::find(unsigned char c, std::size_t from) const
+{
+    const std::size_t total = size();
+    std::size_t offset = from;
+    // 最多分两段连续内存，每段用 memchr（libc 中为向量化实现）查找
+    while (offset < total)
+    {
+        const std::size_t start = static_cast<std::size_t>(readPos + offset) & mask;
+        std::size_t len = capacity() - start;
+        if (len > total - offset)   len = total - offset;
+        const void *hit = memchr(buf.data() + start, c, len);
+        if (hit)    return offset + (static_cast<const char *>(hit) - (buf.data() + start));
+        offset += len;
+    }
+    return total;
+}
+
+FrameSynchronizer::FrameSynchronizer(std::size_t ringCapacity) :
+    ring(ringCapacity),
+    layout(&defaultFrameFormat()),
+    scratch(static_cast<std::size_t>(layout->payloadSize)),
+    skippedBytes(0),
+    badTails(0),
+    resyncs(0),
+    synced(false)
+{
+}
+
+void FrameSynchronizer::setFormat(const FrameFormat &format)
+{
+    layout = &format;
+    scratch.resize(static_cast<std::size_t>(format.payloadSize));
+    reset();
+}
+
+void FrameSynchronizer::reset()
+{
+    ring.clear();
+    synced = false;
+}
+
+FrameSynchronizer::Result FrameSynchronizer::nextFrame(ImuFrame &frame)
+{
+    const FrameFormat &f = *layout;
+    const std::size_t frameSize = static_cast<std::size_t>(f.frameSize);
+    const unsigned char head0 = static_cast<unsigned char>(f.headPattern[0]);
+
+    while (ring.size() >= frameSize)
+    {
+        // 查找帧头首字节，之前的数据都是垃圾
+        std::size_t pos = ring.find(head0, 0);
+        if (pos > 0)
+        {
+            ring.consume(pos);
+            skippedBytes += pos;
+            if (synced) resyncs++;
+            synced = false;
+        }
+        if (ring.size() < frameSize)    break;  // 等待更多数据
+
+        // 检查帧头和尾标 (位置 headSize + payloadSize)
+        if (!ring.matches(0, f.headPattern, static_cast<std::size_t>(f.headSize)) ||
+            !ring.matches(static_cast<std::size_t>(f.headSize + f.payloadSize), f.tailPattern,
+                          static_cast<std::size_t>(f.tailSize)))
+        {
+            if (f.headSize > 1 && ring.at(1) == static_cast<unsigned char>(f.headPattern[1]))  badTails++;
+            // 假帧头，跳过一个字节继续查找
+            ring.consume(1);
+            skippedBytes++;
+            if (synced) resyncs++;
+            synced = false;
+            continue;
+        }
+
+        // 找到完整帧：负载通常在缓冲区中连续，原地解码；跨越回绕点时先复制到暂存区
+        // （解码内核按字节复制，不要求负载对齐）
+        f.decode(ring.contiguous(static_cast<std::size_t>(f.headSize), static_cast<std::size_t>(f.payloadSize),
+                                 scratch.data()), frame);
+        ring.consume(frameSize);
+        synced = true;
+        return FrameReady;
+    }
+    return NeedMoreData;
+}
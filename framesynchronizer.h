@@ -0,0 +1,89 @@
+#ifndef FRAMESYNCHRONIZER_H
+#define FRAMESYNCHRONIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "framelayout.h"
+
+// 预分配的字节环形缓冲区（容量为2的幂）
+// 串口数据直接读入 writeRegion() 返回的连续空间，解析时原地读取，
+// 消费数据只移动读指针，不做 memmove，也不分配内存。
+class ByteRingBuffer
+{
+public:
+    explicit ByteRingBuffer(std::size_t capacityPow2);
+
+    std::size_t capacity() const { return buf.size(); }
+    std::size_t size() const { return static_cast<std::size_t>(writePos - readPos); }
+    std::size_t freeSpace() const { return capacity() - size(); }
+
+    // 写入端：返回当前可连续写入的区域及其长度，写完后调用 commit()
+    char *writeRegion(std::size_t &contiguous);
+    void commit(std::size_t n) { writePos += n; }
+
+    // 读取端：offset 为相对读指针的偏移
+    unsigned char at(std::size_t offset) const
+    {
+        return static_cast<unsigned char>(buf[(readPos + offset) & mask]);
+    }
+    // 从读指针 offset 处复制 n 字节（自动处理回绕）
+    void copyOut(std::size_t offset, void *dst, std::size_t n) const;
+    // 读指针 offset 处 n 字节的连续视图：未跨越回绕点时直接返回缓冲区内的指针，
+    // 否则复制到 scratch（至少 n 字节）并返回 scratch
+    const char *contiguous(std::size_t offset, std::size_t n, char *scratch) const;
+    // 比较读指针 offset 处的 n 字节是否与 pattern 相同
+    bool matches(std::size_t offset, const char *pattern, std::size_t n) const;
+    // 在 [from, size()) 范围内查找字节 c，返回相对偏移，找不到返回 size()
+    std::size_t find(unsigned char c, std::size_t from) const;
+
+    void consume(std::size_t n) { readPos += n; }
+    void clear() { readPos = writePos = 0; }
+
+private:
+    std::vector<char> buf;
+    std::size_t mask;
+    std::uint64_t readPos;    // 单调递增的读位置
+    std::uint64_t writePos;   // 单调递增的写位置
+};
+
+// 帧同步器：按当前帧格式在环形缓冲区中查找 帧头 + 数据 + 尾标，
+// 找到后由该格式的专用内核把负载直接解码到 ImuFrame，每帧不分配、不搬移缓冲区。
+class FrameSynchronizer
+{
+public:
+    enum Result {
+        FrameReady,     // 解析出一帧
+        NeedMoreData    // 缓冲区中没有完整帧
+    };
+
+    explicit FrameSynchronizer(std::size_t ringCapacity = 64 * 1024);
+
+    ByteRingBuffer &buffer() { return ring; }
+
+    // 切换帧格式（同时清空缓冲区），默认为 defaultFrameFormat()
+    void setFormat(const FrameFormat &format);
+    const FrameFormat &format() const { return *layout; }
+
+    // 解析下一帧，成功时 frame 的 imu[] 和 imuCount 被填充
+    Result nextFrame(ImuFrame &frame);
+
+    void reset();
+
+    // 统计：被跳过的垃圾字节数、帧头匹配但尾标不符的次数、
+    // 失步次数（已同步后又开始跳过字节；开始接收时的首次同步不计）
+    std::uint64_t discardedBytes() const { return skippedBytes; }
+    std::uint64_t tailMismatches() const { return badTails; }
+    std::uint64_t resyncEvents() const { return resyncs; }
+
+private:
+    ByteRingBuffer ring;
+    const FrameFormat *layout;        // 当前帧格式
+    std::vector<char> scratch;        // 负载跨越回绕点时的暂存区
+    std::uint64_t skippedBytes;
+    std::uint64_t badTails;
+    std::uint64_t resyncs;
+    bool synced;              // 上一次解析出的是完整帧
+};
+
+#endif // FRAMESYNCHRONIZER_H
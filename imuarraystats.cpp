@@ -0,0 +1,309 @@
+#include "imuarraystats.h"
+#include <cmath>
+#include <cstring>
+#ifdef IMU_HAVE_SSE2_KERNEL
+#include <emmintrin.h>
+#endif
+#if defined(IMU_HAVE_AVX_KERNEL) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+constexpr float ImuArrayStats::DEFAULT_ACCEL_RANGE;
+constexpr float ImuArrayStats::DEFAULT_GYRO_RANGE;
+constexpr float ImuArrayStats::SATURATION_RATIO;
+
+void SampleBlock::load(const ImuFrame *frames, int count)
+{
+    imuCount = frames[0].imuCount;
+    frameCount = count;
+    for (int f = 0; f < count; ++f)
+    {
+        const IMUData *imu = frames[f].imu;
+        for (int i = 0; i < imuCount; ++i)
+        {
+            values[0][i][f] = imu[i].accel[0];
+            values[1][i][f] = imu[i].accel[1];
+            values[2][i][f] = imu[i].accel[2];
+            values[3][i][f] = imu[i].gyro[0];
+            values[4][i][f] = imu[i].gyro[1];
+            values[5][i][f] = imu[i].gyro[2];
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 内核：两遍扫描（先求和/极值，再按均值求平方偏差），方差不会因大的公共偏置损失精度。
+// 稳健均值 = (总和 - 离均值最远的一个读数) / (n - 1)。
+// ---------------------------------------------------------------------------
+
+void blockStatsScalar(const SampleBlock &block, const float *limits, BlockStats &out)
+{
+    const int n = block.imuCount;
+    const float count = static_cast<float>(n);
+    const float others = static_cast<float>(n > 1 ? n - 1 : 1);
+    memset(out.saturatedMask, 0, sizeof(out.saturatedMask));
+
+    for (int c = 0; c < DATA_PER_IMU; ++c)
+    {
+        for (int f = 0; f < block.frameCount; ++f)
+        {
+            float sum = 0.0f;
+            float lo = block.values[c][0][f];
+            float hi = lo;
+            for (int i = 0; i < n; ++i)
+            {
+                const float v = block.values[c][i][f];
+                sum += v;
+                lo = v < lo ? v : lo;
+                hi = v > hi ? v : hi;
+                if (std::fabs(v) >= limits[c])  out.saturatedMask[f] |= 1u << i;
+            }
+            const float mean = sum / count;
+            float squares = 0.0f;
+            for (int i = 0; i < n; ++i)
+            {
+                const float d = block.values[c][i][f] - mean;
+                squares += d * d;
+            }
+            const float farthest = hi - mean > mean - lo ? hi : lo;
+            out.mean[c][f] = mean;
+            out.stdDev[c][f] = std::sqrt(squares / count);
+            out.minimum[c][f] = lo;
+            out.maximum[c][f] = hi;
+            out.robustMean[c][f] = n > 1 ? (sum - farthest) / others : mean;
+        }
+    }
+}
+
+#ifdef IMU_HAVE_SSE2_KERNEL
+void blockStatsSse2(const SampleBlock &block, const float *limits, BlockStats &out)
+{
+    const int n = block.imuCount;
+    const __m128 count = _mm_set1_ps(static_cast<float>(n));
+    const __m128 others = _mm_set1_ps(static_cast<float>(n > 1 ? n - 1 : 1));
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    memset(out.saturatedMask, 0, sizeof(out.saturatedMask));
+
+    for (int c = 0; c < DATA_PER_IMU; ++c)
+    {
+        const __m128 limit = _mm_set1_ps(limits[c]);
+        for (int f = 0; f < block.frameCount; f += 4)
+        {
+            __m128 sum = _mm_setzero_ps();
+            __m128 lo = _mm_load_ps(&block.values[c][0][f]);
+            __m128 hi = lo;
+            for (int i = 0; i < n; ++i)
+            {
+                const __m128 v = _mm_load_ps(&block.values[c][i][f]);
+                sum = _mm_add_ps(sum, v);
+                lo = _mm_min_ps(v, lo);
+                hi = _mm_max_ps(v, hi);
+                const int saturated = _mm_movemask_ps(_mm_cmpge_ps(_mm_and_ps(v, absMask), limit));
+                if (saturated)  markSaturated(out, f, saturated, i);
+            }
+            const __m128 mean = _mm_div_ps(sum, count);
+            __m128 squares = _mm_setzero_ps();
+            for (int i = 0; i < n; ++i)
+            {
+                const __m128 d = _mm_sub_ps(_mm_load_ps(&block.values[c][i][f]), mean);
+                squares = _mm_add_ps(squares, _mm_mul_ps(d, d));
+            }
+            const __m128 highFarther = _mm_cmpgt_ps(_mm_sub_ps(hi, mean), _mm_sub_ps(mean, lo));
+            const __m128 farthest = _mm_or_ps(_mm_and_ps(highFarther, hi), _mm_andnot_ps(highFarther, lo));
+            _mm_store_ps(&out.mean[c][f], mean);
+            _mm_store_ps(&out.stdDev[c][f], _mm_sqrt_ps(_mm_div_ps(squares, count)));
+            _mm_store_ps(&out.minimum[c][f], lo);
+            _mm_store_ps(&out.maximum[c][f], hi);
+            _mm_store_ps(&out.robustMean[c][f], n > 1 ? _mm_div_ps(_mm_sub_ps(sum, farthest), others) : mean);
+        }
+    }
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// 内核选择
+// ---------------------------------------------------------------------------
+
+// CPU 支持 AVX 且操作系统会保存 YMM 寄存器
+static bool cpuHasAvx()
+{
+#if !defined(IMU_HAVE_AVX_KERNEL)
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    return osxsave && avx && (_xgetbv(0) & 6) == 6;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx") != 0;
+#endif
+}
+
+bool ImuArrayStats::isSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case AutoKernel:
+    case ScalarKernel:
+        return true;
+    case Sse2Kernel:
+#ifdef IMU_HAVE_SSE2_KERNEL
+        return true;
+#else
+        return false;
+#endif
+    case AvxKernel:
+        return cpuHasAvx();
+    }
+    return false;
+}
+
+const char *ImuArrayStats::kernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case AutoKernel:    return "auto";
+    case ScalarKernel:  return "scalar";
+    case Sse2Kernel:    return "sse2";
+    case AvxKernel:     return "avx";
+    }
+    return "unknown";
+}
+
+bool ImuArrayStats::setKernel(Kernel kernel)
+{
+    if (kernel == AutoKernel)
+    {
+        kernel = isSupported(AvxKernel) ? AvxKernel : (isSupported(Sse2Kernel) ? Sse2Kernel : ScalarKernel);
+    }
+    if (!isSupported(kernel))   return false;
+
+    switch (kernel)
+    {
+#ifdef IMU_HAVE_AVX_KERNEL
+    case AvxKernel:     run = &blockStatsAvx;       break;
+#endif
+#ifdef IMU_HAVE_SSE2_KERNEL
+    case Sse2Kernel:    run = &blockStatsSse2;      break;
+#endif
+    default:            run = &blockStatsScalar;    break;
+    }
+    active = kernel;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// ImuArrayStats
+// ---------------------------------------------------------------------------
+
+ImuArrayStats::ImuArrayStats()
+{
+    // 内核按整条向量读取，块中未使用的位置也需要是已初始化的数据
+    memset(&block, 0, sizeof(block));
+    memset(&stats, 0, sizeof(stats));
+    active = ScalarKernel;
+    run = &blockStatsScalar;
+    setKernel(AutoKernel);
+    setFullScale(DEFAULT_ACCEL_RANGE, DEFAULT_GYRO_RANGE);
+    stuckLimit = DEFAULT_STUCK_FRAMES;
+    healthChecks = true;
+    reset();
+}
+
+void ImuArrayStats::setFullScale(float accelRange, float gyroRange)
+{
+    accelFullScale = accelRange;
+    gyroFullScale = gyroRange;
+    for (int c = 0; c < 3; ++c)
+    {
+        limits[c] = accelRange * SATURATION_RATIO;
+        limits[3 + c] = gyroRange * SATURATION_RATIO;
+    }
+}
+
+void ImuArrayStats::setStuckFrames(int frames)
+{
+    stuckLimit = frames < 2 ? 2 : frames;
+}
+
+void ImuArrayStats::reset()
+{
+    stateImuCount = 0;
+    // 全1的位模式是 NaN，传感器不会输出，第一帧总被视为“变化”
+    memset(lastBits, 0xff, sizeof(lastBits));
+    memset(runLength, 0, sizeof(runLength));
+}
+
+void ImuArrayStats::process(ImuFrame *frames, std::size_t count)
+{
+    if (count == 0) return;
+    if (frames[0].imuCount != stateImuCount)
+    {
+        reset();
+        stateImuCount = frames[0].imuCount;
+    }
+
+    uint32_t stuckMask[SampleBlock::BLOCK_FRAMES];
+    while (count > 0)
+    {
+        const int chunk = count < static_cast<std::size_t>(SampleBlock::BLOCK_FRAMES)
+                ? static_cast<int>(count) : SampleBlock::BLOCK_FRAMES;
+        block.load(frames, chunk);
+        run(block, limits, stats);
+        if (healthChecks)   detectStuck(stuckMask);
+        store(frames, stuckMask);
+        frames += chunk;
+        count -= static_cast<std::size_t>(chunk);
+    }
+}
+
+void ImuArrayStats::detectStuck(uint32_t *stuckMask)
+{
+    // 逐通道顺序扫描连续帧（SoA 中连续存放），比较位模式：连续 stuckLimit 帧完全相同即标记
+    memset(stuckMask, 0, sizeof(uint32_t) * static_cast<std::size_t>(block.frameCount));
+    for (int c = 0; c < DATA_PER_IMU; ++c)
+    {
+        for (int i = 0; i < block.imuCount; ++i)
+        {
+            const float *row = block.values[c][i];
+            uint32_t last = lastBits[c][i];
+            int length = runLength[c][i];
+            for (int f = 0; f < block.frameCount; ++f)
+            {
+                uint32_t bits;
+                memcpy(&bits, &row[f], sizeof(bits));
+                length = bits != last ? 1 : (length < stuckLimit ? length + 1 : length);
+                last = bits;
+                if (length >= stuckLimit)   stuckMask[f] |= 1u << i;
+            }
+            lastBits[c][i] = last;
+            runLength[c][i] = length;
+        }
+    }
+}
+
+void ImuArrayStats::store(ImuFrame *frames, const uint32_t *stuckMask) const
+{
+    for (int f = 0; f < block.frameCount; ++f)
+    {
+        ImuFrame &frame = frames[f];
+        for (int j = 0; j < 3; ++j)
+        {
+            frame.meanAccel[j] = stats.mean[j][f];
+            frame.meanGyro[j]  = stats.mean[3 + j][f];
+        }
+        for (int c = 0; c < DATA_PER_IMU; ++c)
+        {
+            frame.spread.stdDev[c] = stats.stdDev[c][f];
+            frame.spread.minimum[c] = stats.minimum[c][f];
+            frame.spread.maximum[c] = stats.maximum[c][f];
+            frame.spread.robustMean[c] = stats.robustMean[c][f];
+        }
+        if (!healthChecks)  continue;
+        frame.saturatedMask = stats.saturatedMask[f];
+        frame.stuckMask = stuckMask[f];
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef IMUARRAYSTATS_H
+#define IMUARRAYSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "imuframe.h"
+
+// 结构数组（SoA）样本块：最多 BLOCK_FRAMES 帧，按 通道 → IMU → 帧 存储，
+// 同一通道、同一IMU的连续帧在内存中相邻。跨IMU统计按帧并行：
+// 逐个IMU累加时一条SIMD指令同时处理 4（SSE2）或 8（AVX）帧，不需要水平归约。
+struct SampleBlock
+{
+    static const int BLOCK_FRAMES = 64;     // 8 的倍数，内核按整条向量处理（多出的帧位结果不用）
+
+    int imuCount;
+    int frameCount;
+    // 16字节对齐（C++11 的 new 不保证更大的对齐），AVX 内核使用非对齐加载
+    alignas(16) float values[DATA_PER_IMU][MAX_IMU_COUNT][BLOCK_FRAMES];
+
+    // 从帧数组转置载入（count <= BLOCK_FRAMES，各帧 imuCount 相同）
+    void load(const ImuFrame *frames, int count);
+};
+
+// 一个样本块的逐帧统计结果（同样按通道存储）
+struct BlockStats
+{
+    alignas(16) float mean[DATA_PER_IMU][SampleBlock::BLOCK_FRAMES];
+    alignas(16) float stdDev[DATA_PER_IMU][SampleBlock::BLOCK_FRAMES];
+    alignas(16) float minimum[DATA_PER_IMU][SampleBlock::BLOCK_FRAMES];
+    alignas(16) float maximum[DATA_PER_IMU][SampleBlock::BLOCK_FRAMES];
+    alignas(16) float robustMean[DATA_PER_IMU][SampleBlock::BLOCK_FRAMES];
+    uint32_t saturatedMask[SampleBlock::BLOCK_FRAMES];
+};
+
+// 把 lanes（第 k 位对应第 frame + k 帧）中各帧的第 imu 个饱和位置1（SIMD内核共用，饱和很少发生）
+inline void markSaturated(BlockStats &out, int frame, int lanes, int imu)
+{
+    for (int k = 0; lanes != 0; ++k, lanes >>= 1)
+    {
+        if (lanes & 1) out.saturatedMask[frame + k] |= 1u << imu;
+    }
+}
+
+// 块统计内核：按通道对所有IMU求 均值、标准差、最小/最大、稳健均值，并标记饱和的IMU。
+// limits[c] 为通道 c 的饱和阈值（绝对值）。各内核的累加顺序相同，结果逐位一致。
+typedef void (*BlockStatsKernel)(const SampleBlock &block, const float *limits, BlockStats &out);
+void blockStatsScalar(const SampleBlock &block, const float *limits, BlockStats &out);
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMU_HAVE_SSE2_KERNEL
+void blockStatsSse2(const SampleBlock &block, const float *limits, BlockStats &out);
+#endif
+#ifdef IMU_HAVE_AVX_KERNEL
+void blockStatsAvx(const SampleBlock &block, const float *limits, BlockStats &out);   // imuarraystats_avx.cpp
+#endif
+
+// 跨IMU统计与传感器健康检查（采集线程，逐批调用）：
+// 把一批帧按 BLOCK_FRAMES 帧一块转置为 SampleBlock，用当前CPU支持的最宽SIMD内核计算统计，
+// 结果写回各帧的 meanAccel/meanGyro、spread、saturatedMask、stuckMask。
+// 卡死检测跨批次保存每个通道的上一个读数和连续相同的帧数，数据源切换时需 reset()。
+class ImuArrayStats
+{
+public:
+    enum Kernel {
+        AutoKernel = 0,     // 运行时选择最宽的可用内核
+        ScalarKernel,
+        Sse2Kernel,
+        AvxKernel
+    };
+
+    static const int DEFAULT_STUCK_FRAMES = 50;             // 某通道连续50帧读数完全相同视为卡死
+    static constexpr float DEFAULT_ACCEL_RANGE = 16.0f;     // 加速度量程（g）
+    static constexpr float DEFAULT_GYRO_RANGE = 2000.0f;    // 陀螺仪量程（deg/s）
+    static constexpr float SATURATION_RATIO = 0.999f;       // 读数绝对值达到量程的该比例视为饱和
+
+    ImuArrayStats();
+
+    void setFullScale(float accelRange, float gyroRange);
+    float accelRange() const { return accelFullScale; }
+    float gyroRange() const { return gyroFullScale; }
+    void setStuckFrames(int frames);
+    int stuckFrames() const { return stuckLimit; }
+    // 关闭时只计算统计，保留各帧原有的 saturatedMask/stuckMask（用于已经过滤波、抽取的帧）
+    void setHealthChecks(bool enabled) { healthChecks = enabled; }
+
+    // 不支持的内核返回 false 并保持原内核
+    bool setKernel(Kernel kernel);
+    Kernel kernel() const { return active; }
+    static bool isSupported(Kernel kernel);
+    static const char *kernelName(Kernel kernel);
+
+    // 新的数据源开始：清除卡死检测状态
+    void reset();
+    // 计算一批帧（各帧 imuCount 相同）的统计并写回
+    void process(ImuFrame *frames, std::size_t count);
+
+private:
+    void detectStuck(uint32_t *stuckMask);
+    void store(ImuFrame *frames, const uint32_t *stuckMask) const;
+
+    SampleBlock block;
+    BlockStats stats;
+    Kernel active;
+    BlockStatsKernel run;
+    float accelFullScale;
+    float gyroFullScale;
+    float limits[DATA_PER_IMU];
+    int stuckLimit;
+    bool healthChecks;
+    int stateImuCount;                                  // 卡死检测状态对应的IMU数量
+    uint32_t lastBits[DATA_PER_IMU][MAX_IMU_COUNT];     // 各通道上一帧读数的位模式
+    int runLength[DATA_PER_IMU][MAX_IMU_COUNT];         // 各通道连续相同的帧数
+};
+
+#endif // IMUARRAYSTATS_H
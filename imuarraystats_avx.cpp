@@ -0,0 +1,51 @@
+// AVX 块统计内核：单独编译（qmake AVX_SOURCES，GCC/Clang 加 -mavx），
+// 只在运行时检测到 CPU 和操作系统支持 AVX 后才会被调用。
+#include "imuarraystats.h"
+
+#ifdef IMU_HAVE_AVX_KERNEL
+#include <immintrin.h>
+#include <cstring>
+
+void blockStatsAvx(const SampleBlock &block, const float *limits, BlockStats &out)
+{
+    const int n = block.imuCount;
+    const __m256 count = _mm256_set1_ps(static_cast<float>(n));
+    const __m256 others = _mm256_set1_ps(static_cast<float>(n > 1 ? n - 1 : 1));
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    memset(out.saturatedMask, 0, sizeof(out.saturatedMask));
+
+    for (int c = 0; c < DATA_PER_IMU; ++c)
+    {
+        const __m256 limit = _mm256_set1_ps(limits[c]);
+        for (int f = 0; f < block.frameCount; f += 8)
+        {
+            __m256 sum = _mm256_setzero_ps();
+            __m256 lo = _mm256_loadu_ps(&block.values[c][0][f]);
+            __m256 hi = lo;
+            for (int i = 0; i < n; ++i)
+            {
+                const __m256 v = _mm256_loadu_ps(&block.values[c][i][f]);
+                sum = _mm256_add_ps(sum, v);
+                lo = _mm256_min_ps(v, lo);
+                hi = _mm256_max_ps(v, hi);
+                const int saturated = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_and_ps(v, absMask), limit, _CMP_GE_OQ));
+                if (saturated)  markSaturated(out, f, saturated, i);
+            }
+            const __m256 mean = _mm256_div_ps(sum, count);
+            __m256 squares = _mm256_setzero_ps();
+            for (int i = 0; i < n; ++i)
+            {
+                const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(&block.values[c][i][f]), mean);
+                squares = _mm256_add_ps(squares, _mm256_mul_ps(d, d));
+            }
+            const __m256 highFarther = _mm256_cmp_ps(_mm256_sub_ps(hi, mean), _mm256_sub_ps(mean, lo), _CMP_GT_OQ);
+            const __m256 farthest = _mm256_blendv_ps(lo, hi, highFarther);
+            _mm256_storeu_ps(&out.mean[c][f], mean);
+            _mm256_storeu_ps(&out.stdDev[c][f], _mm256_sqrt_ps(_mm256_div_ps(squares, count)));
+            _mm256_storeu_ps(&out.minimum[c][f], lo);
+            _mm256_storeu_ps(&out.maximum[c][f], hi);
+            _mm256_storeu_ps(&out.robustMean[c][f], n > 1 ? _mm256_div_ps(_mm256_sub_ps(sum, farthest), others) : mean);
+        }
+    }
+}
+#endif
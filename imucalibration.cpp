@@ -0,0 +1,332 @@
+#include "imucalibration.h"
+#include "csvparser.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#ifdef IMU_HAVE_SSE2_KERNEL
+#include <emmintrin.h>
+#endif
+
+static_assert(sizeof(IMUData) == DATA_PER_IMU * sizeof(float), "IMUData is read as a flat float array");
+static_assert(ImuCalibration::SENSOR_COUNT == 2, "CalibrationCoefficients holds accel and gyro");
+static_assert(MAX_IMU_COUNT % 4 == 0, "IMUs are calibrated four at a time");
+
+// 安装误差和刻度因子矩阵接近单位阵；行列式过小说明文件有误（例如列错位），避免把数据压扁
+static const double MIN_DETERMINANT = 0.1;
+
+static const char *skipSpaces(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))    ++p;
+    return p;
+}
+
+// ---------------------------------------------------------------------------
+// 内核
+// ---------------------------------------------------------------------------
+
+static inline void calibrateImu(IMUData &imu, const float (&k)[2][12], unsigned mask)
+{
+    float *v = &imu.accel[0];
+    for (int s = 0; s < ImuCalibration::SENSOR_COUNT; ++s, v += 3)
+    {
+        if (!((mask >> s) & 1)) continue;
+        const float *c = k[s];
+        const float x = v[0], y = v[1], z = v[2];
+        v[0] = c[0] * x + c[1] * y + c[2] * z + c[9];
+        v[1] = c[3] * x + c[4] * y + c[5] * z + c[10];
+        v[2] = c[6] * x + c[7] * y + c[8] * z + c[11];
+    }
+}
+
+void calibrateScalar(ImuFrame *frames, std::size_t count, const CalibrationCoefficients &coefficients, int imuCount)
+{
+    for (std::size_t f = 0; f < count; ++f)
+    {
+        IMUData *imu = frames[f].imu;
+        for (int i = 0; i < imuCount; ++i)
+        {
+            if (coefficients.present[i])    calibrateImu(imu[i], coefficients.k[i], coefficients.present[i]);
+        }
+    }
+}
+
+#ifdef IMU_HAVE_SSE2_KERNEL
+// 一个传感器的3个通道（x、y、z 各为4个IMU）：((k0·x + k1·y) + k2·z) + c，keep 掩码的通道保持原值
+static inline void calibrateLanes(__m128 &x, __m128 &y, __m128 &z, const float (&k)[12][MAX_IMU_COUNT],
+                                  const uint32_t *keep, int i)
+{
+    const __m128 mask = _mm_load_ps(reinterpret_cast<const float *>(keep + i));
+    const __m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(k[0] + i), x),
+                                                       _mm_mul_ps(_mm_load_ps(k[1] + i), y)),
+                                            _mm_mul_ps(_mm_load_ps(k[2] + i), z)), _mm_load_ps(k[9] + i));
+    const __m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(k[3] + i), x),
+                                                       _mm_mul_ps(_mm_load_ps(k[4] + i), y)),
+                                            _mm_mul_ps(_mm_load_ps(k[5] + i), z)), _mm_load_ps(k[10] + i));
+    const __m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(k[6] + i), x),
+                                                       _mm_mul_ps(_mm_load_ps(k[7] + i), y)),
+                                            _mm_mul_ps(_mm_load_ps(k[8] + i), z)), _mm_load_ps(k[11] + i));
+    x = _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, rx));
+    y = _mm_or_ps(_mm_and_ps(mask, y), _mm_andnot_ps(mask, ry));
+    z = _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, rz));
+}
+
+void calibrateSse2(ImuFrame *frames, std::size_t count, const CalibrationCoefficients &coefficients, int imuCount)
+{
+    const int groups = imuCount & ~3;
+    for (std::size_t f = 0; f < count; ++f)
+    {
+        IMUData *imu = frames[f].imu;
+        for (int i = 0; i < groups; i += 4)
+        {
+            // 4个IMU × 6个样本（连续24个 float）转置为 6个通道 × 4个IMU
+            float *p[4] = {&imu[i].accel[0], &imu[i + 1].accel[0], &imu[i + 2].accel[0], &imu[i + 3].accel[0]};
+            __m128 c0 = _mm_loadu_ps(p[0]), c1 = _mm_loadu_ps(p[1]), c2 = _mm_loadu_ps(p[2]), c3 = _mm_loadu_ps(p[3]);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            const __m128 t01 = _mm_unpacklo_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(p[0] + 4)),
+                                               _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(p[1] + 4)));
+            const __m128 t23 = _mm_unpacklo_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(p[2] + 4)),
+                                               _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(p[3] + 4)));
+            __m128 c4 = _mm_movelh_ps(t01, t23);
+            __m128 c5 = _mm_movehl_ps(t23, t01);
+
+            calibrateLanes(c0, c1, c2, coefficients.lanes[0], coefficients.keep[0], i);
+            calibrateLanes(c3, c4, c5, coefficients.lanes[1], coefficients.keep[1], i);
+
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _mm_storeu_ps(p[0], c0);
+            _mm_storeu_ps(p[1], c1);
+            _mm_storeu_ps(p[2], c2);
+            _mm_storeu_ps(p[3], c3);
+            const __m128 lo = _mm_unpacklo_ps(c4, c5);
+            const __m128 hi = _mm_unpackhi_ps(c4, c5);
+            _mm_storel_pi(reinterpret_cast<__m64 *>(p[0] + 4), lo);
+            _mm_storeh_pi(reinterpret_cast<__m64 *>(p[1] + 4), lo);
+            _mm_storel_pi(reinterpret_cast<__m64 *>(p[2] + 4), hi);
+            _mm_storeh_pi(reinterpret_cast<__m64 *>(p[3] + 4), hi);
+        }
+        for (int i = groups; i < imuCount; ++i)
+        {
+            if (coefficients.present[i])    calibrateImu(imu[i], coefficients.k[i], coefficients.present[i]);
+        }
+    }
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// ImuCalibration
+// ---------------------------------------------------------------------------
+
+ImuCalibration::ImuCalibration() :
+    selected(ScalarKernel),
+    run(&calibrateScalar)
+{
+    setKernel(AutoKernel);
+    clear();
+}
+
+bool ImuCalibration::isSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case AutoKernel:
+    case ScalarKernel:
+        return true;
+    case Sse2Kernel:
+#ifdef IMU_HAVE_SSE2_KERNEL
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char *ImuCalibration::kernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case AutoKernel:    return "auto";
+    case ScalarKernel:  return "scalar";
+    case Sse2Kernel:    return "sse2";
+    }
+    return "unknown";
+}
+
+bool ImuCalibration::setKernel(Kernel kernel)
+{
+    if (kernel == AutoKernel)   kernel = isSupported(Sse2Kernel) ? Sse2Kernel : ScalarKernel;
+    if (!isSupported(kernel))   return false;
+
+    switch (kernel)
+    {
+#ifdef IMU_HAVE_SSE2_KERNEL
+    case Sse2Kernel:    run = &calibrateSse2;   break;
+#endif
+    default:            run = &calibrateScalar; break;
+    }
+    selected = kernel;
+    return true;
+}
+
+void ImuCalibration::clear()
+{
+    memset(expanded.present, 0, sizeof(expanded.present));
+    for (int i = 0; i < MAX_IMU_COUNT; ++i)
+    {
+        for (int s = 0; s < SENSOR_COUNT; ++s)
+        {
+            SensorModel &m = models[i][s];
+            for (int k = 0; k < 9; ++k) m.matrix[k] = k % 4 == 0 ? 1.0f : 0.0f;
+            for (int k = 0; k < 3; ++k) m.bias[k] = 0.0f;
+        }
+    }
+    expand();
+}
+
+bool ImuCalibration::parse(const char *text, std::size_t size, std::string *errorString)
+{
+    SensorModel parsed[MAX_IMU_COUNT][SENSOR_COUNT];
+    uint8_t seen[MAX_IMU_COUNT] = {};
+    const char *end = text + size;
+    int lineNumber = 0;
+    char message[160];
+    message[0] = '\0';
+
+    for (const char *line = text; line < end && !message[0]; )
+    {
+        const char *next = CsvParser::nextLine(line, end);
+        const char *lineStop = CsvParser::lineEnd(line, next);
+        ++lineNumber;
+        const char *p = skipSpaces(line, lineStop);
+        line = next;
+        if (p == lineStop || *p == '#')  continue;
+
+        // IMU序号和传感器名
+        int64_t imu = 0;
+        p = CsvParser::parseInt(p, lineStop, imu);
+        if (!p || imu < 1 || imu > MAX_IMU_COUNT)
+        {
+            std::snprintf(message, sizeof(message), "第 %d 行: IMU序号须为 1 ~ %d", lineNumber, MAX_IMU_COUNT);
+            break;
+        }
+        p = skipSpaces(p, lineStop);
+        if (p == lineStop || *p != ',')
+        {
+            std::snprintf(message, sizeof(message), "第 %d 行: 缺少传感器名", lineNumber);
+            break;
+        }
+        p = skipSpaces(p + 1, lineStop);
+        const char *name = p;
+        while (p < lineStop && *p != ',' && *p != ' ' && *p != '\t')    ++p;
+        const std::string sensorName(name, p);
+        int sensor = -1;
+        if (sensorName == "accel")      sensor = Accel;
+        else if (sensorName == "gyro")  sensor = Gyro;
+        if (sensor < 0)
+        {
+            std::snprintf(message, sizeof(message), "第 %d 行: 传感器须为 accel 或 gyro", lineNumber);
+            break;
+        }
+        const int index = static_cast<int>(imu) - 1;
+        if ((seen[index] >> sensor) & 1)
+        {
+            std::snprintf(message, sizeof(message), "第 %d 行: IMU %d 的 %s 重复", lineNumber, index + 1,
+                          sensorName.c_str());
+            break;
+        }
+
+        // 9个矩阵元素和3个零偏
+        float values[12];
+        int count = 0;
+        for (; count < 12; ++count)
+        {
+            p = skipSpaces(p, lineStop);
+            if (p == lineStop || *p != ',') break;
+            p = CsvParser::parseFloat(skipSpaces(p + 1, lineStop), lineStop, values[count]);
+            if (!p || !std::isfinite(values[count]))    break;
+        }
+        if (count < 12 || skipSpaces(p, lineStop) != lineStop)
+        {
+            std::snprintf(message, sizeof(message), "第 %d 行: 须为 imu,sensor 之后12个数值（矩阵9个、零偏3个）",
+                          lineNumber);
+            break;
+        }
+        const float *m = values;
+        const double det = static_cast<double>(m[0]) * (static_cast<double>(m[4]) * m[8] - static_cast<double>(m[5]) * m[7])
+                - static_cast<double>(m[1]) * (static_cast<double>(m[3]) * m[8] - static_cast<double>(m[5]) * m[6])
+                + static_cast<double>(m[2]) * (static_cast<double>(m[3]) * m[7] - static_cast<double>(m[4]) * m[6]);
+        if (!(std::fabs(det) >= MIN_DETERMINANT))
+        {
+            std::snprintf(message, sizeof(message), "第 %d 行: 矩阵接近奇异（行列式 %.3g）", lineNumber, det);
+            break;
+        }
+
+        SensorModel &model = parsed[index][sensor];
+        memcpy(model.matrix, values, sizeof(model.matrix));
+        memcpy(model.bias, values + 9, sizeof(model.bias));
+        seen[index] |= static_cast<uint8_t>(1u << sensor);
+    }
+    if (!message[0])
+    {
+        bool any = false;
+        for (int i = 0; i < MAX_IMU_COUNT; ++i) any = any || seen[i] != 0;
+        if (!any)   std::snprintf(message, sizeof(message), "文件中没有标定数据");
+    }
+    if (message[0])
+    {
+        if (errorString)    *errorString = message;
+        return false;
+    }
+
+    clear();
+    for (int i = 0; i < MAX_IMU_COUNT; ++i)
+    {
+        for (int s = 0; s < SENSOR_COUNT; ++s)
+        {
+            if ((seen[i] >> s) & 1) models[i][s] = parsed[i][s];
+        }
+        expanded.present[i] = seen[i];
+    }
+    expand();
+    return true;
+}
+
+void ImuCalibration::expand()
+{
+    imus = 0;
+    sensorCount = 0;
+    lastImu = 0;
+    for (int i = 0; i < MAX_IMU_COUNT; ++i)
+    {
+        if (expanded.present[i])
+        {
+            ++imus;
+            lastImu = i + 1;
+        }
+        for (int s = 0; s < SENSOR_COUNT; ++s)
+        {
+            if ((expanded.present[i] >> s) & 1) ++sensorCount;
+            // c = -M·b，按 double 计算后取整
+            const SensorModel &m = models[i][s];
+            float *k = expanded.k[i][s];
+            for (int r = 0; r < 3; ++r)
+            {
+                double c = 0;
+                for (int j = 0; j < 3; ++j)
+                {
+                    k[r * 3 + j] = m.matrix[r * 3 + j];
+                    c -= static_cast<double>(m.matrix[r * 3 + j]) * m.bias[j];
+                }
+                k[9 + r] = static_cast<float>(c);
+            }
+            for (int j = 0; j < 12; ++j)    expanded.lanes[s][j][i] = k[j];
+            expanded.keep[s][i] = (expanded.present[i] >> s) & 1 ? 0u : 0xffffffffu;
+        }
+    }
+}
+
+void ImuCalibration::apply(ImuFrame *frames, std::size_t count) const
+{
+    if (sensorCount == 0 || count == 0) return;
+    run(frames, count, expanded, frames[0].imuCount < lastImu ? frames[0].imuCount : lastImu);
+}
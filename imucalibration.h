@@ -0,0 +1,95 @@
+#ifndef IMUCALIBRATION_H
+#define IMUCALIBRATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "imuframe.h"
+#include "imuarraystats.h"     // IMU_HAVE_SSE2_KERNEL
+
+// 展开后的标定系数（加速度计、陀螺仪各12个：M 的9个元素按行，接着 c 的3个元素），
+// 同时按 IMU → 系数（标量内核）和 系数 → IMU（结构数组，SIMD内核一条指令处理4个IMU）存储
+struct CalibrationCoefficients
+{
+    alignas(16) float k[MAX_IMU_COUNT][2][12];
+    alignas(16) float lanes[2][12][MAX_IMU_COUNT];
+    alignas(16) uint32_t keep[2][MAX_IMU_COUNT];   // 没有标定的传感器为全1（保持原值），否则为0
+    uint8_t present[MAX_IMU_COUNT];                 // bit s：传感器 s 有标定
+};
+
+// 校正内核：按系数原地校正一批帧的前 imuCount 个IMU。
+// 没有标定的传感器不做运算（SIMD内核按 keep 掩码选回原值）：单位阵乘上 NaN/Inf 分量会污染其他轴。
+// SSE2 内核每帧把每4个IMU的 6×4 个样本在寄存器中转置为 通道 → IMU，不足4个的IMU按标量处理；
+// 两个内核都按 ((k0·x + k1·y) + k2·z) + c 的顺序先乘后加，结果逐位一致。
+typedef void (*CalibrationKernel)(ImuFrame *frames, std::size_t count, const CalibrationCoefficients &coefficients,
+                                  int imuCount);
+void calibrateScalar(ImuFrame *frames, std::size_t count, const CalibrationCoefficients &coefficients, int imuCount);
+#ifdef IMU_HAVE_SSE2_KERNEL
+void calibrateSse2(ImuFrame *frames, std::size_t count, const CalibrationCoefficients &coefficients, int imuCount);
+#endif
+
+// 各IMU的标定模型：加速度计和陀螺仪分别为 校正值 = M · (原始值 - b)，
+// M 为 3×3 的安装误差/刻度因子矩阵，b 为零偏（g 或 deg/s）。
+// 标定文件为文本，每行一个传感器（# 开头为注释，空行忽略）：
+//   imu,sensor,m11,m12,m13,m21,m22,m23,m31,m32,m33,b1,b2,b3
+// imu 为 1 起的IMU序号，sensor 为 accel 或 gyro；文件中没有的传感器保持原样。
+//
+// 采集线程在保存原始数据之后、跨IMU统计之前按批原地校正（apply），之后的均值、统计、姿态和显示都使用校正后的数据。
+// 系数预先展开为 校正值 = M · 原始值 + c（c = -M·b），每个传感器9次乘加。
+// 与姿态解算相同，所有IMU按结构数组同时校正，SIMD内核一条指令处理4个IMU。
+class ImuCalibration
+{
+public:
+    enum Sensor {
+        Accel = 0,
+        Gyro,
+        SENSOR_COUNT
+    };
+
+    enum Kernel {
+        AutoKernel = 0,         // 运行时选择最宽的可用内核
+        ScalarKernel,
+        Sse2Kernel
+    };
+
+    struct SensorModel {
+        float matrix[9];        // 按行存储
+        float bias[3];
+    };
+
+    ImuCalibration();
+
+    // 解析标定文件的内容（替换当前标定），格式错误时返回 false 并保持原标定
+    bool parse(const char *text, std::size_t size, std::string *errorString);
+    void clear();
+
+    // 至少有一个传感器的标定
+    bool isEnabled() const { return sensorCount > 0; }
+    // 有标定的IMU数和传感器数
+    int imuCount() const { return imus; }
+    int calibratedSensors() const { return sensorCount; }
+    bool hasModel(int imu, Sensor sensor) const { return (expanded.present[imu] >> sensor) & 1; }
+    const SensorModel &model(int imu, Sensor sensor) const { return models[imu][sensor]; }
+
+    // 不支持的内核返回 false 并保持原内核
+    bool setKernel(Kernel kernel);
+    Kernel kernel() const { return selected; }
+    static bool isSupported(Kernel kernel);
+    static const char *kernelName(Kernel kernel);
+
+    // 原地校正一批帧（各帧 imuCount 相同）的前 imuCount 个IMU
+    void apply(ImuFrame *frames, std::size_t count) const;
+
+private:
+    void expand();                          // models → expanded
+
+    SensorModel models[MAX_IMU_COUNT][SENSOR_COUNT];
+    CalibrationCoefficients expanded;
+    int imus;
+    int sensorCount;
+    int lastImu;                            // 有标定的最大IMU序号（1 起），即需要校正的IMU数
+    Kernel selected;
+    CalibrationKernel run;
+};
+
+#endif // IMUCALIBRATION_H
@@ -0,0 +1,302 @@
+#include "imuchart.h"
+#include "recordingview.h"
+#include "attitudefilter.h"
+#include <QPen>
+#include <QFileInfo>
+#include <QDebug>
+#include <cstring>
+#include <cmath>
+
+ImuChart::ImuChart() :
+    imus(DEFAULT_IMU_COUNT),
+    attitude(false),
+    pyramid(DEFAULT_IMU_COUNT * DATA_PER_IMU + 6),
+    source(MEAN_SOURCE),
+    windowSeconds(DEFAULT_WINDOW_SECONDS),
+    dirty(false),
+    recording(nullptr),
+    viewFrom(0),
+    viewTo(0)
+{
+    // 创建图表
+    chartObject = new QChart();
+    chartObject->setAnimationOptions(QChart::NoAnimation);  // 禁用动画提高性能
+
+    // 创建6条曲线（3轴加速度 + 3轴陀螺仪）
+    QString accelNames[3] = {"Accel X", "Accel Y", "Accel Z"};
+    QString gyroNames[3] = {"Gyro X", "Gyro Y", "Gyro Z"};
+    QColor accelColors[3] = {Qt::red, Qt::green, Qt::blue};
+    QColor gyroColors[3] = {Qt::darkRed, Qt::darkGreen, Qt::darkBlue};
+
+    // 初始化加速度曲线（实线）
+    for (int i = 0; i < 3; i++) {
+        accelSeries[i] = new QLineSeries();
+        accelSeries[i]->setName(accelNames[i]);
+        accelSeries[i]->setColor(accelColors[i]);
+        accelSeries[i]->setPen(QPen(accelColors[i], 2, Qt::SolidLine));
+        chartObject->addSeries(accelSeries[i]);
+    }
+
+    // 初始化陀螺仪曲线（虚线）
+    for (int i = 0; i < 3; i++) {
+        gyroSeries[i] = new QLineSeries();
+        gyroSeries[i]->setName(gyroNames[i]);
+        gyroSeries[i]->setColor(gyroColors[i]);
+        gyroSeries[i]->setPen(QPen(gyroColors[i], 2, Qt::DashLine));
+        chartObject->addSeries(gyroSeries[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        series[i] = accelSeries[i];
+        series[3 + i] = gyroSeries[i];
+    }
+
+    // 创建坐标轴
+    axisX = new QValueAxis();
+    axisX->setTitleText("Time (s)");
+    axisX->setRange(0, DEFAULT_WINDOW_SECONDS);  // 显示0-10秒
+    axisX->setTickCount(11);  // 每1秒一个刻度
+    axisX->setLabelFormat("%.1f");
+    chartObject->addAxis(axisX, Qt::AlignBottom);
+
+    // 左Y轴：加速度 (g)
+    QValueAxis *axisYAccel = new QValueAxis();
+    axisYAccel->setTitleText("Accel (g)");
+    axisYAccel->setRange(-2, 2);  // 加速度范围，可根据需要调整
+    chartObject->addAxis(axisYAccel, Qt::AlignLeft);
+
+    // 右Y轴：陀螺仪 (dps)
+    axisYGyro = new QValueAxis();
+    axisYGyro->setTitleText("Gyro (dps)");
+    axisYGyro->setRange(-250, 250);  // 陀螺仪范围，可根据需要调整
+    chartObject->addAxis(axisYGyro, Qt::AlignRight);
+
+    // 将曲线绑定到坐标轴
+    for (int i = 0; i < 3; i++) {
+        accelSeries[i]->attachAxis(axisX);
+        accelSeries[i]->attachAxis(axisYAccel);
+        gyroSeries[i]->attachAxis(axisX);
+        gyroSeries[i]->attachAxis(axisYGyro);
+    }
+
+    // 记录开始时间
+    startTime = QDateTime::currentDateTime();
+    updateTitle();
+}
+
+void ImuChart::append(const ImuFrame &frame)
+{
+    // 计算相对时间（秒），使用帧的解析时刻而不是界面处理时刻
+    const double time = (frame.timestampMs - startTime.toMSecsSinceEpoch()) / 1000.0;
+    float values[MAX_CHANNEL_COUNT];
+    memcpy(values, &frame.imu[0].accel[0], imus * DATA_PER_IMU * sizeof(float));
+    float *mean = values + imus * DATA_PER_IMU;
+    for (int i = 0; i < 3; i++) {
+        mean[i] = frame.meanAccel[i];
+        mean[3 + i] = frame.meanGyro[i];
+    }
+    if (attitude) {
+        // 各IMU的欧拉角；平均姿态为各四元数（与第一个IMU同半球）之和归一化
+        float *euler = mean + 6;
+        float sum[4] = {0, 0, 0, 0};
+        for (int i = 0; i < imus; i++) {
+            const float *q = frame.orientation[i];
+            AttitudeFilter::toEuler(q, euler + i * 3);
+            const float sign = q[0] * frame.orientation[0][0] + q[1] * frame.orientation[0][1]
+                    + q[2] * frame.orientation[0][2] + q[3] * frame.orientation[0][3] < 0 ? -1.0f : 1.0f;
+            for (int k = 0; k < 4; k++) sum[k] += sign * q[k];
+        }
+        const float norm = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2] + sum[3] * sum[3]);
+        if (norm > 0) {
+            for (int k = 0; k < 4; k++) sum[k] /= norm;
+        } else {
+            sum[0] = 1;
+        }
+        AttitudeFilter::toEuler(sum, euler + imus * 3);
+    }
+    pyramid.append(time, values);
+    if (!recording) dirty = true;   // 查看记录时实时数据只写入金字塔
+}
+
+void ImuChart::setImuCount(int count)
+{
+    if (count == imus)  return;
+    imus = count;
+    pyramid = MinMaxPyramid(channelCount());
+    source = MEAN_SOURCE;
+    clear();
+    updateTitle();
+}
+
+void ImuChart::setAttitudeEnabled(bool enabled)
+{
+    if (enabled == attitude)    return;
+    attitude = enabled;
+    pyramid = MinMaxPyramid(channelCount());
+    clear();
+    updateAxes();
+}
+
+void ImuChart::updateAxes()
+{
+    static const char *const GYRO_NAMES[3] = {"Gyro X", "Gyro Y", "Gyro Z"};
+    static const char *const EULER_NAMES[3] = {"Roll", "Pitch", "Yaw"};
+    const bool euler = attitude && !recording;
+    for (int i = 0; i < 3; i++) gyroSeries[i]->setName(euler ? EULER_NAMES[i] : GYRO_NAMES[i]);
+    axisYGyro->setTitleText(euler ? "Attitude (deg)" : "Gyro (dps)");
+    axisYGyro->setRange(euler ? -180 : -250, euler ? 180 : 250);
+}
+
+void ImuChart::setSource(int imuIndex)
+{
+    source = (imuIndex >= 0 && imuIndex < imus) ? imuIndex : MEAN_SOURCE;
+    dirty = true;
+    updateTitle();
+}
+
+void ImuChart::setWindow(double seconds)
+{
+    windowSeconds = seconds;
+    dirty = true;
+    updateTitle();
+    // 查看记录时从当前显示范围的起点开始
+    if (recording)  setViewRange(seconds > 0 ? viewFrom : 0, seconds > 0 ? viewFrom + seconds : recording->duration());
+}
+
+void ImuChart::showRecording(RecordingView *view)
+{
+    recording = view;
+    dirty = true;
+    if (recording)
+    {
+        // 打开后立即显示整个会话（由概览给出），缩放后再按需读取可见的一段
+        viewFrom = 0;
+        viewTo = qMax(recording->duration(), 0.001);
+    }
+    else
+    {
+        // 回到实时数据：去掉记录的曲线，下次刷新时由金字塔重新填充
+        for (int c = 0; c < 6; c++) series[c]->clear();
+        axisX->setRange(0, windowSeconds > 0 ? windowSeconds : DEFAULT_WINDOW_SECONDS);
+    }
+    updateAxes();
+    updateTitle();
+}
+
+void ImuChart::setViewRange(double t0, double t1)
+{
+    if (!recording) return;
+    // 范围不超过记录时长，平移到记录以内；最短10毫秒
+    const double duration = qMax(recording->duration(), 0.001);
+    double span = qBound(qMin(0.01, duration), t1 - t0, duration);
+    if (t0 < 0)                 t0 = 0;
+    if (t0 + span > duration)   t0 = duration - span;
+    if (t0 == viewFrom && t0 + span == viewTo)  return;
+    viewFrom = t0;
+    viewTo = t0 + span;
+    dirty = true;
+    updateTitle();
+}
+
+void ImuChart::updateTitle()
+{
+    QString sourceName = source == MEAN_SOURCE ? QString("IMU Mean") : QString("IMU %1").arg(source + 1);
+    if (recording)
+    {
+        // 记录的文件名和显示范围的UTC时间
+        const QDateTime start = QDateTime::fromMSecsSinceEpoch(recording->startWallClockMs());
+        chartObject->setTitle(QString("%1 - %2 (%3 ~ %4)").arg(sourceName)
+                              .arg(QFileInfo(recording->fileName()).fileName())
+                              .arg(start.addMSecs(qRound64(viewFrom * 1000)).toString("yyyy-MM-dd hh:mm:ss.zzz"))
+                              .arg(start.addMSecs(qRound64(viewTo * 1000)).toString("hh:mm:ss.zzz")));
+        return;
+    }
+    QString windowName;
+    if (windowSeconds <= 0)             windowName = "Whole Session";
+    else if (windowSeconds < 60)        windowName = QString("Last %1 Seconds").arg(windowSeconds);
+    else if (windowSeconds < 3600)      windowName = QString("Last %1 Minutes").arg(windowSeconds / 60);
+    else                                windowName = QString("Last %1 Hours").arg(windowSeconds / 3600);
+    chartObject->setTitle(QString("%1 Data (%2)").arg(sourceName).arg(windowName));
+}
+
+void ImuChart::refresh()
+{
+    if (recording) {
+        refreshRecording();
+        return;
+    }
+    if (!dirty || pyramid.isEmpty()) return;
+    dirty = false;
+
+    const double currentTime = pyramid.lastTime();
+    const double minTime = windowSeconds > 0 ? currentTime - windowSeconds : pyramid.firstTime();
+
+    // 选择窗口内桶数不超过绘图区像素宽度的最细一层（非第0层每个桶输出 min、max 两个点）
+    const int width = qMax(100, static_cast<int>(chartObject->plotArea().width()));
+    const int level = pyramid.selectLevel(minTime, currentTime, static_cast<std::size_t>(width));
+    const int firstChannel = source == MEAN_SOURCE ? imus * DATA_PER_IMU : source * DATA_PER_IMU;
+    // 显示姿态时右轴的3条曲线取欧拉角通道
+    const int eulerChannel = imus * DATA_PER_IMU + 6 + (source == MEAN_SOURCE ? imus : source) * 3;
+
+    // 每条曲线只调用一次 replace()，由 QLineSeries 整体替换数据并只发出一次更新信号
+    // （每次新建缓冲区交给曲线：复用同一个 QVector 会因隐式共享在下次写入时再复制一遍）
+    for (int c = 0; c < 6; c++) {
+        const int channel = attitude && c >= 3 ? eulerChannel + c - 3 : firstChannel + c;
+        const std::size_t n = pyramid.query(level, channel, minTime, currentTime, queryBuffer);
+        QVector<QPointF> points(static_cast<int>(n));
+        QPointF *out = points.data();
+        for (std::size_t k = 0; k < n; k++) {
+            out[k] = QPointF(queryBuffer[k].time, queryBuffer[k].value);
+        }
+        series[c]->replace(points);
+    }
+
+    // 更新X轴范围，实现滚动效果
+    if (windowSeconds <= 0) {
+        axisX->setRange(qMax(0.0, pyramid.firstTime()), qMax(currentTime, 1.0));
+    } else if (currentTime > windowSeconds) {
+        axisX->setRange(currentTime - windowSeconds, currentTime);
+    } else {
+        axisX->setRange(0, windowSeconds);
+    }
+}
+
+void ImuChart::refreshRecording()
+{
+    if (!dirty) return;
+    dirty = false;
+
+    // 与实时显示相同：桶数约等于绘图区像素宽度；范围足够小时逐行原样显示
+    const int width = qMax(100, static_cast<int>(chartObject->plotArea().width()));
+    recording->select(viewFrom, viewTo, static_cast<std::size_t>(width));
+    const int firstChannel = source == MEAN_SOURCE ? imus * DATA_PER_IMU : source * DATA_PER_IMU;
+    for (int c = 0; c < 6; c++) {
+        const std::size_t n = recording->points(firstChannel + c, queryBuffer);
+        QVector<QPointF> points(static_cast<int>(n));
+        QPointF *out = points.data();
+        for (std::size_t k = 0; k < n; k++) {
+            out[k] = QPointF(queryBuffer[k].time, queryBuffer[k].value);
+        }
+        series[c]->replace(points);
+    }
+    axisX->setRange(viewFrom, viewTo);
+}
+
+void ImuChart::clear()
+{
+    pyramid.clear();
+    dirty = recording != nullptr;   // 查看记录时只清除实时数据，曲线照常显示记录
+
+    // 清除6条曲线的所有数据点
+    for (int i = 0; i < 3; i++) {
+        accelSeries[i]->clear();   // 清除加速度曲线
+        gyroSeries[i]->clear();    // 清除陀螺仪曲线
+    }
+
+    // 重置X轴范围到初始状态
+    axisX->setRange(0, windowSeconds > 0 ? windowSeconds : DEFAULT_WINDOW_SECONDS);
+
+    // 重置开始时间，让新的数据从0秒开始
+    startTime = QDateTime::currentDateTime();
+
+    qDebug() << "图表已清除";
+}
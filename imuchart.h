@@ -0,0 +1,98 @@
+#ifndef IMUCHART_H
+#define IMUCHART_H
+
+#include <QtCharts/QChart>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QValueAxis>
+#include <QDateTime>
+#include <QVector>
+#include <QPointF>
+#include <vector>
+#include "imuframe.h"
+#include "minmaxpyramid.h"
+
+class RecordingView;
+
+QT_CHARTS_USE_NAMESPACE
+
+// IMU曲线图：3轴加速度 + 3轴陀螺仪，可选显示所有IMU的均值或单个IMU，
+// 显示窗口可在1秒到整个会话之间切换
+// 从 MainWindow 中独立出来，便于基准测试在无界面环境下单独测量
+//
+// 每帧只写入 min/max 降采样金字塔（不触碰 QLineSeries），所有IMU和均值共 imuCount * 6 + 6 个通道
+// （9 IMU 为60个）；
+// 界面刷新时 refresh() 按窗口长度选择桶数约等于横向像素数的一层，
+// 每条曲线一次 replace()。因此无论窗口多长，每条曲线都只有约一个像素一个桶，
+// 金字塔内存固定（9 IMU 约10MB），与会话时长无关。
+//
+// 查看记录时（showRecording）曲线改由 RecordingView 提供：显示范围由 setViewRange 指定，
+// 实时帧照常写入金字塔，回到实时显示后继续。
+//
+// 帧中带有姿态时（setAttitudeEnabled），金字塔另有各IMU和平均姿态的欧拉角通道，
+// 实时显示时右轴的3条曲线改为横滚/俯仰/航向（度）；记录中没有姿态，查看记录时仍显示陀螺仪。
+class ImuChart
+{
+public:
+    static const int DEFAULT_WINDOW_SECONDS = 10;   // 默认显示最近10秒
+    static const int MEAN_SOURCE = -1;              // 显示所有IMU的均值
+    // 金字塔通道：IMU i 的第 j 个数据为 i * DATA_PER_IMU + j，其后6个为均值；
+    // 显示姿态时再接 IMU i 的横滚/俯仰/航向（imuCount * DATA_PER_IMU + 6 + i * 3 起），最后3个为平均姿态
+    static const int MAX_CHANNEL_COUNT = MAX_IMU_COUNT * (DATA_PER_IMU + 3) + 6 + 3;
+
+    ImuChart();
+
+    QChart *chart() const { return chartObject; }
+
+    // 每帧的IMU数量，改变时按新的通道数重建金字塔（清除已有数据），显示来源回到均值
+    void setImuCount(int count);
+    int imuCount() const { return imus; }
+    // 帧中是否带有姿态（ImuFrame::orientation），改变时重建金字塔（清除已有数据）
+    void setAttitudeEnabled(bool enabled);
+    bool isAttitudeEnabled() const { return attitude; }
+    // 添加一帧（只写入降采样金字塔，不更新曲线）；帧的IMU数量须与 imuCount() 一致
+    void append(const ImuFrame &frame);
+    // 选择显示的数据：MEAN_SOURCE 或 IMU 序号（0 ~ imuCount()-1）
+    void setSource(int imuIndex);
+    // 显示窗口长度（秒），<= 0 表示整个会话
+    void setWindow(double seconds);
+    // 把显示窗口内的数据推送到曲线（每条曲线一次 replace()），没有变化时不做任何事
+    void refresh();
+    // 清除所有曲线，时间从0重新开始
+    void clear();
+
+    // 显示记录（由调用方持有，须在记录关闭前切换回来），nullptr 回到实时数据
+    void showRecording(RecordingView *view);
+    bool isShowingRecording() const { return recording != nullptr; }
+    // 查看记录时的显示范围（秒，记录第一行为0），限制在记录的时长以内
+    void setViewRange(double t0, double t1);
+    double viewStart() const { return viewFrom; }
+    double viewEnd() const { return viewTo; }
+
+private:
+    void updateTitle();
+    void updateAxes();                // 按是否显示姿态设置右轴和曲线名称
+    void refreshRecording();
+    int channelCount() const { return imus * DATA_PER_IMU + 6 + (attitude ? imus * 3 + 3 : 0); }
+
+    int imus;                         // 每帧的IMU数量
+    bool attitude;                    // 金字塔中有姿态通道
+    MinMaxPyramid pyramid;            // 所有通道的降采样金字塔
+    std::vector<MinMaxPyramid::Point> queryBuffer;  // refresh() 的复用缓冲区
+    int source;                       // 当前显示的数据
+    double windowSeconds;             // 当前窗口长度（<= 0 为整个会话）
+    bool dirty;                       // 上次 refresh() 之后是否有新数据或设置变化
+    QLineSeries *series[6];           // accel X/Y/Z, gyro X/Y/Z
+
+    QChart *chartObject;              // 图表对象（由 QChartView 接管所有权）
+    QLineSeries *accelSeries[3];      // 加速度曲线（X,Y,Z）
+    QLineSeries *gyroSeries[3];       // 陀螺仪曲线（X,Y,Z），显示姿态时为横滚/俯仰/航向
+    QValueAxis *axisX;
+    QValueAxis *axisYGyro;            // 右Y轴：陀螺仪（dps）或姿态（度）
+    QDateTime startTime;              // 记录开始时间，用于计算相对时间
+
+    RecordingView *recording;         // 查看中的记录（nullptr 为实时数据）
+    double viewFrom;                  // 查看记录时的显示范围（秒）
+    double viewTo;
+};
+
+#endif // IMUCHART_H
@@ -0,0 +1,51 @@
+#ifndef IMUFRAME_H
+#define IMUFRAME_H
+
+#include <cstdint>
+
+// 数据格式常量（各板卡的帧长和偏移由 framelayout.h 中的 FrameLayout 在编译期推导）
+static const int DEFAULT_IMU_COUNT = 9;   // 默认IMU数量（9 IMU 阵列）
+static const int MAX_IMU_COUNT = 32;      // 支持的最大IMU数量，ImuFrame 按此容量分配
+static const int DATA_PER_IMU = 6;        // 每个IMU的数据量（3轴accel + 3轴gyro）
+static const int FLOAT_SIZE = 4;          // float占4字节
+static const int HEAD_SIZE = 2;           // 帧头2字节
+static const int TAIL_SIZE = 4;           // 尾标4字节
+static const int MAX_DATA_SIZE = MAX_IMU_COUNT * DATA_PER_IMU * FLOAT_SIZE;  // 768字节
+
+// 帧头定义：{0xAA, 0x55}
+static const char HEAD_PATTERN[HEAD_SIZE] = {static_cast<char>(0xAA), static_cast<char>(0x55)};
+// 尾标定义：{0x00, 0x00, 0x80, 0x7f} 对应float的NaN或特定值
+static const char TAIL_PATTERN[TAIL_SIZE] = {0x00, 0x00, static_cast<char>(0x80), 0x7f};
+
+struct IMUData {
+    float accel[3];  // x, y, z (g)
+    float gyro[3];   // x, y, z (deg/s)
+};
+
+// 跨IMU统计：每个通道（accel x/y/z, gyro x/y/z）在本帧所有IMU上的分布
+struct CrossImuStats {
+    float stdDev[DATA_PER_IMU];       // 标准差（总体）
+    float minimum[DATA_PER_IMU];
+    float maximum[DATA_PER_IMU];
+    float robustMean[DATA_PER_IMU];   // 剔除离均值最远的一个IMU后的均值，单个故障IMU不会把它拉偏
+};
+
+// 解析完成的一帧数据，由采集线程产生、界面线程消费
+struct ImuFrame {
+    IMUData imu[MAX_IMU_COUNT];   // 各IMU的原始数据，前 imuCount 个有效
+    int imuCount;                 // 本帧的IMU数量（由帧布局决定）
+    float meanAccel[3];           // 所有IMU加速度均值
+    float meanGyro[3];            // 所有IMU陀螺仪均值
+    CrossImuStats spread;         // 跨IMU统计（采集时计算）
+    float orientation[MAX_IMU_COUNT][4];  // 各IMU的姿态四元数 (w, x, y, z)，开启姿态解算时由采集线程填写
+    uint32_t saturatedMask;       // 本帧读数达到量程的IMU（bit i 对应 imu[i]）
+    uint32_t stuckMask;           // 读数长时间不变、疑似卡死的IMU（bit i 对应 imu[i]）
+    int64_t timestampMs;          // 采样时刻（UTC毫秒），由 monotonicNs 按采集开始时的UTC锚点换算
+    uint64_t sequence;            // 帧序号（含被丢弃的帧，序号跳变即为数据缺口）
+    int64_t monotonicNs;          // 采样时刻（单调时钟纳秒）：帧时钟模型重建的平滑时间戳，已校正晶振漂移
+    int64_t arrivalNs;            // 到达时刻（单调时钟纳秒）：所在批次从串口读出的时刻，未经平滑
+};
+
+static_assert(MAX_IMU_COUNT <= 32, "saturatedMask/stuckMask hold one bit per IMU");
+
+#endif // IMUFRAME_H
@@ -1,10 +1,28 @@
 #include "mainwindow.h"
+#include "metricsserver.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // --metrics-port：在本机提供 Prometheus 监控指标（默认不开启）
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption metricsOption("metrics-port",
+                                     QString("在 127.0.0.1 该端口提供监控指标（常用 %1）").arg(MetricsServer::DEFAULT_PORT),
+                                     "port");
+    parser.addOption(metricsOption);
+    parser.process(a);
+
     MainWindow w;
+    if (parser.isSet(metricsOption))
+    {
+        QString error = w.startMetricsServer(parser.value(metricsOption).toInt());
+        if (!error.isEmpty())   qWarning() << "监控指标服务启动失败:" << error;
+    }
     w.show();
 
     return a.exec();
@@ -1,12 +1,57 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "acquisitionworker.h"
+#include "metricsserver.h"
+#include "recordingreader.h"
+#include "displayformatter.h"
+#include "imuchart.h"
+#include "framelogmodel.h"
+#include "recordingview.h"
+#include "recordinganalyzer.h"
+#include "analysisdialog.h"
+#include <QFileDialog>
+#include <QDir>
+#include <QFileInfo>
+#include <QIntValidator>
+#include <QSharedPointer>
 #include <QtEndian>
 #include <QMessageBox>
-
-// 帧头定义：{0xAA, 0x55}
-const char MainWindow::HEAD_PATTERN[2] = {static_cast<char>(0xAA), static_cast<char>(0x55)};
-// 尾标定义：{0x00, 0x00, 0x80, 0x7f} 对应float的NaN或特定值
-const char MainWindow::TAIL_PATTERN[4] = {0x00, 0x00, static_cast<char>(0x80), 0x7f};
+#include <QSignalBlocker>
+#include <QWheelEvent>
+#include <cmath>
+
+// 分段保存的预设：每段兆字节数（压缩前）或秒数，均为0时不分段
+static const struct {
+    const char *name;
+    int megabytes;
+    int seconds;
+} SEGMENT_PRESETS[] = {
+    {"不分段", 0, 0},
+    {"每10分钟", 0, 600},
+    {"每1小时", 0, 3600},
+    {"每1GB", 1024, 0},
+    {"每4GB", 4096, 0},
+};
+static const int SEGMENT_PRESET_COUNT = sizeof(SEGMENT_PRESETS) / sizeof(SEGMENT_PRESETS[0]);
+
+// 实时信号处理的预设：低通截止频率（Hz，0 不滤波，4阶）、输出帧率（Hz，0 不抽取）、抽取方式、零偏（启动后静止2秒估计）
+static const struct {
+    const char *name;
+    double cutoffHz;
+    double outputHz;
+    DspStage::Decimator decimator;
+    DspStage::BiasMode biasMode;
+} DSP_PRESETS[] = {
+    {"原始数据", 0, 0, DspStage::MovingAverage, DspStage::NoBias},
+    {"去陀螺零偏", 0, 0, DspStage::MovingAverage, DspStage::GyroBias},
+    {"低通20Hz", 20, 0, DspStage::MovingAverage, DspStage::NoBias},
+    {"去零偏+低通20Hz", 20, 0, DspStage::MovingAverage, DspStage::GyroBias},
+    {"去零偏+平均到10Hz", 0, 10, DspStage::MovingAverage, DspStage::GyroBias},
+    {"去零偏+CIC到10Hz", 0, 10, DspStage::CicDecimator, DspStage::GyroBias},
+};
+static const int DSP_PRESET_COUNT = sizeof(DSP_PRESETS) / sizeof(DSP_PRESETS[0]);
+static const int DSP_FILTER_ORDER = 4;
+static const double DSP_BIAS_SECONDS = 2.0;
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -14,17 +59,14 @@ MainWindow::MainWindow(QWidget *parent) :
 {
     ui->setupUi(this);
 
-    serialcheck = new QSerialPort(this);
     isSerialOpen = false;
+    isReplaying = false;
+    recordingView = nullptr;
+    noiseAnalyzer = nullptr;
+    analysisThread = nullptr;
     dataValid = false;
-    totalBytesReceived = 0;
-    validFramesReceived = 0;
-    invalidFramesReceived = 0;
-    actualFrequency = 0;
     totalSaveSeconds = 0;
     remainingSeconds = 0;
-    saveFile = nullptr;
-    fileStream = nullptr;
     isSaving = false;
     autoStopTimer = new QTimer(this);
     connect(autoStopTimer, &QTimer::timeout, this, &MainWindow::onAutoStopTimeout);
@@ -41,13 +83,23 @@ MainWindow::MainWindow(QWidget *parent) :
     scanTimer = new QTimer(this);
     connect(scanTimer, &QTimer::timeout, this, &MainWindow::scanSerialPorts);
     scanTimer->start(2000);
-    // 信号槽连接
-    connect(serialcheck, &QSerialPort::readyRead, this, &MainWindow::onSerialDataReceived);
+
+    // 采集线程：串口和解析器都归工作对象所有，窗口拖动/重绘不会阻塞串口读取
+    acquisitionThread = new QThread(this);
+    acquisitionWorker = new AcquisitionWorker();
+    acquisitionWorker->moveToThread(acquisitionThread);
+    acquisitionThread->start(QThread::HighPriority);
+    metricsThread = nullptr;
+    metricsServer = nullptr;
+    connect(acquisitionWorker, &AcquisitionWorker::replayFinished, this, &MainWindow::onReplayFinished);
+    connect(acquisitionWorker, &AcquisitionWorker::portLost, this, &MainWindow::onPortLost);
+    connect(ui->overload_policy, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onOverloadPolicyChanged);
 
     // 显示更新定时器（10fps，避免界面卡顿）
     QTimer *displayTimer = new QTimer(this);
     connect(displayTimer, &QTimer::timeout, this, &MainWindow::updateDisplay);
-    displayTimer->start(100);
+    displayTimer->start(DATA_INTERVAL_MS);
     // 立即执行一次扫描
     scanSerialPorts();
 
@@ -55,9 +107,43 @@ MainWindow::MainWindow(QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
-    delete ui;
-    if (serialcheck->isOpen())  serialcheck->close();
+    // 指标服务读取工作对象的计数器，先于工作对象停止
+    if (metricsThread)
+    {
+        QMetaObject::invokeMethod(metricsServer, "close", Qt::BlockingQueuedConnection);
+        metricsThread->quit();
+        metricsThread->wait();
+        delete metricsServer;
+    }
     if (isSaving)   stopSaving();
+    QMetaObject::invokeMethod(acquisitionWorker, "stopReplay", Qt::BlockingQueuedConnection);
+    QMetaObject::invokeMethod(acquisitionWorker, "closePort", Qt::BlockingQueuedConnection);
+    acquisitionThread->quit();
+    acquisitionThread->wait();
+    delete acquisitionWorker;
+    delete recordingView;
+    if (noiseAnalyzer)
+    {
+        noiseAnalyzer->cancel();
+        analysisThread->wait();
+        delete noiseAnalyzer;
+    }
+    delete ui;
+}
+
+QString MainWindow::startMetricsServer(int port)
+{
+    if (!metricsThread)
+    {
+        metricsThread = new QThread(this);
+        metricsServer = new MetricsServer(acquisitionWorker);
+        metricsServer->moveToThread(metricsThread);
+        metricsThread->start(QThread::LowPriority);
+    }
+    QString error;
+    QMetaObject::invokeMethod(metricsServer, "listen", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(QString, error), Q_ARG(int, port));
+    return error;
 }
 
 void MainWindow::initUI()
@@ -65,17 +151,61 @@ void MainWindow::initUI()
     ui->serial_port_switch->setIcon(QIcon(":/img/close.png"));
     setWindowIcon(QIcon(":/img/3D_IMUArray.png"));
 
-    // 波特率
-    ui->serial_port_bund->addItem("9600", 9600);
-    ui->serial_port_bund->addItem("115200", 115200);
-    ui->serial_port_bund->addItem("460800", 460800);
-    ui->serial_port_bund->setCurrentIndex(2); // 默认460800
+    // 波特率：常用值，也可直接输入任意波特率（高帧率固件使用 2M/3M 等非标准波特率）
+    const int baudRates[] = {9600, 115200, 230400, 460800, 921600, 1000000, 1500000, 2000000, 3000000};
+    for (int baud : baudRates) ui->serial_port_bund->addItem(QString::number(baud), baud);
+    ui->serial_port_bund->setEditable(true);
+    ui->serial_port_bund->setInsertPolicy(QComboBox::NoInsert);
+    ui->serial_port_bund->setValidator(new QIntValidator(1, 100000000, ui->serial_port_bund));
+    ui->serial_port_bund->setCurrentIndex(ui->serial_port_bund->findData(460800)); // 默认460800
+
+    // 理论帧率
+    ui->frame_rate->setValue(AcquisitionWorker::DEFAULT_FRAME_RATE);
+
+    // 帧格式：按板卡的IMU数量选择（二进制记录回放时按文件头自动选择）
+    for (int i = 0; i < frameFormatCount(); ++i)
+    {
+        const FrameFormat &format = frameFormatAt(i);
+        ui->frame_layout->addItem(QString("%1 (%2字节)").arg(format.name).arg(format.frameSize), format.imuCount);
+    }
+    ui->frame_layout->setCurrentIndex(ui->frame_layout->findData(DEFAULT_IMU_COUNT));
+
+    // 积压过载策略：默认全部解析、全部保存
+    ui->overload_policy->addItem("全部处理", AcquisitionWorker::DrainAll);
+    ui->overload_policy->addItem("丢弃最旧", AcquisitionWorker::DropOldest);
+    ui->overload_policy->addItem("仅显示抽帧", AcquisitionWorker::DecimateDisplay);
+    ui->overload_policy->setCurrentIndex(0);
+
+    // 回放倍速：按录制时间回放，“最快”为不限速（用于测试解析吞吐）
+    ui->replay_speed->addItem("1x", 1.0);
+    ui->replay_speed->addItem("2x", 2.0);
+    ui->replay_speed->addItem("5x", 5.0);
+    ui->replay_speed->addItem("10x", 10.0);
+    ui->replay_speed->addItem("最快", 0.0);
+    ui->replay_speed->setCurrentIndex(0);
+    ui->raw_capture->setChecked(false);
+    ui->raw_capture->setToolTip("打开串口时把收到的原始字节另存为 IMU_Raw_*.bin，可用“回放文件”复现");
 
     ui->serial_port_switch->setText("打开串口");
-    ui->receiveTextEdit->clear();
+
+    // 原始数据区：虚拟化列表，只绘制可见行
+    frameLog = new FrameLogModel(FrameLogModel::DEFAULT_CAPACITY, this);
+    drawArrivals.reserve(AcquisitionWorker::FrameQueue::capacity());
+    ui->receiveView->setModel(frameLog);
+    ui->receiveView->setUniformItemSizes(true);
+    ui->receiveView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
     ui->receiveTextEdit_str->clear();
     ui->savedata->setText("开始保存");
     ui->savedata->setEnabled(false);  // 串口未打开时禁用保存按钮
+    // 保存格式：二进制为原样记录，CSV可事后由“导出CSV”生成
+    ui->save_format->addItem("CSV", AcquisitionWorker::CsvFormat);
+    ui->save_format->addItem("二进制(.imu)", AcquisitionWorker::BinaryFormat);
+    ui->save_format->addItem("压缩二进制(.imuz)", AcquisitionWorker::CompressedFormat);
+    ui->save_format->setCurrentIndex(0);
+    // 分段保存：长时间记录切成多个文件，异常退出只影响正在写的一段
+    for (int i = 0; i < SEGMENT_PRESET_COUNT; ++i)  ui->save_segment->addItem(SEGMENT_PRESETS[i].name, i);
+    ui->save_segment->setCurrentIndex(0);
     ui->checkBox_times->setChecked(false);
     ui->save_total_times->setText("0");
     ui->clear_data->setText("清除接收");
@@ -85,74 +215,45 @@ void MainWindow::initUI()
 
 void MainWindow::initCharts()
 {
-    // 创建图表
-    chart = new QChart();
-    chart->setTitle("IMU Mean Data (Last 10 Seconds)");
-    chart->setAnimationOptions(QChart::NoAnimation);  // 禁用动画提高性能
-
-    // 创建6条曲线（3轴加速度 + 3轴陀螺仪）
-    QString accelNames[3] = {"Accel X", "Accel Y", "Accel Z"};
-    QString gyroNames[3] = {"Gyro X", "Gyro Y", "Gyro Z"};
-    QColor accelColors[3] = {Qt::red, Qt::green, Qt::blue};
-    QColor gyroColors[3] = {Qt::darkRed, Qt::darkGreen, Qt::darkBlue};
-
-    // 初始化加速度曲线（实线）
-    for (int i = 0; i < 3; i++) {
-        accelSeries[i] = new QLineSeries();
-        accelSeries[i]->setName(accelNames[i]);
-        accelSeries[i]->setColor(accelColors[i]);
-        accelSeries[i]->setPen(QPen(accelColors[i], 2, Qt::SolidLine));
-        chart->addSeries(accelSeries[i]);
-    }
-
-    // 初始化陀螺仪曲线（虚线）
-    for (int i = 0; i < 3; i++) {
-        gyroSeries[i] = new QLineSeries();
-        gyroSeries[i]->setName(gyroNames[i]);
-        gyroSeries[i]->setColor(gyroColors[i]);
-        gyroSeries[i]->setPen(QPen(gyroColors[i], 2, Qt::DashLine));
-        chart->addSeries(gyroSeries[i]);
-    }
-
-    // 创建坐标轴
-    QValueAxis *axisX = new QValueAxis();
-    axisX->setTitleText("Time (s)");
-    axisX->setRange(0, MAX_DISPLAY_SECONDS);  // 显示0-10秒
-    axisX->setTickCount(11);  // 每1秒一个刻度
-    axisX->setLabelFormat("%.1f");
-    chart->addAxis(axisX, Qt::AlignBottom);
-
-    // 左Y轴：加速度 (g)
-    QValueAxis *axisYAccel = new QValueAxis();
-    axisYAccel->setTitleText("Accel (g)");
-    axisYAccel->setRange(-2, 2);  // 加速度范围，可根据需要调整
-    chart->addAxis(axisYAccel, Qt::AlignLeft);
-
-    // 右Y轴：陀螺仪 (dps)
-    QValueAxis *axisYGyro = new QValueAxis();
-    axisYGyro->setTitleText("Gyro (dps)");
-    axisYGyro->setRange(-250, 250);  // 陀螺仪范围，可根据需要调整
-    chart->addAxis(axisYGyro, Qt::AlignRight);
-
-    // 将曲线绑定到坐标轴
-    for (int i = 0; i < 3; i++) {
-        accelSeries[i]->attachAxis(axisX);
-        accelSeries[i]->attachAxis(axisYAccel);
-        gyroSeries[i]->attachAxis(axisX);
-        gyroSeries[i]->attachAxis(axisYGyro);
-    }
-
     // 创建图表视图并设置到graphicsView
-    chartView = new QChartView(chart);
+    imuChart = new ImuChart();
+    chartView = new QChartView(imuChart->chart());
     chartView->setRenderHint(QPainter::Antialiasing);
 
     // 将chartView添加到graphicsView中
     QVBoxLayout *layout = new QVBoxLayout(ui->graphicsView);
     layout->setContentsMargins(0, 0, 0, 0);
     layout->addWidget(chartView);
+    chartView->viewport()->installEventFilter(this);
 
-    // 记录开始时间
-    startTime = QDateTime::currentDateTime();
+    // 记录查看：时间滚动条只在查看记录时显示
+    ui->recording_seek->hide();
+    connect(ui->recording_seek, &QScrollBar::valueChanged, this, &MainWindow::onRecordingSeek);
+
+    // 曲线数据来源：均值或单个IMU
+    ui->chart_source->addItem("均值", ImuChart::MEAN_SOURCE);
+    for (int i = 0; i < imuChart->imuCount(); ++i)
+    {
+        ui->chart_source->addItem(QString("IMU %1").arg(i + 1), i);
+    }
+    // 显示窗口：1秒到整个会话
+    ui->chart_window->addItem("1秒", 1);
+    ui->chart_window->addItem("10秒", 10);
+    ui->chart_window->addItem("1分钟", 60);
+    ui->chart_window->addItem("10分钟", 600);
+    ui->chart_window->addItem("1小时", 3600);
+    ui->chart_window->addItem("全部", 0);
+    ui->chart_window->setCurrentIndex(1);
+    connect(ui->chart_source, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onChartSourceChanged);
+    connect(ui->chart_window, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onChartWindowChanged);
+
+    // 实时信号处理：默认显示原始数据
+    for (int i = 0; i < DSP_PRESET_COUNT; ++i) ui->dsp_preset->addItem(DSP_PRESETS[i].name, i);
+    ui->dsp_preset->setCurrentIndex(0);
+    connect(ui->dsp_preset, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onDspPresetChanged);
 }
 
 void MainWindow::scanSerialPorts()
@@ -179,7 +280,7 @@ void MainWindow::scanSerialPorts()
         return;
     }
     // 如果串口已经打开，且突然消失了（例如被拔掉），则自动关闭
-    if (serialcheck->isOpen() && !checkPortAvailable(serialcheck->portName()))
+    if (isSerialOpen && !checkPortAvailable(openedPortName))
     {
         on_serial_port_switch_clicked(); // 触发关闭逻辑
         qDebug() << "设备已拔出";
@@ -210,179 +311,68 @@ bool MainWindow::checkPortAvailable(const QString &portName)
     return false;
 }
 
-int MainWindow::parseReceivedData()
+void MainWindow::consumeFrames()
 {
-    // 数据不足，无法开始查找
-    if (receiveBuffer.size() < FRAME_SIZE)
-    {
-        return 1; // 需要更多数据
-    }
-
-    // 滑动窗口查找帧头+尾标的完整帧
-    int searchLimit = receiveBuffer.size() - HEAD_SIZE;
-
-    for (int i = 0; i <= searchLimit; ++i)
+    // 取出采集线程产生的所有新帧，界面按自己的刷新节奏处理
+    AcquisitionWorker::FrameQueue *queue = acquisitionWorker->frameQueue();
+    ImuFrame frame;
+    while (queue->pop(frame))
     {
-        // 检查帧头 (位置i)
-        if (memcmp(receiveBuffer.constData() + i, HEAD_PATTERN, HEAD_SIZE) != 0)    continue;// 不是帧头，继续查找
-        // 找到帧头，检查后面是否有足够的数据组成完整帧
-        if (i + FRAME_SIZE > receiveBuffer.size())
-        {
-            // 数据不够，保留从帧头开始的数据，等待更多数据
-            if (i > 0)  receiveBuffer.remove(0, i); // 移除帧头之前的垃圾数据
-            return 1; // 需要更多数据
-        }
-
-        // 检查尾标 (位置 i + HEAD_SIZE + DATA_SIZE)
-        int tailPos = i + HEAD_SIZE + DATA_SIZE;
-        if (memcmp(receiveBuffer.constData() + tailPos, TAIL_PATTERN, TAIL_SIZE) != 0) continue;
-
-        // 找到完整帧：帧头 + 数据 + 尾标 都匹配
-        int dataStart = i + HEAD_SIZE; // 数据起始位置 = 帧头位置 + 2
-
-        // 安全读取数据（避免内存对齐问题）
-        float floatData[IMU_COUNT * DATA_PER_IMU];
-        memcpy(floatData, receiveBuffer.constData() + dataStart, sizeof(floatData));
-        // 计算9个IMU的均值
-        float meanAccel[3] = {0.0f, 0.0f, 0.0f};
-        float meanGyro[3] = {0.0f, 0.0f, 0.0f};
-
-        for (int k = 0; k < IMU_COUNT; ++k)
-        {
-            imuData[k].accel[0] = floatData[k * 6 + 0];
-            imuData[k].accel[1] = floatData[k * 6 + 1];
-            imuData[k].accel[2] = floatData[k * 6 + 2];
-            imuData[k].gyro[0]  = floatData[k * 6 + 3];
-            imuData[k].gyro[1]  = floatData[k * 6 + 4];
-            imuData[k].gyro[2]  = floatData[k * 6 + 5];
-
-            meanAccel[0] += imuData[k].accel[0];
-            meanAccel[1] += imuData[k].accel[1];
-            meanAccel[2] += imuData[k].accel[2];
-            meanGyro[0]  += imuData[k].gyro[0];
-            meanGyro[1]  += imuData[k].gyro[1];
-            meanGyro[2]  += imuData[k].gyro[2];
-        }
-        // 计算均值
-        for (int j = 0; j < 3; ++j)
-        {
-            meanAccel[j] /= IMU_COUNT;
-            meanGyro[j]  /= IMU_COUNT;
-        }
+        // 数据源的帧格式改变（切换板卡或回放其他IMU数量的记录）
+        if (frame.imuCount != imuChart->imuCount()) setChartImuCount(frame.imuCount);
+        latestFrame = frame;
         dataValid = true;
 
         // === 更新图表 ===
-        memcpy(lastMeanAccel, meanAccel, sizeof(float)*3);
-        memcpy(lastMeanGyro, meanGyro, sizeof(float)*3);
-        chartUpdateCounter++;
-        if (chartUpdateCounter >= Chart_FPS)
-        {
-            updateChart(lastMeanAccel, lastMeanGyro);  // 使用累积的数据
-            chartUpdateCounter = 0;
-        }
-//        updateChart(meanAccel, meanGyro);
-
-        // === 保存数据到文件 ===
-        saveDataToFile();
-
-        // 计算实际频率
-
-        QDateTime now = QDateTime::currentDateTime();
-        if (lastFrameTime.isValid())
-        {
-            double delta = lastFrameTime.msecsTo(now);
-            if (delta > 0) actualFrequency = 1000.0 / delta;
-        }
-        lastFrameTime = now;
-        framesSinceLastDisplay++;  // 计数帧数
-        // === 显示数据到UI ===
-        // 1. 构建当前帧的完整数据字符串（9个IMU的所有数据）
-
-        // UI更新
-        frameCounter++;
+        // 每帧都写入图表的降采样金字塔（完整帧率），曲线在本次刷新结束时统一更新
+        imuChart->append(frame);
+        drawArrivals.push_back(frame.arrivalNs);
 
-        QString frameData;
-        for (int idx = 0; idx < IMU_COUNT; ++idx)
-        {
-            frameData += QString("IMU%1:%2,%3,%4,%5,%6,%7;")
-                        .arg(idx + 1)
-                        .arg(imuData[idx].accel[0], 0, 'f', 4)
-                        .arg(imuData[idx].accel[1], 0, 'f', 4)
-                        .arg(imuData[idx].accel[2], 0, 'f', 4)
-                        .arg(imuData[idx].gyro[0], 0, 'f', 4)
-                        .arg(imuData[idx].gyro[1], 0, 'f', 4)
-                        .arg(imuData[idx].gyro[2], 0, 'f', 4);
-        }
-        frameData += "\r\n";  // 帧结束标记
-
-        pendingDisplayText += frameData;
-
-        if (frameCounter >= UI_UPDATE_INTERVAL || pendingDisplayText.size() > 1000)
-        {
-            if (ui->receiveTextEdit)
-            {
-                ui->receiveTextEdit->insertPlainText(pendingDisplayText);
-                pendingDisplayText.clear();
-
-                QTextCursor cursor = ui->receiveTextEdit->textCursor();
-                cursor.movePosition(QTextCursor::End);
-                ui->receiveTextEdit->setTextCursor(cursor);
-
-                if (ui->receiveTextEdit->document()->lineCount() > 1000)
-                {
-                    QTextCursor cleanupCursor(ui->receiveTextEdit->document());
-                    cleanupCursor.movePosition(QTextCursor::Start);
-                    cleanupCursor.select(QTextCursor::BlockUnderCursor);
-                    cleanupCursor.removeSelectedText();
-                }
-            }
+        // === 原始数据区 ===
+        // 只把帧写入固定容量的环形缓冲区，文本在行可见并绘制时才格式化
+        frameLog->append(frame);
+    }
 
-            if (ui->receiveTextEdit_str)
-            {
-                QString meanData = QString("Mean:%1,%2,%3,%4,%5,%6")
-                            .arg(meanAccel[0], 0, 'f', 4)
-                            .arg(meanAccel[1], 0, 'f', 4)
-                            .arg(meanAccel[2], 0, 'f', 4)
-                            .arg(meanGyro[0], 0, 'f', 4)
-                            .arg(meanGyro[1], 0, 'f', 4)
-                            .arg(meanGyro[2], 0, 'f', 4);
-                ui->receiveTextEdit_str->setPlainText(meanData);
-            }
+    // 每次刷新统一通知视图一次；停在底部时自动滚动到最新一帧
+    QScrollBar *scrollBar = ui->receiveView->verticalScrollBar();
+    const bool atBottom = scrollBar->value() == scrollBar->maximum();
+    frameLog->commit();
+    if (atBottom)   ui->receiveView->scrollToBottom();
 
-            frameCounter = 0;
-        }
-        // 移除完整帧（包括帧头、数据、尾标）
-        receiveBuffer.remove(0, i + FRAME_SIZE);
-        return 0;  // 成功解析
-    }
-    // 没找到任何完整帧，保留最后 (FRAME_SIZE-1) 字节，其余丢弃
-    if (receiveBuffer.size() > FRAME_SIZE - 1)
+    if (dataValid && ui->receiveTextEdit_str)
     {
-        int keep = FRAME_SIZE - 1;
-        QByteArray temp = receiveBuffer.right(keep);
-        receiveBuffer = temp;
+        ui->receiveTextEdit_str->setPlainText(DisplayFormatter::meanLine(latestFrame));
     }
-    return 1; // 需要更多数据
 }
 
 void MainWindow::startSaving()
 {
-    QString fileName = generateFileName();
-    saveFile = new QFile(fileName);
-    if (!saveFile->open(QIODevice::WriteOnly | QIODevice::Text))
+    int format = ui->save_format->currentData().toInt();
+    const int preset = ui->save_segment->currentData().toInt();
+    QMetaObject::invokeMethod(acquisitionWorker, "setSegmentPolicy", Qt::BlockingQueuedConnection,
+                              Q_ARG(int, SEGMENT_PRESETS[preset].megabytes), Q_ARG(int, SEGMENT_PRESETS[preset].seconds));
+    const char *extension = "csv";
+    if (format == AcquisitionWorker::BinaryFormat)          extension = "imu";
+    else if (format == AcquisitionWorker::CompressedFormat) extension = "imuz";
+    QString fileName = generateFileName(extension);
+    // 文件在采集线程中打开和写入
+    QString error;
+    QMetaObject::invokeMethod(acquisitionWorker, "startSaving", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(QString, error), Q_ARG(QString, fileName), Q_ARG(int, format));
+    if (!error.isEmpty())
     {
         QMessageBox::critical(this, "错误",
-                   QString("无法创建文件: %1").arg(saveFile->errorString()));
-        delete saveFile;
-        saveFile = nullptr;
+                   QString("无法创建文件: %1").arg(error));
         return;
     }
-
-    fileStream = new QTextStream(saveFile);
-    // 设置编码为UTF-8
-    fileStream->setCodec(QTextCodec::codecForName("UTF-8"));
     isSaving = true;
     ui->savedata->setText("停止保存");
+    ui->save_format->setEnabled(false);
+    ui->save_segment->setEnabled(false);
+    // 是否另存处理后的数据和姿态在开始保存时决定，保存期间不能更换标定
+    ui->dsp_preset->setEnabled(false);
+    ui->load_calibration->setEnabled(false);
+    ui->attitude->setEnabled(false);
 
     // 检查是否需要自动停止
     if (ui->checkBox_times->isChecked())
@@ -416,64 +406,29 @@ void MainWindow::stopSaving()
         totalSaveSeconds = 0;  // 重置
     }
 
-    if (fileStream)
-    {
-        fileStream->flush();
-        delete fileStream;
-        fileStream = nullptr;
-    }
-    if(saveFile)
-    {
-        saveFile->close();
-        delete saveFile;
-        saveFile = nullptr;
-    }
+    QMetaObject::invokeMethod(acquisitionWorker, "stopSaving", Qt::BlockingQueuedConnection);
     isSaving = false;
     ui->savedata->setText("开始保存");
+    ui->save_format->setEnabled(true);
+    ui->save_segment->setEnabled(true);
+    ui->dsp_preset->setEnabled(true);
+    ui->load_calibration->setEnabled(true);
+    ui->attitude->setEnabled(true);
     qDebug() << "停止保存数据";
 }
 
-QString MainWindow::generateFileName()
+QString MainWindow::generateFileName(const QString &suffix)
 {
     // 获取桌面路径
     QString desktopPath = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
-    // 生成文件名：年月日_时分.csv（精确到分钟）
-    QString dateTimeStr = QDateTime::currentDateTime().toString("yyyyMMdd_hhmm");
-    QString fileName = QString("%1/IMU_Data_%2.csv").arg(desktopPath).arg(dateTimeStr);
-    // 如果文件已存在，添加秒数区分
-    if (QFile::exists(fileName))
-    {
-        dateTimeStr = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
-        fileName = QString("%1/IMU_Data_%2.csv").arg(desktopPath).arg(dateTimeStr);
-    }
+    // 生成文件名：年月日_时分秒.csv，同一秒内重复时加序号
+    QString baseName = QString("%1/IMU_Data_%2").arg(desktopPath)
+            .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+    QString fileName = QString("%1.%2").arg(baseName).arg(suffix);
+    for (int n = 2; QFile::exists(fileName); ++n)   fileName = QString("%1_%2.%3").arg(baseName).arg(n).arg(suffix);
     return fileName;
 }
 
-void MainWindow::saveDataToFile()
-{
-    if (!isSaving || !fileStream || !dataValid) return;
-    // 获取当前时间戳（精确到毫秒）
-    qint64 timestamp = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
-
-    // 构建CSV行
-    QString line = QString::number(timestamp);
-    // 构建CSV行：时间戳 + 9个IMU的数据（每个IMU 6个值）
-    for (int i = 0; i < IMU_COUNT; ++i)
-    {
-        // 添加accel和gyro数据，用逗号分隔
-        line += QString(",%1,%2,%3,%4,%5,%6")
-                .arg(imuData[i].accel[0], 0, 'f', 6)  // 提高精度到6位小数
-                .arg(imuData[i].accel[1], 0, 'f', 6)
-                .arg(imuData[i].accel[2], 0, 'f', 6)
-                .arg(imuData[i].gyro[0], 0, 'f', 6)
-                .arg(imuData[i].gyro[1], 0, 'f', 6)
-                .arg(imuData[i].gyro[2], 0, 'f', 6);
-    }
-    *fileStream << line << "\n";
-    // 每100帧刷新一次，提高性能
-    if (validFramesReceived % 100 == 0) fileStream->flush();
-}
-
 void MainWindow::updateCountdownDisplay()
 {
     remainingSeconds--;
@@ -491,72 +446,9 @@ void MainWindow::updateCountdownDisplay()
     }
 }
 
-void MainWindow::updateChart(float meanAccel[3], float meanGyro[3])
-{
-    // 计算相对时间（秒）
-    qreal currentTime = startTime.msecsTo(QDateTime::currentDateTime()) / 1000.0;
-
-    // 添加数据点到各条曲线
-    for (int i = 0; i < 3; i++) {
-        accelSeries[i]->append(currentTime, meanAccel[i]);
-        gyroSeries[i]->append(currentTime, meanGyro[i]);
-    }
-
-    // 移除超过10秒的旧数据
-    qreal minTime = currentTime - MAX_DISPLAY_SECONDS;
-    for (int i = 0; i < 3; i++) {
-        // 获取并清理加速度数据
-        QVector<QPointF> accelPoints = accelSeries[i]->pointsVector();
-        int removeCount = 0;
-        for (const QPointF &point : accelPoints) {
-            if (point.x() < minTime) {
-                removeCount++;
-            } else {
-                break;  // 数据是按时间顺序的，找到一个不用的后面的都不用
-            }
-        }
-        for (int j = 0; j < removeCount; j++) {
-            accelSeries[i]->remove(0);
-        }
-
-        // 获取并清理陀螺仪数据
-        QVector<QPointF> gyroPoints = gyroSeries[i]->pointsVector();
-        removeCount = 0;
-        for (const QPointF &point : gyroPoints) {
-            if (point.x() < minTime) {
-                removeCount++;
-            } else {
-                break;
-            }
-        }
-        for (int j = 0; j < removeCount; j++) {
-            gyroSeries[i]->remove(0);
-        }
-    }
-
-    // 更新X轴范围，实现滚动效果
-    if (currentTime > MAX_DISPLAY_SECONDS) {
-        chart->axisX()->setRange(currentTime - MAX_DISPLAY_SECONDS, currentTime);
-    } else {
-        chart->axisX()->setRange(0, MAX_DISPLAY_SECONDS);
-    }
-}
-
 void MainWindow::clearCharts()
 {
-    // 清除6条曲线的所有数据点
-    for (int i = 0; i < 3; i++) {
-        accelSeries[i]->clear();   // 清除加速度曲线
-        gyroSeries[i]->clear();    // 清除陀螺仪曲线
-    }
-
-    // 重置X轴范围到初始状态（0-10秒）
-    chart->axisX()->setRange(0, MAX_DISPLAY_SECONDS);
-
-    // 重置开始时间，让新的数据从0秒开始
-    startTime = QDateTime::currentDateTime();
-
-    qDebug() << "图表已清除";
+    imuChart->clear();
 }
 
 void MainWindow::on_serial_port_switch_clicked()
@@ -564,10 +456,7 @@ void MainWindow::on_serial_port_switch_clicked()
     if (isSerialOpen)
     {
         // 关闭串口
-        if (serialcheck->isOpen())
-        {
-            serialcheck->close();
-        }
+        QMetaObject::invokeMethod(acquisitionWorker, "closePort", Qt::BlockingQueuedConnection);
         isSerialOpen = false;
 
         dataValid = false;
@@ -576,6 +465,11 @@ void MainWindow::on_serial_port_switch_clicked()
         ui->serial_port_switch->setIcon(QIcon(":/img/close.png"));
         ui->serial_port_com->setEnabled(true);
         ui->serial_port_bund->setEnabled(true);
+        ui->frame_layout->setEnabled(true);
+        ui->frame_rate->setEnabled(true);
+        ui->raw_capture->setEnabled(true);
+        ui->replay_file->setEnabled(true);
+        ui->open_recording->setEnabled(true);
 
         // 串口关闭时，如果正在保存则停止保存，并禁用保存按钮
         if (isSaving)   stopSaving();
@@ -585,139 +479,526 @@ void MainWindow::on_serial_port_switch_clicked()
     }
     else
     {
-        // 打开串口
-        serialcheck->setPortName(ui->serial_port_com->currentText());
+        // 打开串口（在采集线程中完成，串口对象归采集线程所有）
+        QString portName = ui->serial_port_com->currentText();
         // 设置波特率
-        qint32 baudRate = ui->serial_port_bund->currentData().toInt();
-        serialcheck->setBaudRate(baudRate);
-
-        // --- 以下是程序内部固定设置的参数 ---
-        serialcheck->setDataBits(QSerialPort::Data8);      // 数据位：8
-        serialcheck->setStopBits(QSerialPort::OneStop);    // 停止位：1
-        serialcheck->setParity(QSerialPort::NoParity);     // 校验位：无
-        serialcheck->setFlowControl(QSerialPort::NoFlowControl); // 流控制：无
-        // ------------------------------------
-        if (serialcheck->open(QIODevice::ReadWrite))
+        // 可编辑：以输入的文本为准
+        qint32 baudRate = ui->serial_port_bund->currentText().toInt();
+        QString error = selectFrameFormat();
+        if (error.isEmpty())
+        {
+            QMetaObject::invokeMethod(acquisitionWorker, "openPort", Qt::BlockingQueuedConnection,
+                                      Q_RETURN_ARG(QString, error),
+                                      Q_ARG(QString, portName), Q_ARG(int, baudRate));
+        }
+        if (error.isEmpty())
         {
             isSerialOpen = true;
+            openedPortName = portName;
             ui->serial_port_switch->setText("关闭串口");
             ui->serial_port_switch->setIcon(QIcon(":/img/open.png"));
             ui->serial_port_com->setEnabled(false);
             ui->serial_port_bund->setEnabled(false);
+            ui->frame_layout->setEnabled(false);
+            ui->frame_rate->setEnabled(false);
+            ui->raw_capture->setEnabled(false);
+            ui->replay_file->setEnabled(false);
+            ui->open_recording->setEnabled(false);
 
             ui->savedata->setEnabled(true);  // 串口打开后启用保存按钮
 
+            // 原始字节录制失败不影响正常采集
+            if (ui->raw_capture->isChecked())
+            {
+                QString rawFile = QString("%1/IMU_Raw_%2.bin")
+                        .arg(QStandardPaths::writableLocation(QStandardPaths::DesktopLocation))
+                        .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+                QString rawError;
+                QMetaObject::invokeMethod(acquisitionWorker, "startRawCapture", Qt::BlockingQueuedConnection,
+                                          Q_RETURN_ARG(QString, rawError), Q_ARG(QString, rawFile));
+                if (!rawError.isEmpty())
+                {
+                    QMessageBox::warning(this, "警告", QString("无法记录原始字节: %1").arg(rawError));
+                }
+                else
+                {
+                    qDebug() << "记录原始字节到:" << rawFile;
+                }
+            }
+
             qDebug() << "已连接";
         }
         else
         {
             QMessageBox::critical(this, "错误",
-                            QString("无法打开串口: %1").arg(serialcheck->errorString()));
+                            QString("无法打开串口: %1").arg(error));
         }
     }
 }
 
 
 
-void MainWindow::onSerialDataReceived()
+void MainWindow::updateDisplay()
 {
-    QByteArray newData = serialcheck->readAll();
-    totalBytesReceived += newData.size();
+    consumeFrames();
+    imuChart->refresh();
+
+    // 读出 → 推送到图表曲线（实际绘制发生在随后的重绘事件中，通常在同一轮事件循环内）
+    const qint64 nowNs = steadyClockNs();
+    for (std::size_t i = 0; i < drawArrivals.size(); ++i)
+    {
+        acquisitionWorker->pipeline.drawLatency.record(nowNs - drawArrivals[i]);
+    }
+    drawArrivals.clear();
+    if (!dataValid) return;
 
-    // 添加到缓冲区
-    receiveBuffer.append(newData);
+    // 统计计数器为原子变量，无需加锁即可读取
+    DisplayStats stats;
+    stats.totalBytesReceived = acquisitionWorker->totalBytesReceived;
+    stats.validFramesReceived = acquisitionWorker->validFramesReceived;
+    stats.invalidFramesReceived = acquisitionWorker->invalidFramesReceived;
+    stats.actualFrequency = acquisitionWorker->actualFrequency;
+    stats.expectedRate = acquisitionWorker->expectedRate;
+    stats.clockDriftPpm = acquisitionWorker->clockDriftPpm;
+    stats.arrivalJitterMs = acquisitionWorker->arrivalJitterMs;
+    stats.droppedBytes = acquisitionWorker->droppedBytes;
+    stats.droppedFrames = acquisitionWorker->droppedFrames;
+    stats.displaySkippedFrames = acquisitionWorker->displaySkippedFrames;
+    stats.backlogBytes = acquisitionWorker->backlogBytes;
+    stats.saturatedFrames = acquisitionWorker->saturatedFrames;
+    stats.saving = isSaving;
+    acquisitionWorker->recordingStats(stats.bytesWritten, stats.writeQueued, stats.writeDropped);
+    stats.pipeline = &acquisitionWorker->pipeline;
+    const QString dspText = acquisitionWorker->dspDescription();
+    stats.dspText = acquisitionWorker->dspEnabled ? &dspText : nullptr;
+    stats.dspBiasProgress = acquisitionWorker->dspBiasProgress;
+    stats.dspFramesOut = acquisitionWorker->dspFramesOut;
+    const QString attitudeText = acquisitionWorker->attitudeDescription();
+    stats.attitudeText = attitudeText.isEmpty() ? nullptr : &attitudeText;
+    stats.attitudeEnabled = acquisitionWorker->attitudeEnabled;
+    stats.nowNs = nowNs;
+
+    QString displayText = DisplayFormatter::statusText(stats, latestFrame);
+    if (ui->textEdit_display)
+    {
+        ui->textEdit_display->setPlainText(displayText);
+    }
 
-    // 循环解析，可能包含多帧
-    int parseCount = 0;
-    const int MAX_PARSE_PER_CALL = 10; // 防止单次处理过多
+}
 
-    while (receiveBuffer.size() >= FRAME_SIZE && parseCount < MAX_PARSE_PER_CALL)
+void MainWindow::on_savedata_clicked()
+{
+    if (isSaving) stopSaving();
+    else startSaving();
+}
+
+void MainWindow::onAutoStopTimeout()
+{
+    if (isSaving)
     {
-        int result = parseReceivedData();
+        stopSaving();
+        qDebug() << "到达设定时间，自动停止保存";
+    }
+}
 
-        if (result == 0)  // 成功解析一帧
-        {
-            validFramesReceived++;
-            parseCount++;
-            // 继续循环，检查是否还有下一帧
-        }
-        else if (result == 1)  // 数据不足，停止解析等待更多数据
-        {
-            break;
-        }
+void MainWindow::onOverloadPolicyChanged(int index)
+{
+    int policy = ui->overload_policy->itemData(index).toInt();
+    QMetaObject::invokeMethod(acquisitionWorker, "setOverloadPolicy", Qt::QueuedConnection,
+                              Q_ARG(int, policy));
+}
 
-        // 防止缓冲区无限增长（超过3帧数据仍未找到合法帧，清空）
-        if (receiveBuffer.size() > FRAME_SIZE * 3)
-        {
-            qDebug() << "缓冲区溢出，丢弃" << receiveBuffer.size() << "字节";
-            receiveBuffer.clear();
-            invalidFramesReceived++;
-            break;
-        }
+void MainWindow::on_export_csv_clicked()
+{
+    QString desktopPath = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
+    QString recordingFile = QFileDialog::getOpenFileName(this, "选择二进制记录", desktopPath,
+                                                         "IMU二进制记录 (*.imu *.imuz)");
+    if (recordingFile.isEmpty())    return;
+
+    QFileInfo info(recordingFile);
+    QString csvFile = info.absolutePath() + "/" + info.completeBaseName() + ".csv";
+    if (QFile::exists(csvFile) &&
+        QMessageBox::question(this, "导出CSV", QString("%1 已存在，是否覆盖？").arg(csvFile)) != QMessageBox::Yes)
+    {
+        return;
     }
+
+    // 大文件导出耗时较长，放到后台线程执行
+    ui->export_csv->setEnabled(false);
+    QSharedPointer<QString> error(new QString);
+    QSharedPointer<bool> ok(new bool(false));
+    QThread *exportThread = QThread::create([recordingFile, csvFile, error, ok]() {
+        *ok = RecordingReader::exportCsv(recordingFile, csvFile, error.data());
+    });
+    connect(exportThread, &QThread::finished, this, [this, exportThread, csvFile, error, ok]() {
+        exportThread->deleteLater();
+        ui->export_csv->setEnabled(true);
+        if (*ok)    QMessageBox::information(this, "导出CSV", QString("已导出到: %1").arg(csvFile));
+        else        QMessageBox::critical(this, "错误", QString("导出失败: %1").arg(*error));
+    });
+    exportThread->start();
 }
 
+void MainWindow::on_replay_file_clicked()
+{
+    if (isReplaying)
+    {
+        stopReplay();
+        return;
+    }
+
+    QString desktopPath = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
+    QString replayFile = QFileDialog::getOpenFileName(this, "选择回放文件", desktopPath,
+                                                      "IMU录制文件 (*.bin *.imu *.imuz);;所有文件 (*)");
+    if (replayFile.isEmpty())   return;
+
+    // 回放数据走与串口相同的解析和保存流程，界面上保存功能照常可用
+    // （原始字节按界面选择的帧格式解析，二进制记录按文件头）
+    double speed = ui->replay_speed->currentData().toDouble();
+    QString error = selectFrameFormat();
+    if (error.isEmpty())
+    {
+        QMetaObject::invokeMethod(acquisitionWorker, "startReplay", Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(QString, error), Q_ARG(QString, replayFile),
+                                  Q_ARG(double, speed), Q_ARG(double, 0.0));
+    }
+    if (!error.isEmpty())
+    {
+        QMessageBox::critical(this, "错误", QString("无法回放文件: %1").arg(error));
+        return;
+    }
 
+    isReplaying = true;
+    ui->replay_file->setText("停止回放");
+    ui->replay_speed->setEnabled(false);
+    ui->frame_layout->setEnabled(false);
+    ui->frame_rate->setEnabled(false);
+    ui->serial_port_switch->setEnabled(false);
+    ui->open_recording->setEnabled(false);
+    ui->savedata->setEnabled(true);
+    qDebug() << "开始回放:" << replayFile;
+}
 
-void MainWindow::updateDisplay()
+void MainWindow::stopReplay()
 {
-    if (!dataValid) return;
+    QMetaObject::invokeMethod(acquisitionWorker, "stopReplay", Qt::BlockingQueuedConnection);
+    isReplaying = false;
+    dataValid = false;
+    ui->replay_file->setText("回放文件");
+    ui->replay_speed->setEnabled(true);
+    ui->frame_layout->setEnabled(true);
+    ui->frame_rate->setEnabled(true);
+    ui->serial_port_switch->setEnabled(true);
+    ui->open_recording->setEnabled(true);
+    if (isSaving)   stopSaving();
+    ui->savedata->setEnabled(false);
+}
 
-    QString displayText;
+void MainWindow::onReplayFinished(qint64 frames, double seconds)
+{
+    if (!isReplaying)   return;
+    stopReplay();
+    QMessageBox::information(this, "回放结束",
+                             QString("共解析 %1 帧，用时 %2 秒（%3 帧/秒）")
+                             .arg(frames).arg(seconds, 0, 'f', 2)
+                             .arg(seconds > 0 ? frames / seconds : 0.0, 0, 'f', 0));
+}
 
-    displayText += QString("=== 接收统计 ===\n");
-    displayText += QString("总字节数: %1  有效帧: %2  无效帧: %3\n")
-            .arg(totalBytesReceived).arg(validFramesReceived).arg(invalidFramesReceived);
-    // 确保 actualFrequency 有有效值
-    if (actualFrequency <= 0 || qIsNaN(actualFrequency))
+QString MainWindow::selectFrameFormat()
+{
+    QString error;
+    QMetaObject::invokeMethod(acquisitionWorker, "setFrameFormat", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(QString, error), Q_ARG(int, ui->frame_layout->currentData().toInt()));
+    if (error.isEmpty())
     {
-        displayText += QString("实际频率: 计算中... (理论100Hz)\n\n");
+        // 信号处理按帧率换算，先关闭，设置帧率后按新的帧率重新应用
+        applyDspPreset(0);
+        QMetaObject::invokeMethod(acquisitionWorker, "setExpectedRate", Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(QString, error), Q_ARG(double, ui->frame_rate->value()));
     }
-    else
+    if (error.isEmpty())    error = applyDspPreset(ui->dsp_preset->currentData().toInt());
+    return error;
+}
+
+QString MainWindow::applyDspPreset(int preset)
+{
+    const double rate = ui->frame_rate->value();
+    const int decimation = DSP_PRESETS[preset].outputHz > 0 ? qMax(1, qRound(rate / DSP_PRESETS[preset].outputHz)) : 1;
+    QString error;
+    QMetaObject::invokeMethod(acquisitionWorker, "setDspConfig", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(QString, error), Q_ARG(double, DSP_PRESETS[preset].cutoffHz),
+                              Q_ARG(int, DSP_FILTER_ORDER), Q_ARG(int, decimation),
+                              Q_ARG(int, DSP_PRESETS[preset].decimator), Q_ARG(int, DSP_PRESETS[preset].biasMode),
+                              Q_ARG(double, DSP_BIAS_SECONDS));
+    return error;
+}
+
+void MainWindow::setChartImuCount(int count)
+{
+    imuChart->setImuCount(count);
+    // 重建来源列表时不触发切换，图表已回到均值
+    QSignalBlocker blocker(ui->chart_source);
+    ui->chart_source->clear();
+    ui->chart_source->addItem("均值", ImuChart::MEAN_SOURCE);
+    for (int i = 0; i < count; ++i)
     {
-        displayText += QString("实际频率: %1 Hz (理论100Hz)\n\n")
-                        .arg(actualFrequency, 0, 'f', 1);  // 明确指定格式
+        ui->chart_source->addItem(QString("IMU %1").arg(i + 1), i);
     }
+    qDebug() << "帧格式:" << count << "个IMU";
+}
+
+void MainWindow::onChartSourceChanged(int index)
+{
+    imuChart->setSource(ui->chart_source->itemData(index).toInt());
+    imuChart->refresh();
+}
 
-    for (int i = 0; i < IMU_COUNT; ++i)
+void MainWindow::onChartWindowChanged(int index)
+{
+    imuChart->setWindow(ui->chart_window->itemData(index).toDouble());
+    imuChart->refresh();
+    if (recordingView)  updateRecordingSeek();
+}
+
+void MainWindow::onDspPresetChanged(int index)
+{
+    // 立即生效：之后交给界面的是处理后的帧（零偏估计期间暂无数据）
+    const QString error = applyDspPreset(ui->dsp_preset->itemData(index).toInt());
+    if (error.isEmpty())    return;
+    QMessageBox::warning(this, "信号处理", QString("无法应用“%1”: %2").arg(ui->dsp_preset->itemText(index)).arg(error));
+    QSignalBlocker blocker(ui->dsp_preset);
+    ui->dsp_preset->setCurrentIndex(0);
+    applyDspPreset(0);
+}
+
+void MainWindow::on_load_calibration_clicked()
+{
+    QString error;
+    if (!calibrationFile.isEmpty())
     {
-        displayText += QString("【IMU %1】\n").arg(i + 1);
-        displayText += QString("  Accel(g):  X=%1  Y=%2  Z=%3\n")
-                    .arg(imuData[i].accel[0], 8, 'f', 4)
-                    .arg(imuData[i].accel[1], 8, 'f', 4)
-                    .arg(imuData[i].accel[2], 8, 'f', 4);
-        displayText += QString("  Gyro(dps): X=%1  Y=%2  Z=%3\n")
-                    .arg(imuData[i].gyro[0], 8, 'f', 4)
-                    .arg(imuData[i].gyro[1], 8, 'f', 4)
-                    .arg(imuData[i].gyro[2], 8, 'f', 4);
-        displayText += "\n";
+        // 已加载标定时该按钮为“清除标定”
+        QMetaObject::invokeMethod(acquisitionWorker, "setCalibrationFile", Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(QString, error), Q_ARG(QString, QString()));
+        calibrationFile.clear();
+        ui->load_calibration->setText("加载标定");
+        return;
     }
-    if (ui->receiveTextEdit)
+
+    QString desktopPath = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
+    QString fileName = QFileDialog::getOpenFileName(this, "选择标定文件", desktopPath,
+                                                    "标定文件 (*.csv *.txt);;所有文件 (*)");
+    if (fileName.isEmpty()) return;
+    QMetaObject::invokeMethod(acquisitionWorker, "setCalibrationFile", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(QString, error), Q_ARG(QString, fileName));
+    if (!error.isEmpty())
     {
-        ui->textEdit_display->setPlainText(displayText);
+        QMessageBox::warning(this, "标定", QString("无法加载标定: %1").arg(error));
+        return;
     }
+    calibrationFile = fileName;
+    ui->load_calibration->setText("清除标定");
+}
 
+void MainWindow::on_attitude_toggled(bool checked)
+{
+    QString error;
+    QMetaObject::invokeMethod(acquisitionWorker, "setAttitudeFilter", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(QString, error), Q_ARG(bool, checked),
+                              Q_ARG(double, AttitudeFilter::DEFAULT_GAIN));
+    if (!error.isEmpty())
+    {
+        QMessageBox::warning(this, "姿态解算", error);
+        QSignalBlocker blocker(ui->attitude);
+        ui->attitude->setChecked(!checked);
+        return;
+    }
+    // 图表的姿态通道从之后的帧开始
+    imuChart->setAttitudeEnabled(checked);
 }
 
-void MainWindow::on_savedata_clicked()
+void MainWindow::on_analyze_recording_clicked()
 {
-    if (isSaving) stopSaving();
-    else startSaving();
+    // 分析中该按钮为“取消分析”
+    if (noiseAnalyzer)
+    {
+        noiseAnalyzer->cancel();
+        return;
+    }
+
+    QString desktopPath = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
+    QStringList files = QFileDialog::getOpenFileNames(this, "选择要分析的记录（分段记录可多选，按文件名顺序拼接）", desktopPath,
+                                                      "IMU记录 (*.csv *.imu *.imuz);;所有文件 (*)");
+    if (files.isEmpty())    return;
+    files.sort();
+    const QFileInfo first(files.first());
+    const QString outputDir = QDir(first.path()).filePath(first.completeBaseName() + "_analysis");
+
+    RecordingAnalyzer *analyzer = new RecordingAnalyzer;
+    noiseAnalyzer = analyzer;
+    QSharedPointer<RecordingAnalyzer::Result> result(new RecordingAnalyzer::Result);
+    QSharedPointer<QString> error(new QString);
+    QSharedPointer<bool> ok(new bool(false));
+    analysisThread = QThread::create([analyzer, files, outputDir, result, error, ok]() {
+        *ok = analyzer->analyze(files, result.data(), error.data())
+                && RecordingAnalyzer::writeResults(*result, outputDir, nullptr, error.data());
+    });
+    QTimer *progressTimer = new QTimer(this);
+    connect(progressTimer, &QTimer::timeout, this, [this, analyzer]() {
+        ui->analyze_recording->setText(QString("取消分析 %1%").arg(analyzer->progress() / 10));
+    });
+    connect(analysisThread, &QThread::finished, this, [this, analyzer, progressTimer, outputDir, result, error, ok]() {
+        progressTimer->deleteLater();
+        analysisThread->deleteLater();
+        analysisThread = nullptr;
+        noiseAnalyzer = nullptr;
+        delete analyzer;
+        ui->analyze_recording->setText("噪声分析");
+        if (!*ok)
+        {
+            QMessageBox::warning(this, "噪声分析", *error);
+            return;
+        }
+        AnalysisDialog *dialog = new AnalysisDialog(*result, outputDir, this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        dialog->show();
+    });
+    ui->analyze_recording->setText("取消分析 0%");
+    progressTimer->start(200);
+    analysisThread->start();
 }
 
-void MainWindow::onAutoStopTimeout()
+void MainWindow::on_open_recording_clicked()
 {
-    if (isSaving)
+    if (recordingView)
     {
-        stopSaving();
-        qDebug() << "到达设定时间，自动停止保存";
+        closeRecording();
+        return;
     }
+
+    QString desktopPath = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
+    QString recordingFile = QFileDialog::getOpenFileName(this, "选择记录", desktopPath,
+                                                         "IMU记录 (*.csv *.imu *.imuz);;所有文件 (*)");
+    if (recordingFile.isEmpty())    return;
+
+    // 内存映射后由后台线程（内部再按CPU核数并行）扫描全文件，建立时间索引和概览，界面不等待
+    ui->open_recording->setEnabled(false);
+    ui->open_recording->setText("正在打开...");
+    ui->serial_port_switch->setEnabled(false);
+    ui->replay_file->setEnabled(false);
+    RecordingView *view = new RecordingView;
+    QSharedPointer<QString> error(new QString);
+    QSharedPointer<bool> ok(new bool(false));
+    QThread *openThread = QThread::create([view, recordingFile, error, ok]() {
+        *ok = view->open(recordingFile, 0, error.data());
+    });
+    connect(openThread, &QThread::finished, this, [this, openThread, view, error, ok]() {
+        openThread->deleteLater();
+        ui->open_recording->setEnabled(true);
+        if (*ok)
+        {
+            showRecording(view);
+            return;
+        }
+        delete view;
+        ui->open_recording->setText("查看记录");
+        ui->serial_port_switch->setEnabled(true);
+        ui->replay_file->setEnabled(true);
+        QMessageBox::critical(this, "错误", QString("无法打开记录: %1").arg(*error));
+    });
+    openThread->start();
+}
+
+void MainWindow::showRecording(RecordingView *view)
+{
+    recordingView = view;
+    setChartImuCount(view->imuCount());
+    imuChart->showRecording(view);
+    // 先显示整个会话，之后用滚轮缩放、滚动条平移
+    ui->chart_window->setCurrentIndex(ui->chart_window->findData(0));
+    imuChart->refresh();
+    ui->recording_seek->show();
+    updateRecordingSeek();
+    ui->open_recording->setText("返回实时");
+
+    const double mb = view->fileSize() / (1024.0 * 1024.0);
+    ui->textEdit_display->setPlainText(
+                QString("记录: %1\nIMU数量: %2  行数: %3（跳过 %4 行）\n开始: %5  时长: %6 秒\n"
+                        "打开: %7 MB，%8 秒（%9 MB/s，%10 线程）\n滚轮缩放，滚动条平移")
+                .arg(QFileInfo(view->fileName()).fileName()).arg(view->imuCount())
+                .arg(view->rowCount()).arg(view->badRowCount())
+                .arg(QDateTime::fromMSecsSinceEpoch(view->startWallClockMs()).toString("yyyy-MM-dd hh:mm:ss"))
+                .arg(view->duration(), 0, 'f', 1)
+                .arg(mb, 0, 'f', 1).arg(view->scanSeconds(), 0, 'f', 2)
+                .arg(view->scanSeconds() > 0 ? mb / view->scanSeconds() : 0.0, 0, 'f', 0)
+                .arg(view->threadCount()));
+    qDebug() << "查看记录:" << view->fileName();
+}
+
+void MainWindow::closeRecording()
+{
+    imuChart->showRecording(nullptr);
+    delete recordingView;
+    recordingView = nullptr;
+    ui->recording_seek->hide();
+    ui->open_recording->setText("查看记录");
+    ui->serial_port_switch->setEnabled(true);
+    ui->replay_file->setEnabled(true);
+    ui->textEdit_display->clear();
+}
+
+void MainWindow::updateRecordingSeek()
+{
+    // 滑块长度为显示范围占整个记录的比例
+    const double duration = qMax(recordingView->duration(), 0.001);
+    const double span = imuChart->viewEnd() - imuChart->viewStart();
+    const int page = qBound(1, qRound(span / duration * SEEK_STEPS), SEEK_STEPS);
+    QSignalBlocker blocker(ui->recording_seek);
+    ui->recording_seek->setRange(0, SEEK_STEPS - page);
+    ui->recording_seek->setPageStep(page);
+    ui->recording_seek->setSingleStep(qMax(1, page / 10));
+    ui->recording_seek->setValue(qRound(imuChart->viewStart() / duration * SEEK_STEPS));
+}
+
+void MainWindow::onRecordingSeek(int value)
+{
+    if (!recordingView) return;
+    const double span = imuChart->viewEnd() - imuChart->viewStart();
+    const double start = value * qMax(recordingView->duration(), 0.001) / SEEK_STEPS;
+    imuChart->setViewRange(start, start + span);
+    imuChart->refresh();
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Wheel && recordingView && watched == chartView->viewport())
+    {
+        // 以鼠标所在时刻为中心缩放：向前滚放大（每格 0.8 倍），向后滚缩小
+        QWheelEvent *wheel = static_cast<QWheelEvent *>(event);
+        QChart *chart = imuChart->chart();
+        const double t0 = imuChart->viewStart();
+        const double t1 = imuChart->viewEnd();
+        const double pivot = qBound(t0, chart->mapToValue(chart->mapFromScene(chartView->mapToScene(wheel->pos()))).x(), t1);
+        const double factor = std::pow(0.8, wheel->angleDelta().y() / 120.0);
+        imuChart->setViewRange(pivot - (pivot - t0) * factor, pivot + (t1 - pivot) * factor);
+        imuChart->refresh();
+        updateRecordingSeek();
+        return true;
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::onPortLost(const QString &error)
+{
+    // 采集线程已关闭串口并写完保存文件，这里只需恢复界面状态
+    if (!isSerialOpen)  return;
+    on_serial_port_switch_clicked();
+    qDebug() << "设备已断开:" << error;
 }
 
 void MainWindow::on_clear_data_clicked()
 {
     ui->textEdit_display->clear();
-    ui->receiveTextEdit->clear();
+    frameLog->clear();
     ui->receiveTextEdit_str->clear();
     clearCharts();
 }
@@ -21,18 +21,22 @@
 #include <QTextCodec>
 #include <QScrollBar>
 #include <QValueAxis>
+#include <QThread>
+#include <vector>
+#include "imuframe.h"
 
+class AcquisitionWorker;
+class MetricsServer;
+class ImuChart;
+class FrameLogModel;
+class RecordingView;
+class RecordingAnalyzer;
 
 QT_CHARTS_USE_NAMESPACE
 namespace Ui {
 class MainWindow;
 }
 
-struct IMUData {
-    float accel[3];  // x, y, z (g)
-    float gyro[3];   // x, y, z (deg/s)
-};
-
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -40,15 +44,34 @@ class MainWindow : public QMainWindow
 public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
+
+    // 在 127.0.0.1:port 上提供 Prometheus 监控指标（独立线程），返回空字符串表示成功
+    QString startMetricsServer(int port);
 private slots:
     void scanSerialPorts();   // 扫描串口槽函数
-    void onSerialDataReceived();
     void on_serial_port_switch_clicked();
     void updateDisplay();             // 更新显示（定时器触发）
 
     void on_savedata_clicked();
     void onAutoStopTimeout();         // 自动停止超时
     void on_clear_data_clicked();
+    void onOverloadPolicyChanged(int index);  // 切换积压过载策略
+    void on_export_csv_clicked();     // 二进制记录导出为CSV
+    void on_replay_file_clicked();    // 开始/停止回放录制文件
+    void onReplayFinished(qint64 frames, double seconds);  // 回放结束
+    void onPortLost(const QString &error);  // 串口意外断开
+    void onChartSourceChanged(int index);   // 切换曲线显示的IMU
+    void onChartWindowChanged(int index);   // 切换曲线显示窗口长度
+    void onDspPresetChanged(int index);     // 切换实时信号处理
+    void on_load_calibration_clicked(); // 加载 / 清除IMU标定文件
+    void on_attitude_toggled(bool checked); // 开关实时姿态解算
+    void on_open_recording_clicked(); // 查看保存的记录 / 回到实时数据
+    void on_analyze_recording_clicked();  // 对保存的记录做噪声分析 / 取消分析
+    void onRecordingSeek(int value);  // 拖动记录的时间滚动条
+
+protected:
+    // 查看记录时在曲线上滚动滚轮：以鼠标所在时刻为中心缩放
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
     Ui::MainWindow *ui;
@@ -56,71 +79,58 @@ private:
     void initCharts();                // 初始化图表
     // 检查串口是否仍然存在（用于处理USB拔出情况）
     bool checkPortAvailable(const QString &portName);
-    QSerialPort *serialcheck;
     QTimer *scanTimer;
     bool isSerialOpen;
-
-    // 数据解析
-    int parseReceivedData();         // 解析接收缓冲区
-    // 数据缓冲区
-    QByteArray receiveBuffer;         // 原始接收缓冲区
-    // 解析后的数据（9个IMU）
-    IMUData imuData[9];
+    QString openedPortName;           // 当前打开的串口名
+    bool isReplaying;                 // 是否正在回放录制文件
+    void stopReplay();                // 停止回放并恢复串口控件
+    QString selectFrameFormat();      // 把界面选择的帧格式（IMU数量）和理论帧率交给采集线程
+    QString applyDspPreset(int preset);   // 按理论帧率把信号处理预设交给采集线程
+    QString calibrationFile;          // 已加载的标定文件，空为未标定
+
+    // 采集线程：串口读取、帧解析和文件保存都在该线程中完成
+    QThread *acquisitionThread;
+    AcquisitionWorker *acquisitionWorker;
+    void consumeFrames();             // 从采集队列取出新帧（界面刷新时调用）
+
+    // 监控指标服务线程：只读取采集线程的原子计数器
+    QThread *metricsThread;
+    MetricsServer *metricsServer;
+
+    // 最新一帧解析数据
+    ImuFrame latestFrame;
     bool dataValid;                   // 当前数据是否有效
-    // 统计信息
-    qint64 totalBytesReceived;        // 总接收字节数
-    qint64 validFramesReceived;       // 有效帧数
-    qint64 invalidFramesReceived;     // 无效帧数
-    QDateTime lastFrameTime;          // 最后一帧时间
-    float actualFrequency;            // 实际接收频率
-    QDateTime displayLastUpdateTime;  // 上次显示更新时间
-    int framesSinceLastDisplay;       // 上次显示以来收到的帧数
-
-    QString pendingDisplayText;       // 缓冲待显示的文本
-    int frameCounter = 0;             // 帧计数器，用于UI降频
-    static const int UI_UPDATE_INTERVAL = 100; // 每100帧（1000ms）更新一次UI
-
-    // 数据格式常量
-    static const int IMU_COUNT = 9;           // IMU数量
-    static const int DATA_PER_IMU = 6;        // 每个IMU的数据量（3轴accel + 3轴gyro）
-    static const int FLOAT_SIZE = 4;          // float占4字节
-    static const int HEAD_SIZE = 2;           // 帧头2字节
-    static const int TAIL_SIZE = 4;           // 尾标4字节
-    static const int DATA_SIZE = IMU_COUNT * DATA_PER_IMU * FLOAT_SIZE; // 216字节
-    static const int FRAME_SIZE = HEAD_SIZE + DATA_SIZE + TAIL_SIZE;    // 222字节
-
-    static const char HEAD_PATTERN[2];
-    // 尾标定义：{0x00, 0x00, 0x80, 0x7f} 对应float的NaN或特定值
-    static const char TAIL_PATTERN[4];
-
-    QFile *saveFile;                  // 保存文件指针
-    QTextStream *fileStream;          // 文件流
+
+    FrameLogModel *frameLog;          // 原始数据区：最近的已解码帧（固定容量）
+    std::vector<qint64> drawArrivals; // 本次刷新取出的帧的到达时刻，曲线更新后统计绘制延迟
+
     bool isSaving;                    // 是否正在保存
     QTimer *autoStopTimer;            // 自动停止定时器
     void startSaving();               // 开始保存
     void stopSaving();                // 停止保存
-    QString generateFileName();       // 生成文件名
-    void saveDataToFile();            // 保存数据到文件
+    QString generateFileName(const QString &suffix);  // 生成文件名
     int totalSaveSeconds;        // 用户设定的总保存时间（秒）
     int remainingSeconds;        // 剩余秒数
     QTimer *countdownTimer;      // 倒计时定时器（每秒更新）
     void updateCountdownDisplay();  // 更新显示
 
     // 图表相关
-    QChart *chart;                    // 图表对象
+    ImuChart *imuChart;               // 均值曲线（图表对象由 chartView 接管）
     QChartView *chartView;            // 图表视图
-    QLineSeries *accelSeries[3];      // 加速度曲线（X,Y,Z）
-    QLineSeries *gyroSeries[3];       // 陀螺仪曲线（X,Y,Z）
-    QDateTime startTime;              // 记录开始时间，用于计算相对时间
-    static const int MAX_DISPLAY_SECONDS = 10;  // 最大显示10秒数据
     static const int DATA_INTERVAL_MS = 100;    // 数据间隔100ms（10Hz显示）
-    void updateChart(float meanAccel[3], float meanGyro[3]);  // 更新图表
-    static const int Chart_FPS = 10;  //刷新频率10Hz
-    // 添加成员变量
-    int chartUpdateCounter = 0;
-    float lastMeanAccel[3] = {0};
-    float lastMeanGyro[3] = {0};
     void clearCharts();            // 清除图表曲线
+    void setChartImuCount(int count);  // 帧的IMU数量变化时重建图表通道和曲线来源列表
+
+    // 记录查看：后台线程打开并扫描记录，之后曲线显示记录，缩放时只读取可见的一段
+    RecordingView *recordingView;     // 查看中的记录（nullptr 为实时数据）
+    static const int SEEK_STEPS = 100000;   // 时间滚动条的分辨率
+    void showRecording(RecordingView *view);
+    void closeRecording();
+    void updateRecordingSeek();       // 按当前显示范围更新时间滚动条
+
+    // 噪声分析：后台线程（内部再按CPU核数并行）分析记录，完成后显示结果
+    RecordingAnalyzer *noiseAnalyzer; // 分析中的对象（nullptr 为未在分析）
+    QThread *analysisThread;
 
 };
 
@@ -0,0 +1,296 @@
+#include "metricsserver.h"
+#include "acquisitionworker.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QDebug>
+
+// 请求头超过该长度仍未结束则断开（只接受简单的 GET 请求）
+static const int MAX_REQUEST_BYTES = 8 * 1024;
+
+MetricsServer::MetricsServer(const AcquisitionWorker *worker, QObject *parent) :
+    QObject(parent)
+{
+    if (worker) addWorker(worker, QString());
+    // 以本对象为父对象，随 moveToThread 一起迁移到服务线程
+    server = new QTcpServer(this);
+    connect(server, &QTcpServer::newConnection, this, &MetricsServer::onNewConnection);
+}
+
+void MetricsServer::addWorker(const AcquisitionWorker *worker, const QString &port)
+{
+    Source source;
+    source.worker = worker;
+    // 标签值中的反斜杠、引号和换行需要转义
+    source.port = port.toUtf8().replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    sources.append(source);
+}
+
+QString MetricsServer::listen(int port)
+{
+    close();
+    // 只监听本机回环地址，不对外暴露
+    if (!server->listen(QHostAddress::LocalHost, static_cast<quint16>(port)))
+    {
+        return server->errorString();
+    }
+    qDebug() << "监控指标: http://127.0.0.1:" << server->serverPort() << "/metrics";
+    return QString();
+}
+
+void MetricsServer::close()
+{
+    if (server->isListening())  server->close();
+}
+
+void MetricsServer::onNewConnection()
+{
+    while (QTcpSocket *socket = server->nextPendingConnection())
+    {
+        connect(socket, &QTcpSocket::readyRead, this, &MetricsServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void MetricsServer::onReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (!socket)    return;
+
+    // 请求可能分多次到达，收齐请求头（空行）后再应答
+    QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+    if (request.contains("\r\n\r\n") || request.contains("\n\n"))
+    {
+        socket->setProperty("request", QVariant());
+        respond(socket, request);
+    }
+    else if (request.size() > MAX_REQUEST_BYTES)
+    {
+        socket->abort();
+    }
+    else
+    {
+        socket->setProperty("request", request);
+    }
+}
+
+void MetricsServer::respond(QTcpSocket *socket, const QByteArray &request)
+{
+    // 请求行：方法 路径 版本
+    const QList<QByteArray> requestLine = request.left(request.indexOf('\n')).trimmed().split(' ');
+    const QByteArray method = requestLine.value(0);
+    QByteArray path = requestLine.value(1);
+    if (path.contains('?')) path = path.left(path.indexOf('?'));
+
+    QByteArray status = "200 OK";
+    QByteArray contentType = "text/plain; version=0.0.4; charset=utf-8";
+    QByteArray body;
+    if (method != "GET" && method != "HEAD")
+    {
+        status = "405 Method Not Allowed";
+        contentType = "text/plain; charset=utf-8";
+        body = "only GET is supported\n";
+    }
+    else if (path == "/metrics")
+    {
+        body = render(sources);
+    }
+    else if (path == "/")
+    {
+        contentType = "text/plain; charset=utf-8";
+        body = "IMU acquisition metrics: /metrics\n";
+    }
+    else
+    {
+        status = "404 Not Found";
+        contentType = "text/plain; charset=utf-8";
+        body = "not found\n";
+    }
+
+    QByteArray response = "HTTP/1.1 " + status + "\r\n"
+            "Content-Type: " + contentType + "\r\n"
+            "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n";
+    if (method != "HEAD")   response += body;
+    socket->write(response);
+    // 写完后关闭连接
+    socket->disconnectFromHost();
+}
+
+// ---------------------------------------------------------------------------
+// 指标
+// ---------------------------------------------------------------------------
+
+static void appendHeader(QByteArray &out, const char *name, const char *type, const char *help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+// 数据源的标签（port 和可选的其他标签，如 stage="decoded"），都没有时为空
+static QByteArray labels(const MetricsServer::Source &source, const char *extra)
+{
+    QByteArray text;
+    if (!source.port.isEmpty()) text = "port=\"" + source.port + '"';
+    if (extra)  text += (text.isEmpty() ? QByteArray() : QByteArray(",")) + extra;
+    return text;
+}
+
+static QByteArray wrap(const QByteArray &labelText)
+{
+    return labelText.isEmpty() ? QByteArray() : '{' + labelText + '}';
+}
+
+// 读取一个工作对象的某项指标
+typedef double (*Reading)(const AcquisitionWorker *worker, qint64 nowNs);
+
+static void appendMetric(QByteArray &out, const QVector<MetricsServer::Source> &sources,
+                         const char *name, const char *type, const char *help, Reading read)
+{
+    const qint64 nowNs = steadyClockNs();
+    appendHeader(out, name, type, help);
+    for (const MetricsServer::Source &source : sources)
+    {
+        out += name;
+        out += wrap(labels(source, nullptr));
+        out += ' ';
+        out += QByteArray::number(read(source.worker, nowNs), 'g', 15);
+        out += '\n';
+    }
+}
+
+// 直方图按 Prometheus summary 输出：分位数、总和与次数（秒）
+static void appendSummary(QByteArray &out, const char *name, const QByteArray &labelText, const LatencyHistogram &histogram)
+{
+    static const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+    const QByteArray prefix = QByteArray(name) + '{' + (labelText.isEmpty() ? QByteArray() : labelText + ',');
+    for (double q : QUANTILES)
+    {
+        out += prefix + "quantile=\"" + QByteArray::number(q) + "\"} "
+                + QByteArray::number(histogram.percentile(q * 100) / 1.0e9, 'g', 9) + '\n';
+    }
+    out += QByteArray(name) + "_sum" + wrap(labelText) + ' '
+            + QByteArray::number(histogram.mean() * histogram.count() / 1.0e9, 'g', 15) + '\n';
+    out += QByteArray(name) + "_count" + wrap(labelText) + ' ' + QByteArray::number(histogram.count()) + '\n';
+}
+
+static int popcount(quint32 mask)
+{
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1) count++;
+    return count;
+}
+
+static quint64 writerQueued(const AcquisitionWorker *worker)
+{
+    quint64 written = 0, queued = 0, dropped = 0;
+    worker->recordingStats(written, queued, dropped);
+    return queued;
+}
+
+static quint64 writerWritten(const AcquisitionWorker *worker)
+{
+    quint64 written = 0, queued = 0, dropped = 0;
+    worker->recordingStats(written, queued, dropped);
+    return written;
+}
+
+static quint64 writerDropped(const AcquisitionWorker *worker)
+{
+    quint64 written = 0, queued = 0, dropped = 0;
+    worker->recordingStats(written, queued, dropped);
+    return dropped;
+}
+
+QByteArray MetricsServer::render(const QVector<Source> &sources)
+{
+    QByteArray out;
+    out.reserve(8 * 1024 * sources.size());
+
+    appendMetric(out, sources, "imu_received_bytes_total", "counter", "Bytes read from the serial port or replay source.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->totalBytesReceived.load()); });
+    appendMetric(out, sources, "imu_valid_frames_total", "counter", "Frames decoded successfully.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->validFramesReceived.load()); });
+    appendMetric(out, sources, "imu_invalid_frames_total", "counter", "Frames whose header matched but tail did not.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->invalidFramesReceived.load()); });
+    appendMetric(out, sources, "imu_dropped_bytes_total", "counter", "Bytes discarded while resynchronizing or by the overload policy.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->droppedBytes.load()); });
+    appendMetric(out, sources, "imu_dropped_frames_total", "counter", "Frames dropped by the overload policy and not saved.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->droppedFrames.load()); });
+    appendMetric(out, sources, "imu_display_skipped_frames_total", "counter", "Frames saved but not shown.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->displaySkippedFrames.load()); });
+    appendMetric(out, sources, "imu_resync_events_total", "counter", "Times the frame synchronizer lost sync (since the source or recording started).",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->pipeline.resyncEvents.load()); });
+
+    appendMetric(out, sources, "imu_frame_rate_hz", "gauge", "True frame rate estimated by the frame clock model (0 until converged).",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->actualFrequency.load()); });
+    appendMetric(out, sources, "imu_frame_rate_1s_hz", "gauge", "Frames received per second over the last second.",
+                 [](const AcquisitionWorker *w, qint64 nowNs) { return w->pipeline.rate1s.rate(nowNs); });
+    appendMetric(out, sources, "imu_frame_rate_10s_hz", "gauge", "Frames received per second over the last 10 seconds.",
+                 [](const AcquisitionWorker *w, qint64 nowNs) { return w->pipeline.rate10s.rate(nowNs); });
+    appendMetric(out, sources, "imu_clock_drift_ppm", "gauge", "Device clock drift against the nominal frame rate.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->clockDriftPpm.load()); });
+    appendMetric(out, sources, "imu_arrival_jitter_seconds", "gauge", "RMS arrival jitter around the frame clock model.",
+                 [](const AcquisitionWorker *w, qint64) { return w->arrivalJitterMs.load() / 1.0e3; });
+
+    appendMetric(out, sources, "imu_sensor_count", "gauge", "IMUs per frame in the current frame layout.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->imuCount.load()); });
+    appendMetric(out, sources, "imu_saturated_frames_total", "counter", "Frames in which at least one IMU reading reached full scale.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->saturatedFrames.load()); });
+    appendMetric(out, sources, "imu_saturated_sensors", "gauge", "IMUs saturated in the latest batch.",
+                 [](const AcquisitionWorker *w, qint64) { return double(popcount(w->saturatedImuMask.load())); });
+    appendMetric(out, sources, "imu_stuck_sensors", "gauge", "IMUs with a channel repeating the same value (stuck sensor).",
+                 [](const AcquisitionWorker *w, qint64) { return double(popcount(w->stuckImuMask.load())); });
+    appendMetric(out, sources, "imu_backlog_bytes", "gauge", "Bytes received but not yet parsed.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->backlogBytes.load()); });
+    appendMetric(out, sources, "imu_frame_queue_depth", "gauge", "Frames waiting in the GUI (or merge) queue.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->frameQueueDepth()); });
+    appendMetric(out, sources, "imu_writer_queue_bytes", "gauge", "Bytes queued for the disk writer threads.",
+                 [](const AcquisitionWorker *w, qint64) { return double(writerQueued(w)); });
+    appendMetric(out, sources, "imu_written_bytes_total", "counter", "Bytes written to disk by the writer threads.",
+                 [](const AcquisitionWorker *w, qint64) { return double(writerWritten(w)); });
+    appendMetric(out, sources, "imu_writer_dropped_bytes_total", "counter", "Bytes dropped because the disk could not keep up.",
+                 [](const AcquisitionWorker *w, qint64) { return double(writerDropped(w)); });
+    appendMetric(out, sources, "imu_recording_file_bytes", "gauge", "Size of the current (or last) recording data file.",
+                 [](const AcquisitionWorker *w, qint64) { return double(w->recordingFileBytes()); });
+    appendMetric(out, sources, "imu_recording_active", "gauge", "1 while a recording is open.",
+                 [](const AcquisitionWorker *w, qint64) { return w->isRecording() ? 1.0 : 0.0; });
+
+    appendHeader(out, "imu_frame_interval_seconds", "summary", "Interval between consecutive frame arrivals.");
+    for (const Source &source : sources)
+    {
+        appendSummary(out, "imu_frame_interval_seconds", labels(source, nullptr), source.worker->pipeline.frameInterval);
+    }
+    appendMetric(out, sources, "imu_frame_interval_max_seconds", "gauge", "Longest interval between frame arrivals.",
+                 [](const AcquisitionWorker *w, qint64) { return w->pipeline.frameInterval.maximum() / 1.0e9; });
+
+    appendHeader(out, "imu_stage_latency_seconds", "summary", "Latency from the serial read to each pipeline stage.");
+    for (const Source &source : sources)
+    {
+        const PipelineStats &pipeline = source.worker->pipeline;
+        appendSummary(out, "imu_stage_latency_seconds", labels(source, "stage=\"decoded\""), pipeline.decodeLatency);
+        appendSummary(out, "imu_stage_latency_seconds", labels(source, "stage=\"written\""), pipeline.writeLatency);
+        appendSummary(out, "imu_stage_latency_seconds", labels(source, "stage=\"drawn\""), pipeline.drawLatency);
+    }
+
+    appendHeader(out, "imu_dsp_block_channel_seconds", "summary",
+                 "Real-time DSP cost per block (up to 64 frames) and channel.");
+    for (const Source &source : sources)
+    {
+        appendSummary(out, "imu_dsp_block_channel_seconds", labels(source, nullptr), source.worker->pipeline.dspCost);
+    }
+    appendHeader(out, "imu_attitude_frame_seconds", "summary",
+                 "Attitude filter cost per frame (all IMUs).");
+    for (const Source &source : sources)
+    {
+        appendSummary(out, "imu_attitude_frame_seconds", labels(source, nullptr), source.worker->pipeline.attitudeCost);
+    }
+    return out;
+}
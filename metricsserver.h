@@ -0,0 +1,57 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class QTcpServer;
+class QTcpSocket;
+class AcquisitionWorker;
+
+// 本地监控指标服务：在 127.0.0.1 上以 Prometheus 文本格式（GET /metrics）提供采集计数器，
+// 供无人值守的采集电脑接入外部监控。
+// 运行在独立的 QThread 中（moveToThread 后通过 invokeMethod 调用 listen()），
+// 生成指标时只读取 AcquisitionWorker 的原子计数器和统计，不向采集线程发送任何事件，
+// 因此抓取频率和网络状况都不会占用采集线程的时间。
+// 同时采集多个串口时每个工作对象登记一个串口标签，各指标按 port="..." 标签分别输出。
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int DEFAULT_PORT = 9464;
+
+    // 一个数据源：工作对象和它的串口标签（为空时不输出 port 标签）
+    struct Source {
+        const AcquisitionWorker *worker;
+        QByteArray port;
+    };
+
+    // worker 的生命周期必须长于本对象；worker 为 nullptr 时由 addWorker() 登记
+    explicit MetricsServer(const AcquisitionWorker *worker, QObject *parent = nullptr);
+
+    // 再登记一个工作对象（须在 listen() 之前、移入服务线程之前调用）
+    void addWorker(const AcquisitionWorker *worker, const QString &port);
+
+    // 生成 Prometheus 文本格式的全部指标（任意线程可调用）
+    static QByteArray render(const QVector<Source> &sources);
+
+public slots:
+    // 以下函数需在服务线程中执行；返回空字符串表示成功，否则为错误描述
+    QString listen(int port);
+    void close();
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    void respond(QTcpSocket *socket, const QByteArray &request);
+
+    QVector<Source> sources;
+    QTcpServer *server;
+};
+
+#endif // METRICSSERVER_H
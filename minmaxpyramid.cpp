@@ -0,0 +1,179 @@
+#include "minmaxpyramid.h"
+#include <algorithm>
+#include <cstring>
+
+MinMaxPyramid::MinMaxPyramid(int channelCount, int levels, std::size_t bucketsPerLevel, int fanout) :
+    channels(channelCount),
+    capacity(bucketsPerLevel),
+    levelData(static_cast<std::size_t>(levels)),
+    totalSamples(0),
+    firstSampleTime(0),
+    lastSampleTime(0)
+{
+    std::size_t samplesPerBucket = 1;
+    for (std::size_t k = 0; k < levelData.size(); ++k)
+    {
+        Level &level = levelData[k];
+        level.samplesPerBucket = samplesPerBucket;
+        level.startTime.resize(capacity);
+        level.minMax.resize(capacity * static_cast<std::size_t>(channels) * 2);
+        level.partial.resize(static_cast<std::size_t>(channels) * 2);
+        samplesPerBucket *= static_cast<std::size_t>(fanout);
+    }
+    clear();
+}
+
+void MinMaxPyramid::clear()
+{
+    for (std::size_t k = 0; k < levelData.size(); ++k)
+    {
+        levelData[k].head = 0;
+        levelData[k].count = 0;
+        levelData[k].partialStart = 0;
+        levelData[k].partialSamples = 0;
+    }
+    totalSamples = 0;
+    firstSampleTime = 0;
+    lastSampleTime = 0;
+}
+
+std::size_t MinMaxPyramid::memoryBytes() const
+{
+    std::size_t bytes = 0;
+    for (std::size_t k = 0; k < levelData.size(); ++k)
+    {
+        bytes += levelData[k].startTime.size() * sizeof(double);
+        bytes += (levelData[k].minMax.size() + levelData[k].partial.size()) * sizeof(float);
+    }
+    return bytes;
+}
+
+void MinMaxPyramid::append(double time, const float *values)
+{
+    if (totalSamples == 0)  firstSampleTime = time;
+    lastSampleTime = time;
+    totalSamples++;
+
+    // 最小值和最大值分块存放，内层循环无分支，编译器可以向量化
+    const std::size_t n = static_cast<std::size_t>(channels);
+    for (std::size_t k = 0; k < levelData.size(); ++k)
+    {
+        Level &level = levelData[k];
+        float *accMin = level.partial.data();
+        float *accMax = accMin + n;
+        if (level.partialSamples == 0)
+        {
+            level.partialStart = time;
+            memcpy(accMin, values, n * sizeof(float));
+            memcpy(accMax, values, n * sizeof(float));
+        }
+        else
+        {
+            for (std::size_t c = 0; c < n; ++c)
+            {
+                accMin[c] = std::min(accMin[c], values[c]);
+                accMax[c] = std::max(accMax[c], values[c]);
+            }
+        }
+
+        // 当前桶写满：移入环形缓冲区（覆盖最旧的桶）
+        if (++level.partialSamples == level.samplesPerBucket)
+        {
+            level.startTime[level.head] = level.partialStart;
+            memcpy(&level.minMax[level.head * n * 2], accMin, n * 2 * sizeof(float));
+            level.head = (level.head + 1) % capacity;
+            if (level.count < capacity) level.count++;
+            level.partialSamples = 0;
+        }
+    }
+}
+
+std::size_t MinMaxPyramid::bucketCount(const Level &level) const
+{
+    return level.count + (level.partialSamples > 0 ? 1 : 0);
+}
+
+double MinMaxPyramid::bucketStart(const Level &level, std::size_t i) const
+{
+    if (i == level.count)   return level.partialStart;
+    return level.startTime[(level.head + capacity - level.count + i) % capacity];
+}
+
+const float *MinMaxPyramid::bucketValues(const Level &level, std::size_t i) const
+{
+    if (i == level.count)   return level.partial.data();
+    const std::size_t slot = (level.head + capacity - level.count + i) % capacity;
+    return &level.minMax[slot * static_cast<std::size_t>(channels) * 2];
+}
+
+void MinMaxPyramid::bucketRange(const Level &level, double t0, double t1,
+                                std::size_t &first, std::size_t &last) const
+{
+    const std::size_t n = bucketCount(level);
+
+    // first: 包含 t0 的桶，即最后一个起始时间 <= t0 的桶
+    std::size_t lo = 0, hi = n;
+    while (lo < hi)
+    {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        if (bucketStart(level, mid) <= t0)  lo = mid + 1;
+        else                                hi = mid;
+    }
+    first = lo > 0 ? lo - 1 : 0;
+
+    // last: 第一个起始时间 > t1 的桶
+    lo = first;
+    hi = n;
+    while (lo < hi)
+    {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        if (bucketStart(level, mid) <= t1)  lo = mid + 1;
+        else                                hi = mid;
+    }
+    last = lo;
+}
+
+int MinMaxPyramid::selectLevel(double t0, double t1, std::size_t maxBuckets) const
+{
+    for (std::size_t k = 0; k < levelData.size(); ++k)
+    {
+        const Level &level = levelData[k];
+        if (bucketCount(level) == 0)    continue;
+        // 环形缓冲区已覆盖过旧数据时，该层最旧的桶必须早于窗口起点
+        const bool covers = level.count < capacity || bucketStart(level, 0) <= t0;
+        std::size_t first = 0, last = 0;
+        bucketRange(level, t0, t1, first, last);
+        if (covers && last - first <= maxBuckets)   return static_cast<int>(k);
+    }
+    return levelCount() - 1;
+}
+
+std::size_t MinMaxPyramid::query(int levelIndex, int channel, double t0, double t1, std::vector<Point> &out) const
+{
+    out.clear();
+    if (levelIndex < 0 || levelIndex >= levelCount() || channel < 0 || channel >= channels)  return 0;
+
+    const Level &level = levelData[static_cast<std::size_t>(levelIndex)];
+    std::size_t first = 0, last = 0;
+    bucketRange(level, t0, t1, first, last);
+    out.reserve((last - first) * 2);
+
+    const std::size_t c = static_cast<std::size_t>(channel);
+    const std::size_t n = static_cast<std::size_t>(channels);
+    for (std::size_t i = first; i < last; ++i)
+    {
+        const double start = bucketStart(level, i);
+        const float *values = bucketValues(level, i);
+        Point point;
+        point.time = start;
+        point.value = values[c];
+        out.push_back(point);
+        // 第0层 min == max，只输出一个点
+        if (level.samplesPerBucket > 1)
+        {
+            point.value = values[n + c];
+            out.push_back(point);
+        }
+    }
+    return out.size();
+}
@@ -0,0 +1,70 @@
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include <cstddef>
+#include <vector>
+
+// 多分辨率 min/max 降采样金字塔（多通道共用时间轴）
+// 第0层每个桶是一个原始样本，第 k 层每个桶覆盖 fanout^k 个样本，记录桶内每个通道的最小值和最大值。
+// 每层是固定容量的环形缓冲区，新样本到来时增量更新所有层（包括各层尚未写满的当前桶），
+// 因此内存固定：levels * bucketsPerLevel * (channels * 8 + 8) 字节，与会话时长无关。
+// 默认参数（10层，每层2048桶，4倍）下第0层覆盖最近2048个样本（100Hz约20秒），
+// 最顶层覆盖约 2048 * 4^9 个样本（100Hz约62天）。
+//
+// 显示时按窗口长度和像素宽度选择桶数不超过像素数的最细一层，
+// 这样无论窗口是1秒还是整个会话，每条曲线的点数都约等于横向像素数。
+class MinMaxPyramid
+{
+public:
+    struct Point {
+        double time;
+        float value;
+    };
+
+    MinMaxPyramid(int channels, int levels = 10, std::size_t bucketsPerLevel = 2048, int fanout = 4);
+
+    void clear();
+    // values 为 channels 个通道的值，time 需单调不减
+    void append(double time, const float *values);
+
+    int channelCount() const { return channels; }
+    int levelCount() const { return static_cast<int>(levelData.size()); }
+    bool isEmpty() const { return totalSamples == 0; }
+    double firstTime() const { return firstSampleTime; }
+    double lastTime() const { return lastSampleTime; }
+    std::size_t memoryBytes() const;
+
+    // 选择能覆盖 [t0, t1]、且窗口内桶数不超过 maxBuckets 的最细一层；都不满足时返回最粗一层
+    int selectLevel(double t0, double t1, std::size_t maxBuckets) const;
+    // 把某通道在 [t0, t1] 内的数据按时间顺序写入 out（先清空）：
+    // 第0层每个样本一个点，其余层每个桶依次输出最小值和最大值两个点。返回点数
+    std::size_t query(int level, int channel, double t0, double t1, std::vector<Point> &out) const;
+
+private:
+    struct Level {
+        std::size_t samplesPerBucket;
+        std::vector<double> startTime;  // 每个桶第一个样本的时间
+        std::vector<float> minMax;      // 每个桶 channels 个最小值，接着 channels 个最大值
+        std::size_t head;               // 下一个写入的桶
+        std::size_t count;              // 环形缓冲区中已完成的桶数
+        double partialStart;            // 当前桶（未写满）
+        std::vector<float> partial;
+        std::size_t partialSamples;
+    };
+
+    // 层内逻辑序号 i（0 为最旧，count 为当前未写满的桶）对应的数据
+    std::size_t bucketCount(const Level &level) const;
+    double bucketStart(const Level &level, std::size_t i) const;
+    const float *bucketValues(const Level &level, std::size_t i) const;
+    // 窗口 [t0, t1] 对应的桶序号范围 [first, last)
+    void bucketRange(const Level &level, double t0, double t1, std::size_t &first, std::size_t &last) const;
+
+    int channels;
+    std::size_t capacity;
+    std::vector<Level> levelData;
+    std::size_t totalSamples;
+    double firstSampleTime;
+    double lastSampleTime;
+};
+
+#endif // MINMAXPYRAMID_H
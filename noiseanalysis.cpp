@@ -0,0 +1,252 @@
+#include "noiseanalysis.h"
+#include <algorithm>
+#include <cmath>
+
+static const double PI = 3.14159265358979323846;
+
+RealFft::RealFft(int size) :
+    n(size)
+{
+    const int half = n / 2;
+    int bits = 0;
+    while ((1 << bits) < half)  ++bits;
+    bitReverse.resize(static_cast<std::size_t>(half));
+    for (int i = 0; i < half; ++i)
+    {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b)  reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        bitReverse[static_cast<std::size_t>(i)] = reversed;
+    }
+    twiddles.resize(static_cast<std::size_t>(half));
+    for (int k = 0; k < half / 2; ++k)
+    {
+        twiddles[static_cast<std::size_t>(2 * k)] = std::cos(2 * PI * k / half);
+        twiddles[static_cast<std::size_t>(2 * k + 1)] = -std::sin(2 * PI * k / half);
+    }
+    splitTwiddles.resize(static_cast<std::size_t>(2 * (half + 1)));
+    for (int k = 0; k <= half; ++k)
+    {
+        splitTwiddles[static_cast<std::size_t>(2 * k)] = std::cos(2 * PI * k / n);
+        splitTwiddles[static_cast<std::size_t>(2 * k + 1)] = -std::sin(2 * PI * k / n);
+    }
+}
+
+void RealFft::powerSpectrum(const double *input, double *power, double *work) const
+{
+    const int half = n / 2;
+    // 相邻两个实数样本作为一个复数，按位反转顺序放入工作区
+    for (int j = 0; j < half; ++j)
+    {
+        const int r = bitReverse[static_cast<std::size_t>(j)];
+        work[2 * r] = input[2 * j];
+        work[2 * r + 1] = input[2 * j + 1];
+    }
+    // 基2 蝶形运算
+    for (int length = 2; length <= half; length <<= 1)
+    {
+        const int step = half / length;
+        const int span = length / 2;
+        for (int i = 0; i < half; i += length)
+        {
+            for (int k = 0; k < span; ++k)
+            {
+                const double wr = twiddles[static_cast<std::size_t>(2 * k * step)];
+                const double wi = twiddles[static_cast<std::size_t>(2 * k * step + 1)];
+                double *u = work + 2 * (i + k);
+                double *v = work + 2 * (i + k + span);
+                const double tr = wr * v[0] - wi * v[1];
+                const double ti = wr * v[1] + wi * v[0];
+                v[0] = u[0] - tr;
+                v[1] = u[1] - ti;
+                u[0] += tr;
+                u[1] += ti;
+            }
+        }
+    }
+    // 拆分：X[k] = E[k] + W^k·O[k]，E = (Z[k] + conj(Z[half-k])) / 2，O = (Z[k] - conj(Z[half-k])) / 2i
+    for (int k = 0; k <= half; ++k)
+    {
+        const double *z = work + 2 * (k % half);
+        const double *zc = work + 2 * ((half - k) % half);
+        const double er = (z[0] + zc[0]) * 0.5;
+        const double ei = (z[1] - zc[1]) * 0.5;
+        const double orr = (z[1] + zc[1]) * 0.5;
+        const double oi = -(z[0] - zc[0]) * 0.5;
+        const double wr = splitTwiddles[static_cast<std::size_t>(2 * k)];
+        const double wi = splitTwiddles[static_cast<std::size_t>(2 * k + 1)];
+        const double xr = er + wr * orr - wi * oi;
+        const double xi = ei + wr * oi + wi * orr;
+        power[k] = xr * xr + xi * xi;
+    }
+}
+
+AllanDeviation::AllanDeviation() :
+    ringMask(0),
+    total(0),
+    first(0),
+    last(0),
+    samples(0),
+    invalid(0)
+{
+    configure(1);
+}
+
+void AllanDeviation::configure(int64_t maxCluster, int resolution, int pointsPerDecade)
+{
+    int ringResolution = 1;
+    while (ringResolution < resolution) ringResolution <<= 1;
+    maxCluster = std::max<int64_t>(1, maxCluster);
+    pointsPerDecade = std::max(1, pointsPerDecade);
+
+    // 对数等分的簇长，长簇取整到所在级步长的倍数
+    clusters.clear();
+    for (int i = 0; ; ++i)
+    {
+        int64_t m = static_cast<int64_t>(std::floor(std::pow(10.0, static_cast<double>(i) / pointsPerDecade) + 0.5));
+        if (m > maxCluster) break;
+        int level = 0;
+        while ((m >> (level + 1)) >= ringResolution)    ++level;
+        m = (m >> level) << level;
+        if (!clusters.empty() && m <= clusters.back().m)    continue;
+        Cluster cluster = {m, level, 0.0, 0};
+        clusters.push_back(cluster);
+    }
+
+    const int levelCount = clusters.back().level + 1;
+    levels.assign(static_cast<std::size_t>(levelCount), Level());
+    ringMask = static_cast<std::size_t>(4 * ringResolution) - 1;
+    std::size_t c = 0;
+    for (int l = 0; l < levelCount; ++l)
+    {
+        Level &level = levels[static_cast<std::size_t>(l)];
+        level.ring.assign(ringMask + 1, 0.0);
+        level.position = 1;             // X[0] = 0 已在环中
+        level.firstCluster = c;
+        while (c < clusters.size() && clusters[c].level == l)   ++c;
+        level.endCluster = c;
+    }
+    total = 0;
+    first = 0;
+    last = 0;
+    samples = 0;
+    invalid = 0;
+}
+
+void AllanDeviation::add(const float *values, std::size_t count)
+{
+    const std::size_t levelCount = levels.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float v = values[i];
+        if (!std::isfinite(v))
+        {
+            ++invalid;
+            v = samples > 0 ? last : 0.0f;
+        }
+        if (samples == 0)   first = v;
+        last = v;
+        total += static_cast<double>(v) - first;
+        ++samples;
+
+        // X[j]（j = 已有样本数）写入步长整除 j 的各级，并计算以它结尾的二阶差分
+        const uint64_t j = static_cast<uint64_t>(samples);
+        for (std::size_t l = 0; l < levelCount && (j & ((uint64_t(1) << l) - 1)) == 0; ++l)
+        {
+            Level &level = levels[l];
+            const std::size_t end = level.position;
+            level.ring[end & ringMask] = total;
+            level.position = end + 1;
+            for (std::size_t c = level.firstCluster; c < level.endCluster; ++c)
+            {
+                Cluster &cluster = clusters[c];
+                if (static_cast<uint64_t>(2 * cluster.m) > j)   break;
+                const std::size_t span = static_cast<std::size_t>(cluster.m >> l);
+                const double d = total - 2 * level.ring[(end - span) & ringMask] + level.ring[(end - 2 * span) & ringMask];
+                cluster.sum += d * d;
+                ++cluster.terms;
+            }
+        }
+    }
+}
+
+double AllanDeviation::deviation(std::size_t i) const
+{
+    const Cluster &cluster = clusters[i];
+    if (cluster.terms == 0) return 0;
+    const double m = static_cast<double>(cluster.m);
+    return std::sqrt(cluster.sum / (2 * m * m * static_cast<double>(cluster.terms)));
+}
+
+WelchPsd::WelchPsd(const RealFft *fft) :
+    transform(fft),
+    windowPower(0),
+    position(0),
+    pending(fft->size()),
+    segments(0),
+    last(0)
+{
+    const int n = fft->size();
+    window.resize(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i)
+    {
+        // 周期 Hann 窗（与 scipy.signal.welch 的默认窗相同）
+        const double w = 0.5 - 0.5 * std::cos(2 * PI * i / n);
+        window[static_cast<std::size_t>(i)] = w;
+        windowPower += w * w;
+    }
+    history.assign(static_cast<std::size_t>(n), 0.0);
+    segment.resize(static_cast<std::size_t>(n));
+    work.resize(static_cast<std::size_t>(n));
+    power.resize(static_cast<std::size_t>(n / 2 + 1));
+    accumulated.assign(static_cast<std::size_t>(n / 2 + 1), 0.0);
+}
+
+void WelchPsd::add(const float *samples, std::size_t count)
+{
+    const std::size_t mask = history.size() - 1;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        double v = samples[i];
+        if (!std::isfinite(v))  v = last;
+        last = v;
+        history[position] = v;
+        position = (position + 1) & mask;
+        if (--pending == 0)
+        {
+            processSegment();
+            pending = transform->size() / 2;
+        }
+    }
+}
+
+void WelchPsd::processSegment()
+{
+    const std::size_t n = history.size();
+    const std::size_t mask = n - 1;
+    double mean = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        segment[i] = history[(position + i) & mask];    // position 处为最早的样本
+        mean += segment[i];
+    }
+    mean /= static_cast<double>(n);
+    for (std::size_t i = 0; i < n; ++i) segment[i] = (segment[i] - mean) * window[i];
+    transform->powerSpectrum(segment.data(), power.data(), work.data());
+    for (std::size_t k = 0; k < power.size(); ++k)  accumulated[k] += power[k];
+    ++segments;
+}
+
+std::vector<double> WelchPsd::density(double sampleRate) const
+{
+    std::vector<double> result;
+    if (segments == 0 || !(sampleRate > 0)) return result;
+    const double scale = 1.0 / (sampleRate * windowPower * static_cast<double>(segments));
+    result.resize(accumulated.size());
+    for (std::size_t k = 0; k < accumulated.size(); ++k)
+    {
+        // 单边谱：除直流和奈奎斯特频点外，负频率的功率折叠到正频率
+        const double fold = k == 0 || k + 1 == accumulated.size() ? 1.0 : 2.0;
+        result[k] = accumulated[k] * scale * fold;
+    }
+    return result;
+}
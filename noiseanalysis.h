@@ -0,0 +1,112 @@
+#ifndef NOISEANALYSIS_H
+#define NOISEANALYSIS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 噪声分析的单通道流式累加器：逐块送入样本，内存占用与记录长度无关（离线分析 RecordingAnalyzer 使用）。
+
+// 实数序列的 FFT（长度为 2 的幂，>= 4）：把实数序列打包为 n/2 点复数序列做基2 FFT，再拆分出各频点。
+// 旋转因子预先计算，变换本身只读，多个线程可共用同一个对象（各自提供工作区）。
+class RealFft
+{
+public:
+    explicit RealFft(int size);
+
+    int size() const { return n; }
+    // input 的 n 个样本 → 频点 0 ~ n/2 的功率 |X_k|²（power 有 n/2 + 1 项），work 为 n 个 double 的工作区
+    void powerSpectrum(const double *input, double *power, double *work) const;
+
+private:
+    int n;
+    std::vector<int> bitReverse;        // n/2 点复数 FFT 的位反转置换
+    std::vector<double> twiddles;       // n/2 点 FFT 的旋转因子 exp(-2πik/(n/2))，实部虚部交替
+    std::vector<double> splitTwiddles;  // 拆分用的 exp(-2πik/n)，k < n/2
+};
+
+// 重叠 Allan 方差：σ²(m) = <(X[k+2m] - 2X[k+m] + X[k])²> / (2m²)，X 为样本累加和，τ = m·τ0。
+// 簇长 m 按对数等分（每十倍 pointsPerDecade 个）。m < resolution 时每个样本都作为起点（完全重叠）；
+// 更长的簇按 2 的幂步长 s 取起点（m/s 在 [resolution, 2·resolution) 之间），累加和只需保留每级最近
+// 4·resolution 个值，因此内存为 O(resolution · log(最大簇长))，而不是整个记录。
+// 长簇的起点虽有间隔，估计仍无偏，只是平均的项数少一些（对这些簇长本来就只有少数独立样本）。
+// 非有限值（nan/inf）按前一个样本计入，以免污染之后的累加和。
+class AllanDeviation
+{
+public:
+    static const int DEFAULT_RESOLUTION = 1024;
+    static const int DEFAULT_POINTS_PER_DECADE = 10;
+
+    AllanDeviation();
+
+    // 簇长最长到 maxCluster 个样本（按预计的样本数的一半设置）
+    void configure(int64_t maxCluster, int resolution = DEFAULT_RESOLUTION,
+                   int pointsPerDecade = DEFAULT_POINTS_PER_DECADE);
+    void add(const float *samples, std::size_t count);
+
+    int64_t sampleCount() const { return samples; }
+    int64_t invalidCount() const { return invalid; }
+    // 各簇长（样本数）、平均的项数和 Allan 偏差（与样本同单位）；项数为 0 的簇长偏差为 0
+    std::size_t clusterCount() const { return clusters.size(); }
+    int64_t clusterLength(std::size_t i) const { return clusters[i].m; }
+    int64_t termCount(std::size_t i) const { return clusters[i].terms; }
+    double deviation(std::size_t i) const;
+
+private:
+    struct Cluster {
+        int64_t m;
+        int level;                      // 步长 2^level
+        double sum;                     // 二阶差分平方和
+        int64_t terms;
+    };
+    // 每级保存步长 2^level 的累加和的最近 ring.size() 个值
+    struct Level {
+        std::vector<double> ring;
+        std::size_t position;          // 下一个写入位置
+        std::size_t firstCluster;      // 该级的簇在 clusters 中的范围
+        std::size_t endCluster;
+    };
+
+    std::vector<Cluster> clusters;      // 按 m 递增
+    std::vector<Level> levels;
+    std::size_t ringMask;
+    double total;                       // 累加和 X（减去第一个样本，避免长记录中数值过大）
+    float first;
+    float last;
+    int64_t samples;
+    int64_t invalid;
+};
+
+// Welch 功率谱密度：长度 n 的 Hann 窗分段，相邻段重叠一半，每段减去均值后做 FFT，对各段的 |X|² 取平均。
+// 只保留最近 n 个样本和累加的功率，结果按采样率换算为单边功率谱密度（单位²/Hz）。
+class WelchPsd
+{
+public:
+    static const int DEFAULT_LENGTH = 4096;
+
+    // fft 须在累加器使用期间有效
+    explicit WelchPsd(const RealFft *fft);
+    void add(const float *samples, std::size_t count);
+
+    int64_t segmentCount() const { return segments; }
+    // 单边功率谱密度：第 k 项对应频率 k·sampleRate/n（k = 0 ~ n/2），没有完整的段时为空
+    std::vector<double> density(double sampleRate) const;
+
+private:
+    void processSegment();
+
+    const RealFft *transform;
+    std::vector<double> window;
+    double windowPower;                 // Σw²
+    std::vector<double> history;        // 最近 n 个样本（环形）
+    std::size_t position;
+    int64_t pending;                    // 距离下一段结束还差的样本数
+    std::vector<double> segment;
+    std::vector<double> work;
+    std::vector<double> power;
+    std::vector<double> accumulated;
+    int64_t segments;
+    double last;                        // 上一个有限样本，非有限值按它计入
+};
+
+#endif // NOISEANALYSIS_H
@@ -0,0 +1,256 @@
+#include "pipelinestats.h"
+#include <cstdarg>
+#include <cstdio>
+#include <limits>
+
+// ---------------------------------------------------------------------------
+// LatencyHistogram
+// ---------------------------------------------------------------------------
+
+static const int SUB_BUCKETS = 64;          // 0~63 为线性区
+static const int HALF_SUB_BUCKETS = 32;     // 之后每个2的幂区间32个桶
+
+// 最高有效位位置（v > 0）
+static int highestBit(uint64_t v)
+{
+    int bit = 0;
+    if (v >> 32) { v >>= 32; bit += 32; }
+    if (v >> 16) { v >>= 16; bit += 16; }
+    if (v >> 8)  { v >>= 8;  bit += 8; }
+    if (v >> 4)  { v >>= 4;  bit += 4; }
+    if (v >> 2)  { v >>= 2;  bit += 2; }
+    if (v >> 1)  { bit += 1; }
+    return bit;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+int LatencyHistogram::bucketIndex(int64_t valueNs)
+{
+    if (valueNs < SUB_BUCKETS)  return valueNs < 0 ? 0 : static_cast<int>(valueNs);
+    const uint64_t v = static_cast<uint64_t>(valueNs);
+    const int shift = highestBit(v) - 5;
+    return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS + static_cast<int>((v >> shift) - HALF_SUB_BUCKETS);
+}
+
+int64_t LatencyHistogram::bucketLower(int bucket)
+{
+    if (bucket < SUB_BUCKETS)   return bucket;
+    const int k = bucket - SUB_BUCKETS;
+    const int shift = k / HALF_SUB_BUCKETS + 1;
+    return static_cast<int64_t>(static_cast<uint64_t>(k % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS) << shift);
+}
+
+int64_t LatencyHistogram::bucketUpper(int bucket)
+{
+    if (bucket + 1 >= BUCKET_COUNT) return std::numeric_limits<int64_t>::max();
+    return bucketLower(bucket + 1) - 1;
+}
+
+void LatencyHistogram::record(int64_t valueNs, uint64_t count)
+{
+    if (count == 0) return;
+    if (valueNs < 0)    valueNs = 0;
+    // 单写者：读-改-写无需原子操作，只需保证其他线程读到完整的值
+    std::atomic<uint64_t> &bucket = counts[bucketIndex(valueNs)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    total.store(total.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    sum.store(sum.load(std::memory_order_relaxed) + valueNs * static_cast<int64_t>(count), std::memory_order_relaxed);
+    if (valueNs < minValue.load(std::memory_order_relaxed)) minValue.store(valueNs, std::memory_order_relaxed);
+    if (valueNs > maxValue.load(std::memory_order_relaxed)) maxValue.store(valueNs, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < BUCKET_COUNT; ++i)  counts[i].store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    minValue.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::minimum() const
+{
+    return count() > 0 ? minValue.load(std::memory_order_relaxed) : 0;
+}
+
+double LatencyHistogram::mean() const
+{
+    const uint64_t n = count();
+    return n > 0 ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+int64_t LatencyHistogram::percentile(double percent) const
+{
+    const uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(percent / 100.0 * n + 0.5);
+    if (target < 1) target = 1;
+    if (target > n) target = n;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += bucketCount(i);
+        if (seen >= target)
+        {
+            const int64_t upper = bucketUpper(i);
+            return upper < maximum() ? upper : maximum();
+        }
+    }
+    return maximum();
+}
+
+// ---------------------------------------------------------------------------
+// SlidingRate
+// ---------------------------------------------------------------------------
+
+SlidingRate::SlidingRate(double windowSeconds, int bins)
+{
+    binCount = bins < 2 ? 2 : (bins > MAX_BINS ? MAX_BINS : bins);
+    binNs = static_cast<int64_t>(windowSeconds * 1.0e9 / (binCount - 1));
+    reset();
+}
+
+void SlidingRate::reset()
+{
+    for (int i = 0; i < MAX_BINS; ++i)
+    {
+        binId[i].store(-1, std::memory_order_relaxed);
+        binEvents[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void SlidingRate::add(int64_t nowNs, uint64_t events)
+{
+    const int64_t id = nowNs / binNs;
+    const int slot = static_cast<int>(id % binCount);
+    if (binId[slot].load(std::memory_order_relaxed) != id)
+    {
+        // 桶已过期，重新开始计数（先清零再改序号，读者最多少算几个事件）
+        binEvents[slot].store(0, std::memory_order_relaxed);
+        binId[slot].store(id, std::memory_order_release);
+    }
+    binEvents[slot].store(binEvents[slot].load(std::memory_order_relaxed) + events, std::memory_order_relaxed);
+}
+
+double SlidingRate::rate(int64_t nowNs) const
+{
+    // 只统计当前桶之前的 binCount - 1 个完整桶
+    const int64_t current = nowNs / binNs;
+    uint64_t events = 0;
+    for (int i = 0; i < binCount; ++i)
+    {
+        const int64_t id = binId[i].load(std::memory_order_acquire);
+        if (id < current && id > current - binCount)    events += binEvents[i].load(std::memory_order_relaxed);
+    }
+    return events / windowSeconds();
+}
+
+// ---------------------------------------------------------------------------
+// PipelineStats
+// ---------------------------------------------------------------------------
+
+PipelineStats::PipelineStats() :
+    rate1s(1.0, 21),
+    rate10s(10.0, 101)
+{
+    reset();
+}
+
+void PipelineStats::reset()
+{
+    frameInterval.reset();
+    decodeLatency.reset();
+    writeLatency.reset();
+    drawLatency.reset();
+    dspCost.reset();
+    attitudeCost.reset();
+    rate1s.reset();
+    rate10s.reset();
+    resyncEvents = 0;
+    frameQueuePeak = 0;
+    writeQueuePeak = 0;
+    backlogPeak = 0;
+}
+
+void PipelineStats::raisePeak(std::atomic<uint64_t> &peak, uint64_t value)
+{
+    uint64_t old = peak.load(std::memory_order_relaxed);
+    while (value > old && !peak.compare_exchange_weak(old, value, std::memory_order_relaxed)) {}
+}
+
+static void appendLine(std::string &out, const char *format, ...)
+{
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    out += line;
+}
+
+// 单项计算耗时的分位数表（耗时很短，按纳秒输出），没有样本时不输出
+static void appendCostTable(std::string &out, const char *title, const char *name, const LatencyHistogram &h)
+{
+    if (h.count() == 0) return;
+    appendLine(out, "\n# %s\nstage,count,min,p50,p90,p99,p99.9,max,mean\n", title);
+    appendLine(out, "%s,%llu,%lld,%lld,%lld,%lld,%lld,%lld,%.1f\n", name,
+               static_cast<unsigned long long>(h.count()),
+               static_cast<long long>(h.minimum()), static_cast<long long>(h.percentile(50)),
+               static_cast<long long>(h.percentile(90)), static_cast<long long>(h.percentile(99)),
+               static_cast<long long>(h.percentile(99.9)), static_cast<long long>(h.maximum()), h.mean());
+}
+
+std::string PipelineStats::report() const
+{
+    struct Entry {
+        const char *name;
+        const LatencyHistogram *histogram;
+    };
+    const Entry entries[] = {
+        {"frame_interval", &frameInterval},
+        {"read_to_decoded", &decodeLatency},
+        {"read_to_written", &writeLatency},
+        {"read_to_drawn", &drawLatency}
+    };
+    const int entryCount = static_cast<int>(sizeof(entries) / sizeof(entries[0]));
+
+    // 汇总表：毫秒，便于直接回答“最长停顿是否超过 X ms”
+    std::string out;
+    out += "# 管线延迟汇总（毫秒）\n";
+    out += "stage,count,min,p50,p90,p99,p99.9,max,mean\n";
+    for (int i = 0; i < entryCount; ++i)
+    {
+        const LatencyHistogram &h = *entries[i].histogram;
+        appendLine(out, "%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", entries[i].name,
+                   static_cast<unsigned long long>(h.count()),
+                   h.minimum() / 1.0e6, h.percentile(50) / 1.0e6, h.percentile(90) / 1.0e6,
+                   h.percentile(99) / 1.0e6, h.percentile(99.9) / 1.0e6, h.maximum() / 1.0e6, h.mean() / 1.0e6);
+    }
+    appendLine(out, "\nresync_events,%llu\nframe_queue_peak_frames,%llu\nwrite_queue_peak_bytes,%llu\nbacklog_peak_bytes,%llu\n",
+               static_cast<unsigned long long>(resyncEvents.load()),
+               static_cast<unsigned long long>(frameQueuePeak.load()),
+               static_cast<unsigned long long>(writeQueuePeak.load()),
+               static_cast<unsigned long long>(backlogPeak.load()));
+    appendCostTable(out, "实时信号处理每块每通道耗时（纳秒）", "dsp_block_channel", dspCost);
+    appendCostTable(out, "姿态解算每帧耗时（纳秒，所有IMU）", "attitude_frame", attitudeCost);
+
+    // 完整直方图：每个非空桶一行，纳秒
+    for (int i = 0; i < entryCount; ++i)
+    {
+        const LatencyHistogram &h = *entries[i].histogram;
+        appendLine(out, "\n# %s 直方图（纳秒）\nlower,upper,count\n", entries[i].name);
+        for (int b = 0; b < LatencyHistogram::BUCKET_COUNT; ++b)
+        {
+            const uint64_t n = h.bucketCount(b);
+            if (n == 0) continue;
+            appendLine(out, "%lld,%lld,%llu\n", static_cast<long long>(LatencyHistogram::bucketLower(b)),
+                       static_cast<long long>(LatencyHistogram::bucketUpper(b)), static_cast<unsigned long long>(n));
+        }
+    }
+    return out;
+}
@@ -0,0 +1,102 @@
+#ifndef PIPELINESTATS_H
+#define PIPELINESTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// 各线程共用的单调时钟（纳秒），帧的到达时刻和各阶段时刻都用它
+inline int64_t steadyClockNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// HDR风格的对数-线性直方图（纳秒）：
+// 0~63 每个值一个桶，之后每个2的幂区间均分为32个桶，相对精度约3%，
+// 覆盖 0 ~ 2^63 纳秒，内存固定（约15KB），记录一次只是几次整数运算。
+// 单写者：只允许一个线程调用 record()，其余线程可以随时无锁读取（读到的是近似快照）。
+class LatencyHistogram
+{
+public:
+    static const int BUCKET_COUNT = 64 + 57 * 32;
+
+    LatencyHistogram();
+
+    void record(int64_t valueNs, uint64_t count = 1);
+    // 清零；与 record() 并发时个别计数可能丢失，仅用于统计
+    void reset();
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    int64_t minimum() const;
+    int64_t maximum() const { return maxValue.load(std::memory_order_relaxed); }
+    double mean() const;
+    // 百分位（0~100），返回所在桶的上界（不超过最大值）
+    int64_t percentile(double percent) const;
+
+    // 逐桶访问，用于导出完整直方图
+    uint64_t bucketCount(int bucket) const { return counts[bucket].load(std::memory_order_relaxed); }
+    static int64_t bucketLower(int bucket);
+    static int64_t bucketUpper(int bucket);
+    static int bucketIndex(int64_t valueNs);
+
+private:
+    std::atomic<uint64_t> counts[BUCKET_COUNT];
+    std::atomic<uint64_t> total;
+    std::atomic<int64_t> sum;
+    std::atomic<int64_t> minValue;
+    std::atomic<int64_t> maxValue;
+};
+
+// 滑动窗口速率：把事件计入按时间划分的固定个数的桶，
+// 速率 = 最近 bins - 1 个完整桶的事件数 / 对应时长，数据停止到达时会随时间降到0。
+// 单写者，多读者。
+class SlidingRate
+{
+public:
+    static const int MAX_BINS = 128;
+
+    SlidingRate(double windowSeconds, int bins);
+
+    void add(int64_t nowNs, uint64_t events);
+    void reset();
+    double rate(int64_t nowNs) const;      // 事件/秒
+    double windowSeconds() const { return binNs * (binCount - 1) / 1.0e9; }
+
+private:
+    int64_t binNs;
+    int binCount;
+    std::atomic<int64_t> binId[MAX_BINS];       // 桶对应的时间序号（nowNs / binNs）
+    std::atomic<uint64_t> binEvents[MAX_BINS];
+};
+
+// 采集管线的运行统计：帧到达间隔、各阶段延迟、失步次数、队列深度峰值。
+// 各直方图分别由产生数据的线程写入（见成员注释），界面线程和统计报告只读。
+// 所有时间均为单调时钟（std::chrono::steady_clock）纳秒，各阶段以帧的到达时刻为起点。
+struct PipelineStats
+{
+    PipelineStats();
+
+    LatencyHistogram frameInterval;   // 相邻两帧的到达间隔（同一批读出的帧间隔为0），采集线程
+    LatencyHistogram decodeLatency;   // 串口读出 → 帧解析完成，采集线程
+    LatencyHistogram writeLatency;    // 串口读出 → 写入文件（按写盘缓冲区统计，取其中最早一帧），写盘线程
+    LatencyHistogram drawLatency;     // 串口读出 → 推送到图表曲线，界面线程
+    LatencyHistogram dspCost;         // 实时信号处理每块（最多64帧）每通道的耗时，采集线程
+    LatencyHistogram attitudeCost;    // 姿态解算每帧（所有IMU）的耗时，按批平均，采集线程
+    SlidingRate rate1s;               // 最近约1秒的帧率，采集线程
+    SlidingRate rate10s;              // 最近约10秒的帧率，采集线程
+
+    std::atomic<uint64_t> resyncEvents;     // 失步次数（从同步状态开始丢弃字节）
+    std::atomic<uint64_t> frameQueuePeak;   // 界面帧队列深度峰值（帧）
+    std::atomic<uint64_t> writeQueuePeak;   // 写盘队列深度峰值（字节）
+    std::atomic<uint64_t> backlogPeak;      // 接收积压峰值（字节）
+
+    void reset();
+    static void raisePeak(std::atomic<uint64_t> &peak, uint64_t value);
+
+    // 文本报告：汇总表（次数、最小、P50/P90/P99/P99.9、最大、平均）+ 各直方图的非空桶
+    std::string report() const;
+};
+
+#endif // PIPELINESTATS_H
@@ -0,0 +1,657 @@
+#include "recordinganalyzer.h"
+#include "recordingreader.h"
+#include "csvparser.h"
+#include "noiseanalysis.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+static const char *const CHANNEL_NAMES[DATA_PER_IMU] = {"ax", "ay", "az", "gx", "gy", "gz"};
+static const int NOMINAL_INTERVAL_SAMPLES = 1001;      // 取前这么多个帧间隔的中位数作为标称间隔
+
+// 一个输入文件
+struct AnalysisInput {
+    QString fileName;
+    bool binary;
+    std::unique_ptr<QFile> file;        // CSV：映射的文件
+    const char *data;                   // CSV：映射的内容
+    qint64 size;
+    qint64 dataStart;                   // CSV：第一行数据的偏移（跳过表头）
+    qint64 frames;                      // 二进制记录：帧数
+};
+
+// 一块输入：CSV 为按行对齐的字节范围，二进制记录为帧范围
+struct AnalysisChunk {
+    int input;
+    qint64 begin;
+    qint64 end;
+};
+
+// 解析好的一块：各通道的列和每行的时间戳
+struct AnalysisPart {
+    std::vector<float> packed;          // 解析时按行存放（每行 channelCount 个值）
+    std::vector<float> columns;         // 转置为 通道 → 行
+    std::vector<qint64> stamps;         // 每行的时间戳（纳秒）
+    qint64 rows;
+    qint64 bad;
+    std::size_t index;                  // 块序号
+    bool ready;
+};
+
+// 时间戳：统计缺口并估计平均采样间隔（作为一个特殊的“通道”按顺序处理）
+struct StampTracker {
+    qint64 first;
+    qint64 last;
+    qint64 rows;
+    double nominal;                     // 标称间隔（纳秒），确定之前为0
+    std::vector<qint64> intervals;      // 确定标称间隔之前的帧间隔
+    qint64 gaps;
+    qint64 missing;
+
+    StampTracker() : first(0), last(0), rows(0), nominal(0), gaps(0), missing(0) {}
+
+    void classify(qint64 interval)
+    {
+        if (interval <= 1.5 * nominal)  return;
+        ++gaps;
+        missing += std::llround(interval / nominal) - 1;
+    }
+    void settle()
+    {
+        if (nominal > 0 || intervals.empty())   return;
+        std::vector<qint64> sorted(intervals);
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        nominal = std::max<double>(1.0, static_cast<double>(sorted[sorted.size() / 2]));
+        for (qint64 interval : intervals)   classify(interval);
+        std::vector<qint64>().swap(intervals);
+    }
+    void add(const qint64 *stamps, qint64 count)
+    {
+        for (qint64 i = 0; i < count; ++i)
+        {
+            if (rows++ == 0)
+            {
+                first = last = stamps[i];
+                continue;
+            }
+            const qint64 interval = stamps[i] - last;
+            last = stamps[i];
+            if (nominal > 0)
+            {
+                classify(interval);
+                continue;
+            }
+            intervals.push_back(interval);
+            if (static_cast<int>(intervals.size()) >= NOMINAL_INTERVAL_SAMPLES) settle();
+        }
+    }
+};
+
+RecordingAnalyzer::RecordingAnalyzer() :
+    threadCount(0),
+    chunkBytes(DEFAULT_CHUNK_BYTES),
+    fftLength(WelchPsd::DEFAULT_LENGTH),
+    progressPermille(0),
+    cancelRequested(false)
+{
+}
+
+bool RecordingAnalyzer::analyze(const QStringList &inputs, Result *result, QString *errorString)
+{
+    QElapsedTimer timer;
+    timer.start();
+    progressPermille = 0;
+    cancelRequested = false;
+    const int threads = threadCount > 0 ? threadCount : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    const auto fail = [errorString](const QString &message) {
+        if (errorString)    *errorString = message;
+        return false;
+    };
+    if (inputs.isEmpty())   return fail("没有输入文件");
+    if (!isValidFftLength(fftLength))   return fail(QString("FFT长度 %1 不是 16 ~ 2^24 之间的2的幂").arg(fftLength));
+
+    // 打开输入：按文件头的 magic 识别二进制记录，其余按CSV内存映射；同时估计总行数（决定最长簇长）
+    std::vector<AnalysisInput> files(static_cast<std::size_t>(inputs.size()));
+    int imuCount = 0;
+    int firstInput = -1;
+    qint64 inputBytes = 0;
+    qint64 expectedRows = 0;
+    for (int i = 0; i < inputs.size(); ++i)
+    {
+        AnalysisInput &input = files[static_cast<std::size_t>(i)];
+        input.fileName = inputs.at(i);
+        input.file.reset(new QFile(input.fileName));
+        if (!input.file->open(QIODevice::ReadOnly))
+            return fail(QString("%1: %2").arg(input.fileName, input.file->errorString()));
+        input.size = input.file->size();
+        input.data = nullptr;
+        input.dataStart = 0;
+        input.frames = 0;
+        inputBytes += input.size;
+
+        char magic[sizeof(RECORDING_MAGIC)] = {0};
+        input.file->read(magic, sizeof(magic));
+        input.binary = memcmp(magic, RECORDING_MAGIC, sizeof(magic)) == 0
+                || memcmp(magic, RECORDING_COMPRESSED_MAGIC, sizeof(magic)) == 0;
+
+        int fileImuCount = 0;
+        if (input.binary)
+        {
+            input.file.reset();
+            RecordingReader reader;
+            QString error;
+            if (!reader.open(input.fileName, &error))   return fail(QString("%1: %2").arg(input.fileName, error));
+            input.frames = reader.frameCount();
+            fileImuCount = reader.frameFormat().imuCount;
+            expectedRows += input.frames;
+        }
+        else if (input.size > 0)
+        {
+            input.data = reinterpret_cast<const char *>(input.file->map(0, input.size));
+            if (!input.data)    return fail(QString("%1: %2").arg(input.fileName, input.file->errorString()));
+            const char *end = input.data + input.size;
+            const char *first = CsvParser::findData(input.data, end);
+            input.dataStart = first - input.data;
+            if (first == end)   continue;
+            const int values = CsvParser::valueCount(first, end);
+            if (values == 0 || values % DATA_PER_IMU != 0 || values / DATA_PER_IMU > MAX_IMU_COUNT)
+                return fail(QString("%1: 第一行数据有 %2 个数值，不是 IMU数量 × %3").arg(input.fileName).arg(values).arg(DATA_PER_IMU));
+            fileImuCount = values / DATA_PER_IMU;
+            // 各行长度相近（固定6位小数），按第一行的长度估计，留出余量
+            const qint64 lineBytes = std::max<qint64>(1, CsvParser::nextLine(first, end) - first);
+            expectedRows += (input.size - input.dataStart) * 5 / (lineBytes * 4) + 1;
+        }
+        else
+        {
+            continue;
+        }
+
+        if (firstInput >= 0 && input.binary != files[static_cast<std::size_t>(firstInput)].binary)
+            return fail("不能把CSV和二进制记录拼接分析");
+        if (imuCount != 0 && fileImuCount != imuCount)
+            return fail(QString("%1: IMU数量 %2 与之前的文件（%3）不同").arg(input.fileName).arg(fileImuCount).arg(imuCount));
+        if (firstInput < 0) firstInput = i;
+        imuCount = fileImuCount;
+    }
+    if (firstInput < 0) return fail("输入文件中没有数据");
+    const bool binary = files[static_cast<std::size_t>(firstInput)].binary;
+    const int valueCount = imuCount * DATA_PER_IMU;
+    const int channelCount = valueCount + 6;
+
+    // 切块：CSV 每块约 chunkBytes 字节并延伸到行尾，二进制记录按每帧的数据量换算为帧数
+    std::vector<AnalysisChunk> chunks;
+    const qint64 chunkSize = std::max<qint64>(chunkBytes, 64 * 1024);
+    for (int i = 0; i < static_cast<int>(files.size()); ++i)
+    {
+        const AnalysisInput &input = files[static_cast<std::size_t>(i)];
+        const qint64 total = input.binary ? input.frames : input.size;
+        const qint64 step = input.binary ? std::max<qint64>(1, chunkSize / (valueCount * 4 + 32)) : chunkSize;
+        for (qint64 begin = input.dataStart; begin < total;)
+        {
+            qint64 end = std::min(total, begin + step);
+            if (!input.binary && end < total)   end = CsvParser::nextLine(input.data + end - 1, input.data + total) - input.data;
+            chunks.push_back(AnalysisChunk{i, begin, end});
+            begin = end;
+        }
+    }
+
+    // 每个线程为每个二进制输入各开一个读取器（读取器缓存解码的块，不能共用）
+    std::vector<std::vector<std::unique_ptr<RecordingReader>>> readers(static_cast<std::size_t>(threads));
+    if (binary)
+    {
+        for (auto &perThread : readers)
+        {
+            for (const AnalysisInput &input : files)
+            {
+                perThread.emplace_back(input.binary ? new RecordingReader : nullptr);
+                if (!input.binary)  continue;
+                QString error;
+                if (!perThread.back()->open(input.fileName, &error))
+                    return fail(QString("%1: %2").arg(input.fileName, error));
+            }
+        }
+    }
+
+    // 各通道的累加器，最后一个“通道”为时间戳
+    const RealFft fft(fftLength);
+    std::vector<AllanDeviation> allan(static_cast<std::size_t>(channelCount));
+    std::vector<std::unique_ptr<WelchPsd>> welch;
+    for (int c = 0; c < channelCount; ++c)
+    {
+        allan[static_cast<std::size_t>(c)].configure(std::max<qint64>(1, expectedRows / 2));
+        welch.emplace_back(new WelchPsd(&fft));
+    }
+    StampTracker stamps;
+    qint64 badLines = 0;
+    const int tasks = channelCount + 1;
+
+    const auto parse = [&](const AnalysisChunk &chunk, AnalysisPart &part, int thread) {
+        const AnalysisInput &input = files[static_cast<std::size_t>(chunk.input)];
+        const std::size_t width = static_cast<std::size_t>(channelCount);
+        part.rows = 0;
+        part.bad = 0;
+        part.packed.clear();
+        part.stamps.clear();
+        const auto appendRow = [&](qint64 stamp, const float *values, const float *mean) {
+            const std::size_t offset = part.packed.size();
+            part.packed.resize(offset + width);
+            memcpy(&part.packed[offset], values, static_cast<std::size_t>(valueCount) * sizeof(float));
+            memcpy(&part.packed[offset + static_cast<std::size_t>(valueCount)], mean, 6 * sizeof(float));
+            part.stamps.push_back(stamp);
+            ++part.rows;
+        };
+        if (input.binary)
+        {
+            RecordingReader &reader = *readers[static_cast<std::size_t>(thread)][static_cast<std::size_t>(chunk.input)];
+            part.packed.reserve(static_cast<std::size_t>(chunk.end - chunk.begin) * width);
+            ImuFrame frame;
+            float mean[6];
+            for (qint64 i = chunk.begin; i < chunk.end; ++i)
+            {
+                // 损坏的压缩块中的帧跳过
+                if (!reader.readFrame(i, frame))
+                {
+                    ++part.bad;
+                    continue;
+                }
+                memcpy(mean, frame.meanAccel, sizeof(frame.meanAccel));
+                memcpy(mean + 3, frame.meanGyro, sizeof(frame.meanGyro));
+                appendRow(frame.monotonicNs, &frame.imu[0].accel[0], mean);
+            }
+        }
+        else
+        {
+            const char *p = input.data + chunk.begin;
+            const char *end = input.data + chunk.end;
+            int64_t timestampMs;
+            float values[MAX_IMU_COUNT * DATA_PER_IMU];
+            float mean[6];
+            while (p < end)
+            {
+                const char *next = CsvParser::nextLine(p, end);
+                const char *lineEnd = CsvParser::lineEnd(p, next);
+                if (lineEnd > p)
+                {
+                    if (CsvParser::parseLine(p, lineEnd, valueCount, timestampMs, values))
+                    {
+                        // CSV 中没有均值，按行计算（与采集时相同：所有IMU的算术平均）
+                        for (int j = 0; j < 6; ++j)     mean[j] = 0;
+                        for (int i = 0; i < imuCount; ++i)
+                        {
+                            for (int j = 0; j < 6; ++j) mean[j] += values[i * DATA_PER_IMU + j];
+                        }
+                        for (int j = 0; j < 6; ++j)     mean[j] /= imuCount;
+                        appendRow(timestampMs * 1000000, values, mean);
+                    }
+                    else
+                    {
+                        ++part.bad;
+                    }
+                }
+                p = next;
+            }
+        }
+
+        // 行 → 列：每个通道的样本连续，交给各通道的累加器
+        const std::size_t rows = static_cast<std::size_t>(part.rows);
+        part.columns.resize(rows * width);
+        for (std::size_t r = 0; r < rows; ++r)
+        {
+            const float *row = &part.packed[r * width];
+            for (std::size_t c = 0; c < width; ++c) part.columns[c * rows + r] = row[c];
+        }
+    };
+
+    const auto consume = [&](int task, const AnalysisPart &part) {
+        if (task == channelCount)
+        {
+            stamps.add(part.stamps.data(), part.rows);
+            badLines += part.bad;
+            return;
+        }
+        const float *column = part.columns.data() + static_cast<std::size_t>(task) * static_cast<std::size_t>(part.rows);
+        allan[static_cast<std::size_t>(task)].add(column, static_cast<std::size_t>(part.rows));
+        welch[static_cast<std::size_t>(task)]->add(column, static_cast<std::size_t>(part.rows));
+    };
+
+    // 解析：线程按块序号取块，结果放入 parts[块序号 % window]；
+    // 分析：每个通道按块的顺序读入，某块被所有通道读过后其位置才能放入新的块，同时在途的块不超过 window 个
+    const std::size_t window = static_cast<std::size_t>(threads) * 2;
+    std::vector<AnalysisPart> parts(window);
+    for (AnalysisPart &part : parts)    part.ready = false;
+    std::vector<std::size_t> consumed(static_cast<std::size_t>(tasks), 0);
+    std::vector<char> busy(static_cast<std::size_t>(tasks), 0);
+    std::size_t nextChunk = 0;
+    std::size_t released = 0;
+    bool stopped = false;
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            int scanStart = t * tasks / threads;
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;)
+            {
+                if (stopped || cancelRequested)
+                {
+                    stopped = true;
+                    changed.notify_all();
+                    return;
+                }
+                if (released >= chunks.size())  return;
+
+                // 优先处理已解析的块，尽快腾出位置
+                int task = -1;
+                for (int i = 0; i < tasks && task < 0; ++i)
+                {
+                    const int candidate = (scanStart + i) % tasks;
+                    const std::size_t index = consumed[static_cast<std::size_t>(candidate)];
+                    if (busy[static_cast<std::size_t>(candidate)] || index >= chunks.size()) continue;
+                    const AnalysisPart &part = parts[index % window];
+                    if (part.ready && part.index == index)  task = candidate;
+                }
+                if (task >= 0)
+                {
+                    scanStart = task + 1;
+                    busy[static_cast<std::size_t>(task)] = 1;
+                    const AnalysisPart &part = parts[consumed[static_cast<std::size_t>(task)] % window];
+                    lock.unlock();
+                    consume(task, part);
+                    lock.lock();
+                    busy[static_cast<std::size_t>(task)] = 0;
+                    ++consumed[static_cast<std::size_t>(task)];
+                    const std::size_t done = *std::min_element(consumed.begin(), consumed.end());
+                    for (; released < done; ++released) parts[released % window].ready = false;
+                    progressPermille = static_cast<int>(released * 1000 / chunks.size());
+                    changed.notify_all();
+                    continue;
+                }
+
+                if (nextChunk < chunks.size() && nextChunk < released + window)
+                {
+                    const std::size_t index = nextChunk++;
+                    AnalysisPart &part = parts[index % window];
+                    lock.unlock();
+                    parse(chunks[index], part, t);
+                    lock.lock();
+                    part.index = index;
+                    part.ready = true;
+                    changed.notify_all();
+                    continue;
+                }
+                changed.wait(lock);
+            }
+        });
+    }
+    for (std::thread &worker : workers) worker.join();
+    if (stopped)    return fail("分析已取消");
+
+    stamps.settle();
+    if (stamps.rows < 2)    return fail("数据太少，至少需要两帧");
+
+    Result stats;
+    stats.imuCount = imuCount;
+    for (int imu = 0; imu < imuCount; ++imu)
+    {
+        for (int channel = 0; channel < DATA_PER_IMU; ++channel)
+            stats.channels << QString("imu%1_%2").arg(imu + 1).arg(CHANNEL_NAMES[channel]);
+    }
+    for (int channel = 0; channel < DATA_PER_IMU; ++channel)
+        stats.channels << QString("mean_%1").arg(CHANNEL_NAMES[channel]);
+    stats.rows = stamps.rows;
+    stats.badLines = badLines;
+    stats.invalidValues = 0;
+    for (const AllanDeviation &a : allan)   stats.invalidValues += a.invalidCount();
+    stats.gaps = stamps.gaps;
+    stats.missingFrames = stamps.missing;
+    stats.sampleInterval = static_cast<double>(stamps.last - stamps.first) / 1e9 / static_cast<double>(stamps.rows - 1 + stamps.missing);
+    stats.inputBytes = inputBytes;
+    stats.threads = threads;
+    if (!(stats.sampleInterval > 0))    return fail("时间戳不递增，无法确定采样间隔");
+
+    const AllanDeviation &reference = allan.front();
+    for (std::size_t i = 0; i < reference.clusterCount(); ++i)
+    {
+        if (reference.termCount(i) == 0)    break;
+        stats.tau.push_back(static_cast<double>(reference.clusterLength(i)) * stats.sampleInterval);
+        stats.terms.push_back(reference.termCount(i));
+    }
+    stats.adev.resize(static_cast<std::size_t>(channelCount));
+    stats.psd.resize(static_cast<std::size_t>(channelCount));
+    const double sampleRate = 1.0 / stats.sampleInterval;
+    for (int c = 0; c < channelCount; ++c)
+    {
+        std::vector<double> &adev = stats.adev[static_cast<std::size_t>(c)];
+        for (std::size_t i = 0; i < stats.tau.size(); ++i)  adev.push_back(allan[static_cast<std::size_t>(c)].deviation(i));
+        stats.psd[static_cast<std::size_t>(c)] = welch[static_cast<std::size_t>(c)]->density(sampleRate);
+    }
+    stats.fftLength = fftLength;
+    stats.segments = welch.front()->segmentCount();
+    for (std::size_t k = 0; k < stats.psd.front().size(); ++k)
+        stats.frequency.push_back(static_cast<double>(k) * sampleRate / fftLength);
+
+    progressPermille = 1000;
+    stats.seconds = timer.nsecsElapsed() / 1e9;
+    if (result) *result = stats;
+    return true;
+}
+
+RecordingAnalyzer::NoiseSummary RecordingAnalyzer::summarize(const Result &result, int channel)
+{
+    NoiseSummary summary = {0, 0, 0, 0};
+    const std::vector<double> &adev = result.adev[static_cast<std::size_t>(channel)];
+    for (std::size_t i = 0; i < adev.size(); ++i)
+    {
+        if (adev[i] > 0 && (summary.minimumAdev == 0 || adev[i] < summary.minimumAdev))
+        {
+            summary.minimumAdev = adev[i];
+            summary.minimumTau = result.tau[i];
+        }
+        // τ = 1 秒落在两个簇长之间时按对数坐标线性插值；记录短于 1 秒时为0
+        if (i > 0 && result.tau[i - 1] <= 1.0 && result.tau[i] >= 1.0 && adev[i - 1] > 0 && adev[i] > 0)
+        {
+            const double f = std::log(1.0 / result.tau[i - 1]) / std::log(result.tau[i] / result.tau[i - 1]);
+            summary.adevAt1s = std::exp(std::log(adev[i - 1]) + f * (std::log(adev[i]) - std::log(adev[i - 1])));
+        }
+    }
+    summary.biasInstability = summary.minimumAdev / 0.664;
+    return summary;
+}
+
+// 一条曲线
+struct PlotSeries {
+    const std::vector<double> *values;
+    const char *color;
+    double width;
+    double opacity;
+    QString label;                      // 为空时不列入图例
+};
+
+// 双对数坐标的曲线图（SVG），坐标轴按整十倍取整，非正值的点断开曲线
+static QByteArray svgPlot(const QString &title, const QString &xLabel, const QString &yLabel,
+                          const std::vector<double> &x, const std::vector<PlotSeries> &series)
+{
+    const double width = 900, height = 600;
+    const double left = 90, right = 30, top = 50, bottom = 60;
+    const double plotWidth = width - left - right, plotHeight = height - top - bottom;
+
+    double xMin = 0, xMax = 0, yMin = 0, yMax = 0;
+    const auto extend = [](double v, double &lo, double &hi) {
+        if (!(v > 0) || !std::isfinite(v))  return;
+        if (lo == 0 || v < lo)  lo = v;
+        if (hi == 0 || v > hi)  hi = v;
+    };
+    for (std::size_t i = 0; i < x.size(); ++i)
+    {
+        if (!(x[i] > 0))    continue;
+        bool any = false;
+        for (const PlotSeries &s : series)
+        {
+            const double v = (*s.values)[i];
+            if (v > 0 && std::isfinite(v))
+            {
+                extend(v, yMin, yMax);
+                any = true;
+            }
+        }
+        if (any)    extend(x[i], xMin, xMax);
+    }
+    if (xMin == 0 || yMin == 0)
+    {
+        xMin = yMin = 1;
+        xMax = yMax = 10;
+    }
+    const double x0 = std::floor(std::log10(xMin)), x1 = std::max(x0 + 1, std::ceil(std::log10(xMax)));
+    const double y0 = std::floor(std::log10(yMin)), y1 = std::max(y0 + 1, std::ceil(std::log10(yMax)));
+    const auto px = [&](double v) { return left + (std::log10(v) - x0) / (x1 - x0) * plotWidth; };
+    const auto py = [&](double v) { return top + (y1 - std::log10(v)) / (y1 - y0) * plotHeight; };
+    const auto num = [](double v) { return QByteArray::number(v, 'f', 1); };
+
+    QByteArray svg;
+    svg += "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" + num(width) + "\" height=\"" + num(height)
+            + "\" font-family=\"sans-serif\" font-size=\"12\">\n";
+    svg += "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n";
+    svg += "<text x=\"" + num(width / 2) + "\" y=\"28\" text-anchor=\"middle\" font-size=\"16\">" + title.toUtf8() + "</text>\n";
+    // 整十倍网格和刻度
+    for (double d = x0; d <= x1; ++d)
+    {
+        const double p = left + (d - x0) / (x1 - x0) * plotWidth;
+        svg += "<line x1=\"" + num(p) + "\" y1=\"" + num(top) + "\" x2=\"" + num(p) + "\" y2=\"" + num(top + plotHeight)
+                + "\" stroke=\"#ddd\"/>\n";
+        svg += "<text x=\"" + num(p) + "\" y=\"" + num(top + plotHeight + 18) + "\" text-anchor=\"middle\">1e"
+                + QByteArray::number(static_cast<int>(d)) + "</text>\n";
+    }
+    for (double d = y0; d <= y1; ++d)
+    {
+        const double p = top + (y1 - d) / (y1 - y0) * plotHeight;
+        svg += "<line x1=\"" + num(left) + "\" y1=\"" + num(p) + "\" x2=\"" + num(left + plotWidth) + "\" y2=\"" + num(p)
+                + "\" stroke=\"#ddd\"/>\n";
+        svg += "<text x=\"" + num(left - 6) + "\" y=\"" + num(p + 4) + "\" text-anchor=\"end\">1e"
+                + QByteArray::number(static_cast<int>(d)) + "</text>\n";
+    }
+    svg += "<rect x=\"" + num(left) + "\" y=\"" + num(top) + "\" width=\"" + num(plotWidth) + "\" height=\"" + num(plotHeight)
+            + "\" fill=\"none\" stroke=\"black\"/>\n";
+    svg += "<text x=\"" + num(left + plotWidth / 2) + "\" y=\"" + num(height - 15) + "\" text-anchor=\"middle\">"
+            + xLabel.toUtf8() + "</text>\n";
+    svg += "<text transform=\"translate(22," + num(top + plotHeight / 2) + ") rotate(-90)\" text-anchor=\"middle\">"
+            + yLabel.toUtf8() + "</text>\n";
+
+    // 曲线：先画细的（各IMU），粗的（均值）在上层
+    int legend = 0;
+    for (const PlotSeries &s : series)
+    {
+        QByteArray points;
+        const auto flush = [&]() {
+            if (points.isEmpty())   return;
+            svg += "<polyline fill=\"none\" stroke=\"" + QByteArray(s.color) + "\" stroke-width=\"" + QByteArray::number(s.width)
+                    + "\" stroke-opacity=\"" + QByteArray::number(s.opacity) + "\" points=\"" + points + "\"/>\n";
+            points.clear();
+        };
+        for (std::size_t i = 0; i < x.size(); ++i)
+        {
+            const double v = (*s.values)[i];
+            if (!(x[i] > 0) || !(v > 0) || !std::isfinite(v))
+            {
+                flush();
+                continue;
+            }
+            points += num(px(x[i])) + ',' + num(py(v)) + ' ';
+        }
+        flush();
+        if (s.label.isEmpty())  continue;
+        const double ly = top + 18 + legend * 18;
+        svg += "<line x1=\"" + num(left + plotWidth - 110) + "\" y1=\"" + num(ly - 4) + "\" x2=\"" + num(left + plotWidth - 85)
+                + "\" y2=\"" + num(ly - 4) + "\" stroke=\"" + QByteArray(s.color) + "\" stroke-width=\"" + QByteArray::number(s.width) + "\"/>\n";
+        svg += "<text x=\"" + num(left + plotWidth - 80) + "\" y=\"" + num(ly) + "\">" + s.label.toUtf8() + "</text>\n";
+        ++legend;
+    }
+    svg += "</svg>\n";
+    return svg;
+}
+
+bool RecordingAnalyzer::writeResults(const Result &result, const QString &outputDir, QStringList *files, QString *errorString)
+{
+    const auto fail = [errorString](const QString &message) {
+        if (errorString)    *errorString = message;
+        return false;
+    };
+    if (!QDir().mkpath(outputDir))  return fail(QString("无法创建输出目录 %1").arg(outputDir));
+    const auto write = [&](const QString &name, const QByteArray &content) {
+        const QString path = QDir(outputDir).filePath(name);
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(content) != content.size())
+            return fail(QString("%1: %2").arg(path, file.errorString()));
+        if (files)  *files << path;
+        return true;
+    };
+    const auto number = [](double v) { return QByteArray::number(v, 'g', 8); };
+    const int channelCount = result.channels.size();
+    const QByteArray names = result.channels.join(',').toLatin1();
+
+    QByteArray allan = "tau_s,terms," + names + '\n';
+    for (std::size_t i = 0; i < result.tau.size(); ++i)
+    {
+        allan += number(result.tau[i]) + ',' + QByteArray::number(result.terms[i]);
+        for (int c = 0; c < channelCount; ++c)  allan += ',' + number(result.adev[static_cast<std::size_t>(c)][i]);
+        allan += '\n';
+    }
+    QByteArray psd = "frequency_hz," + names + '\n';
+    for (std::size_t k = 0; k < result.frequency.size(); ++k)
+    {
+        psd += number(result.frequency[k]);
+        for (int c = 0; c < channelCount; ++c)  psd += ',' + number(result.psd[static_cast<std::size_t>(c)][k]);
+        psd += '\n';
+    }
+    QByteArray summary = "channel,adev_1s,min_adev,tau_at_min_s,bias_instability\n";
+    for (int c = 0; c < channelCount; ++c)
+    {
+        const NoiseSummary s = summarize(result, c);
+        summary += result.channels.at(c).toLatin1() + ',' + number(s.adevAt1s) + ',' + number(s.minimumAdev) + ','
+                + number(s.minimumTau) + ',' + number(s.biasInstability) + '\n';
+    }
+    if (!write("allan.csv", allan) || !write("psd.csv", psd) || !write("summary.csv", summary))    return false;
+
+    // 曲线图：加速度计和陀螺仪各一张，各IMU为细线，均值为粗线
+    static const char *const AXIS_COLORS[3] = {"#d62728", "#2ca02c", "#1f77b4"};
+    static const char *const AXIS_NAMES[3] = {"X", "Y", "Z"};
+    const int meanChannel = result.imuCount * DATA_PER_IMU;
+    for (int sensor = 0; sensor < 2; ++sensor)
+    {
+        const QString kind = sensor == 0 ? "accel" : "gyro";
+        const QString unit = sensor == 0 ? "g" : "dps";
+        std::vector<PlotSeries> adevSeries, psdSeries;
+        for (int imu = 0; imu <= result.imuCount; ++imu)
+        {
+            const bool mean = imu == result.imuCount;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const int c = (mean ? meanChannel : imu * DATA_PER_IMU) + sensor * 3 + axis;
+                const QString label = mean ? QString("mean %1").arg(AXIS_NAMES[axis]) : QString();
+                adevSeries.push_back(PlotSeries{&result.adev[static_cast<std::size_t>(c)], AXIS_COLORS[axis],
+                                                mean ? 2.5 : 1.0, mean ? 1.0 : 0.25, label});
+                psdSeries.push_back(PlotSeries{&result.psd[static_cast<std::size_t>(c)], AXIS_COLORS[axis],
+                                               mean ? 2.0 : 1.0, mean ? 1.0 : 0.2, label});
+            }
+        }
+        const QString title = QString("%1 (%2 IMU, %3 frames, τ0 = %4 ms)").arg(kind).arg(result.imuCount).arg(result.rows)
+                .arg(result.sampleInterval * 1000, 0, 'f', 3);
+        if (!write(QString("allan_%1.svg").arg(kind),
+                   svgPlot("Allan deviation, " + title, "τ (s)", QString("Allan deviation (%1)").arg(unit), result.tau, adevSeries))
+                || !write(QString("psd_%1.svg").arg(kind),
+                          svgPlot("Welch PSD, " + title, "frequency (Hz)", QString("PSD (%1²/Hz)").arg(unit),
+                                  result.frequency, psdSeries)))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef RECORDINGANALYZER_H
+#define RECORDINGANALYZER_H
+
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <vector>
+
+// 离线噪声分析：对保存的CSV或二进制记录（*.imu、*.imuz）的每个通道（各IMU的6个数据和6个均值）
+// 计算重叠 Allan 偏差和 Welch 功率谱密度，用于由长时间静止记录评估传感器噪声。
+//
+// 与离线转换相同，输入切分为约 chunkBytes 的块（CSV 按行对齐，二进制记录按帧）并行解析为
+// 通道 → 行 的列；各通道的累加器（AllanDeviation、WelchPsd）必须按顺序读入，
+// 因此每个通道同一时刻只由一个线程处理，不同通道由各线程并行处理。
+// 同时在途的块数有上限，累加器的内存与记录长度无关（只随最长簇长对数增长）。
+// 多个输入文件（例如分段记录的各段）按顺序拼接为一段数据。
+class RecordingAnalyzer
+{
+public:
+    // 分析结果
+    struct Result {
+        int imuCount;
+        QStringList channels;           // 通道名：imuK_ax ... imuK_gz，之后为 mean_ax ... mean_gz
+        qint64 rows;                    // 分析的行（帧）数
+        qint64 badLines;                // 跳过的格式错误行（二进制记录为损坏块中的帧）
+        qint64 invalidValues;           // 非有限值（按前一个样本计入）
+        qint64 gaps;                    // 间隔超过标称间隔1.5倍的缺口数
+        qint64 missingFrames;           // 按标称间隔估计的缺口中缺少的帧数
+        double sampleInterval;          // 平均采样间隔 τ0（秒，缺口按缺少的帧计）
+        qint64 inputBytes;
+        double seconds;                 // 耗时
+        int threads;
+
+        // Allan 偏差：tau[i] = 簇长 × τ0，adev[通道][i]；terms[i] 为平均的项数
+        std::vector<double> tau;
+        std::vector<qint64> terms;
+        std::vector<std::vector<double>> adev;
+        // Welch 功率谱密度（单位²/Hz）：frequency[k]，psd[通道][k]
+        int fftLength;
+        qint64 segments;
+        std::vector<double> frequency;
+        std::vector<std::vector<double>> psd;
+    };
+
+    // 某通道的噪声参数（由 Allan 偏差曲线读出）
+    struct NoiseSummary {
+        double adevAt1s;                // τ = 1 秒的 Allan 偏差（对数插值）：白噪声（角度/速度随机游走）系数
+        double minimumAdev;             // 曲线最低点
+        double minimumTau;
+        double biasInstability;         // 零偏不稳定性 = 最低点 / 0.664
+    };
+
+    static const qint64 DEFAULT_CHUNK_BYTES = 8 * 1024 * 1024;
+
+    RecordingAnalyzer();
+
+    // 分析线程数，<= 0 为CPU核数
+    void setThreadCount(int count) { threadCount = count; }
+    void setChunkBytes(qint64 bytes) { chunkBytes = bytes; }
+    // Welch 分段长度（样本数，2 的幂）
+    void setFftLength(int length) { fftLength = length; }
+    static bool isValidFftLength(int length) { return length >= 16 && length <= (1 << 24) && (length & (length - 1)) == 0; }
+
+    // 把 inputs 按顺序拼接分析，成功返回 true
+    bool analyze(const QStringList &inputs, Result *result, QString *errorString);
+
+    // 分析进度（0 ~ 1000）和取消：可在其他线程调用，取消后 analyze 返回 false
+    int progress() const { return progressPermille.load(); }
+    void cancel() { cancelRequested = true; }
+
+    static NoiseSummary summarize(const Result &result, int channel);
+    // 写出 allan.csv、psd.csv、summary.csv 以及 allan_accel/gyro.svg、psd_accel/gyro.svg（对数坐标的曲线图）
+    static bool writeResults(const Result &result, const QString &outputDir, QStringList *files, QString *errorString);
+
+private:
+    int threadCount;
+    qint64 chunkBytes;
+    int fftLength;
+    std::atomic<int> progressPermille;
+    std::atomic<bool> cancelRequested;
+};
+
+#endif // RECORDINGANALYZER_H
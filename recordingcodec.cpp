@@ -0,0 +1,568 @@
+#include "recordingcodec.h"
+#include <algorithm>
+#include <cstring>
+
+// 单块帧数上限（解码时校验块头，防止损坏的块头导致巨大的分配）
+static const uint32_t MAX_BLOCK_FRAMES = 1 << 16;
+static const int DELTA_GROUP = 16;          // 差分编码的分组大小
+static const std::size_t READ_STEP = 1 << 20;   // 流式解码按此大小分步读入压缩数据
+
+// 压缩数据长度的上限：每帧的3个整数列最多 3 × 68 位，每个 float 最多 1 + 44 位（XOR）或 32 + 6/16 位（差分），
+// 均小于原始记录长度的2倍；另加按32位写出的尾部
+static uint64_t maxPayloadSize(const RecordingFileHeader &header, uint32_t frameCount)
+{
+    return 2 * static_cast<uint64_t>(frameCount) * header.recordSize + 8;
+}
+
+// ---------------------------------------------------------------------------
+// 位流：低位在前，按32位批量写出
+// ---------------------------------------------------------------------------
+
+static inline uint32_t lowMask(int n)
+{
+    return n >= 32 ? 0xffffffffu : (1u << n) - 1;
+}
+
+static inline int leadingZeros(uint32_t x)
+{
+#if defined(__GNUC__)
+    return x ? __builtin_clz(x) : 32;
+#else
+    int n = 0;
+    for (uint32_t bit = 0x80000000u; bit && !(x & bit); bit >>= 1)   n++;
+    return n;
+#endif
+}
+
+static inline int trailingZeros(uint32_t x)
+{
+#if defined(__GNUC__)
+    return x ? __builtin_ctz(x) : 32;
+#else
+    int n = 0;
+    for (uint32_t bit = 1; bit && !(x & bit); bit <<= 1)    n++;
+    return n;
+#endif
+}
+
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<char> &buffer) : out(buffer), acc(0), bits(0) {}
+
+    // n <= 32
+    void write(uint32_t value, int n)
+    {
+        acc |= static_cast<uint64_t>(value & lowMask(n)) << bits;
+        bits += n;
+        if (bits >= 32)
+        {
+            const uint32_t word = static_cast<uint32_t>(acc);
+            const char *p = reinterpret_cast<const char *>(&word);
+            out.insert(out.end(), p, p + 4);
+            acc >>= 32;
+            bits -= 32;
+        }
+    }
+    void write64(uint64_t value)
+    {
+        write(static_cast<uint32_t>(value), 32);
+        write(static_cast<uint32_t>(value >> 32), 32);
+    }
+    // 写出不满一个字节的剩余位
+    void flush()
+    {
+        for (; bits > 0; bits -= 8, acc >>= 8) out.push_back(static_cast<char>(acc & 0xff));
+        bits = 0;
+        acc = 0;
+    }
+
+private:
+    std::vector<char> &out;
+    uint64_t acc;
+    int bits;
+};
+
+class BitReader
+{
+public:
+    BitReader(const char *data, std::size_t size) :
+        p(reinterpret_cast<const unsigned char *>(data)),
+        end(reinterpret_cast<const unsigned char *>(data) + size),
+        acc(0), bits(0), overrun(false) {}
+
+    // n <= 32；读过数据末尾时返回0并置 overrun
+    uint32_t read(int n)
+    {
+        if (bits < n)
+        {
+            while (bits <= 56 && p < end)
+            {
+                acc |= static_cast<uint64_t>(*p++) << bits;
+                bits += 8;
+            }
+            if (bits < n)
+            {
+                overrun = true;
+                return 0;
+            }
+        }
+        const uint32_t value = static_cast<uint32_t>(acc) & lowMask(n);
+        acc >>= n;
+        bits -= n;
+        return value;
+    }
+    uint64_t read64()
+    {
+        const uint64_t low = read(32);
+        return low | static_cast<uint64_t>(read(32)) << 32;
+    }
+    bool failed() const { return overrun; }
+
+private:
+    const unsigned char *p;
+    const unsigned char *end;
+    uint64_t acc;
+    int bits;
+    bool overrun;
+};
+
+// ---------------------------------------------------------------------------
+// 整数列：按大小分档的有符号变长编码
+// ---------------------------------------------------------------------------
+
+static void writeSigned(BitWriter &w, int64_t v)
+{
+    if (v == 0)
+    {
+        w.write(0, 1);                                      // 0
+    }
+    else if (v >= -128 && v < 128)
+    {
+        w.write(0x1, 2);                                    // 1 0
+        w.write(static_cast<uint32_t>(v), 8);
+    }
+    else if (v >= -32768 && v < 32768)
+    {
+        w.write(0x3, 3);                                    // 1 1 0
+        w.write(static_cast<uint32_t>(v), 16);
+    }
+    else if (v >= INT32_MIN && v <= INT32_MAX)
+    {
+        w.write(0x7, 4);                                    // 1 1 1 0
+        w.write(static_cast<uint32_t>(v), 32);
+    }
+    else
+    {
+        w.write(0xf, 4);                                    // 1 1 1 1
+        w.write64(static_cast<uint64_t>(v));
+    }
+}
+
+static int64_t readSigned(BitReader &r)
+{
+    if (!r.read(1)) return 0;
+    if (!r.read(1)) return static_cast<int8_t>(r.read(8));
+    if (!r.read(1)) return static_cast<int16_t>(r.read(16));
+    if (!r.read(1)) return static_cast<int32_t>(r.read(32));
+    return static_cast<int64_t>(r.read64());
+}
+
+// 差分用无符号运算，回绕时也有定义
+static inline int64_t difference(uint64_t a, uint64_t b)
+{
+    return static_cast<int64_t>(a - b);
+}
+
+// order = 2：二阶差分（帧序号、时间戳）；order = 1：一阶差分（到达时刻）
+static void encodeIntColumn(BitWriter &w, const uint64_t *v, int n, int order)
+{
+    w.write64(v[0]);
+    int64_t lastDelta = 0;
+    for (int i = 1; i < n; ++i)
+    {
+        const int64_t delta = difference(v[i], v[i - 1]);
+        writeSigned(w, order == 2 ? difference(static_cast<uint64_t>(delta), static_cast<uint64_t>(lastDelta)) : delta);
+        lastDelta = delta;
+    }
+}
+
+static void decodeIntColumn(BitReader &r, uint64_t *v, int n, int order)
+{
+    v[0] = r.read64();
+    uint64_t lastDelta = 0;
+    for (int i = 1; i < n; ++i)
+    {
+        const uint64_t delta = static_cast<uint64_t>(readSigned(r)) + (order == 2 ? lastDelta : 0);
+        v[i] = v[i - 1] + delta;
+        lastDelta = delta;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// float 列（按位模式处理，无损）
+// ---------------------------------------------------------------------------
+
+// XOR：0 相同；1 0 沿用上一窗口的有效位；1 1 + 前导零(5位) + 有效位数-1(5位) + 有效位
+static std::size_t xorBits(const uint32_t *v, int n)
+{
+    std::size_t bits = 32;
+    int lead = -1, trail = 0;
+    for (int i = 1; i < n; ++i)
+    {
+        const uint32_t x = v[i] ^ v[i - 1];
+        if (!x)
+        {
+            bits += 1;
+            continue;
+        }
+        const int l = leadingZeros(x);
+        const int t = trailingZeros(x);
+        if (lead >= 0 && l >= lead && t >= trail)
+        {
+            bits += 2 + static_cast<std::size_t>(32 - lead - trail);
+        }
+        else
+        {
+            bits += 2 + 5 + 5 + static_cast<std::size_t>(32 - l - t);
+            lead = l;
+            trail = t;
+        }
+    }
+    return bits;
+}
+
+static void encodeXor(BitWriter &w, const uint32_t *v, int n)
+{
+    w.write(v[0], 32);
+    int lead = -1, trail = 0;
+    for (int i = 1; i < n; ++i)
+    {
+        const uint32_t x = v[i] ^ v[i - 1];
+        if (!x)
+        {
+            w.write(0, 1);
+            continue;
+        }
+        const int l = leadingZeros(x);
+        const int t = trailingZeros(x);
+        if (lead >= 0 && l >= lead && t >= trail)
+        {
+            w.write(0x1, 2);
+            w.write(x >> trail, 32 - lead - trail);
+        }
+        else
+        {
+            const int length = 32 - l - t;
+            w.write(0x3, 2);
+            w.write(static_cast<uint32_t>(l), 5);
+            w.write(static_cast<uint32_t>(length - 1), 5);
+            w.write(x >> t, length);
+            lead = l;
+            trail = t;
+        }
+    }
+}
+
+static bool decodeXor(BitReader &r, uint32_t *v, int n)
+{
+    v[0] = r.read(32);
+    int lead = -1, trail = 0;
+    for (int i = 1; i < n; ++i)
+    {
+        uint32_t x = 0;
+        if (r.read(1))
+        {
+            if (r.read(1))
+            {
+                lead = static_cast<int>(r.read(5));
+                const int length = static_cast<int>(r.read(5)) + 1;
+                trail = 32 - lead - length;
+                if (trail < 0)  return false;
+            }
+            else if (lead < 0)
+            {
+                return false;
+            }
+            x = r.read(32 - lead - trail) << trail;
+        }
+        v[i] = v[i - 1] ^ x;
+    }
+    return !r.failed();
+}
+
+static inline uint32_t zigzag(uint32_t a, uint32_t b)
+{
+    const int32_t d = static_cast<int32_t>(a - b);
+    return (static_cast<uint32_t>(d) << 1) ^ static_cast<uint32_t>(d >> 31);
+}
+
+static inline uint32_t unzigzag(uint32_t z)
+{
+    return (z >> 1) ^ (0u - (z & 1));
+}
+
+// 差分：位模式差分的 zigzag 值，每 DELTA_GROUP 个一组：位宽(6位) + 各值
+static std::size_t deltaBits(const uint32_t *v, int n)
+{
+    std::size_t bits = 32;
+    for (int g = 1; g < n; g += DELTA_GROUP)
+    {
+        const int m = n - g < DELTA_GROUP ? n - g : DELTA_GROUP;
+        uint32_t any = 0;
+        for (int k = 0; k < m; ++k)  any |= zigzag(v[g + k], v[g + k - 1]);
+        bits += 6 + static_cast<std::size_t>(m * (32 - leadingZeros(any)));
+    }
+    return bits;
+}
+
+static void encodeDelta(BitWriter &w, const uint32_t *v, int n)
+{
+    w.write(v[0], 32);
+    uint32_t z[DELTA_GROUP];
+    for (int g = 1; g < n; g += DELTA_GROUP)
+    {
+        const int m = n - g < DELTA_GROUP ? n - g : DELTA_GROUP;
+        uint32_t any = 0;
+        for (int k = 0; k < m; ++k)
+        {
+            z[k] = zigzag(v[g + k], v[g + k - 1]);
+            any |= z[k];
+        }
+        const int width = 32 - leadingZeros(any);
+        w.write(static_cast<uint32_t>(width), 6);
+        if (width == 0) continue;
+        for (int k = 0; k < m; ++k)  w.write(z[k], width);
+    }
+}
+
+static bool decodeDelta(BitReader &r, uint32_t *v, int n)
+{
+    v[0] = r.read(32);
+    for (int g = 1; g < n; g += DELTA_GROUP)
+    {
+        const int m = n - g < DELTA_GROUP ? n - g : DELTA_GROUP;
+        const int width = static_cast<int>(r.read(6));
+        if (width > 32) return false;
+        for (int k = 0; k < m; ++k)
+        {
+            const uint32_t z = width ? r.read(width) : 0;
+            v[g + k] = v[g + k - 1] + unzigzag(z);
+        }
+    }
+    return !r.failed();
+}
+
+// ---------------------------------------------------------------------------
+// RecordBlockCodec
+// ---------------------------------------------------------------------------
+
+uint32_t RecordBlockCodec::checksum(const char *data, std::size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void RecordBlockCodec::encodeBlock(const RecordingFileHeader &header, const char *records, int count,
+                                   ChannelCodec codec, std::vector<char> &out)
+{
+    if (count <= 0) return;
+    const std::size_t recordSize = header.recordSize;
+    const int channels = header.imuCount * header.dataPerImu;
+
+    std::vector<uint64_t> sequence(static_cast<std::size_t>(count));
+    std::vector<uint64_t> timestamp(static_cast<std::size_t>(count));
+    std::vector<uint64_t> arrival(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i)
+    {
+        RecordHeader record;
+        memcpy(&record, records + i * recordSize, sizeof(record));
+        sequence[i] = record.sequence;
+        timestamp[i] = static_cast<uint64_t>(record.timestampNs);
+        arrival[i] = static_cast<uint64_t>(record.arrivalNs);
+    }
+
+    const std::size_t headerPos = out.size();
+    out.resize(headerPos + sizeof(CompressedBlockHeader));
+    const std::size_t payloadPos = out.size();
+    BitWriter w(out);
+    encodeIntColumn(w, sequence.data(), count, 2);
+    encodeIntColumn(w, timestamp.data(), count, 2);
+    encodeIntColumn(w, arrival.data(), count, 1);
+
+    std::vector<uint32_t> column(static_cast<std::size_t>(count));
+    for (int c = 0; c < channels; ++c)
+    {
+        const char *field = records + sizeof(RecordHeader) + c * sizeof(float);
+        for (int i = 0; i < count; ++i)  memcpy(&column[i], field + i * recordSize, sizeof(uint32_t));
+
+        bool useDelta = codec == DeltaCodec;
+        if (codec == AutoCodec) useDelta = deltaBits(column.data(), count) < xorBits(column.data(), count);
+        w.write(useDelta ? 1 : 0, 1);
+        if (useDelta)   encodeDelta(w, column.data(), count);
+        else            encodeXor(w, column.data(), count);
+    }
+    w.flush();
+
+    CompressedBlockHeader block;
+    memcpy(block.magic, COMPRESSED_BLOCK_MAGIC, sizeof(block.magic));
+    block.frameCount = static_cast<uint32_t>(count);
+    block.payloadSize = static_cast<uint32_t>(out.size() - payloadPos);
+    block.checksum = checksum(out.data() + payloadPos, block.payloadSize);
+    block.firstTimestampNs = static_cast<int64_t>(timestamp.front());
+    block.lastTimestampNs = static_cast<int64_t>(timestamp.back());
+    memcpy(out.data() + headerPos, &block, sizeof(block));
+}
+
+bool RecordBlockCodec::isValidHeader(const RecordingFileHeader &header, const CompressedBlockHeader &block)
+{
+    return memcmp(block.magic, COMPRESSED_BLOCK_MAGIC, sizeof(block.magic)) == 0 &&
+           block.frameCount > 0 && block.frameCount <= MAX_BLOCK_FRAMES &&
+           block.payloadSize <= maxPayloadSize(header, block.frameCount);
+}
+
+bool RecordBlockCodec::decodeBlock(const RecordingFileHeader &header, const CompressedBlockHeader &block,
+                                   const char *payload, std::vector<char> &records)
+{
+    records.clear();
+    if (!isValidHeader(header, block) ||
+        header.recordSize != recordSizeFor(header.imuCount) ||
+        checksum(payload, block.payloadSize) != block.checksum)
+    {
+        return false;
+    }
+
+    const int count = static_cast<int>(block.frameCount);
+    const std::size_t recordSize = header.recordSize;
+    const int channels = header.imuCount * header.dataPerImu;
+    BitReader r(payload, block.payloadSize);
+
+    std::vector<uint64_t> sequence(static_cast<std::size_t>(count));
+    std::vector<uint64_t> timestamp(static_cast<std::size_t>(count));
+    std::vector<uint64_t> arrival(static_cast<std::size_t>(count));
+    decodeIntColumn(r, sequence.data(), count, 2);
+    decodeIntColumn(r, timestamp.data(), count, 2);
+    decodeIntColumn(r, arrival.data(), count, 1);
+    if (r.failed()) return false;
+
+    records.resize(count * recordSize);
+    for (int i = 0; i < count; ++i)
+    {
+        RecordHeader record;
+        record.sequence = sequence[i];
+        record.timestampNs = static_cast<int64_t>(timestamp[i]);
+        record.arrivalNs = static_cast<int64_t>(arrival[i]);
+        memcpy(&records[i * recordSize], &record, sizeof(record));
+    }
+
+    std::vector<uint32_t> column(static_cast<std::size_t>(count));
+    for (int c = 0; c < channels; ++c)
+    {
+        const bool ok = r.read(1) ? decodeDelta(r, column.data(), count) : decodeXor(r, column.data(), count);
+        if (!ok)
+        {
+            records.clear();
+            return false;
+        }
+        char *field = &records[sizeof(RecordHeader) + c * sizeof(float)];
+        for (int i = 0; i < count; ++i)  memcpy(field + i * recordSize, &column[i], sizeof(uint32_t));
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// CompressedRecordingEncoder
+// ---------------------------------------------------------------------------
+
+CompressedRecordingEncoder::CompressedRecordingEncoder() :
+    codec(RecordBlockCodec::AutoCodec)
+{
+    reset();
+}
+
+void CompressedRecordingEncoder::reset()
+{
+    memset(&header, 0, sizeof(header));
+    headerDone = false;
+    pending.clear();
+    consumed = 0;
+}
+
+void CompressedRecordingEncoder::encode(const char *data, std::size_t size, AsyncFileWriter::Buffer &out)
+{
+    consumed += size;
+    if (!headerDone)
+    {
+        const std::size_t take = std::min(size, sizeof(header) - pending.size());
+        pending.insert(pending.end(), data, data + take);
+        data += take;
+        size -= take;
+        if (pending.size() < sizeof(header))    return;
+
+        // 文件头改写 magic 后写出，其余字段描述解压后的记录
+        memcpy(&header, pending.data(), sizeof(header));
+        pending.clear();
+        RecordingFileHeader compressed = header;
+        memcpy(compressed.magic, RECORDING_COMPRESSED_MAGIC, sizeof(compressed.magic));
+        const char *p = reinterpret_cast<const char *>(&compressed);
+        out.insert(out.end(), p, p + sizeof(compressed));
+        headerDone = true;
+    }
+
+    const std::size_t blockBytes = static_cast<std::size_t>(RecordBlockCodec::BLOCK_FRAMES) * header.recordSize;
+    while (size > 0)
+    {
+        // 整块直接从输入编码，不经过 pending
+        if (pending.empty() && size >= blockBytes)
+        {
+            RecordBlockCodec::encodeBlock(header, data, RecordBlockCodec::BLOCK_FRAMES, codec, out);
+            data += blockBytes;
+            size -= blockBytes;
+            continue;
+        }
+        const std::size_t take = std::min(size, blockBytes - pending.size());
+        pending.insert(pending.end(), data, data + take);
+        data += take;
+        size -= take;
+        if (pending.size() == blockBytes)   flushBlock(out);
+    }
+}
+
+void CompressedRecordingEncoder::finish(AsyncFileWriter::Buffer &out)
+{
+    if (headerDone) flushBlock(out);
+    // 分段记录：下一个文件从文件头开始
+    pending.clear();
+    headerDone = false;
+}
+
+void CompressedRecordingEncoder::flushBlock(AsyncFileWriter::Buffer &out)
+{
+    const int count = header.recordSize ? static_cast<int>(pending.size() / header.recordSize) : 0;
+    RecordBlockCodec::encodeBlock(header, pending.data(), count, codec, out);
+    // 不完整的记录（只会在异常截断时出现）丢弃
+    pending.clear();
+}
+
+bool readCompressedBlock(std::FILE *file, const RecordingFileHeader &header, std::vector<char> &records)
+{
+    records.clear();
+    CompressedBlockHeader block;
+    if (std::fread(&block, 1, sizeof(block), file) != sizeof(block))   return false;
+    if (!RecordBlockCodec::isValidHeader(header, block))    return false;
+    // 分步读入：截断的文件不会按块头中的长度一次分配
+    std::vector<char> payload;
+    while (payload.size() < block.payloadSize)
+    {
+        const std::size_t offset = payload.size();
+        const std::size_t take = std::min<std::size_t>(block.payloadSize - offset, READ_STEP);
+        payload.resize(offset + take);
+        if (std::fread(payload.data() + offset, 1, take, file) != take) return false;
+    }
+    return RecordBlockCodec::decodeBlock(header, block, payload.data(), records);
+}
@@ -0,0 +1,79 @@
+#ifndef RECORDINGCODEC_H
+#define RECORDINGCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "recordingformat.h"
+#include "asyncfilewriter.h"
+
+// 压缩二进制记录（*.imuz）的块编解码，无损，不依赖外部库。
+// 一块最多 BLOCK_FRAMES 条记录（当前版本的 RecordHeader + imuCount 个 IMUData），
+// 按列编码，每列写成一段位流（低位在前）：
+//   帧序号、采样时间戳：首值原样，之后为二阶差分（稳定帧率下为0，占1位）
+//   到达时刻：首值原样，之后为一阶差分（同一批读出的帧差分为0）
+//   每个 float 通道（imuCount × 6 列）：首值原样，之后二选一，按实际位数择优，1位标记：
+//     XOR：与前值异或（Gorilla），相同时1位，否则只存有效位段，窗口与上一值相同时省去位置信息
+//     差分：位模式（int32）差分的 zigzag 值，每16个一组按组内最大位宽打包
+// 整数差分按大小分档：0 → 1位；8/16/32/64位值分别加2/3/4/4位前缀。
+class RecordBlockCodec
+{
+public:
+    static const int BLOCK_FRAMES = 256;    // 每块帧数（100Hz 约2.5秒；写盘线程凑满一块才写出）
+
+    // 通道编码方式
+    enum ChannelCodec {
+        AutoCodec = 0,      // 每块每列按实际位数择优
+        XorCodec,
+        DeltaCodec
+    };
+
+    // records 为 count 条连续记录（header 描述的当前版本布局），编码后追加块头和压缩数据到 out
+    static void encodeBlock(const RecordingFileHeader &header, const char *records, int count,
+                            ChannelCodec codec, std::vector<char> &out);
+    // 解码一块：校验块头和校验和，records 调整为 frameCount 条记录；数据损坏时返回 false
+    static bool decodeBlock(const RecordingFileHeader &header, const CompressedBlockHeader &block,
+                            const char *payload, std::vector<char> &records);
+    // 块头是否合理（magic、帧数和压缩数据长度在上限内），不检查数据本身；
+    // 读取压缩数据或为其分配内存之前先调用
+    static bool isValidHeader(const RecordingFileHeader &header, const CompressedBlockHeader &block);
+
+    // 压缩数据的校验和（FNV-1a）
+    static uint32_t checksum(const char *data, std::size_t size);
+};
+
+// 写盘线程中的流式压缩（AsyncFileWriter::Encoder）：
+// 输入为 BinaryRecorder 写出的 *.imu 字节流（文件头 + 定长记录，可在任意位置分段），
+// 输出为 *.imuz：改写文件头的 magic，每凑满 BLOCK_FRAMES 条记录编码一块，finish() 时写出不满的最后一块，
+// 之后的输入视为新文件（分段记录）。
+// 异常退出时最多丢失未写出的一块。
+class CompressedRecordingEncoder : public AsyncFileWriter::Encoder
+{
+public:
+    CompressedRecordingEncoder();
+
+    void setCodec(RecordBlockCodec::ChannelCodec channelCodec) { codec = channelCodec; }
+    // 开始新文件（打开写盘线程之前调用）
+    void reset();
+
+    void encode(const char *data, std::size_t size, AsyncFileWriter::Buffer &out) override;
+    void finish(AsyncFileWriter::Buffer &out) override;
+
+    uint64_t inputBytes() const { return consumed; }
+
+private:
+    void flushBlock(AsyncFileWriter::Buffer &out);
+
+    RecordBlockCodec::ChannelCodec codec;
+    RecordingFileHeader header;
+    bool headerDone;
+    std::vector<char> pending;      // 文件头或当前块中已收到的记录
+    uint64_t consumed;              // 已收到的输入字节数
+};
+
+// 流式解码：从 *.imuz 文件的当前位置顺序读出下一块并解码为记录（当前版本布局）。
+// 文件尾、块被截断或损坏时返回 false，records 为空。
+bool readCompressedBlock(std::FILE *file, const RecordingFileHeader &header, std::vector<char> &records);
+
+#endif // RECORDINGCODEC_H
@@ -0,0 +1,460 @@
+#include "recordingconverter.h"
+#include "recordingreader.h"
+#include "csvparser.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+static const char *const CHANNEL_NAMES[DATA_PER_IMU] = {"ax", "ay", "az", "gx", "gy", "gz"};
+
+// 一个输入文件
+struct ConvertInput {
+    QString fileName;
+    bool binary;
+    std::unique_ptr<QFile> file;        // CSV：映射的文件
+    const char *data;                   // CSV：映射的内容
+    qint64 size;                        // 文件大小
+    qint64 dataStart;                   // CSV：第一行数据的偏移（跳过表头）
+    qint64 frames;                      // 二进制记录：帧数
+};
+
+// 一块输入：CSV 为按行对齐的字节范围，二进制记录为帧范围
+struct ConvertChunk {
+    int input;
+    qint64 begin;
+    qint64 end;
+};
+
+// 解析好的一块：每个输出文件一段字节
+struct ConvertPart {
+    std::vector<char> packed;           // 紧凑行（各列依次排列）
+    std::vector<std::vector<char>> files;
+    qint64 rows;
+    qint64 bad;
+    bool ready;
+};
+
+RecordingConverter::RecordingConverter() :
+    outputLayout(ChannelFiles),
+    threadCount(0),
+    chunkBytes(DEFAULT_CHUNK_BYTES),
+    packedRowBytes(0)
+{
+}
+
+const char *RecordingConverter::layoutName(Layout layout)
+{
+    switch (layout)
+    {
+    case ChannelFiles:  return "channels";
+    case StructFile:    return "struct";
+    case ImuFiles:      return "imu";
+    }
+    return "?";
+}
+
+void RecordingConverter::buildOutputs(int imuCount, bool binary)
+{
+    columns.clear();
+    outputs.clear();
+
+    const auto addColumn = [this](const QString &name, char kind, int size) {
+        Column column;
+        column.name = name;
+        column.kind = kind;
+        column.size = size;
+        column.offset = packedRowBytes;
+        packedRowBytes += size;
+        columns.push_back(column);
+    };
+    packedRowBytes = 0;
+    if (binary)
+    {
+        addColumn("sequence", 'u', 8);
+        addColumn("timestamp_ns", 'i', 8);
+        addColumn("arrival_ns", 'i', 8);
+    }
+    addColumn("timestamp_ms", 'i', 8);
+    const int firstValue = static_cast<int>(columns.size());
+    for (int imu = 0; imu < imuCount; ++imu)
+    {
+        for (int channel = 0; channel < DATA_PER_IMU; ++channel)
+            addColumn(QString("imu%1_%2").arg(imu + 1).arg(CHANNEL_NAMES[channel]), 'f', 4);
+    }
+
+    const auto addOutput = [this](const QString &name, int first, int count, bool structured) {
+        Output output;
+        output.name = name;
+        output.structured = structured;
+        output.rowBytes = 0;
+        for (int i = first; i < first + count; ++i)
+        {
+            output.columns.push_back(i);
+            output.rowBytes += columns[static_cast<std::size_t>(i)].size;
+        }
+        outputs.push_back(output);
+    };
+    switch (outputLayout)
+    {
+    case StructFile:
+        addOutput("data.npy", 0, static_cast<int>(columns.size()), true);
+        break;
+    case ImuFiles:
+        for (int i = 0; i < firstValue; ++i)    addOutput(columns[static_cast<std::size_t>(i)].name + ".npy", i, 1, false);
+        for (int imu = 0; imu < imuCount; ++imu)
+            addOutput(QString("imu%1.npy").arg(imu + 1), firstValue + imu * DATA_PER_IMU, DATA_PER_IMU, false);
+        break;
+    case ChannelFiles:
+        for (int i = 0; i < static_cast<int>(columns.size()); ++i)
+            addOutput(columns[static_cast<std::size_t>(i)].name + ".npy", i, 1, false);
+        break;
+    }
+}
+
+// NPY 1.0 文件头：magic、版本、头长度和描述数组的 Python 字典，按64字节对齐并至少 minSize 字节
+QByteArray RecordingConverter::npyHeader(const Output &output, qint64 rows, int minSize) const
+{
+    const auto dtype = [](const Column &column) {
+        return QByteArray("<") + column.kind + QByteArray::number(column.size);
+    };
+
+    QByteArray descr;
+    QByteArray shape = '(' + QByteArray::number(rows);
+    if (output.structured)
+    {
+        QByteArrayList fields;
+        for (int i : output.columns)
+        {
+            const Column &column = columns[static_cast<std::size_t>(i)];
+            fields << "('" + column.name.toLatin1() + "', '" + dtype(column) + "')";
+        }
+        descr = '[' + fields.join(", ") + ']';
+        shape += ",)";
+    }
+    else
+    {
+        descr = '\'' + dtype(columns[static_cast<std::size_t>(output.columns.front())]) + '\'';
+        shape += output.columns.size() == 1 ? QByteArray(",)") : ", " + QByteArray::number(int(output.columns.size())) + ')';
+    }
+    const QByteArray dict = "{'descr': " + descr + ", 'fortran_order': False, 'shape': " + shape + ", }";
+
+    const int prefix = 10;              // magic(6) + 版本(2) + 头长度(2)
+    int total = prefix + dict.size() + 1;
+    total = std::max(minSize, (total + 63) / 64 * 64);
+    const int length = total - prefix;
+
+    QByteArray header("\x93NUMPY\x01\x00", 8);
+    header.append(static_cast<char>(length & 0xff));
+    header.append(static_cast<char>(length >> 8));
+    header.append(dict);
+    header.append(total - 1 - header.size(), ' ');
+    header.append('\n');
+    return header;
+}
+
+bool RecordingConverter::convert(const QStringList &inputs, const QString &outputDir, Result *result, QString *errorString)
+{
+    QElapsedTimer timer;
+    timer.start();
+    Result stats;
+    stats.rows = 0;
+    stats.badLines = 0;
+    stats.inputBytes = 0;
+    stats.outputBytes = 0;
+    stats.seconds = 0;
+    const int threads = threadCount > 0 ? threadCount : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    stats.threads = threads;
+
+    const auto fail = [errorString](const QString &message) {
+        if (errorString)    *errorString = message;
+        return false;
+    };
+    if (inputs.isEmpty())   return fail("没有输入文件");
+
+    // 打开输入：按文件头的 magic 识别二进制记录，其余按CSV内存映射
+    std::vector<ConvertInput> files(static_cast<std::size_t>(inputs.size()));
+    int imuCount = 0;
+    int firstInput = -1;                // 第一个有数据的输入
+    for (int i = 0; i < inputs.size(); ++i)
+    {
+        ConvertInput &input = files[static_cast<std::size_t>(i)];
+        input.fileName = inputs.at(i);
+        input.file.reset(new QFile(input.fileName));
+        if (!input.file->open(QIODevice::ReadOnly))
+            return fail(QString("%1: %2").arg(input.fileName, input.file->errorString()));
+        input.size = input.file->size();
+        input.data = nullptr;
+        input.dataStart = 0;
+        input.frames = 0;
+        stats.inputBytes += input.size;
+
+        char magic[sizeof(RECORDING_MAGIC)] = {0};
+        input.file->read(magic, sizeof(magic));
+        input.binary = memcmp(magic, RECORDING_MAGIC, sizeof(magic)) == 0
+                || memcmp(magic, RECORDING_COMPRESSED_MAGIC, sizeof(magic)) == 0;
+
+        int fileImuCount = 0;
+        if (input.binary)
+        {
+            input.file.reset();
+            RecordingReader reader;
+            QString error;
+            if (!reader.open(input.fileName, &error))   return fail(QString("%1: %2").arg(input.fileName, error));
+            input.frames = reader.frameCount();
+            fileImuCount = reader.frameFormat().imuCount;
+        }
+        else if (input.size > 0)
+        {
+            input.data = reinterpret_cast<const char *>(input.file->map(0, input.size));
+            if (!input.data)    return fail(QString("%1: %2").arg(input.fileName, input.file->errorString()));
+            input.dataStart = CsvParser::findData(input.data, input.data + input.size) - input.data;
+            if (input.dataStart == input.size)  continue;
+            const int values = CsvParser::valueCount(input.data + input.dataStart, input.data + input.size);
+            if (values == 0 || values % DATA_PER_IMU != 0 || values / DATA_PER_IMU > MAX_IMU_COUNT)
+                return fail(QString("%1: 第一行数据有 %2 个数值，不是 IMU数量 × %3").arg(input.fileName).arg(values).arg(DATA_PER_IMU));
+            fileImuCount = values / DATA_PER_IMU;
+        }
+        else
+        {
+            continue;
+        }
+
+        if (firstInput >= 0 && input.binary != files[static_cast<std::size_t>(firstInput)].binary)
+            return fail("不能把CSV和二进制记录拼接转换");
+        if (imuCount != 0 && fileImuCount != imuCount)
+            return fail(QString("%1: IMU数量 %2 与之前的文件（%3）不同").arg(input.fileName).arg(fileImuCount).arg(imuCount));
+        if (firstInput < 0) firstInput = i;
+        imuCount = fileImuCount;
+    }
+    if (firstInput < 0) return fail("输入文件中没有数据");
+    const bool binary = files[static_cast<std::size_t>(firstInput)].binary;
+    buildOutputs(imuCount, binary);
+
+    // 切块：CSV 每块约 chunkBytes 字节并延伸到行尾，二进制记录按解压后的记录大小换算为帧数
+    std::vector<ConvertChunk> chunks;
+    const qint64 chunkSize = std::max<qint64>(chunkBytes, 64 * 1024);
+    for (int i = 0; i < static_cast<int>(files.size()); ++i)
+    {
+        const ConvertInput &input = files[static_cast<std::size_t>(i)];
+        const qint64 total = input.binary ? input.frames : input.size;
+        const qint64 step = input.binary ? std::max<qint64>(1, chunkSize / (packedRowBytes + 8)) : chunkSize;
+        for (qint64 begin = input.dataStart; begin < total;)
+        {
+            qint64 end = std::min(total, begin + step);
+            if (!input.binary && end < total)   end = CsvParser::nextLine(input.data + end - 1, input.data + total) - input.data;
+            chunks.push_back(ConvertChunk{i, begin, end});
+            begin = end;
+        }
+    }
+
+    // 每个线程为每个二进制输入各开一个读取器（读取器缓存解码的块，不能共用）
+    std::vector<std::vector<std::unique_ptr<RecordingReader>>> readers(static_cast<std::size_t>(threads));
+    if (binary)
+    {
+        for (auto &perThread : readers)
+        {
+            for (const ConvertInput &input : files)
+            {
+                perThread.emplace_back(input.binary ? new RecordingReader : nullptr);
+                if (!input.binary)  continue;
+                QString error;
+                if (!perThread.back()->open(input.fileName, &error))
+                    return fail(QString("%1: %2").arg(input.fileName, error));
+            }
+        }
+    }
+
+    // 输出文件：先写占位文件头，行数在最后回填
+    if (!QDir().mkpath(outputDir))  return fail(QString("无法创建输出目录 %1").arg(outputDir));
+    std::vector<std::unique_ptr<QFile>> outFiles;
+    std::vector<int> headerSizes;
+    for (const Output &output : outputs)
+    {
+        const QString path = QDir(outputDir).filePath(output.name);
+        outFiles.emplace_back(new QFile(path));
+        const QByteArray header = npyHeader(output, std::numeric_limits<qint64>::max(), 0);
+        if (!outFiles.back()->open(QIODevice::WriteOnly | QIODevice::Truncate)
+                || outFiles.back()->write(header) != header.size())
+            return fail(QString("%1: %2").arg(path, outFiles.back()->errorString()));
+        headerSizes.push_back(header.size());
+        stats.files << path;
+    }
+
+    // 解析线程按块序号取块，解析结果放入 parts[块序号 % window]；
+    // 主线程按块的顺序写盘，同时在途的块不超过 window 个，内存占用有上限
+    const std::size_t window = static_cast<std::size_t>(threads) * 2;
+    std::vector<ConvertPart> parts(window);
+    for (ConvertPart &part : parts)
+    {
+        part.files.resize(outputs.size());
+        part.ready = false;
+    }
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t nextChunk = 0;
+    std::size_t written = 0;
+    bool failed = false;
+    const int valueCount = imuCount * DATA_PER_IMU;
+
+    const auto parse = [&](const ConvertChunk &chunk, ConvertPart &part, int thread) {
+        const ConvertInput &input = files[static_cast<std::size_t>(chunk.input)];
+        part.rows = 0;
+        part.bad = 0;
+        if (input.binary)
+        {
+            RecordingReader &reader = *readers[static_cast<std::size_t>(thread)][static_cast<std::size_t>(chunk.input)];
+            part.packed.resize(static_cast<std::size_t>((chunk.end - chunk.begin) * packedRowBytes));
+            char *row = part.packed.data();
+            ImuFrame frame;
+            for (qint64 i = chunk.begin; i < chunk.end; ++i)
+            {
+                // 损坏的压缩块中的帧跳过
+                if (!reader.readFrame(i, frame))
+                {
+                    ++part.bad;
+                    continue;
+                }
+                const int64_t header[4] = {static_cast<int64_t>(frame.sequence), frame.monotonicNs,
+                                           frame.arrivalNs, frame.timestampMs};
+                memcpy(row, header, sizeof(header));
+                memcpy(row + sizeof(header), &frame.imu[0].accel[0], static_cast<std::size_t>(valueCount) * sizeof(float));
+                row += packedRowBytes;
+                ++part.rows;
+            }
+        }
+        else
+        {
+            const char *p = input.data + chunk.begin;
+            const char *end = input.data + chunk.end;
+            // 最短的行为每个数值2字节（"0,"），按此预留不会在解析中途扩容
+            part.packed.resize(static_cast<std::size_t>((end - p) / (2 * valueCount + 2) + 1) * static_cast<std::size_t>(packedRowBytes));
+            char *row = part.packed.data();
+            int64_t timestampMs;
+            float values[MAX_IMU_COUNT * DATA_PER_IMU];
+            while (p < end)
+            {
+                const char *next = CsvParser::nextLine(p, end);
+                const char *lineEnd = CsvParser::lineEnd(p, next);
+                if (lineEnd > p)
+                {
+                    if (CsvParser::parseLine(p, lineEnd, valueCount, timestampMs, values))
+                    {
+                        memcpy(row, &timestampMs, sizeof(timestampMs));
+                        memcpy(row + sizeof(timestampMs), values, static_cast<std::size_t>(valueCount) * sizeof(float));
+                        row += packedRowBytes;
+                        ++part.rows;
+                    }
+                    else
+                    {
+                        ++part.bad;
+                    }
+                }
+                p = next;
+            }
+        }
+
+        // 紧凑行 → 各输出文件的行
+        for (std::size_t o = 0; o < outputs.size(); ++o)
+        {
+            const Output &output = outputs[o];
+            std::vector<char> &bytes = part.files[o];
+            bytes.resize(static_cast<std::size_t>(part.rows * output.rowBytes));
+            if (output.rowBytes == packedRowBytes)
+            {
+                memcpy(bytes.data(), part.packed.data(), bytes.size());
+                continue;
+            }
+            int destOffset = 0;
+            for (int c : output.columns)
+            {
+                const Column &column = columns[static_cast<std::size_t>(c)];
+                const char *src = part.packed.data() + column.offset;
+                char *dest = bytes.data() + destOffset;
+                for (qint64 r = 0; r < part.rows; ++r)
+                {
+                    if (column.size == 4)   memcpy(dest, src, 4);
+                    else                    memcpy(dest, src, 8);
+                    src += packedRowBytes;
+                    dest += output.rowBytes;
+                }
+                destOffset += column.size;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            for (;;)
+            {
+                std::size_t index;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]() {
+                        return failed || nextChunk >= chunks.size() || nextChunk < written + window;
+                    });
+                    if (failed || nextChunk >= chunks.size())   return;
+                    index = nextChunk++;
+                }
+                ConvertPart &part = parts[index % window];
+                parse(chunks[index], part, t);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    part.ready = true;
+                }
+                changed.notify_all();
+            }
+        });
+    }
+
+    QString error;
+    for (std::size_t index = 0; index < chunks.size() && error.isEmpty(); ++index)
+    {
+        ConvertPart &part = parts[index % window];
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&part]() { return part.ready; });
+        }
+        for (std::size_t o = 0; o < outputs.size() && error.isEmpty(); ++o)
+        {
+            const std::vector<char> &bytes = part.files[o];
+            QFile &out = *outFiles[o];
+            if (out.write(bytes.data(), static_cast<qint64>(bytes.size())) != static_cast<qint64>(bytes.size()))
+                error = QString("%1: %2").arg(out.fileName(), out.errorString());
+        }
+        stats.rows += part.rows;
+        stats.badLines += part.bad;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            part.ready = false;
+            written = index + 1;
+            failed = !error.isEmpty();
+        }
+        changed.notify_all();
+    }
+    for (std::thread &worker : workers) worker.join();
+    if (!error.isEmpty())   return fail(error);
+
+    // 回填行数
+    for (std::size_t o = 0; o < outputs.size(); ++o)
+    {
+        QFile &out = *outFiles[o];
+        const QByteArray header = npyHeader(outputs[o], stats.rows, headerSizes[o]);
+        if (!out.seek(0) || out.write(header) != header.size())
+            return fail(QString("%1: %2").arg(out.fileName(), out.errorString()));
+        stats.outputBytes += out.size();
+        out.close();
+    }
+
+    stats.seconds = timer.nsecsElapsed() / 1e9;
+    if (result) *result = stats;
+    return true;
+}
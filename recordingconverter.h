@@ -0,0 +1,79 @@
+#ifndef RECORDINGCONVERTER_H
+#define RECORDINGCONVERTER_H
+
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+// 离线转换：把保存的CSV或二进制记录（*.imu、*.imuz）转换为 NumPy 可直接加载的列式 .npy 文件。
+//
+// 输入切分为约 chunkBytes 大小的块（CSV 按行对齐，二进制记录按帧），由多个线程并行解析，
+// 主线程按块的顺序依次追加写入各输出文件；同时在途的块数有上限，因此内存占用与文件大小无关。
+// CSV 通过内存映射读取；多个输入文件（例如分段记录的各段）按顺序拼接为同一组输出。
+//
+// 列：CSV 为 timestamp_ms（<i8）和 imuK_ax ... imuK_gz（<f4）；
+// 二进制记录另有 sequence（<u8）、timestamp_ns、arrival_ns（<i8），timestamp_ms 按文件头换算为UTC毫秒。
+class RecordingConverter
+{
+public:
+    // 输出布局
+    enum Layout {
+        ChannelFiles = 0,       // 每列一个一维 .npy（timestamp_ms.npy、imu1_ax.npy ...）
+        StructFile,             // 一个结构化数组 data.npy，字段即各列
+        ImuFiles                // 每个IMU一个 (N, 6) 的 imuK.npy，时间戳等整数列各一个文件
+    };
+
+    // 转换结果
+    struct Result {
+        qint64 rows;            // 写出的行（帧）数
+        qint64 badLines;        // 跳过的格式错误行（二进制记录为损坏块中的帧）
+        qint64 inputBytes;      // 输入文件总大小
+        qint64 outputBytes;     // 输出文件总大小
+        double seconds;         // 耗时
+        int threads;            // 解析线程数
+        QStringList files;      // 写出的文件
+    };
+
+    // 默认块大小
+    static const qint64 DEFAULT_CHUNK_BYTES = 8 * 1024 * 1024;
+
+    RecordingConverter();
+
+    void setLayout(Layout layout) { outputLayout = layout; }
+    // 解析线程数，<= 0 为CPU核数
+    void setThreadCount(int count) { threadCount = count; }
+    void setChunkBytes(qint64 bytes) { chunkBytes = bytes; }
+
+    // 把 inputs 按顺序拼接转换到 outputDir（不存在时创建），成功返回 true
+    bool convert(const QStringList &inputs, const QString &outputDir, Result *result, QString *errorString);
+
+    static const char *layoutName(Layout layout);
+
+private:
+    // 一列：在行缓冲区中的偏移和 numpy 类型（'i'、'u' 或 'f'，size 字节）
+    struct Column {
+        QString name;
+        char kind;
+        int size;
+        int offset;
+    };
+    // 一个输出文件包含的列
+    struct Output {
+        QString name;
+        std::vector<int> columns;
+        bool structured;        // 结构化数组（否则各列同类型，多列时为二维数组）
+        int rowBytes;
+    };
+
+    void buildOutputs(int imuCount, bool binary);
+    QByteArray npyHeader(const Output &output, qint64 rows, int minSize) const;
+
+    Layout outputLayout;
+    int threadCount;
+    qint64 chunkBytes;
+    std::vector<Column> columns;
+    std::vector<Output> outputs;
+    int packedRowBytes;         // 解析时每行的紧凑字节数（各列依次排列）
+};
+
+#endif // RECORDINGCONVERTER_H
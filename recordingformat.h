@@ -0,0 +1,182 @@
+#ifndef RECORDINGFORMAT_H
+#define RECORDINGFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include "framelayout.h"
+
+// 二进制记录文件格式（*.imu），所有字段为小端序
+//
+//   [RecordingFileHeader 128字节]
+//   [RecordHeader 24字节][帧负载 imuCount × 24 字节]   × N
+//
+// 帧负载为解码后的 IMUData 数组（IMU1_Ax ... IMUn_Gz，float32），
+// 9 IMU 板卡即串口帧中的216字节；IMU数量记录在文件头中，读取端按其选择帧格式。
+// 旁路索引文件（*.imu.idx）每 indexInterval 帧记录一次 时间戳→文件偏移，
+// 读取端据此二分查找，无需扫描整个文件即可定位任意时刻。
+//
+// 版本1的记录头为16字节（没有 arrivalNs），读取端仍然兼容。
+//
+// 正常结束的文件（分段记录的每一段）末尾另有 64 字节的 RecordingFooter，记录本段帧数和时间范围；
+// 读取端按 magic 和 dataBytes 识别，没有文件尾（异常退出或旧版本）的文件照常读取。
+//
+// 压缩二进制记录（*.imuz）：文件头相同（magic 为 RECORDING_COMPRESSED_MAGIC，
+// 其余字段描述解压后的记录），之后为可独立解码的压缩块，没有旁路索引：
+//
+//   [RecordingFileHeader 128字节]
+//   [CompressedBlockHeader 32字节][压缩数据 payloadSize 字节]   × M
+//   [RecordingFooter 64字节]（可选）
+//
+// 块头记录帧数和首末时间戳，读取端只需跳读块头即可建立时间索引；块内编码见 recordingcodec.h。
+
+static const char RECORDING_MAGIC[8] = {'I', 'M', 'U', 'R', 'E', 'C', '\0', '\1'};
+static const char RECORDING_INDEX_MAGIC[8] = {'I', 'M', 'U', 'I', 'D', 'X', '\0', '\1'};
+static const char RECORDING_COMPRESSED_MAGIC[8] = {'I', 'M', 'U', 'Z', 'I', 'P', '\0', '\1'};
+static const char COMPRESSED_BLOCK_MAGIC[4] = {'I', 'M', 'Z', 'B'};
+static const char RECORDING_FOOTER_MAGIC[8] = {'I', 'M', 'U', 'E', 'N', 'D', '\0', '\1'};
+static const uint32_t RECORDING_VERSION = 2;
+static const uint32_t RECORDING_INDEX_INTERVAL = 100;   // 每100帧（约1秒）一个索引项
+
+struct RecordingFileHeader {
+    char magic[8];              // RECORDING_MAGIC
+    uint32_t version;           // 格式版本
+    uint32_t headerSize;        // 文件头长度（128）
+    uint32_t recordSize;        // 每条记录长度 = sizeof(RecordHeader) + payloadSize
+    uint16_t imuCount;          // IMU数量
+    uint16_t dataPerImu;        // 每个IMU的通道数
+    uint32_t payloadSize;       // 帧负载长度
+    uint32_t indexInterval;     // 索引间隔（帧）
+    int64_t startWallClockMs;   // 开始记录时的UTC毫秒，用于把单调时间换算为绝对时间
+    int64_t startSteadyNs;      // 开始记录时的单调时钟（纳秒）
+    char accelUnit[16];         // 加速度单位，"g"
+    char gyroUnit[16];          // 角速度单位，"dps"
+    char channelOrder[32];      // 每个IMU内的通道顺序
+    uint8_t reserved[16];
+};
+static_assert(sizeof(RecordingFileHeader) == 128, "RecordingFileHeader must be 128 bytes");
+
+struct RecordHeader {
+    uint64_t sequence;          // 帧序号（丢帧时跳变）
+    int64_t timestampNs;        // 采样时刻：帧时钟模型重建的单调时间戳（纳秒，与 startSteadyNs 同一时基）
+    int64_t arrivalNs;          // 到达时刻：从串口读出的单调时间（纳秒），未经平滑
+};
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader must be 24 bytes");
+static const uint32_t RECORD_HEADER_SIZE_V1 = 16;       // 版本1：sequence + timestampNs
+
+struct CompressedBlockHeader {
+    char magic[4];              // COMPRESSED_BLOCK_MAGIC
+    uint32_t frameCount;        // 本块帧数
+    uint32_t payloadSize;       // 压缩数据字节数
+    uint32_t checksum;          // 压缩数据的 FNV-1a 校验，截断或损坏的块不会被解码
+    int64_t firstTimestampNs;   // 第一帧的采样时间戳
+    int64_t lastTimestampNs;    // 最后一帧的采样时间戳
+};
+static_assert(sizeof(CompressedBlockHeader) == 32, "CompressedBlockHeader must be 32 bytes");
+
+struct RecordingFooter {
+    char magic[8];              // RECORDING_FOOTER_MAGIC
+    uint32_t footerSize;        // 文件尾长度（64）
+    uint32_t segmentIndex;      // 分段序号（1起；不分段时为1）
+    uint64_t frameCount;        // 本文件的帧数
+    uint64_t firstSequence;     // 第一帧和最后一帧的帧序号
+    uint64_t lastSequence;
+    int64_t firstTimestampNs;   // 第一帧和最后一帧的采样时间戳
+    int64_t lastTimestampNs;
+    uint64_t dataBytes;         // 记录的字节数 frameCount × recordSize（压缩记录为解压后的字节数）
+};
+static_assert(sizeof(RecordingFooter) == 64, "RecordingFooter must be 64 bytes");
+
+struct RecordingIndexHeader {
+    char magic[8];              // RECORDING_INDEX_MAGIC
+    uint32_t version;
+    uint32_t entrySize;         // sizeof(RecordingIndexEntry)
+};
+static_assert(sizeof(RecordingIndexHeader) == 16, "RecordingIndexHeader must be 16 bytes");
+
+struct RecordingIndexEntry {
+    int64_t timestampNs;        // 该记录的时间戳
+    uint64_t sequence;          // 该记录的帧序号
+    uint64_t offset;            // 该记录在数据文件中的字节偏移
+};
+static_assert(sizeof(RecordingIndexEntry) == 24, "RecordingIndexEntry must be 24 bytes");
+
+// 当前版本下 imuCount 个IMU的记录长度
+inline uint32_t recordSizeFor(int imuCount)
+{
+    return static_cast<uint32_t>(sizeof(RecordHeader) + imuCount * sizeof(IMUData));
+}
+
+// 文件头描述的版本和帧布局是否可由本程序读取（IMU数量须有对应的帧格式）
+inline bool isReadableRecordLayout(const RecordingFileHeader &header)
+{
+    const FrameFormat *format = findFrameFormat(header.imuCount);
+    if (!format || header.dataPerImu != DATA_PER_IMU ||
+        header.payloadSize != static_cast<uint32_t>(format->dataSize))
+    {
+        return false;
+    }
+    if (header.version == 1)    return header.recordSize == RECORD_HEADER_SIZE_V1 + header.payloadSize;
+    return header.version == RECORDING_VERSION && header.recordSize == recordSizeFor(header.imuCount);
+}
+
+// 解出一条记录的记录头（版本1没有到达时刻，以时间戳代替）；负载紧随其后
+inline void readRecordHeader(const RecordingFileHeader &fileHeader, const void *record, RecordHeader &out)
+{
+    const uint32_t size = fileHeader.recordSize - fileHeader.payloadSize;
+    memcpy(&out, record, size);
+    if (size < sizeof(RecordHeader))    out.arrivalNs = out.timestampNs;
+}
+
+// 按帧格式填写文件头
+inline RecordingFileHeader makeRecordingHeader(const FrameFormat &format, int64_t startWallClockMs, int64_t startSteadyNs)
+{
+    RecordingFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+    header.version = RECORDING_VERSION;
+    header.headerSize = sizeof(RecordingFileHeader);
+    header.recordSize = recordSizeFor(format.imuCount);
+    header.imuCount = static_cast<uint16_t>(format.imuCount);
+    header.dataPerImu = DATA_PER_IMU;
+    header.payloadSize = static_cast<uint32_t>(format.dataSize);
+    header.indexInterval = RECORDING_INDEX_INTERVAL;
+    header.startWallClockMs = startWallClockMs;
+    header.startSteadyNs = startSteadyNs;
+    strncpy(header.accelUnit, "g", sizeof(header.accelUnit) - 1);
+    strncpy(header.gyroUnit, "dps", sizeof(header.gyroUnit) - 1);
+    strncpy(header.channelOrder, "ax,ay,az,gx,gy,gz", sizeof(header.channelOrder) - 1);
+    return header;
+}
+
+// 解出文件尾（data 指向 sizeof(RecordingFooter) 字节）：magic 和长度相符时返回 true
+inline bool parseRecordingFooter(const void *data, RecordingFooter &footer)
+{
+    memcpy(&footer, data, sizeof(footer));
+    return memcmp(footer.magic, RECORDING_FOOTER_MAGIC, sizeof(footer.magic)) == 0 &&
+            footer.footerSize == sizeof(RecordingFooter);
+}
+
+// 未压缩记录文件中文件头之后的记录字节数：fileTail 为文件最后 sizeof(RecordingFooter) 字节
+// （文件更短时可为 nullptr），有与文件长度相符的文件尾时不计文件尾
+inline uint64_t recordingDataBytes(const RecordingFileHeader &header, uint64_t fileSize, const void *fileTail)
+{
+    if (fileSize < header.headerSize)   return 0;
+    RecordingFooter footer;
+    if (fileTail && fileSize >= header.headerSize + sizeof(footer) && parseRecordingFooter(fileTail, footer) &&
+        footer.dataBytes == fileSize - header.headerSize - sizeof(footer))
+    {
+        return footer.dataBytes;
+    }
+    return fileSize - header.headerSize;
+}
+
+inline RecordingIndexHeader makeRecordingIndexHeader()
+{
+    RecordingIndexHeader header;
+    memcpy(header.magic, RECORDING_INDEX_MAGIC, sizeof(header.magic));
+    header.version = RECORDING_VERSION;
+    header.entrySize = sizeof(RecordingIndexEntry);
+    return header;
+}
+
+#endif // RECORDINGFORMAT_H
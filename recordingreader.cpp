@@ -0,0 +1,279 @@
+#include "recordingreader.h"
+#include "csvencoder.h"
+#include "recordingcodec.h"
+#include <algorithm>
+#include <cstring>
+
+RecordingReader::RecordingReader() :
+    data(nullptr),
+    frames(0),
+    format(&defaultFrameFormat()),
+    compressed(false),
+    cachedBlock(-1)
+{
+    memset(&fileHeader, 0, sizeof(fileHeader));
+}
+
+RecordingReader::~RecordingReader()
+{
+    close();
+}
+
+bool RecordingReader::open(const QString &fileName, QString *errorString)
+{
+    close();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (errorString)    *errorString = file.errorString();
+        return false;
+    }
+    if (file.size() < static_cast<qint64>(sizeof(RecordingFileHeader)))
+    {
+        if (errorString)    *errorString = "文件太短，不是有效的记录文件";
+        file.close();
+        return false;
+    }
+    data = file.map(0, file.size());
+    if (!data)
+    {
+        if (errorString)    *errorString = file.errorString();
+        file.close();
+        return false;
+    }
+
+    memcpy(&fileHeader, data, sizeof(fileHeader));
+    compressed = memcmp(fileHeader.magic, RECORDING_COMPRESSED_MAGIC, sizeof(fileHeader.magic)) == 0;
+    if ((!compressed && memcmp(fileHeader.magic, RECORDING_MAGIC, sizeof(fileHeader.magic)) != 0) ||
+        !isReadableRecordLayout(fileHeader) ||
+        (compressed && fileHeader.recordSize != recordSizeFor(fileHeader.imuCount)))
+    {
+        if (errorString)    *errorString = "记录文件格式或帧布局不匹配";
+        close();
+        return false;
+    }
+    format = findFrameFormat(fileHeader.imuCount);
+
+    if (compressed)
+    {
+        scanBlocks();
+        return true;
+    }
+
+    // 正常结束的文件末尾有文件尾；未正常关闭的文件末尾可能有半条记录，忽略之
+    const qint64 size = file.size();
+    const uchar *tail = size >= static_cast<qint64>(sizeof(RecordingFooter)) ? data + size - sizeof(RecordingFooter) : nullptr;
+    frames = static_cast<qint64>(recordingDataBytes(fileHeader, static_cast<quint64>(size), tail) / fileHeader.recordSize);
+
+    if (!loadIndex(fileName + ".idx"))  rebuildIndex();
+    return true;
+}
+
+void RecordingReader::close()
+{
+    if (data)
+    {
+        file.unmap(const_cast<uchar *>(data));
+        data = nullptr;
+    }
+    if (file.isOpen())  file.close();
+    frames = 0;
+    index.clear();
+    compressed = false;
+    blocks.clear();
+    cachedBlock = -1;
+    blockCache.clear();
+}
+
+bool RecordingReader::loadIndex(const QString &indexFileName)
+{
+    QFile indexFile(indexFileName);
+    if (!indexFile.open(QIODevice::ReadOnly))   return false;
+
+    RecordingIndexHeader indexHeader;
+    if (indexFile.read(reinterpret_cast<char *>(&indexHeader), sizeof(indexHeader)) != sizeof(indexHeader) ||
+        memcmp(indexHeader.magic, RECORDING_INDEX_MAGIC, sizeof(indexHeader.magic)) != 0 ||
+        indexHeader.entrySize != sizeof(RecordingIndexEntry))
+    {
+        return false;
+    }
+
+    const qint64 count = (indexFile.size() - static_cast<qint64>(sizeof(indexHeader))) /
+            static_cast<qint64>(sizeof(RecordingIndexEntry));
+    index.resize(static_cast<int>(count));
+    indexFile.read(reinterpret_cast<char *>(index.data()), count * static_cast<qint64>(sizeof(RecordingIndexEntry)));
+
+    // 丢弃指向文件末尾之外的索引项（数据文件比索引文件先截断的情况）
+    const quint64 dataEnd = fileHeader.headerSize + static_cast<quint64>(frames) * fileHeader.recordSize;
+    while (!index.isEmpty() && index.last().offset >= dataEnd)  index.removeLast();
+    return !index.isEmpty() || frames == 0;
+}
+
+void RecordingReader::rebuildIndex()
+{
+    // 索引文件缺失时按相同间隔重建，只触及每 indexInterval 条中的一条记录
+    index.clear();
+    const qint64 interval = fileHeader.indexInterval > 0 ? fileHeader.indexInterval : RECORDING_INDEX_INTERVAL;
+    for (qint64 i = 0; i < frames; i += interval)
+    {
+        RecordHeader record;
+        readRecordHeader(fileHeader, recordAt(i), record);
+        RecordingIndexEntry entry;
+        entry.timestampNs = record.timestampNs;
+        entry.sequence = record.sequence;
+        entry.offset = fileHeader.headerSize + static_cast<quint64>(i) * fileHeader.recordSize;
+        index.append(entry);
+    }
+}
+
+void RecordingReader::scanBlocks()
+{
+    // 顺序跳读块头，遇到文件尾或第一个不合理的块头结束；未正常关闭的文件末尾可能有不完整的块，忽略之
+    frames = 0;
+    const qint64 size = file.size();
+    qint64 offset = fileHeader.headerSize;
+    while (offset + static_cast<qint64>(sizeof(CompressedBlockHeader)) <= size)
+    {
+        Block block;
+        block.offset = offset;
+        block.firstFrame = frames;
+        memcpy(&block.header, data + offset, sizeof(block.header));
+        const qint64 end = offset + static_cast<qint64>(sizeof(block.header)) + block.header.payloadSize;
+        if (!RecordBlockCodec::isValidHeader(fileHeader, block.header) || end > size)   break;
+        blocks.append(block);
+
+        // 块数据以首帧序号（64位原值）开头
+        RecordingIndexEntry entry;
+        entry.timestampNs = block.header.firstTimestampNs;
+        entry.sequence = 0;
+        if (block.header.payloadSize >= sizeof(entry.sequence))
+        {
+            memcpy(&entry.sequence, data + offset + sizeof(block.header), sizeof(entry.sequence));
+        }
+        entry.offset = fileHeader.headerSize + static_cast<quint64>(frames) * fileHeader.recordSize;
+        index.append(entry);
+
+        frames += block.header.frameCount;
+        offset = end;
+    }
+}
+
+const uchar *RecordingReader::recordAt(qint64 index) const
+{
+    if (!compressed)    return data + fileHeader.headerSize + index * fileHeader.recordSize;
+
+    auto it = std::upper_bound(blocks.constBegin(), blocks.constEnd(), index,
+                               [](qint64 i, const Block &block) { return i < block.firstFrame; });
+    const int b = static_cast<int>(it - blocks.constBegin()) - 1;
+    if (b != cachedBlock)
+    {
+        cachedBlock = b;
+        const Block &block = blocks[b];
+        const char *payload = reinterpret_cast<const char *>(data + block.offset + sizeof(block.header));
+        if (!RecordBlockCodec::decodeBlock(fileHeader, block.header, payload, blockCache))  blockCache.clear();
+    }
+    const qint64 offset = (index - blocks[b].firstFrame) * fileHeader.recordSize;
+    if (offset >= static_cast<qint64>(blockCache.size()))   return nullptr;    // 块已损坏
+    return reinterpret_cast<const uchar *>(blockCache.data() + offset);
+}
+
+qint64 RecordingReader::timestampAt(qint64 index) const
+{
+    const uchar *recordData = recordAt(index);
+    if (!recordData)
+    {
+        // 损坏的压缩块：以块头中的首帧时间戳代替，保持查找有序
+        auto it = std::upper_bound(blocks.constBegin(), blocks.constEnd(), index,
+                                   [](qint64 i, const Block &block) { return i < block.firstFrame; });
+        return (it - 1)->header.firstTimestampNs;
+    }
+    RecordHeader record;
+    readRecordHeader(fileHeader, recordData, record);
+    return record.timestampNs;
+}
+
+bool RecordingReader::readFrame(qint64 index, ImuFrame &frame) const
+{
+    if (!data || index < 0 || index >= frames)  return false;
+
+    const uchar *record = recordAt(index);
+    if (!record)    return false;
+    RecordHeader recordHeader;
+    readRecordHeader(fileHeader, record, recordHeader);
+    memcpy(frame.imu, record + (fileHeader.recordSize - fileHeader.payloadSize), fileHeader.payloadSize);
+    frame.imuCount = format->imuCount;
+    format->reduce(frame);
+    memset(&frame.spread, 0, sizeof(frame.spread));
+    frame.saturatedMask = 0;
+    frame.stuckMask = 0;
+    frame.sequence = recordHeader.sequence;
+    frame.monotonicNs = recordHeader.timestampNs;
+    frame.arrivalNs = recordHeader.arrivalNs;
+    frame.timestampMs = wallClockMs(recordHeader.timestampNs);
+    return true;
+}
+
+qint64 RecordingReader::findFrameAtTime(qint64 timestampNs) const
+{
+    if (frames == 0)    return 0;
+
+    // 在稀疏索引中二分查找最后一个早于目标时刻的索引项，再向后顺序查找
+    qint64 start = 0;
+    if (!index.isEmpty())
+    {
+        auto it = std::lower_bound(index.constBegin(), index.constEnd(), timestampNs,
+                                   [](const RecordingIndexEntry &entry, qint64 t) {
+                                       return entry.timestampNs < t;
+                                   });
+        if (it != index.constBegin())
+        {
+            --it;
+            start = static_cast<qint64>((it->offset - fileHeader.headerSize) / fileHeader.recordSize);
+        }
+    }
+    for (qint64 i = start; i < frames; ++i)
+    {
+        if (timestampAt(i) >= timestampNs)  return i;
+    }
+    return frames;
+}
+
+qint64 RecordingReader::wallClockMs(qint64 timestampNs) const
+{
+    return fileHeader.startWallClockMs + (timestampNs - fileHeader.startSteadyNs) / 1000000;
+}
+
+bool RecordingReader::exportCsv(const QString &recordingFile, const QString &csvFile, QString *errorString)
+{
+    RecordingReader reader;
+    if (!reader.open(recordingFile, errorString))   return false;
+
+    QFile out(csvFile);
+    if (!out.open(QIODevice::WriteOnly))
+    {
+        if (errorString)    *errorString = out.errorString();
+        return false;
+    }
+
+    // 与实时保存的CSV格式一致，按1MB大块写出
+    const std::size_t CHUNK_SIZE = 1024 * 1024;
+    std::vector<char> buffer;
+    buffer.reserve(CHUNK_SIZE + CsvEncoder::MAX_LINE_SIZE);
+    ImuFrame frame;
+    for (qint64 i = 0; i < reader.frameCount(); ++i)
+    {
+        // 损坏的压缩块中的帧跳过
+        if (reader.readFrame(i, frame)) CsvEncoder::appendFrame(buffer, frame.timestampMs, frame.imu, frame.imuCount);
+        if (buffer.size() >= CHUNK_SIZE || i + 1 == reader.frameCount())
+        {
+            if (out.write(buffer.data(), static_cast<qint64>(buffer.size())) != static_cast<qint64>(buffer.size()))
+            {
+                if (errorString)    *errorString = out.errorString();
+                return false;
+            }
+            buffer.clear();
+        }
+    }
+    return true;
+}
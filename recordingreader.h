@@ -0,0 +1,67 @@
+#ifndef RECORDINGREADER_H
+#define RECORDINGREADER_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <vector>
+#include "imuframe.h"
+#include "recordingformat.h"
+
+// 二进制记录读取器：内存映射数据文件，借助稀疏索引按时间戳定位，
+// 多GB文件也无需整体扫描或载入内存。
+// 压缩记录（*.imuz）打开时只跳读各块的块头，以块为单位建立索引；
+// 读取时按需解码所在的块并缓存最近一块（因此同一对象不能被多个线程同时读取）。
+class RecordingReader
+{
+public:
+    RecordingReader();
+    ~RecordingReader();
+
+    bool open(const QString &fileName, QString *errorString);
+    void close();
+
+    const RecordingFileHeader &header() const { return fileHeader; }
+    const FrameFormat &frameFormat() const { return *format; }
+    qint64 frameCount() const { return frames; }
+    bool isCompressed() const { return compressed; }
+
+    // 读取第 index 帧（0起），同时计算均值并换算UTC时间
+    // （跨IMU统计和健康标志只在采集时按批计算，这里清零）；所在的压缩块损坏时返回 false
+    bool readFrame(qint64 index, ImuFrame &frame) const;
+    // 第 index 帧的单调时间戳（纳秒）
+    qint64 timestampAt(qint64 index) const;
+    // 返回时间戳 >= timestampNs 的第一帧序号，全部早于该时刻时返回 frameCount()
+    qint64 findFrameAtTime(qint64 timestampNs) const;
+    // 单调时间戳换算为UTC毫秒
+    qint64 wallClockMs(qint64 timestampNs) const;
+
+    // 把二进制记录导出为与实时保存相同格式的CSV
+    static bool exportCsv(const QString &recordingFile, const QString &csvFile, QString *errorString);
+
+private:
+    // 压缩块的位置
+    struct Block {
+        qint64 offset;                  // 块头的文件偏移
+        qint64 firstFrame;              // 块中第一帧的序号（0起）
+        CompressedBlockHeader header;
+    };
+
+    bool loadIndex(const QString &indexFileName);
+    void rebuildIndex();
+    void scanBlocks();
+    const uchar *recordAt(qint64 index) const;
+
+    QFile file;
+    const uchar *data;                  // 映射的文件内容
+    qint64 frames;
+    RecordingFileHeader fileHeader;
+    const FrameFormat *format;          // 按文件头中的IMU数量选择的帧格式
+    QVector<RecordingIndexEntry> index; // 稀疏时间索引（按时间递增）；压缩记录每块一项，offset 为解压后的偏移
+    bool compressed;
+    QVector<Block> blocks;
+    mutable int cachedBlock;            // blockCache 中是哪一块（-1 为无）
+    mutable std::vector<char> blockCache;   // 最近解码的一块记录
+};
+
+#endif // RECORDINGREADER_H
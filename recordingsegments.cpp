@@ -0,0 +1,83 @@
+#include "recordingsegments.h"
+#include <cstdio>
+#include <cstring>
+
+RecordingSegments::RecordingSegments() :
+    segment(1),
+    frameCount(0),
+    byteCount(0),
+    firstSequence(0),
+    lastSequence(0),
+    firstTimestampNs(0),
+    lastTimestampNs(0)
+{
+}
+
+void RecordingSegments::start(const std::string &fileName, const Limits &limits)
+{
+    baseName = fileName;
+    segmentLimits = limits;
+    segment = 1;
+    frameCount = 0;
+    byteCount = 0;
+}
+
+std::string RecordingSegments::fileName(int index) const
+{
+    if (!segmentLimits.enabled())   return baseName;
+
+    // 序号插在扩展名之前（只看最后一级路径中的点）
+    const std::size_t slash = baseName.find_last_of("/\\");
+    std::size_t dot = baseName.rfind('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))    dot = baseName.size();
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%03d", index);
+    return baseName.substr(0, dot) + suffix + baseName.substr(dot);
+}
+
+bool RecordingSegments::full(int64_t timestampNs) const
+{
+    if (frameCount == 0)    return false;
+    if (segmentLimits.maxBytes > 0 && byteCount >= segmentLimits.maxBytes)  return true;
+    return segmentLimits.maxDurationNs > 0 && timestampNs - firstTimestampNs >= segmentLimits.maxDurationNs;
+}
+
+void RecordingSegments::add(uint64_t sequence, int64_t timestampNs, std::size_t bytes)
+{
+    if (frameCount == 0)
+    {
+        firstSequence = sequence;
+        firstTimestampNs = timestampNs;
+    }
+    lastSequence = sequence;
+    lastTimestampNs = timestampNs;
+    frameCount++;
+    byteCount += bytes;
+}
+
+std::string RecordingSegments::next()
+{
+    segment++;
+    frameCount = 0;
+    byteCount = 0;
+    return currentFileName();
+}
+
+RecordingFooter RecordingSegments::footer() const
+{
+    RecordingFooter footer;
+    memset(&footer, 0, sizeof(footer));
+    memcpy(footer.magic, RECORDING_FOOTER_MAGIC, sizeof(footer.magic));
+    footer.footerSize = sizeof(RecordingFooter);
+    footer.segmentIndex = static_cast<uint32_t>(segment);
+    footer.frameCount = frameCount;
+    if (frameCount > 0)
+    {
+        footer.firstSequence = firstSequence;
+        footer.lastSequence = lastSequence;
+        footer.firstTimestampNs = firstTimestampNs;
+        footer.lastTimestampNs = lastTimestampNs;
+    }
+    footer.dataBytes = byteCount;
+    return footer;
+}
@@ -0,0 +1,60 @@
+#ifndef RECORDINGSEGMENTS_H
+#define RECORDINGSEGMENTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "recordingformat.h"
+
+// 分段记录：录制文件达到设定的大小或时长后切换到新文件，每段都是独立可读的完整文件
+// （各有文件头；二进制记录正常结束的段末尾有 RecordingFooter）。异常退出只影响正在写的一段，
+// 单个文件也不会大到难以搬运。
+// 启用分段时各段命名为 基本名_001.扩展名、基本名_002.扩展名 ...；未启用时只有一个文件，沿用原文件名。
+// 只在采集线程中使用：写入每帧前用 full() 判断，切换文件由调用方通过 AsyncFileWriter::rollover() 完成。
+class RecordingSegments
+{
+public:
+    struct Limits {
+        uint64_t maxBytes;          // 每段写入的数据（压缩前）达到该字节数后切换，0 为不限
+        int64_t maxDurationNs;      // 每段的帧时间戳跨度达到该值后切换，0 为不限
+        Limits() : maxBytes(0), maxDurationNs(0) {}
+        bool enabled() const { return maxBytes > 0 || maxDurationNs > 0; }
+    };
+
+    RecordingSegments();
+
+    // 开始记录：fileName 为用户选择的文件名（UTF-8），当前段为第1段
+    void start(const std::string &fileName, const Limits &limits);
+    const Limits &limits() const { return segmentLimits; }
+
+    int index() const { return segment; }
+    // 第 index 段（1起）的文件名
+    std::string fileName(int index) const;
+    std::string currentFileName() const { return fileName(segment); }
+
+    // 写入采样时刻为 timestampNs 的下一帧之前调用：当前段已满时返回 true
+    bool full(int64_t timestampNs) const;
+    // 记录写入当前段的一帧（bytes 为该帧占用的字节数）
+    void add(uint64_t sequence, int64_t timestampNs, std::size_t bytes);
+    // 切换到下一段，返回新文件名
+    std::string next();
+
+    // 当前段的文件尾（二进制记录：add() 的 bytes 为记录长度）
+    RecordingFooter footer() const;
+
+    uint64_t frames() const { return frameCount; }
+    uint64_t bytes() const { return byteCount; }
+
+private:
+    std::string baseName;
+    Limits segmentLimits;
+    int segment;
+    uint64_t frameCount;                // 当前段的帧数
+    uint64_t byteCount;                 // 当前段写入的字节数
+    uint64_t firstSequence;
+    uint64_t lastSequence;
+    int64_t firstTimestampNs;
+    int64_t lastTimestampNs;
+};
+
+#endif // RECORDINGSEGMENTS_H
@@ -0,0 +1,436 @@
+#include "recordingview.h"
+#include "recordingreader.h"
+#include "csvparser.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+static const qint64 SCAN_CHUNK_BYTES = 8 * 1024 * 1024;    // 打开时每块的大小
+static const std::size_t RAW_ROWS_PER_BUCKET = 2;           // 可见行数不超过桶数的该倍数时逐行原样显示
+
+void RecordingView::Buckets::reset(double startTime, double bucketWidth, std::size_t bucketCount, std::size_t channelCount)
+{
+    start = startTime;
+    width = bucketWidth > 0 ? bucketWidth : 1e-9;
+    count = bucketCount;
+    channels = channelCount;
+    minMax.assign(count * channels * 2, 0.0f);
+    samples.assign(count, 0);
+}
+
+std::size_t RecordingView::Buckets::bucketAt(double time) const
+{
+    const double k = std::floor((time - start) / width);
+    if (!(k > 0))   return 0;
+    return k >= static_cast<double>(count) ? count - 1 : static_cast<std::size_t>(k);
+}
+
+void RecordingView::Buckets::merge(std::size_t bucket, const float *values, quint32 n)
+{
+    float *accMin = &minMax[bucket * channels * 2];
+    float *accMax = accMin + channels;
+    if (samples[bucket] == 0)
+    {
+        memcpy(accMin, values, channels * 2 * sizeof(float));
+    }
+    else
+    {
+        for (std::size_t c = 0; c < channels; ++c)
+        {
+            accMin[c] = std::min(accMin[c], values[c]);
+            accMax[c] = std::max(accMax[c], values[channels + c]);
+        }
+    }
+    samples[bucket] += n;
+}
+
+RecordingView::BucketWriter::BucketWriter(Buckets &target, std::mutex &mutex) :
+    buckets(target),
+    lock(mutex),
+    current(0),
+    samples(0),
+    minMax(target.channels * 2)
+{
+}
+
+void RecordingView::BucketWriter::add(double time, const float *values)
+{
+    const std::size_t bucket = buckets.bucketAt(time);
+    if (samples > 0 && bucket != current)   flush();
+
+    const std::size_t n = buckets.channels;
+    float *accMin = minMax.data();
+    float *accMax = accMin + n;
+    if (samples == 0)
+    {
+        current = bucket;
+        memcpy(accMin, values, n * sizeof(float));
+        memcpy(accMax, values, n * sizeof(float));
+    }
+    else
+    {
+        for (std::size_t c = 0; c < n; ++c)
+        {
+            accMin[c] = std::min(accMin[c], values[c]);
+            accMax[c] = std::max(accMax[c], values[c]);
+        }
+    }
+    ++samples;
+}
+
+void RecordingView::BucketWriter::flush()
+{
+    if (samples == 0)   return;
+    std::lock_guard<std::mutex> guard(lock);
+    buckets.merge(current, minMax.data(), samples);
+    samples = 0;
+}
+
+RecordingView::RecordingView() :
+    data(nullptr),
+    csv(true),
+    imus(0),
+    threads(1),
+    size(0),
+    dataStart(0),
+    rows(0),
+    badRows(0),
+    frameTotal(0),
+    firstStamp(0),
+    stampScale(1e-3),
+    startMs(0),
+    lastTime(0),
+    openSeconds(0),
+    selectedStart(0),
+    selectedEnd(0),
+    selectedBuckets(0),
+    raw(false)
+{
+    overview.reset(0, 1, 0, 0);
+    slice.reset(0, 1, 0, 0);
+}
+
+RecordingView::~RecordingView()
+{
+    close();
+}
+
+void RecordingView::close()
+{
+    readers.clear();
+    if (data)   file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
+    data = nullptr;
+    file.close();
+    imus = 0;
+    size = 0;
+    rows = 0;
+    badRows = 0;
+    frameTotal = 0;
+    lastTime = 0;
+    std::vector<IndexEntry>().swap(index);
+    overview.reset(0, 1, 0, 0);
+    slice.reset(0, 1, 0, 0);
+    std::vector<double>().swap(rawTimes);
+    std::vector<float>().swap(rawValues);
+    selectedBuckets = 0;
+}
+
+template <typename Visitor>
+qint64 RecordingView::scan(qint64 begin, qint64 end, int thread, Visitor visit) const
+{
+    const int count = imus * DATA_PER_IMU;
+    float values[MAX_IMU_COUNT * DATA_PER_IMU + 6];
+    float *mean = values + count;
+    qint64 bad = 0;
+    if (csv)
+    {
+        const char *p = data + begin;
+        const char *stop = data + end;
+        int64_t stamp;
+        while (p < stop)
+        {
+            const char *next = CsvParser::nextLine(p, stop);
+            const char *lineEnd = CsvParser::lineEnd(p, next);
+            if (lineEnd > p)
+            {
+                if (CsvParser::parseLine(p, lineEnd, count, stamp, values))
+                {
+                    // CSV 中没有均值，按行计算（与采集时相同：所有IMU的算术平均）
+                    for (int j = 0; j < 6; ++j)     mean[j] = 0;
+                    for (int i = 0; i < imus; ++i)
+                    {
+                        for (int j = 0; j < 6; ++j) mean[j] += values[i * DATA_PER_IMU + j];
+                    }
+                    for (int j = 0; j < 6; ++j)     mean[j] /= imus;
+                    visit(static_cast<qint64>(p - data), (stamp - firstStamp) * stampScale, values);
+                }
+                else
+                {
+                    ++bad;
+                }
+            }
+            p = next;
+        }
+    }
+    else
+    {
+        RecordingReader &reader = *readers[static_cast<std::size_t>(thread)];
+        ImuFrame frame;
+        for (qint64 i = begin; i < end; ++i)
+        {
+            // 损坏的压缩块中的帧跳过
+            if (!reader.readFrame(i, frame))
+            {
+                ++bad;
+                continue;
+            }
+            memcpy(values, &frame.imu[0].accel[0], static_cast<std::size_t>(count) * sizeof(float));
+            memcpy(mean, frame.meanAccel, sizeof(frame.meanAccel));
+            memcpy(mean + 3, frame.meanGyro, sizeof(frame.meanGyro));
+            visit(i, (frame.monotonicNs - firstStamp) * stampScale, values);
+        }
+    }
+    return bad;
+}
+
+bool RecordingView::open(const QString &fileName, int threadCount, QString *errorString)
+{
+    close();
+    QElapsedTimer timer;
+    timer.start();
+    const auto fail = [this, errorString](const QString &message) {
+        close();
+        if (errorString)    *errorString = message;
+        return false;
+    };
+
+    threads = threadCount > 0 ? threadCount : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    name = fileName;
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly))    return fail(file.errorString());
+    size = file.size();
+    char magic[sizeof(RECORDING_MAGIC)] = {0};
+    file.read(magic, sizeof(magic));
+    csv = memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0
+            && memcmp(magic, RECORDING_COMPRESSED_MAGIC, sizeof(magic)) != 0;
+
+    // 先确定IMU数量和首末时刻，概览按整个会话的时长等分
+    int imuCount = 0;
+    if (csv)
+    {
+        if (size == 0)  return fail("文件为空");
+        data = reinterpret_cast<const char *>(file.map(0, size));
+        if (!data)  return fail(file.errorString());
+        const char *end = data + size;
+        const char *first = CsvParser::findData(data, end);
+        if (first == end)   return fail("文件中没有数据");
+        dataStart = first - data;
+        const int values = CsvParser::valueCount(first, end);
+        if (values == 0 || values % DATA_PER_IMU != 0 || values / DATA_PER_IMU > MAX_IMU_COUNT)
+            return fail(QString("第一行数据有 %1 个数值，不是 IMU数量 × %2").arg(values).arg(DATA_PER_IMU));
+        imuCount = values / DATA_PER_IMU;
+
+        std::vector<float> scratch(static_cast<std::size_t>(values));
+        int64_t firstMs = 0;
+        if (!CsvParser::parseLine(first, CsvParser::lineEnd(first, CsvParser::nextLine(first, end)), values, firstMs, scratch.data()))
+            return fail("第一行数据格式错误");
+        // 异常退出时最后一行可能不完整，向前找最后一个完整的行
+        int64_t lastMs = firstMs;
+        const char *stop = end;
+        for (int tries = 0; tries < 16; ++tries)
+        {
+            const char *last = CsvParser::findLastLine(first, stop);
+            if (last == stop)   break;
+            int64_t stamp;
+            if (CsvParser::parseLine(last, CsvParser::lineEnd(last, CsvParser::nextLine(last, stop)), values, stamp, scratch.data()))
+            {
+                lastMs = stamp;
+                break;
+            }
+            stop = last;
+        }
+        firstStamp = firstMs;
+        stampScale = 1e-3;
+        startMs = firstMs;
+        lastTime = (lastMs - firstMs) * stampScale;
+    }
+    else
+    {
+        file.close();
+        for (int t = 0; t < threads; ++t)
+        {
+            readers.emplace_back(new RecordingReader);
+            QString error;
+            if (!readers.back()->open(fileName, &error))    return fail(error);
+        }
+        const RecordingReader &reader = *readers.front();
+        frameTotal = reader.frameCount();
+        if (frameTotal == 0)    return fail("记录中没有帧");
+        imuCount = reader.frameFormat().imuCount;
+        firstStamp = reader.timestampAt(0);
+        stampScale = 1e-9;
+        startMs = reader.wallClockMs(firstStamp);
+        lastTime = (reader.timestampAt(frameTotal - 1) - firstStamp) * stampScale;
+    }
+    imus = imuCount;
+    lastTime = std::max(lastTime, 0.0);
+    overview.reset(0, lastTime / OVERVIEW_BUCKETS, OVERVIEW_BUCKETS, static_cast<std::size_t>(channelCount()));
+
+    // 切块：CSV 每块约 SCAN_CHUNK_BYTES 字节并延伸到行尾，二进制记录按记录大小换算为帧数
+    std::vector<std::pair<qint64, qint64>> chunks;
+    const qint64 total = positionEnd();
+    const qint64 step = csv ? SCAN_CHUNK_BYTES : std::max<qint64>(1, SCAN_CHUNK_BYTES / (channelCount() * 4 + 24));
+    for (qint64 begin = csv ? dataStart : 0; begin < total;)
+    {
+        qint64 end = std::min(total, begin + step);
+        if (csv && end < total) end = CsvParser::nextLine(data + end - 1, data + total) - data;
+        chunks.push_back(std::make_pair(begin, end));
+        begin = end;
+    }
+
+    // 各线程依次取块：每块自己的稀疏索引，概览桶换桶时加锁合并
+    std::vector<std::vector<IndexEntry>> chunkIndex(chunks.size());
+    std::atomic<std::size_t> nextChunk(0);
+    std::atomic<qint64> rowTotal(0);
+    std::atomic<qint64> badTotal(0);
+    std::mutex overviewMutex;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            BucketWriter writer(overview, overviewMutex);
+            for (std::size_t c = nextChunk++; c < chunks.size(); c = nextChunk++)
+            {
+                std::vector<IndexEntry> &entries = chunkIndex[c];
+                qint64 n = 0;
+                badTotal += scan(chunks[c].first, chunks[c].second, t, [&](qint64 position, double time, const float *values) {
+                    if (n++ % INDEX_INTERVAL == 0)  entries.push_back(IndexEntry{time, position});
+                    writer.add(time, values);
+                });
+                rowTotal += n;
+            }
+        });
+    }
+    for (std::thread &worker : workers) worker.join();
+
+    rows = rowTotal;
+    badRows = badTotal;
+    for (const std::vector<IndexEntry> &entries : chunkIndex)   index.insert(index.end(), entries.begin(), entries.end());
+    if (rows == 0)  return fail("文件中没有可解析的数据");
+
+    openSeconds = timer.nsecsElapsed() / 1e9;
+    return true;
+}
+
+void RecordingView::positionRange(double t0, double t1, std::size_t &first, std::size_t &last) const
+{
+    // first: 最后一个时刻 <= t0 的索引项；last: 第一个时刻 > t1 的索引项
+    const auto later = [](double t, const IndexEntry &entry) { return t < entry.time; };
+    const auto begin = std::upper_bound(index.begin(), index.end(), t0, later);
+    first = begin == index.begin() ? 0 : static_cast<std::size_t>(begin - index.begin()) - 1;
+    last = static_cast<std::size_t>(std::upper_bound(index.begin() + static_cast<std::ptrdiff_t>(first), index.end(), t1, later) - index.begin());
+}
+
+bool RecordingView::select(double t0, double t1, std::size_t maxBuckets)
+{
+    if (!isOpen() || maxBuckets == 0)   return false;
+    t0 = std::max(t0, 0.0);
+    t1 = std::min(t1, lastTime);
+    if (t1 <= t0)   t1 = t0 + overview.width;
+    if (t0 == selectedStart && t1 == selectedEnd && maxBuckets == selectedBuckets)  return false;
+    selectedStart = t0;
+    selectedEnd = t1;
+    selectedBuckets = maxBuckets;
+
+    const std::size_t channels = static_cast<std::size_t>(channelCount());
+    raw = false;
+    rawTimes.clear();
+    rawValues.clear();
+    slice.reset(t0, (t1 - t0) / maxBuckets, maxBuckets, channels);
+
+    // 概览足够细：合并范围内的概览桶，不读文件
+    if ((t1 - t0) / overview.width >= maxBuckets)
+    {
+        const std::size_t last = overview.bucketAt(t1);
+        for (std::size_t b = overview.bucketAt(t0); b <= last; ++b)
+        {
+            if (overview.samples[b] == 0)   continue;
+            slice.merge(slice.bucketAt(overview.start + b * overview.width), &overview.minMax[b * channels * 2],
+                        overview.samples[b]);
+        }
+        return true;
+    }
+
+    // 否则只解析可见的一段：由时间索引定位
+    std::size_t first = 0, last = 0;
+    positionRange(t0, t1, first, last);
+    const auto positionAt = [this](std::size_t entry) {
+        return entry < index.size() ? index[entry].position : positionEnd();
+    };
+    const std::size_t estimatedRows = (last - first) * INDEX_INTERVAL;
+    if (estimatedRows <= maxBuckets * RAW_ROWS_PER_BUCKET)
+    {
+        raw = true;
+        scan(positionAt(first), positionAt(last), 0, [&](qint64, double time, const float *values) {
+            if (time < t0 || time > t1) return;
+            rawTimes.push_back(time);
+            rawValues.insert(rawValues.end(), values, values + channels);
+        });
+        return true;
+    }
+
+    // 行数较多：按索引项把这一段分给各线程，各自按像素桶累加 min/max
+    std::mutex sliceMutex;
+    const std::size_t parts = std::min(static_cast<std::size_t>(threads), last - first);
+    std::vector<std::thread> workers;
+    for (std::size_t k = 0; k < parts; ++k)
+    {
+        const qint64 begin = positionAt(first + (last - first) * k / parts);
+        const qint64 end = positionAt(first + (last - first) * (k + 1) / parts);
+        workers.emplace_back([&, begin, end, k]() {
+            BucketWriter writer(slice, sliceMutex);
+            scan(begin, end, static_cast<int>(k), [&](qint64, double time, const float *values) {
+                if (time >= t0 && time <= t1)   writer.add(time, values);
+            });
+        });
+    }
+    for (std::thread &worker : workers) worker.join();
+    return true;
+}
+
+std::size_t RecordingView::points(int channel, std::vector<Point> &out) const
+{
+    out.clear();
+    if (!isOpen() || channel < 0 || channel >= channelCount())  return 0;
+
+    const std::size_t channels = static_cast<std::size_t>(channelCount());
+    const std::size_t c = static_cast<std::size_t>(channel);
+    Point point;
+    if (raw)
+    {
+        out.reserve(rawTimes.size());
+        for (std::size_t i = 0; i < rawTimes.size(); ++i)
+        {
+            point.time = rawTimes[i];
+            point.value = rawValues[i * channels + c];
+            out.push_back(point);
+        }
+        return out.size();
+    }
+
+    out.reserve(slice.count * 2);
+    for (std::size_t b = 0; b < slice.count; ++b)
+    {
+        if (slice.samples[b] == 0)  continue;
+        const float *values = &slice.minMax[b * channels * 2];
+        point.time = slice.start + b * slice.width;
+        point.value = values[c];
+        out.push_back(point);
+        point.value = values[channels + c];
+        out.push_back(point);
+    }
+    return out.size();
+}
@@ -0,0 +1,130 @@
+#ifndef RECORDINGVIEW_H
+#define RECORDINGVIEW_H
+
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "imuframe.h"
+#include "minmaxpyramid.h"
+
+class RecordingReader;
+
+// 记录查看器的数据源：内存映射一个保存的记录（CSV 或 *.imu、*.imuz），不把文件读入内存。
+// 打开时由多个线程并行扫描整个文件（CSV 按行对齐切块，二进制记录按帧），
+// 建立稀疏时间索引（每块每 INDEX_INTERVAL 行一项）和整个会话的 min/max 概览（OVERVIEW_BUCKETS 个等宽时间桶）。
+// 之后显示任意时间范围时：
+//   - 范围内的概览桶不少于要求的桶数，直接由概览合并，不读文件；
+//   - 否则按时间索引只解析可见的一段（多线程）：行数不多时逐行原样显示，否则每个像素桶取 min/max。
+// 通道与 ImuChart 的金字塔相同：IMU i 的第 j 个数据为 i * DATA_PER_IMU + j，其后6个为均值。
+class RecordingView
+{
+public:
+    typedef MinMaxPyramid::Point Point;
+
+    static const int OVERVIEW_BUCKETS = 16384;  // 概览的时间桶数（9 IMU 约8MB）
+    static const int INDEX_INTERVAL = 256;      // 时间索引间隔（行）
+
+    RecordingView();
+    ~RecordingView();
+
+    // 打开并扫描记录（耗时与文件大小成正比，应在后台线程中调用），threads <= 0 为CPU核数
+    bool open(const QString &fileName, int threads, QString *errorString);
+    void close();
+
+    bool isOpen() const { return imus > 0; }
+    QString fileName() const { return name; }
+    int imuCount() const { return imus; }
+    int channelCount() const { return imus * DATA_PER_IMU + 6; }
+    qint64 rowCount() const { return rows; }
+    qint64 badRowCount() const { return badRows; }
+    qint64 fileSize() const { return size; }
+    double duration() const { return lastTime; }            // 秒，第一行为0
+    qint64 startWallClockMs() const { return startMs; }    // 第一行的UTC毫秒
+    double scanSeconds() const { return openSeconds; }      // 打开时扫描的耗时
+    int threadCount() const { return threads; }
+
+    // 准备 [t0, t1]（秒）内的数据，约 maxBuckets 个桶；与上次相同时不做任何事，返回 false
+    bool select(double t0, double t1, std::size_t maxBuckets);
+    // 当前选择是否逐行原样（否则每个桶依次输出最小值和最大值两个点）
+    bool isRawSelection() const { return raw; }
+    // 当前选择中某通道的数据（先清空 out），返回点数
+    std::size_t points(int channel, std::vector<Point> &out) const;
+
+private:
+    struct IndexEntry {
+        double time;
+        qint64 position;                // CSV 为该行的字节偏移，二进制记录为帧序号
+    };
+
+    // 等宽时间桶，每个桶记录各通道的最小值、最大值和行数
+    struct Buckets {
+        double start;
+        double width;
+        std::size_t count;
+        std::size_t channels;
+        std::vector<float> minMax;      // 每个桶 channels 个最小值，接着 channels 个最大值
+        std::vector<quint32> samples;
+
+        void reset(double startTime, double bucketWidth, std::size_t bucketCount, std::size_t channelCount);
+        std::size_t bucketAt(double time) const;    // 超出范围的时刻归入首末桶
+        void merge(std::size_t bucket, const float *values, quint32 n);  // values 为 min、max 两组
+    };
+
+    // 按时间顺序向 Buckets 累加行：同一桶内先在本地累加，换桶时加锁合并，多个线程可同时写入同一个 Buckets
+    class BucketWriter
+    {
+    public:
+        BucketWriter(Buckets &target, std::mutex &mutex);
+        ~BucketWriter() { flush(); }
+        void add(double time, const float *values);
+        void flush();
+
+    private:
+        Buckets &buckets;
+        std::mutex &lock;
+        std::size_t current;
+        quint32 samples;
+        std::vector<float> minMax;
+    };
+
+    // 解析 [begin, end)（CSV 为字节范围，二进制记录为帧范围），每行调用 visit(position, time, values)；
+    // thread 选择二进制记录的读取器。返回跳过的格式错误行（损坏的帧）数
+    template <typename Visitor>
+    qint64 scan(qint64 begin, qint64 end, int thread, Visitor visit) const;
+    // 时间索引中 [t0, t1] 所在的位置范围
+    void positionRange(double t0, double t1, std::size_t &first, std::size_t &last) const;
+    qint64 positionEnd() const { return csv ? size : frameTotal; }
+
+    QString name;
+    QFile file;
+    const char *data;                   // CSV：映射的文件内容
+    bool csv;
+    std::vector<std::unique_ptr<RecordingReader>> readers;  // 二进制记录：每个线程一个读取器
+    int imus;
+    int threads;
+    qint64 size;
+    qint64 dataStart;                   // CSV：第一行数据的偏移
+    qint64 rows;
+    qint64 badRows;
+    qint64 frameTotal;                  // 二进制记录：帧数
+    qint64 firstStamp;                  // 第一行的时间戳（CSV 为UTC毫秒，二进制记录为单调纳秒）
+    double stampScale;                  // 时间戳 → 秒
+    qint64 startMs;
+    double lastTime;
+    double openSeconds;
+    std::vector<IndexEntry> index;
+    Buckets overview;
+
+    // 当前选择
+    double selectedStart;
+    double selectedEnd;
+    std::size_t selectedBuckets;
+    bool raw;
+    std::vector<double> rawTimes;       // 逐行原样：每行的时刻和 channelCount() 个值
+    std::vector<float> rawValues;
+    Buckets slice;                      // 否则：每个像素桶的 min/max
+};
+
+#endif // RECORDINGVIEW_H
@@ -0,0 +1,227 @@
+#include "replaysource.h"
+#include "fileutil.h"
+#include "recordingcodec.h"
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+ReplaySource::ReplaySource() :
+    file(nullptr),
+    sourceKind(RawCapture),
+    rawFormat(&defaultFrameFormat()),
+    format(rawFormat),
+    recordPos(0),
+    recordsLeft(0),
+    playbackSpeed(1.0),
+    nominalFrameRate(100.0),
+    corruptionRate(0.0),
+    rng(1),
+    pendingPos(0),
+    pendingDueNs(0),
+    firstTimestampNs(0),
+    rawBytesProduced(0),
+    eof(true),
+    corruptBytes(0),
+    corruptUnits(0)
+{
+    memset(&header, 0, sizeof(header));
+}
+
+ReplaySource::~ReplaySource()
+{
+    close();
+}
+
+bool ReplaySource::open(const std::string &path, std::string *errorString)
+{
+    close();
+
+    file = openFileUtf8(path, "rb");
+    if (!file)
+    {
+        if (errorString)    *errorString = std::strerror(errno);
+        return false;
+    }
+
+    // 带记录文件头的按二进制记录回放（帧格式由文件头决定），否则视为原始串口字节
+    sourceKind = RawCapture;
+    format = rawFormat;
+    const bool headerRead = std::fread(&header, 1, sizeof(header), file) == sizeof(header);
+    const bool compressed = headerRead &&
+            memcmp(header.magic, RECORDING_COMPRESSED_MAGIC, sizeof(header.magic)) == 0;
+    if (compressed || (headerRead && memcmp(header.magic, RECORDING_MAGIC, sizeof(header.magic)) == 0))
+    {
+        if (!isReadableRecordLayout(header) || (compressed && header.recordSize != recordSizeFor(header.imuCount)))
+        {
+            if (errorString)    *errorString = "记录文件的版本或帧布局与当前程序不一致";
+            close();
+            return false;
+        }
+        sourceKind = compressed ? CompressedRecording : BinaryRecording;
+        format = findFrameFormat(header.imuCount);
+        record.resize(compressed ? 0 : header.recordSize);
+        recordPos = 0;
+        if (!compressed)
+        {
+            // 正常结束的文件末尾有文件尾，按其中的长度确定记录数
+            RecordingFooter tail;
+            const int64_t size = seekFile(file, 0, SEEK_END) ? tellFile(file) : -1;
+            const bool hasTail = size >= static_cast<int64_t>(sizeof(tail)) &&
+                    seekFile(file, size - static_cast<int64_t>(sizeof(tail)), SEEK_SET) &&
+                    std::fread(&tail, 1, sizeof(tail), file) == sizeof(tail);
+            recordsLeft = recordingDataBytes(header, static_cast<uint64_t>(size > 0 ? size : 0),
+                                             hasTail ? &tail : nullptr) / header.recordSize;
+        }
+        seekFile(file, static_cast<int64_t>(header.headerSize), SEEK_SET);
+    }
+    else
+    {
+        std::rewind(file);
+    }
+
+    pending.clear();
+    pendingPos = 0;
+    pendingDueNs = 0;
+    firstTimestampNs = std::numeric_limits<int64_t>::min();
+    rawBytesProduced = 0;
+    corruptBytes = 0;
+    corruptUnits = 0;
+    eof = false;
+    return true;
+}
+
+void ReplaySource::close()
+{
+    if (file)
+    {
+        std::fclose(file);
+        file = nullptr;
+    }
+    pending.clear();
+    pendingPos = 0;
+    eof = true;
+}
+
+void ReplaySource::setCorruptionRate(double probability, unsigned seed)
+{
+    corruptionRate = probability;
+    rng.seed(seed);
+}
+
+bool ReplaySource::atEnd() const
+{
+    return eof && pendingPos >= pending.size();
+}
+
+bool ReplaySource::produceNext()
+{
+    if (eof || !file)   return false;
+
+    pending.clear();
+    pendingPos = 0;
+
+    if (sourceKind != RawCapture)
+    {
+        // 记录 = RecordHeader + 负载，重建为串口帧：帧头 + 负载 + 尾标
+        const char *recordData = record.data();
+        if (sourceKind == CompressedRecording)
+        {
+            // 当前块用完时解码下一块；块被截断或损坏时回放结束
+            if (recordPos >= record.size())
+            {
+                recordPos = 0;
+                if (!readCompressedBlock(file, header, record))
+                {
+                    eof = true;
+                    return false;
+                }
+            }
+            recordData = record.data() + recordPos;
+            recordPos += header.recordSize;
+        }
+        else if (recordsLeft == 0 || std::fread(record.data(), 1, header.recordSize, file) != header.recordSize)
+        {
+            eof = true;
+            return false;
+        }
+        else
+        {
+            recordsLeft--;
+        }
+        RecordHeader recordHeader;
+        readRecordHeader(header, recordData, recordHeader);
+        if (firstTimestampNs == std::numeric_limits<int64_t>::min())
+        {
+            firstTimestampNs = recordHeader.timestampNs;
+        }
+        const char *payload = recordData + (header.recordSize - header.payloadSize);
+        pending.insert(pending.end(), format->headPattern, format->headPattern + format->headSize);
+        pending.insert(pending.end(), payload, payload + header.payloadSize);
+        pending.insert(pending.end(), format->tailPattern, format->tailPattern + format->tailSize);
+        const double offsetNs = static_cast<double>(recordHeader.timestampNs - firstTimestampNs);
+        pendingDueNs = playbackSpeed > 0 ? static_cast<int64_t>(offsetNs / playbackSpeed) : 0;
+    }
+    else
+    {
+        // 原始字节按帧长分段，到达时刻按理论数据率换算
+        pending.resize(static_cast<std::size_t>(format->frameSize));
+        const std::size_t n = std::fread(pending.data(), 1, pending.size(), file);
+        pending.resize(n);
+        if (n == 0)
+        {
+            eof = true;
+            return false;
+        }
+        const double bytesPerSecond = format->frameSize * nominalFrameRate;
+        const double offsetNs = rawBytesProduced / bytesPerSecond * 1.0e9;
+        pendingDueNs = playbackSpeed > 0 ? static_cast<int64_t>(offsetNs / playbackSpeed) : 0;
+        rawBytesProduced += n;
+    }
+
+    if (corruptionRate > 0 && std::generate_canonical<double, 32>(rng) < corruptionRate)
+    {
+        corrupt(pending);
+    }
+    return true;
+}
+
+void ReplaySource::corrupt(std::vector<char> &unit)
+{
+    corruptUnits++;
+    std::uniform_int_distribution<std::size_t> position(0, unit.size() - 1);
+    if (rng() & 1)
+    {
+        // 插入1~16个随机字节，其中约1/4为帧头首字节，制造假帧头
+        std::uniform_int_distribution<int> count(1, 16);
+        const int n = count(rng);
+        std::vector<char> garbage(static_cast<std::size_t>(n));
+        for (int i = 0; i < n; ++i)
+        {
+            garbage[static_cast<std::size_t>(i)] = (rng() & 3) == 0 ? format->headPattern[0] : static_cast<char>(rng() & 0xFF);
+        }
+        unit.insert(unit.begin() + static_cast<std::ptrdiff_t>(position(rng)), garbage.begin(), garbage.end());
+        corruptBytes += static_cast<uint64_t>(n);
+    }
+    else
+    {
+        // 翻转任意一个字节中的一位
+        unit[position(rng)] ^= static_cast<char>(1 << (rng() & 7));
+    }
+}
+
+std::size_t ReplaySource::read(char *dst, std::size_t maxBytes, int64_t elapsedNs)
+{
+    std::size_t total = 0;
+    while (total < maxBytes)
+    {
+        if (pendingPos >= pending.size() && !produceNext())    break;
+        if (playbackSpeed > 0 && pendingDueNs > elapsedNs)  break;  // 还没到达送出时刻
+
+        std::size_t n = pending.size() - pendingPos;
+        if (n > maxBytes - total)   n = maxBytes - total;
+        memcpy(dst + total, pending.data() + pendingPos, n);
+        pendingPos += n;
+        total += n;
+    }
+    return total;
+}
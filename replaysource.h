@@ -0,0 +1,79 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "recordingformat.h"
+
+// 回放数据源：把录制的原始串口字节（*.bin）或二进制记录（*.imu / *.imuz）
+// 还原为串口字节流，交给与实时串口完全相同的帧同步和解析流程。
+//  - speed > 0 时按录制时间（原始字节按理论数据率）以 speed 倍速送出
+//  - speed <= 0 时不限速，尽可能快地送出
+//  - 可按概率向每帧注入垃圾字节或翻转字节，用于检验失步恢复逻辑
+class ReplaySource
+{
+public:
+    enum Kind {
+        RawCapture,         // 原始串口字节
+        BinaryRecording,    // *.imu 二进制记录，按帧重建 帧头+负载+尾标
+        CompressedRecording // *.imuz 压缩记录，逐块解码后同上
+    };
+
+    ReplaySource();
+    ~ReplaySource();
+
+    // path 为 UTF-8 编码，按文件头自动识别类型
+    bool open(const std::string &path, std::string *errorString);
+    void close();
+
+    void setSpeed(double speed) { playbackSpeed = speed; }
+    // 原始字节按该帧率换算理论数据率（Hz）
+    void setNominalFrameRate(double hz) { nominalFrameRate = hz; }
+    // 原始字节的帧格式（打开前设置）；二进制记录按文件头中的IMU数量自动选择
+    void setRawFrameFormat(const FrameFormat &format) { rawFormat = &format; }
+    // 回放数据对应的帧格式，帧同步器应按此格式解析
+    const FrameFormat &frameFormat() const { return *format; }
+    // 每帧注入错误的概率（0~1）
+    void setCorruptionRate(double probability, unsigned seed = 1);
+
+    Kind kind() const { return sourceKind; }
+    bool atEnd() const;
+
+    // 取出回放开始后 elapsedNs 纳秒内应当到达、尚未取出的字节，最多 maxBytes
+    std::size_t read(char *dst, std::size_t maxBytes, int64_t elapsedNs);
+
+    uint64_t injectedBytes() const { return corruptBytes; }  // 注入的垃圾字节数
+    uint64_t corruptedFrames() const { return corruptUnits; } // 被注入错误的帧数
+
+private:
+    bool produceNext();                 // 生成下一帧（或一段原始字节）到 pending
+    void corrupt(std::vector<char> &unit);
+
+    std::FILE *file;
+    Kind sourceKind;
+    RecordingFileHeader header;
+    const FrameFormat *rawFormat;       // 原始字节的帧格式
+    const FrameFormat *format;          // 当前回放的帧格式
+    std::vector<char> record;           // 二进制记录的一条记录；压缩记录为当前解码的一块
+    std::size_t recordPos;              // 压缩记录：下一条记录在块中的偏移
+    uint64_t recordsLeft;               // 二进制记录：剩余的记录数（不读文件尾）
+    double playbackSpeed;
+    double nominalFrameRate;
+    double corruptionRate;
+    std::mt19937 rng;
+
+    std::vector<char> pending;          // 已生成、尚未送出的字节
+    std::size_t pendingPos;
+    int64_t pendingDueNs;               // pending 的到达时刻（相对回放开始，已按倍速换算）
+    int64_t firstTimestampNs;           // 二进制记录第一帧的时间戳
+    uint64_t rawBytesProduced;          // 原始字节模式下已生成的字节数
+    bool eof;
+
+    uint64_t corruptBytes;
+    uint64_t corruptUnits;
+};
+
+#endif // REPLAYSOURCE_H
@@ -0,0 +1,101 @@
+#include "serialtuning.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+// 设备名（ttyUSB0 等），取不到时返回空字符串
+static std::string deviceName(int fd)
+{
+    char link[64];
+    char target[256];
+    std::snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+    const ssize_t n = readlink(link, target, sizeof(target) - 1);
+    if (n <= 0) return std::string();
+    target[n] = '\0';
+    const char *slash = std::strrchr(target, '/');
+    return slash ? std::string(slash + 1) : std::string(target);
+}
+
+// USB 转串口芯片的延迟定时器（毫秒）：读出原值，不为1时尝试改为1
+static void tuneLatencyTimer(int fd, std::string &report)
+{
+    const std::string name = deviceName(fd);
+    if (name.empty())   return;
+    const std::string path = "/sys/class/tty/" + name + "/device/latency_timer";
+    std::FILE *file = std::fopen(path.c_str(), "r");
+    if (!file)  return;     // 不是带延迟定时器的 USB 转串口芯片
+    int latencyMs = -1;
+    const bool parsed = std::fscanf(file, "%d", &latencyMs) == 1;
+    std::fclose(file);
+    if (!parsed)    return;
+
+    char line[128];
+    if (latencyMs > 1)
+    {
+        file = std::fopen(path.c_str(), "w");
+        if (file && std::fputs("1", file) >= 0 && std::fclose(file) == 0)
+        {
+            std::snprintf(line, sizeof(line), ", latency_timer %d→1ms", latencyMs);
+        }
+        else
+        {
+            if (file)   std::fclose(file);
+            std::snprintf(line, sizeof(line), ", latency_timer %dms（无权限修改 %s）", latencyMs, path.c_str());
+        }
+    }
+    else
+    {
+        std::snprintf(line, sizeof(line), ", latency_timer %dms", latencyMs);
+    }
+    report += line;
+}
+#endif
+
+bool applySerialLowLatency(int fd, std::string &report)
+{
+#if defined(__linux__)
+    termios tio;
+    if (tcgetattr(fd, &tio) != 0)
+    {
+        report = std::string("tcgetattr: ") + std::strerror(errno);
+        return false;
+    }
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        report = std::string("tcsetattr: ") + std::strerror(errno);
+        return false;
+    }
+    report = "VMIN=0 VTIME=0";
+
+    serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) != 0)
+    {
+        report += std::string(", 不支持 ASYNC_LOW_LATENCY（") + std::strerror(errno) + "）";
+    }
+    else if (!(serial.flags & ASYNC_LOW_LATENCY))
+    {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        if (ioctl(fd, TIOCSSERIAL, &serial) == 0)   report += ", ASYNC_LOW_LATENCY";
+        else    report += std::string(", 无法设置 ASYNC_LOW_LATENCY（") + std::strerror(errno) + "）";
+    }
+    else
+    {
+        report += ", ASYNC_LOW_LATENCY";
+    }
+
+    tuneLatencyTimer(fd, report);
+    return true;
+#else
+    (void)fd;
+    report = "未做低延迟设置（仅支持 Linux）";
+    return true;
+#endif
+}
@@ -0,0 +1,16 @@
+#ifndef SERIALTUNING_H
+#define SERIALTUNING_H
+
+#include <string>
+
+// 串口低延迟设置（Linux），作用于已打开的串口文件描述符（QSerialPort::handle()）：
+// - termios VMIN = 0、VTIME = 0：收到任意字节即报告可读（VMIN > 0 时 poll 要攒够 VMIN 字节才唤醒），
+//   读取立即返回已到达的全部数据，由帧同步器自己拼帧；
+// - ASYNC_LOW_LATENCY（TIOCSSERIAL）：驱动收到数据后立即交给 tty 层，不再攒批；
+// - USB 转串口芯片的延迟定时器（sysfs latency_timer，FTDI 默认16ms）设为1ms，
+//   否则高帧率时数据按16ms成批到达。需要写权限，失败时只在报告中说明。
+// 伪终端和部分驱动不支持后两项，保留原设置。
+// 返回 false 表示 termios 设置失败；report 为可读的结果说明。其他平台不做设置，返回 true。
+bool applySerialLowLatency(int fd, std::string &report);
+
+#endif // SERIALTUNING_H
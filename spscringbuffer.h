@@ -0,0 +1,60 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+
+// 单生产者/单消费者无锁环形队列
+// 生产者（采集线程）只写 head，消费者（界面线程）只写 tail，两端互不加锁。
+// 容量必须是2的幂，实际可存放 Capacity - 1 个元素。
+template <typename T, std::size_t Capacity>
+class SpscRingBuffer
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRingBuffer capacity must be a power of two");
+
+public:
+    SpscRingBuffer() : head(0), tail(0) {}
+
+    // 生产者调用：队列已满时返回 false，不覆盖未读数据
+    bool push(const T &item)
+    {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        const std::size_t next = (h + 1) & MASK;
+        if (next == tail.load(std::memory_order_acquire))   return false;
+        slots[h] = item;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用：队列为空时返回 false
+    bool pop(T &item)
+    {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))  return false;
+        item = slots[t];
+        tail.store((t + 1) & MASK, std::memory_order_release);
+        return true;
+    }
+
+    // 当前排队元素个数（近似值，仅用于统计显示）
+    std::size_t size() const
+    {
+        const std::size_t h = head.load(std::memory_order_acquire);
+        const std::size_t t = tail.load(std::memory_order_acquire);
+        return (h - t) & MASK;
+    }
+
+    bool isEmpty() const { return size() == 0; }
+    static std::size_t capacity() { return Capacity - 1; }
+
+private:
+    static const std::size_t MASK = Capacity - 1;
+
+    // head/tail 分别放在独立的缓存行，避免生产者和消费者互相伪共享
+    alignas(64) std::atomic<std::size_t> head;
+    alignas(64) std::atomic<std::size_t> tail;
+    alignas(64) T slots[Capacity];
+};
+
+#endif // SPSCRINGBUFFER_H